@@ -12,6 +12,7 @@
 #include <Systems/TextureSystem.h>
 #include <Systems/ShaderSystem.h>
 #include <Systems/RenderViewSystem.hpp>
+#include <Systems/JobSystem.hpp>
 #include <Core/Identifier.hpp>
 #include <Renderer/RendererFrontend.hpp>
 #include "Keybinds.hpp"
@@ -20,6 +21,52 @@
 static FrustumCullMode CullMode = FrustumCullMode::eAABB_Cull;
 static bool EnableFrustumCulling = true;
 
+// Meshes per parallel culling chunk.
+#define FRUSTUM_CULL_GRAIN 16
+
+static bool IsGeometryVisible(Frustum& frustum, Geometry* g, const Matrix4& model) {
+	switch (CullMode)
+	{
+	// Bounding sphere calculation
+	case FrustumCullMode::eSphere_Cull:
+	{
+		Vector3 ExtensMin = g->Extents.min.Transform(model);
+		Vector3 ExtensMax = g->Extents.max.Transform(model);
+
+		float Min = DMIN(DMIN(ExtensMin.x, ExtensMin.y), ExtensMin.z);
+		float Max = DMIN(DMIN(ExtensMax.x, ExtensMax.y), ExtensMax.z);
+		float Diff = Dabs(Max - Min);
+		float Radius = Diff / 2.0f;
+
+		// Translate/scale the center.
+		Vector3 Center = g->Center.Transform(model);
+		return frustum.IntersectsSphere(Center, Radius);
+	}
+	// AABB calculation
+	case FrustumCullMode::eAABB_Cull:
+	{
+		if (!EnableFrustumCulling) {
+			return true;
+		}
+
+		// Translate/scale the extents.
+		Vector3 ExtentsMax = g->Extents.max.Transform(model);
+
+		// Translate/scale the center.
+		Vector3 Center = g->Center.Transform(model);
+		Vector3 HalfExtents = {
+			Dabs(ExtentsMax.x - Center.x),
+			Dabs(ExtentsMax.y - Center.y),
+			Dabs(ExtentsMax.z - Center.z)
+		};
+
+		return frustum.IntersectsAABB(Center, HalfExtents);
+	}
+	}
+
+	return false;
+}
+
 bool GameOnEvent(eEventCode code, void* sender, void* listender_inst, SEventContext context) {
 	GameInstance* GameInst = (GameInstance*)listender_inst;
 
@@ -280,12 +327,8 @@ void GameInstance::Shutdown() {
 }
 
 bool GameInstance::Update(float delta_time) {
-	// Ensure this is cleaned up to avoid leaking memory.
-	// TODO: Need a version of this that uses the frame allocator.
-	if (!FrameData.WorldGeometries.empty()) {
-		FrameData.WorldGeometries.clear();
-		std::vector<GeometryRenderData>().swap(FrameData.WorldGeometries);
-	}
+	// Drop last frame's geometries rather than clearing them, their memory belongs to the other frame arena.
+	TFrameVector<GeometryRenderData>().swap(FrameData.WorldGeometries);
 
 	int px, py, cx, cy;
 	Controller::GetMousePosition(cx, cy);
@@ -331,87 +374,47 @@ bool GameInstance::Update(float delta_time) {
 	// TODO: Get camera fov, aspect etc.
 	CameraFrustum = Frustum(WorldCamera->GetPosition(), Forward, Right, Up, (float)Width / (float)Height, Deg2Rad(45.0f), 0.1f, 1000.0f);
 
-	// NOTE: starting at a reasonable default to avoid too many realloc.
-	uint32_t DrawCount = 0;
-	for (uint32_t i = 0; i < (uint32_t)Meshes.Size(); ++i) {
+	// Resolve world transforms up front, Transform::GetLocal() updates lazily and parents may be shared.
+	uint32_t MeshCount = (uint32_t)Meshes.Size();
+	std::vector<Matrix4> Models(MeshCount);
+	std::vector<uint32_t> GeometryOffsets(MeshCount + 1, 0);
+	for (uint32_t i = 0; i < MeshCount; ++i) {
 		Mesh* m = Meshes[i];
-		if (m == nullptr) {
-			continue;
+		uint32_t GeometryCount = 0;
+		if (m != nullptr && m->Generation != INVALID_ID_U8) {
+			Models[i] = m->GetWorldTransform();
+			GeometryCount = m->geometry_count;
 		}
+		GeometryOffsets[i + 1] = GeometryOffsets[i] + GeometryCount;
+	}
 
-		if (m->Generation != INVALID_ID_U8) {
-			Matrix4 Model = m->GetWorldTransform();
-
-			for (uint32_t j = 0; j < m->geometry_count; j++) {
-				Geometry* g = m->geometries[j];
-				if (g == nullptr) {
-					continue;
-				}
-
-				switch (CullMode)
-				{
-				// Bounding sphere calculation
-				case FrustumCullMode::eSphere_Cull:
-				{
-					Vector3 ExtensMin = g->Extents.min.Transform(Model);
-					Vector3 ExtensMax = g->Extents.max.Transform(Model);
-
-					float Min = DMIN(DMIN(ExtensMin.x, ExtensMin.y), ExtensMin.z);
-					float Max = DMIN(DMIN(ExtensMax.x, ExtensMax.y), ExtensMax.z);
-					float Diff = Dabs(Max - Min);
-					float Radius = Diff / 2.0f;
-
-					// Translate/scale the center.
-					Vector3 Center = g->Center.Transform(Model);
-
-					if (CameraFrustum.IntersectsSphere(Center, Radius)) {
-						// Add it to the list to be rendered.
-						GeometryRenderData Data;
-						Data.model = Model;
-						Data.geometry = g;
-						Data.uniqueID = m->UniqueID;
-						FrameData.WorldGeometries.push_back(Data);
-						DrawCount++;
-					}
-				} break;
-				// AABB calculation
-				case FrustumCullMode::eAABB_Cull:
-				{
-					// Translate/scale the extents.
-					Vector3 ExtentsMax = g->Extents.max.Transform(Model);
-
-					// Translate/scale the center.
-					Vector3 Center = g->Center.Transform(Model);
-					Vector3 HalfExtents = {
-						Dabs(ExtentsMax.x - Center.x),
-						Dabs(ExtentsMax.y - Center.y),
-						Dabs(ExtentsMax.z - Center.z)
-					};
-
-					if (CameraFrustum.IntersectsAABB(Center, HalfExtents) && EnableFrustumCulling) {
-						// Add it to the list to be rendered.
-						GeometryRenderData Data;
-						Data.model = Model;
-						Data.geometry = g;
-						Data.uniqueID = m->UniqueID;
-						FrameData.WorldGeometries.push_back(Data);
-						DrawCount++;
-					}
-					else if (!EnableFrustumCulling) {
-						// Add it to the list to be rendered.
-						GeometryRenderData Data;
-						Data.model = Model;
-						Data.geometry = g;
-						Data.uniqueID = m->UniqueID;
-						FrameData.WorldGeometries.push_back(Data);
-						DrawCount++;
-					}
-				} break;
-				}
+	// Cull on the job threads, then gather the visible geometries in mesh order.
+	std::vector<unsigned char> Visible(GeometryOffsets[MeshCount], 0);
+	JobSystem::ParallelFor(0, MeshCount, FRUSTUM_CULL_GRAIN, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			for (uint32_t j = 0; j < GeometryOffsets[i + 1] - GeometryOffsets[i]; ++j) {
+				Geometry* g = Meshes[i]->geometries[j];
+				Visible[GeometryOffsets[i] + j] = g != nullptr && IsGeometryVisible(CameraFrustum, g, Models[i]);
 			}
 		}
-	}
+	});
+
+	uint32_t DrawCount = 0;
+	for (uint32_t i = 0; i < MeshCount; ++i) {
+		for (uint32_t j = 0; j < GeometryOffsets[i + 1] - GeometryOffsets[i]; ++j) {
+			if (!Visible[GeometryOffsets[i] + j]) {
+				continue;
+			}
 
+			// Add it to the list to be rendered.
+			GeometryRenderData Data;
+			Data.model = Models[i];
+			Data.geometry = Meshes[i]->geometries[j];
+			Data.uniqueID = Meshes[i]->UniqueID;
+			FrameData.WorldGeometries.push_back(Data);
+			DrawCount++;
+		}
+	}
 
 	// TODO: Temp
 	std::string HoverdObjectName = "None";
@@ -495,18 +498,21 @@ bool GameInstance::Render(SRenderPacket* packet, float delta_time) {
 		}
 	}
 	
-	// UI
+	// UI. The list holds exactly the loaded meshes, the view frees it by their count.
 	uint32_t UIMeshCount = 0;
-	Mesh** TempUIMeshes = (Mesh**)Memory::Allocate(sizeof(Mesh*) * 10, MemoryType::eMemory_Type_Array);
-	// TODO: Flexible size array.
 	for (uint32_t i = 0; i < (uint32_t)UIMeshes.Size(); ++i) {
 		if (UIMeshes[i]->Generation != INVALID_ID_U8) {
-			TempUIMeshes[UIMeshCount] = UIMeshes[i];
 			UIMeshCount++;
 		}
 	}
+	Mesh** TempUIMeshes = (Mesh**)Memory::AllocateFrame(sizeof(Mesh*) * UIMeshCount, alignof(Mesh*));
+	for (uint32_t i = 0, j = 0; i < (uint32_t)UIMeshes.Size(); ++i) {
+		if (UIMeshes[i]->Generation != INVALID_ID_U8) {
+			TempUIMeshes[j++] = UIMeshes[i];
+		}
+	}
 
-	UIText** Texts = (UIText**)Memory::Allocate(sizeof(UIText*) * 4, MemoryType::eMemory_Type_Array);
+	UIText** Texts = (UIText**)Memory::AllocateFrame(sizeof(UIText*) * 4, alignof(UIText*));
 	Texts[0] = &TestText;
 	Texts[1] = &TestSysText;
 	Texts[2] = GameConsole->GetText();
@@ -4,307 +4,464 @@
 #include "Core/EngineLogger.hpp"
 #include "Platform/Platform.hpp"
 
-bool Freelist::Create(size_t total_size) {
-	// Enough space to hold state, plus array for all nodes.
-	TotalSize = total_size;
-	MaxEntries = (total_size / sizeof(void*));
-	LOG_INFO("Freelist max entries: %d.", MaxEntries);
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#define FREELIST_INITIAL_NODES 64
+#define FREELIST_INITIAL_LOOKUP 128
+
+static uint32_t HighestBit(uint64_t value) {
+#if defined(_MSC_VER)
+	unsigned long Index = 0;
+	_BitScanReverse64(&Index, value);
+	return (uint32_t)Index;
+#else
+	return 63 - (uint32_t)__builtin_clzll(value);
+#endif
+}
 
-	size_t UesdSize = sizeof(FreelistNode) * MaxEntries;
-	ListMemory = Platform::PlatformAllocate(UesdSize, false);
-	if (ListMemory == nullptr) {
-		LOG_FATAL("Cannot allocate enough memory for freelist!");
-		return false;
+static uint32_t LowestBit(uint64_t value) {
+#if defined(_MSC_VER)
+	unsigned long Index = 0;
+	_BitScanForward64(&Index, value);
+	return (uint32_t)Index;
+#else
+	return (uint32_t)__builtin_ctzll(value);
+#endif
+}
+
+// Obtains the class a free block of the given size is kept in.
+static void MapSize(size_t size, uint32_t* out_fl, uint32_t* out_sl) {
+	if (size < FREELIST_SL_COUNT) {
+		*out_fl = 0;
+		*out_sl = (uint32_t)size;
+		return;
 	}
 
-	Memory::Zero(ListMemory, UesdSize);
+	uint32_t Bit = HighestBit(size);
+	*out_fl = Bit - FREELIST_SL_LOG2 + 1;
+	*out_sl = (uint32_t)(size >> (Bit - FREELIST_SL_LOG2)) - FREELIST_SL_COUNT;
+}
 
-	Nodes = (FreelistNode*)ListMemory;
+static size_t HashOffset(size_t offset, size_t capacity) {
+	return (size_t)(((uint64_t)offset * 0x9E3779B97F4A7C15ull) >> 32) & (capacity - 1);
+}
 
-	Head = &Nodes[0];
-	Head->offset = 0;
-	Head->size = total_size;
-	Head->next = nullptr;
+bool Freelist::Create(size_t total_size) {
+	TotalSize = total_size;
+	FreeSpace = 0;
 
-	// Invalidate the offset and size for all but the first node. The invalid value
-	// will be checked for when seeking a new node from the list.
-	for (size_t i = 1; i < MaxEntries; ++i) {
-		Nodes[i].offset = INVALID_ID;
-		Nodes[i].size = INVALID_ID;
+	NodeCapacity = FREELIST_INITIAL_NODES;
+	Nodes = (FreelistNode*)Platform::PlatformAllocate(sizeof(FreelistNode) * NodeCapacity, false);
+	if (Nodes == nullptr || !ResizeLookup(FREELIST_INITIAL_LOOKUP)) {
+		LOG_FATAL("Cannot allocate enough memory for freelist!");
+		return false;
 	}
 
+	Clear();
 	return true;
 }
 
 void Freelist::Destroy() {
-	if (ListMemory != nullptr) {
-		Platform::PlatformFree(ListMemory, false);
-		ListMemory = nullptr;
+	if (Nodes != nullptr) {
+		Platform::PlatformFree(Nodes, false);
+		Nodes = nullptr;
+	}
+	if (LookupSlots != nullptr) {
+		Platform::PlatformFree(LookupSlots, false);
+		LookupSlots = nullptr;
 	}
+
+	NodeCapacity = 0;
+	LookupCapacity = 0;
+	LookupCount = 0;
+	FreeSpace = 0;
 }
 
 bool Freelist::AllocateBlock(size_t size, size_t* offset) {
-	if (offset == nullptr || ListMemory == nullptr) {
+	if (offset == nullptr || Nodes == nullptr || size == 0) {
 		return false;
 	}
 
-	FreelistNode* Node = Head;
-	FreelistNode* Prev = nullptr;
-	while (Node != nullptr) {
-		if (Node->size == size) {
-			// Exact match. Just return the node.
-			// If not aligned, this wont be large enough.
-			*offset = Node->offset;
-			FreelistNode* ReturnNode = nullptr;
-			if (Prev != nullptr) {
-				Prev->next = Node->next;
-				ReturnNode = Node;
-			}
-			else {
-				// This node is the head of the list. Reassign the head and return the previous head node.
-				ReturnNode = Head;
-				Head = Node->next;
-			}
-			ResetNode(ReturnNode);
-			return true;
+	// Make sure a node for the remainder and room in the lookup are at hand before anything is taken apart.
+	if ((LookupCount + 1) * 2 > LookupCapacity && !ResizeLookup(LookupCapacity * 2)) {
+		return false;
+	}
+	uint32_t Remainder = AcquireNode();
+	if (Remainder == INVALID_ID) {
+		return false;
+	}
+
+	uint32_t Found = FindFreeNode(size);
+	if (Found == INVALID_ID) {
+		ReleaseNode(Remainder);
+		LOG_WARN("Freelist find block, no block with enough free space found (requested: %lluB, available: %lluB, largest: %lluB).",
+			(unsigned long long)size, (unsigned long long)FreeSpace, (unsigned long long)GetLargestFreeBlock());
+		return false;
+	}
+
+	RemoveFreeNode(Found);
+	FreelistNode* Node = &Nodes[Found];
+	if (Node->size > size) {
+		// Split off the rest and keep it free.
+		FreelistNode* Rest = &Nodes[Remainder];
+		Rest->offset = Node->offset + size;
+		Rest->size = Node->size - size;
+		Rest->prev_physical = Found;
+		Rest->next_physical = Node->next_physical;
+		if (Rest->next_physical != INVALID_ID) {
+			Nodes[Rest->next_physical].prev_physical = Remainder;
 		}
-		else if (Node->size > size) {
-			// Node is larger than the requirement + the alignment offset.
-			// Deduct the memory from it and move the offset by that amount.
-			*offset = Node->offset;
-			Node->size -= size;
-			Node->offset += size;
-			return true;
+		else {
+			LastNode = Remainder;
 		}
-
-		Prev = Node;
-		Node = Node->next;
+		Node->next_physical = Remainder;
+		Node->size = size;
+		InsertFreeNode(Remainder);
+	}
+	else {
+		ReleaseNode(Remainder);
 	}
 
-	size_t FreeSpace = GetFreeSpace();
-	LOG_WARN("Freelist find block, no block with enough free space found (requested: %uB, available: %lluB).", size, FreeSpace);
-	return false;
+	Node->free = false;
+	InsertLookup(Found);
+	FreeSpace -= size;
+	*offset = Node->offset;
+	return true;
 }
 
 bool Freelist::FreeBlock(size_t size, size_t offset) {
-	if (ListMemory == nullptr || size == 0) {
+	if (Nodes == nullptr || size == 0) {
 		return false;
 	}
 
-	FreelistNode* Node = Head;
-	FreelistNode* Prev = nullptr;
-
-	if (Node == nullptr) {
-		// Check for the case where the entire thing is allocated.
-		// In this case a new node is needed at the head.
-		FreelistNode* NewNode = AcquireFreeNode();
-		NewNode->offset = offset;
-		NewNode->size = size;
-		NewNode->next = nullptr;
-		Head = NewNode;
-		return true;
+	uint32_t Index = FindLookup(offset);
+	if (Index == INVALID_ID) {
+		// Either already freed, or never handed out.
+		LOG_FATAL("Attemping to free block of memory at offset %llu which is not allocated.", (unsigned long long)offset);
+		return false;
+	}
+	if (Nodes[Index].size != size) {
+		LOG_WARN("Unable to free block at offset %llu, its size is %lluB rather than %lluB. Corruption possible?",
+			(unsigned long long)offset, (unsigned long long)Nodes[Index].size, (unsigned long long)size);
+		return false;
 	}
-	else
-	{
-		while (Node != nullptr) {
-			if (Node->offset + Node->size == offset) {
-				// Can just be appended to right of this node.
-				Node->size += size;
-
-				// Check if this then connects the range between this and the next node,
-				// and if so, combine them and return the second node.
-				if (Node->next && Node->next->offset == Node->offset + Node->size) {
-					Node->size += Node->next->size;
-					FreelistNode* Next = Node->next;
-					Node->next = Node->next->next;
-					ResetNode(Next);
-				}
-				return true;
-			}
-			else if (Node->offset == offset) {
-				// If there is a exact match, this means the exact block of memory
-				// that is already free is being freed again.
-				LOG_FATAL("Attemping to free already-freed block of memory at offset %llu.", Node->offset);
-				return false;
-			}
-			else if (Node->offset > offset) {
-				// Iterated beyond the space to be freed. Need a new node.
-				FreelistNode* NewNode = AcquireFreeNode();
-				NewNode->offset = offset;
-				NewNode->size = size;
-
-				// If there is a previous node, the new node should be inserted between this and it.
-				if (Prev) {
-					Prev->next = NewNode;
-					NewNode->next = Node;
-				}
-				else {
-					// Otherwise, the new node becomes the head.
-					NewNode->next = Node;
-					Head = NewNode;
-				}
-
-				// Double check next node to see if it can be joined.
-				if (NewNode->next && NewNode->offset + NewNode->size == NewNode->next->offset) {
-					NewNode->size += NewNode->next->size;
-					FreelistNode* Rubbish = NewNode->next;
-					NewNode->next = Rubbish->next;
-					ResetNode(Rubbish);
-				}
-
-				// Double check next node to see if it can be joined.
-				if (Prev && Prev->offset + Prev->size == NewNode->offset) {
-					Prev->size += NewNode->size;
-					FreelistNode* Rubbish = NewNode;
-					Prev->next = Rubbish->next;
-					ResetNode(Rubbish);
-				}
-
-				return true;
-			}
-
-			// If on the last node and the last node's offset+size < the free offset,
-			// a new node is required.
-			if (!Node->next && Node->offset + Node->size < offset) {
-				FreelistNode* NewNode = AcquireFreeNode();
-				NewNode->offset = offset;
-				NewNode->size = size;
-				NewNode->next = nullptr;
-				Node->next = NewNode;
 
-				return true;
-			}
+	RemoveLookup(offset);
+	FreeSpace += size;
+
+	// Merge with the free neighbours right away, so free blocks never sit next to each other.
+	uint32_t Next = Nodes[Index].next_physical;
+	if (Next != INVALID_ID && Nodes[Next].free) {
+		RemoveFreeNode(Next);
+		Nodes[Index].size += Nodes[Next].size;
+		Nodes[Index].next_physical = Nodes[Next].next_physical;
+		if (Nodes[Next].next_physical != INVALID_ID) {
+			Nodes[Nodes[Next].next_physical].prev_physical = Index;
+		}
+		else {
+			LastNode = Index;
+		}
+		ReleaseNode(Next);
+	}
 
-			Prev = Node;
-			Node = Node->next;
+	uint32_t Prev = Nodes[Index].prev_physical;
+	if (Prev != INVALID_ID && Nodes[Prev].free) {
+		RemoveFreeNode(Prev);
+		Nodes[Prev].size += Nodes[Index].size;
+		Nodes[Prev].next_physical = Nodes[Index].next_physical;
+		if (Nodes[Index].next_physical != INVALID_ID) {
+			Nodes[Nodes[Index].next_physical].prev_physical = Prev;
+		}
+		else {
+			LastNode = Prev;
 		}
+		ReleaseNode(Index);
+		Index = Prev;
 	}
 
-	LOG_WARN("Unable to find block to be freed. Corruption possible?");
-	return false;
+	InsertFreeNode(Index);
+	return true;
 }
 
 bool Freelist::Resize(size_t new_size) {
-	if (ListMemory == nullptr || new_size < TotalSize) {
+	if (Nodes == nullptr || new_size < TotalSize) {
 		return false;
 	}
 
-	size_t OldSize = TotalSize;
-
-	// Enough space to hold state.
 	size_t SizeDiff = new_size - TotalSize;
-	MaxEntries = (new_size / sizeof(void*));
-	TotalSize = new_size;
-
-	void* NewMemory = Platform::PlatformAllocate(sizeof(FreelistNode) * MaxEntries, false);
-	Memory::Zero(NewMemory, sizeof(FreelistNode) * MaxEntries);
-
-	// Invalidate the offset and size for all but the first node. The invalid value
-	// will be checked for when seeking a new node from the list.
-	for (size_t i = 1; i < MaxEntries; ++i) {
-		Nodes[i].offset = INVALID_ID;
-		Nodes[i].size = INVALID_ID;
+	if (SizeDiff == 0) {
+		return true;
 	}
 
-	// Copy over the nodes.
-	FreelistNode* NewListNode = &((FreelistNode*)NewMemory)[0];
-	FreelistNode* OldListNode = Head;
-
-	Nodes = (FreelistNode*)ListMemory;
-	Head = &Nodes[0];
-
-	if (OldListNode == nullptr) {
-		// If there is no head, then the entire list is allocated. In this case
-		// the head should be set to the difference of the space now available, and
-		// at the end of the list.
-		Head->offset = OldSize;
-		Head->size = SizeDiff;
-		Head->next = nullptr;
+	// The new space follows the last block, joining it if that one is free.
+	if (LastNode != INVALID_ID && Nodes[LastNode].free) {
+		RemoveFreeNode(LastNode);
+		Nodes[LastNode].size += SizeDiff;
+		InsertFreeNode(LastNode);
 	}
 	else {
-		while (OldListNode) {
-			// Get a new node, copy the offset/size, and set next to it.
-			FreelistNode* NewNode = AcquireFreeNode();
-			NewNode->offset = OldListNode->offset;
-			NewNode->size = OldListNode->size;
-			NewNode->next = nullptr;
-			NewListNode->next = NewNode;
-			// Move to the next entry.
-			NewListNode = NewListNode->next;
-
-			if (OldListNode->next) {
-				// If there is another node, move on.
-				OldListNode = OldListNode->next;
-			}
-			else {
-				// Reached the end of the list.
-				// Check if it extends to the end of the block. If so, just append
-				// to the size. Otherwise, create a new node and attach to it.
-				if (OldListNode->offset + OldListNode->size == OldSize) {
-					NewNode->size += SizeDiff;
-				}
-				else {
-					FreelistNode* NewNodeEnd = AcquireFreeNode();
-					NewNodeEnd->offset = OldSize;
-					NewNodeEnd->size = SizeDiff;
-					NewNodeEnd->next = nullptr;
-					NewNode->next = NewNodeEnd;
-				}
-				break;
-			}
+		uint32_t Index = AcquireNode();
+		if (Index == INVALID_ID) {
+			return false;
 		}
-	}
 
-	Platform::PlatformFree(ListMemory, false);
-	ListMemory = NewMemory;
+		Nodes[Index].offset = TotalSize;
+		Nodes[Index].size = SizeDiff;
+		Nodes[Index].prev_physical = LastNode;
+		Nodes[Index].next_physical = INVALID_ID;
+		if (LastNode != INVALID_ID) {
+			Nodes[LastNode].next_physical = Index;
+		}
+		LastNode = Index;
+		InsertFreeNode(Index);
+	}
 
+	TotalSize = new_size;
+	FreeSpace += SizeDiff;
 	return true;
 }
 
 void Freelist::Clear() {
-	if (ListMemory != nullptr) {
-		// Invalidate the offset and size for all but the first node. The invalid value
-		// will be checked for when seeking a new node from the list.
-		for (size_t i = 0; i < MaxEntries; ++i) {
-			Nodes[i].offset = INVALID_ID;
-			Nodes[i].size = INVALID_ID;
+	if (Nodes == nullptr) {
+		return;
+	}
+
+	// Chain every node as unused.
+	for (uint32_t i = 0; i < NodeCapacity; ++i) {
+		Nodes[i] = FreelistNode();
+		Nodes[i].next_free = i + 1 < NodeCapacity ? i + 1 : INVALID_ID;
+	}
+	UnusedNodes = 0;
+
+	for (size_t i = 0; i < LookupCapacity; ++i) {
+		LookupSlots[i] = INVALID_ID;
+	}
+	LookupCount = 0;
+
+	FirstLevelMap = 0;
+	for (uint32_t i = 0; i < FREELIST_FL_COUNT; ++i) {
+		SecondLevelMaps[i] = 0;
+		for (uint32_t j = 0; j < FREELIST_SL_COUNT; ++j) {
+			FreeHeads[i][j] = INVALID_ID;
 		}
+	}
 
-		// Reset the head to occupy the entire thing.
-		Head->offset = 0;
-		Head->size = TotalSize;
-		Head->next = nullptr;
+	LastNode = INVALID_ID;
+	FreeSpace = 0;
+	if (TotalSize > 0) {
+		// The whole range starts out as a single free block.
+		LastNode = AcquireNode();
+		Nodes[LastNode].offset = 0;
+		Nodes[LastNode].size = TotalSize;
+		InsertFreeNode(LastNode);
+		FreeSpace = TotalSize;
 	}
 }
 
 size_t Freelist::GetFreeSpace() {
-	if (ListMemory == nullptr) {
+	return Nodes != nullptr ? FreeSpace : 0;
+}
+
+size_t Freelist::GetLargestFreeBlock() {
+	if (Nodes == nullptr || FirstLevelMap == 0) {
 		return 0;
 	}
 
-	size_t RunningTotal = 0;
-	FreelistNode* Node = Head;
-	while (Node != nullptr) {
-		RunningTotal += Node->size;
-		Node = Node->next;
+	// Blocks of the highest class differ in size, so its list is walked.
+	uint32_t FL = HighestBit(FirstLevelMap);
+	uint32_t SL = HighestBit(SecondLevelMaps[FL]);
+	size_t Largest = 0;
+	for (uint32_t Index = FreeHeads[FL][SL]; Index != INVALID_ID; Index = Nodes[Index].next_free) {
+		Largest = DMAX(Largest, Nodes[Index].size);
+	}
+	return Largest;
+}
+
+uint32_t Freelist::AcquireNode() {
+	if (UnusedNodes == INVALID_ID) {
+		// Grow the node pool. Nodes refer to each other by index, so they may move.
+		uint32_t NewCapacity = NodeCapacity * 2;
+		FreelistNode* NewNodes = (FreelistNode*)Platform::PlatformAllocate(sizeof(FreelistNode) * NewCapacity, false);
+		if (NewNodes == nullptr) {
+			LOG_FATAL("Cannot allocate enough memory for freelist nodes!");
+			return INVALID_ID;
+		}
+
+		Platform::PlatformCopyMemory(NewNodes, Nodes, sizeof(FreelistNode) * NodeCapacity);
+		for (uint32_t i = NodeCapacity; i < NewCapacity; ++i) {
+			NewNodes[i] = FreelistNode();
+			NewNodes[i].next_free = i + 1 < NewCapacity ? i + 1 : INVALID_ID;
+		}
+		Platform::PlatformFree(Nodes, false);
+		Nodes = NewNodes;
+		UnusedNodes = NodeCapacity;
+		NodeCapacity = NewCapacity;
 	}
 
-	return RunningTotal;
+	uint32_t Index = UnusedNodes;
+	UnusedNodes = Nodes[Index].next_free;
+	Nodes[Index] = FreelistNode();
+	return Index;
+}
+
+void Freelist::ReleaseNode(uint32_t node) {
+	Nodes[node] = FreelistNode();
+	Nodes[node].next_free = UnusedNodes;
+	UnusedNodes = node;
 }
 
-FreelistNode* Freelist::AcquireFreeNode() {
-	for (size_t i = 1; i < MaxEntries; ++i) {
-		if (Nodes[i].offset == INVALID_ID) {
-			return &Nodes[i];
+void Freelist::InsertFreeNode(uint32_t node) {
+	uint32_t FL = 0, SL = 0;
+	MapSize(Nodes[node].size, &FL, &SL);
+
+	FreelistNode* Node = &Nodes[node];
+	Node->free = true;
+	Node->prev_free = INVALID_ID;
+	Node->next_free = FreeHeads[FL][SL];
+	if (Node->next_free != INVALID_ID) {
+		Nodes[Node->next_free].prev_free = node;
+	}
+	FreeHeads[FL][SL] = node;
+
+	FirstLevelMap |= 1ull << FL;
+	SecondLevelMaps[FL] |= 1u << SL;
+}
+
+void Freelist::RemoveFreeNode(uint32_t node) {
+	uint32_t FL = 0, SL = 0;
+	MapSize(Nodes[node].size, &FL, &SL);
+
+	FreelistNode* Node = &Nodes[node];
+	if (Node->prev_free != INVALID_ID) {
+		Nodes[Node->prev_free].next_free = Node->next_free;
+	}
+	else {
+		FreeHeads[FL][SL] = Node->next_free;
+	}
+	if (Node->next_free != INVALID_ID) {
+		Nodes[Node->next_free].prev_free = Node->prev_free;
+	}
+
+	if (FreeHeads[FL][SL] == INVALID_ID) {
+		SecondLevelMaps[FL] &= ~(1u << SL);
+		if (SecondLevelMaps[FL] == 0) {
+			FirstLevelMap &= ~(1ull << FL);
 		}
 	}
 
-	// Return nothing if no nodes are available.
-	return nullptr;
+	Node->free = false;
+	Node->prev_free = INVALID_ID;
+	Node->next_free = INVALID_ID;
 }
 
-void Freelist::ResetNode(FreelistNode* node) {
-	node->offset = INVALID_ID;
-	node->size = INVALID_ID;
-	node->next = nullptr;
+uint32_t Freelist::FindFreeNode(size_t size) {
+	// Round the size up to the next class, so any block found there is large enough without looking at it.
+	size_t Rounded = size;
+	if (size >= FREELIST_SL_COUNT) {
+		Rounded += ((size_t)1 << (HighestBit(size) - FREELIST_SL_LOG2)) - 1;
+	}
+
+	if (Rounded >= size) {
+		uint32_t FL = 0, SL = 0;
+		MapSize(Rounded, &FL, &SL);
+
+		uint32_t SecondMap = SecondLevelMaps[FL] & (~0u << SL);
+		if (SecondMap == 0) {
+			uint64_t FirstMap = FL + 1 < 64 ? FirstLevelMap & (~0ull << (FL + 1)) : 0;
+			if (FirstMap != 0) {
+				FL = LowestBit(FirstMap);
+				SecondMap = SecondLevelMaps[FL];
+			}
+		}
+
+		if (SecondMap != 0) {
+			return FreeHeads[FL][LowestBit(SecondMap)];
+		}
+	}
+
+	// Nothing in the classes above, a block of the size's own class may still fit. Only happens close to running out.
+	uint32_t FL = 0, SL = 0;
+	MapSize(size, &FL, &SL);
+	for (uint32_t Index = FreeHeads[FL][SL]; Index != INVALID_ID; Index = Nodes[Index].next_free) {
+		if (Nodes[Index].size >= size) {
+			return Index;
+		}
+	}
+
+	return INVALID_ID;
+}
+
+void Freelist::InsertLookup(uint32_t node) {
+	size_t Slot = HashOffset(Nodes[node].offset, LookupCapacity);
+	while (LookupSlots[Slot] != INVALID_ID) {
+		Slot = (Slot + 1) & (LookupCapacity - 1);
+	}
+	LookupSlots[Slot] = node;
+	LookupCount++;
+}
+
+uint32_t Freelist::FindLookup(size_t offset) {
+	size_t Slot = HashOffset(offset, LookupCapacity);
+	while (LookupSlots[Slot] != INVALID_ID) {
+		if (Nodes[LookupSlots[Slot]].offset == offset) {
+			return LookupSlots[Slot];
+		}
+		Slot = (Slot + 1) & (LookupCapacity - 1);
+	}
+	return INVALID_ID;
+}
+
+void Freelist::RemoveLookup(size_t offset) {
+	size_t Mask = LookupCapacity - 1;
+	size_t Slot = HashOffset(offset, LookupCapacity);
+	while (LookupSlots[Slot] != INVALID_ID && Nodes[LookupSlots[Slot]].offset != offset) {
+		Slot = (Slot + 1) & Mask;
+	}
+	if (LookupSlots[Slot] == INVALID_ID) {
+		return;
+	}
+
+	// Shift the following entries back, so no lookup stops early at the hole.
+	size_t Hole = Slot;
+	size_t Next = (Hole + 1) & Mask;
+	while (LookupSlots[Next] != INVALID_ID) {
+		size_t Home = HashOffset(Nodes[LookupSlots[Next]].offset, LookupCapacity);
+		if (((Next - Home) & Mask) >= ((Next - Hole) & Mask)) {
+			LookupSlots[Hole] = LookupSlots[Next];
+			Hole = Next;
+		}
+		Next = (Next + 1) & Mask;
+	}
+	LookupSlots[Hole] = INVALID_ID;
+	LookupCount--;
+}
+
+bool Freelist::ResizeLookup(size_t capacity) {
+	uint32_t* NewSlots = (uint32_t*)Platform::PlatformAllocate(sizeof(uint32_t) * capacity, false);
+	if (NewSlots == nullptr) {
+		LOG_FATAL("Cannot allocate enough memory for freelist lookup!");
+		return false;
+	}
+
+	for (size_t i = 0; i < capacity; ++i) {
+		NewSlots[i] = INVALID_ID;
+	}
+
+	uint32_t* OldSlots = LookupSlots;
+	size_t OldCapacity = LookupCapacity;
+	LookupSlots = NewSlots;
+	LookupCapacity = capacity;
+	LookupCount = 0;
+	for (size_t i = 0; i < OldCapacity; ++i) {
+		if (OldSlots[i] != INVALID_ID) {
+			InsertLookup(OldSlots[i]);
+		}
+	}
+
+	if (OldSlots != nullptr) {
+		Platform::PlatformFree(OldSlots, false);
+	}
+	return true;
 }
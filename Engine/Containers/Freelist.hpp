@@ -2,20 +2,38 @@
 
 #include "Defines.hpp"
 
+// Free blocks are sorted into classes by size, one first level class per power of two,
+// each split into FREELIST_SL_COUNT second level classes of equal width.
+#define FREELIST_SL_LOG2 5
+#define FREELIST_SL_COUNT (1 << FREELIST_SL_LOG2)
+#define FREELIST_FL_COUNT (64 - FREELIST_SL_LOG2 + 1)
+
 struct DAPI FreelistNode {
 	size_t offset = 0;
 	size_t size = 0;
-	struct FreelistNode* next = nullptr;
+	// The blocks right before and after this one, free or not.
+	uint32_t prev_physical = INVALID_ID;
+	uint32_t next_physical = INVALID_ID;
+	// The neighbours in the list of the size class while free. While unused, next_free links the unused nodes.
+	uint32_t prev_free = INVALID_ID;
+	uint32_t next_free = INVALID_ID;
+	bool free = false;
 };
 
+/**
+ * @brief Tracks free ranges of a memory block by offset, the memory itself is never touched.
+ * Two level segregated fit: allocating and freeing take constant time, and freed blocks merge with
+ * their free neighbours right away.
+ */
 class DAPI Freelist {
 public:
-	Freelist() : ListMemory(nullptr), Head(nullptr), Nodes(nullptr), MaxEntries(50), TotalSize(0) {}
+	Freelist() : TotalSize(0), FreeSpace(0), Nodes(nullptr), NodeCapacity(0), UnusedNodes(INVALID_ID), LastNode(INVALID_ID),
+		LookupSlots(nullptr), LookupCapacity(0), LookupCount(0), FirstLevelMap(0) {}
 
 public:
 	/*
 	* @brief Creates a new FreeList or obtains the memory requirement for one.
-	* 
+	*
 	* @param total_size The total size in bytes that the free list should track.
 	*/
 	bool Create(size_t total_size);
@@ -27,7 +45,7 @@ public:
 
 	/*
 	* @brief Attempts to find a free block of memory the given size.
-	* 
+	*
 	* @param size The size to allocate.
 	* @param offset A pointer to hold the offset to the allocated memory.
 	* @return bool True if a block of memory has found and allocated; otherwise false.
@@ -35,10 +53,10 @@ public:
 	bool AllocateBlock(size_t size, size_t* offset);
 
 	/*
-	* @brief Attempts to free a free block of memory at the given offset, and of the 
+	* @brief Attempts to free a free block of memory at the given offset, and of the
 	* given size. Can fail if invalid data is passed.
 	*
-	* @param size The size to allocate.
+	* @param size The size to allocate. Must match the size the block was allocated with.
 	* @param offset The offset to free at.
 	* @return bool True if a block of memory has free; otherwise false.
 	*/
@@ -46,7 +64,7 @@ public:
 
 	/**
 	 * @brief Attempts to resize the freelist
-	 * 
+	 *
 	 * @param new_size The new size of memory the freelist could hold.
 	 */
 	bool Resize(size_t new_size);
@@ -58,19 +76,44 @@ public:
 
 	/*
 	* @brief Returns the amount of free space in this list.
-	* NOTE: Since this has to iterate the entire internal list, this can be an expensive operation. Use sparingly.
 	*/
 	size_t GetFreeSpace();
 
+	/*
+	* @brief Returns the size of the largest free block, the largest allocation that can succeed.
+	*/
+	size_t GetLargestFreeBlock();
+
 private:
-	FreelistNode* AcquireFreeNode();
-	void ResetNode(FreelistNode* node);
+	uint32_t AcquireNode();
+	void ReleaseNode(uint32_t node);
+
+	void InsertFreeNode(uint32_t node);
+	void RemoveFreeNode(uint32_t node);
+	uint32_t FindFreeNode(size_t size);
+
+	void InsertLookup(uint32_t node);
+	uint32_t FindLookup(size_t offset);
+	void RemoveLookup(size_t offset);
+	bool ResizeLookup(size_t capacity);
 
 private:
 	size_t TotalSize;
-	size_t MaxEntries;
-	FreelistNode* Head;
+	size_t FreeSpace;
+
+	// Every block, free or allocated, has a node. Unused nodes are chained through next_free.
 	FreelistNode* Nodes;
+	uint32_t NodeCapacity;
+	uint32_t UnusedNodes;
+	uint32_t LastNode;
+
+	// Allocated blocks by offset, open addressing.
+	uint32_t* LookupSlots;
+	size_t LookupCapacity;
+	size_t LookupCount;
 
-	void* ListMemory;
+	// A bit is set for every class holding free blocks.
+	uint64_t FirstLevelMap;
+	uint32_t SecondLevelMaps[FREELIST_FL_COUNT];
+	uint32_t FreeHeads[FREELIST_FL_COUNT][FREELIST_SL_COUNT];
 };
@@ -2,10 +2,14 @@
 
 #include "Defines.hpp"
 #include "Core/EngineLogger.hpp"
+#include "Core/DMemory.hpp"
 #include "Platform/Platform.hpp"
+#include <cstring>
 #include <type_traits>
+#include <utility>
 
-#define ARRAY_DEFAULT_CAPACITY 1
+// The capacity of the first allocation. A default constructed array allocates nothing until the first element comes.
+#define ARRAY_DEFAULT_CAPACITY 4
 #define ARRAY_DEFAULT_RESIZE_FACTOR 2
 
 /*
@@ -18,122 +22,134 @@ void* elements
 template<typename ElementType>
 class DAPI TArray {
 public:
-	TArray() {
-		size_t ArrayMemSize = ARRAY_DEFAULT_CAPACITY * sizeof(ElementType);
-		ArrayMemory = (ElementType*)Memory::Allocate(ArrayMemSize, MemoryType::eMemory_Type_Array);
-		Platform::PlatformSetMemory(ArrayMemory, 0, ArrayMemSize);
+	TArray() : ArrayMemory(nullptr), Capacity(0), Stride(sizeof(ElementType)), Length(0) {}
 
-		Capacity = ARRAY_DEFAULT_CAPACITY;
-		Stride = sizeof(ElementType);
-		Length = 0;
+	TArray(const TArray& arr) : ArrayMemory(nullptr), Capacity(0), Stride(sizeof(ElementType)), Length(0) {
+		CopyFrom(arr);
 	}
 
-	TArray(const TArray& arr) {
-		Capacity = arr.Capacity;
-		Stride = arr.Stride;
-		Length = arr.Length;
-
-		size_t ArrayMemSize = Capacity * Stride;
-		ArrayMemory = (ElementType*)Memory::Allocate(ArrayMemSize, MemoryType::eMemory_Type_Array);
-		if (ArrayMemory) {
-			for (size_t i = 0; i < Length; ++i) {
-				new(reinterpret_cast<ElementType*>(ArrayMemory) + i) ElementType(arr[i]); // 使用拷贝构造函数
-			}
-		}
+	TArray(TArray&& arr) noexcept : ArrayMemory(arr.ArrayMemory), Capacity(arr.Capacity), Stride(sizeof(ElementType)), Length(arr.Length) {
+		arr.ArrayMemory = nullptr;
+		arr.Capacity = 0;
+		arr.Length = 0;
 	}
 
-	TArray(size_t size) {
-		size_t ArrayMemSize = size * sizeof(ElementType);
-		ArrayMemory = (ElementType*)Memory::Allocate(ArrayMemSize, MemoryType::eMemory_Type_Array);
-		Capacity = size;
-		Stride = sizeof(ElementType);
-		Length = size;
-
-		// If pointer then new object
-		if constexpr (std::is_pointer<ElementType>::value) {
-			Platform::PlatformSetMemory(ArrayMemory, 0, ArrayMemSize);
-		}
-		else {
-			for (size_t i = 0; i < size; ++i) {
-				new(reinterpret_cast<char*>(ArrayMemory) + i * sizeof(ElementType)) ElementType();
-			}
+	TArray(size_t size) : ArrayMemory(nullptr), Capacity(0), Stride(sizeof(ElementType)), Length(0) {
+		if (size > 0) {
+			Resize(size);
 		}
 	}
 
-	virtual ~TArray() {
+	~TArray() {
 		Destroy();
 	}
 
 	ElementType* begin() {
-		return reinterpret_cast<ElementType*>(ArrayMemory);
+		return ArrayMemory;
+	}
+
+	const ElementType* begin() const {
+		return ArrayMemory;
 	}
 
 	const ElementType* end() {
-		return reinterpret_cast<const ElementType*>(ArrayMemory) + Length;
+		return ArrayMemory + Length;
+	}
+
+	const ElementType* end() const {
+		return ArrayMemory + Length;
 	}
 
 
 public:
-	size_t GetField(size_t field) {}
-	void SetField(size_t field, size_t val){}
+	/**
+	 * @brief Makes room for at least the given number of elements, so adding up to that many does not move them again.
+	 */
+	void Reserve(size_t capacity) {
+		if (capacity > Capacity) {
+			Reallocate(capacity);
+		}
+	}
 
+	/**
+	 * @brief Grows the capacity when called without a size. With a size, sets the length to it, value initializing the
+	 * elements added.
+	 */
 	void Resize(size_t size = 0) {
-		size_t NewCapacity = size > 0 ? size : Capacity * ARRAY_DEFAULT_RESIZE_FACTOR;
-		ElementType* TempMemory = (ElementType*)Memory::Allocate(NewCapacity * Stride, MemoryType::eMemory_Type_Array);
+		if (size == 0) {
+			Reallocate(GetGrowCapacity());
+			return;
+		}
 
-		if (ArrayMemory) {
-			for (size_t i = 0; i < Length; ++i) {
-				new(reinterpret_cast<ElementType*>(TempMemory) + i) ElementType(ArrayMemory[i]); 
+		Reserve(size);
+		if constexpr (std::is_trivially_default_constructible<ElementType>::value) {
+			if (size > Length) {
+				Platform::PlatformZeroMemory(ArrayMemory + Length, (size - Length) * sizeof(ElementType));
 			}
 		}
-		Memory::Free(ArrayMemory, Capacity, MemoryType::eMemory_Type_Array);
-
-		if (size > 0) {
-			Length = size;
+		else {
+			for (size_t i = Length; i < size; ++i) {
+				new(ArrayMemory + i) ElementType();
+			}
 		}
-		Capacity = NewCapacity;
-		ArrayMemory = TempMemory;
+		DestroyElements(ArrayMemory + DMIN(size, Length), Length > size ? Length - size : 0);
+		Length = size;
 	}
 
 	void Push(const ElementType& value) {
-		if (Length >= Capacity) {
-			Resize();
-		}
+		EmplaceBack(value);
+	}
 
-		char* addr = (char*)ArrayMemory + (Length * Stride);
-		new(reinterpret_cast<char*>(addr)) ElementType(value);
+	void Push(ElementType&& value) {
+		EmplaceBack(std::move(value));
+	}
 
-		Length++;
+	/**
+	 * @brief Constructs an element at the end of the array in place.
+	 * @return The new element.
+	 */
+	template<typename... Args>
+	ElementType& EmplaceBack(Args&&... args) {
+		if (Length < Capacity) {
+			new(ArrayMemory + Length) ElementType(std::forward<Args>(args)...);
+		}
+		else {
+			// The arguments may refer to an element of this array, so the new element is constructed before the old ones move.
+			size_t NewCapacity = GetGrowCapacity();
+			ElementType* NewMemory = AllocateElements(NewCapacity);
+			new(NewMemory + Length) ElementType(std::forward<Args>(args)...);
+			RelocateElements(NewMemory, ArrayMemory, Length);
+			FreeElements(ArrayMemory, Capacity);
+			ArrayMemory = NewMemory;
+			Capacity = NewCapacity;
+		}
+
+		return ArrayMemory[Length++];
 	}
 
 	void InsertAt(size_t index, ElementType val) {
 		if (index > Length) {
 			LOG_ERROR("Index Out of length! Length: %i, Index: %i", Length, index);
+			return;
 		}
 
 		if (Length >= Capacity) {
 			Resize();
 		}
 
-		if (index != Length - 1) {
-			for (size_t i = index; i < Length - 1; ++i) {
-				if constexpr (std::is_pointer<ElementType>::value) {
-					ArrayMemory[i] = ArrayMemory[i + 1];
-				}
-				else {
-					reinterpret_cast<ElementType*>(ArrayMemory)[i + 1].~ElementType();
-					new(reinterpret_cast<char*>(ArrayMemory) + (i + 1) * sizeof(ElementType)) ElementType(ArrayMemory[i]);
-				}
-			}
+		if (index == Length) {
+			new(ArrayMemory + Length) ElementType(std::move(val));
 		}
-
-		// Handle the element at index.
-		if constexpr (std::is_pointer<ElementType>::value) {
-			ArrayMemory[index] = val;
+		else if constexpr (std::is_trivially_copyable<ElementType>::value) {
+			memmove(ArrayMemory + index + 1, ArrayMemory + index, (Length - index) * sizeof(ElementType));
+			new(ArrayMemory + index) ElementType(std::move(val));
 		}
 		else {
-			reinterpret_cast<ElementType*>(ArrayMemory)[index].~ElementType();
-			new(reinterpret_cast<char*>(ArrayMemory) + (index) * sizeof(ElementType)) ElementType(val);
+			new(ArrayMemory + Length) ElementType(std::move(ArrayMemory[Length - 1]));
+			for (size_t i = Length - 1; i > index; --i) {
+				ArrayMemory[i] = std::move(ArrayMemory[i - 1]);
+			}
+			ArrayMemory[index] = std::move(val);
 		}
 
 		Length++;
@@ -145,38 +161,27 @@ public:
 			return ElementType();
 		}
 
-		ElementType result = ArrayMemory[Length - 1];
-
-		char* addr = (char*)ArrayMemory + (Length * Stride);
-		addr += ((Length - 1) * Stride);
-		if constexpr (std::is_pointer<ElementType>::value) {
-			ArrayMemory[Length - 1] = nullptr;
-		}
-		else{
-			reinterpret_cast<ElementType*>(ArrayMemory)[Length - 1].~ElementType();
-		}
-
+		ElementType result = std::move(ArrayMemory[Length - 1]);
+		DestroyElements(ArrayMemory + Length - 1, 1);
 		Length--;
 		return result;
 	}
 
 	ElementType PopAt(size_t index) {
-		if (index > Length - 1 ) {
+		if (index >= Length) {
 			LOG_ERROR("Index Out of length! Length: %i, Index: %i", Length, index);
 			return ElementType();
 		}
 
-		ElementType result = ArrayMemory[index];
-		if (index != Length - 1) {
+		ElementType result = std::move(ArrayMemory[index]);
+		if constexpr (std::is_trivially_copyable<ElementType>::value) {
+			memmove(ArrayMemory + index, ArrayMemory + index + 1, (Length - index - 1) * sizeof(ElementType));
+		}
+		else {
 			for (size_t i = index; i < Length - 1; ++i) {
-				if constexpr (std::is_pointer<ElementType>::value) {
-					ArrayMemory[i] = ArrayMemory[i + 1];
-				}
-				else {
-					reinterpret_cast<ElementType*>(ArrayMemory)[i].~ElementType();
-					new(reinterpret_cast<char*>(ArrayMemory) + i * sizeof(ElementType)) ElementType(ArrayMemory[i + 1]);
-				}
+				ArrayMemory[i] = std::move(ArrayMemory[i + 1]);
 			}
+			DestroyElements(ArrayMemory + Length - 1, 1);
 		}
 
 		Length--;
@@ -184,61 +189,47 @@ public:
 	}
 
 	void Clear() {
-		if (ArrayMemory != nullptr) {
-			if constexpr (std::is_pointer<ElementType>::value) {
-				size_t MemorySize = Capacity * Stride;
-				Memory::Zero(ArrayMemory, MemorySize);
-			}
-			else {
-				for (size_t i = 0; i < Length; ++i) {
-					reinterpret_cast<ElementType*>(ArrayMemory)[i].~ElementType();
-				}
-			}
-
-			Length = 0;
-		}
+		DestroyElements(ArrayMemory, Length);
+		Length = 0;
 	}
 
 	void Destroy() {
 		if (ArrayMemory != nullptr) {
-			if constexpr (std::is_pointer<ElementType>::value) {
-				Memory::Free(ArrayMemory, Capacity * Stride, MemoryType::eMemory_Type_Array);
-			}
-			else {
-				for (size_t i = 0; i < Length; ++i) {
-					reinterpret_cast<ElementType*>(ArrayMemory)[i].~ElementType();
-				}
-				Memory::Free(ArrayMemory, Capacity * Stride, MemoryType::eMemory_Type_Array);
-			}
+			DestroyElements(ArrayMemory, Length);
+			FreeElements(ArrayMemory, Capacity);
 			ArrayMemory = nullptr;
 		}
 
 		Capacity = 0;
-		Stride = 0;
 		Length = 0;
 	}
 
-	const ElementType& Pop() const { return Pop(); }
-	const ElementType& PopAt(size_t index) const { return PopAt(index); }
-	
-	bool IsEmpty() const { return (ArrayMemory == nullptr) && (Length == 0); }
+	bool IsEmpty() const { return Length == 0; }
 	size_t Size() const { return Length; }
+	size_t GetCapacity() const { return Capacity; }
 
 
-	ElementType* Data() { return (ElementType*)ArrayMemory; }
-	const ElementType* Data() const { return (ElementType*)ArrayMemory; }
+	ElementType* Data() { return ArrayMemory; }
+	const ElementType* Data() const { return ArrayMemory; }
 
 	TArray<ElementType>& operator=(const TArray<ElementType>& other) {
-		Capacity = other.Capacity;
-		Stride = other.Stride;
-		Length = other.Length;
+		if (this != &other) {
+			Clear();
+			CopyFrom(other);
+		}
 
-		size_t ArrayMemSize = Capacity * Stride;
-		ArrayMemory = (ElementType*)Memory::Allocate(ArrayMemSize, MemoryType::eMemory_Type_Array);
-		if (ArrayMemory) {
-			for (size_t i = 0; i < Length; ++i) {
-				new(reinterpret_cast<ElementType*>(ArrayMemory) + i) ElementType(other[i]); // 使用拷贝构造函数
-			}
+		return *this;
+	}
+
+	TArray<ElementType>& operator=(TArray<ElementType>&& other) noexcept {
+		if (this != &other) {
+			Destroy();
+			ArrayMemory = other.ArrayMemory;
+			Capacity = other.Capacity;
+			Length = other.Length;
+			other.ArrayMemory = nullptr;
+			other.Capacity = 0;
+			other.Length = 0;
 		}
 
 		return *this;
@@ -254,11 +245,75 @@ public:
 		return ArrayMemory[i];
 	}
 
+private:
+	size_t GetGrowCapacity() const {
+		return Capacity > 0 ? Capacity * ARRAY_DEFAULT_RESIZE_FACTOR : ARRAY_DEFAULT_CAPACITY;
+	}
+
+	static ElementType* AllocateElements(size_t capacity) {
+		// Elements are constructed as they are added, so the memory is not zeroed first.
+		return (ElementType*)Memory::AllocateUninitialized(capacity * sizeof(ElementType), (unsigned short)alignof(ElementType), MemoryType::eMemory_Type_Array);
+	}
+
+	static void FreeElements(ElementType* elements, size_t capacity) {
+		if (elements != nullptr) {
+			Memory::FreeAligned(elements, capacity * sizeof(ElementType), (unsigned short)alignof(ElementType), MemoryType::eMemory_Type_Array);
+		}
+	}
+
+	static void DestroyElements(ElementType* elements, size_t count) {
+		if constexpr (!std::is_trivially_destructible<ElementType>::value) {
+			for (size_t i = 0; i < count; ++i) {
+				elements[i].~ElementType();
+			}
+		}
+	}
+
+	/**
+	 * @brief Moves elements to uninitialized memory, leaving the source destroyed. Trivially copyable elements are copied as a whole.
+	 */
+	static void RelocateElements(ElementType* dst, ElementType* src, size_t count) {
+		if constexpr (std::is_trivially_copyable<ElementType>::value) {
+			if (count > 0) {
+				Memory::Copy(dst, src, count * sizeof(ElementType));
+			}
+		}
+		else {
+			for (size_t i = 0; i < count; ++i) {
+				new(dst + i) ElementType(std::move(src[i]));
+				src[i].~ElementType();
+			}
+		}
+	}
+
+	void Reallocate(size_t capacity) {
+		ElementType* NewMemory = AllocateElements(capacity);
+		RelocateElements(NewMemory, ArrayMemory, Length);
+		FreeElements(ArrayMemory, Capacity);
+		ArrayMemory = NewMemory;
+		Capacity = capacity;
+	}
+
+	// Expects the array to be empty.
+	void CopyFrom(const TArray& other) {
+		Reserve(other.Length);
+		if constexpr (std::is_trivially_copyable<ElementType>::value) {
+			if (other.Length > 0) {
+				Memory::Copy(ArrayMemory, other.ArrayMemory, other.Length * sizeof(ElementType));
+			}
+		}
+		else {
+			for (size_t i = 0; i < other.Length; ++i) {
+				new(ArrayMemory + i) ElementType(other.ArrayMemory[i]);
+			}
+		}
+		Length = other.Length;
+	}
+
 private:
 	ElementType* ArrayMemory;
 
-	size_t Capacity;		
+	size_t Capacity;
 	size_t Stride;
 	size_t Length;
 };
-
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "Defines.hpp"
+
+#include "Platform/Platform.hpp"
+
+#include <atomic>
+#include <utility>
+
+/**
+ * @brief A fixed capacity, lock-free multi producer single consumer queue.
+ * Any thread may Push(), only one thread at a time may Pop(). Each slot carries a sequence
+ * number telling whether it is free for the producer claiming it or filled for the consumer,
+ * so producers never wait on each other beyond a compare exchange.
+ */
+template<typename ElementType>
+class MPSCQueue {
+public:
+	MPSCQueue() : Head(0), Tail(0), Mask(0), Cells(nullptr) {}
+	~MPSCQueue() { Destroy(); }
+
+	/**
+	 * @brief Creates the queue.
+	 *
+	 * @param capacity The maximum element count. Rounded up to a power of two.
+	 * @return True if success.
+	 */
+	bool Create(size_t capacity) {
+		size_t Capacity = 2;
+		while (Capacity < capacity) {
+			Capacity <<= 1;
+		}
+
+		Cells = (Cell*)Platform::PlatformAllocate(sizeof(Cell) * Capacity, false);
+		if (Cells == nullptr) {
+			return false;
+		}
+
+		for (size_t i = 0; i < Capacity; ++i) {
+			new(&Cells[i]) Cell();
+			Cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		Mask = Capacity - 1;
+		Head = 0;
+		Tail = 0;
+		return true;
+	}
+
+	/**
+	 * @brief Destroys the queue and any element left in it. No thread may access it anymore.
+	 */
+	void Destroy() {
+		if (Cells != nullptr) {
+			for (size_t i = 0; i <= Mask; ++i) {
+				Cells[i].~Cell();
+			}
+			Platform::PlatformFree(Cells, false);
+			Cells = nullptr;
+		}
+		Mask = 0;
+	}
+
+	/**
+	 * @brief Moves a value to the back of the queue. Any thread.
+	 *
+	 * @return False if the queue is full, the value is left untouched then.
+	 */
+	bool Push(ElementType& value) {
+		Cell* Target = nullptr;
+		size_t Pos = Tail.load(std::memory_order_relaxed);
+		while (true) {
+			Target = &Cells[Pos & Mask];
+			size_t Sequence = Target->sequence.load(std::memory_order_acquire);
+			intptr_t Diff = (intptr_t)Sequence - (intptr_t)Pos;
+			if (Diff == 0) {
+				// The slot is free, claim it.
+				if (Tail.compare_exchange_weak(Pos, Pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			}
+			else if (Diff < 0) {
+				// The consumer has not freed this slot yet.
+				return false;
+			}
+			else {
+				Pos = Tail.load(std::memory_order_relaxed);
+			}
+		}
+
+		Target->data = std::move(value);
+		// Publishes the element to the consumer.
+		Target->sequence.store(Pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief Moves the value at the front of the queue out. Consumer thread only.
+	 *
+	 * @return False if the queue is empty, or the next element is still being written.
+	 */
+	bool Pop(ElementType& out_value) {
+		size_t Pos = Head.load(std::memory_order_relaxed);
+		Cell* Target = &Cells[Pos & Mask];
+		if (Target->sequence.load(std::memory_order_acquire) != Pos + 1) {
+			return false;
+		}
+
+		out_value = std::move(Target->data);
+		Target->data = ElementType();
+		// Hands the slot back to producers one lap later.
+		Target->sequence.store(Pos + Mask + 1, std::memory_order_release);
+		Head.store(Pos + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	/**
+	 * @brief Approximate element count, only a hint when read from other threads.
+	 */
+	size_t Size() const {
+		size_t T = Tail.load(std::memory_order_relaxed);
+		size_t H = Head.load(std::memory_order_relaxed);
+		return T > H ? T - H : 0;
+	}
+
+	bool IsEmpty() const { return Size() == 0; }
+
+private:
+	struct Cell {
+		std::atomic<size_t> sequence;
+		ElementType data;
+	};
+
+	// Producers contend on Tail, keep it away from the consumer-only Head.
+	alignas(64) std::atomic<size_t> Head;
+	alignas(64) std::atomic<size_t> Tail;
+	size_t Mask;
+	Cell* Cells;
+};
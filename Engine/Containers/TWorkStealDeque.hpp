@@ -0,0 +1,147 @@
+#pragma once
+
+#include "Defines.hpp"
+
+#include "Platform/Platform.hpp"
+
+#include <atomic>
+#include <type_traits>
+
+/**
+ * @brief A fixed capacity, lock-free work-stealing deque (Chase-Lev).
+ * Only the owning thread may Push() and Pop() at the bottom, which is LIFO and keeps
+ * recently spawned work hot in cache. Any other thread may Steal() from the top, which is FIFO.
+ * Elements must be trivially copyable, typically pointers.
+ */
+template<typename ElementType>
+class WorkStealDeque {
+	static_assert(std::is_trivially_copyable<ElementType>::value, "WorkStealDeque elements must be trivially copyable.");
+
+public:
+	WorkStealDeque() : Top(0), Bottom(0), Mask(0), Block(nullptr) {}
+	~WorkStealDeque() { Destroy(); }
+
+	/**
+	 * @brief Creates the deque.
+	 *
+	 * @param capacity The maximum element count. Rounded up to a power of two.
+	 * @return True if success.
+	 */
+	bool Create(size_t capacity) {
+		size_t Capacity = 1;
+		while (Capacity < capacity) {
+			Capacity <<= 1;
+		}
+
+		Block = (std::atomic<ElementType>*)Platform::PlatformAllocate(sizeof(std::atomic<ElementType>) * Capacity, false);
+		if (Block == nullptr) {
+			return false;
+		}
+
+		for (size_t i = 0; i < Capacity; ++i) {
+			new(&Block[i]) std::atomic<ElementType>();
+		}
+
+		Mask = Capacity - 1;
+		Top = 0;
+		Bottom = 0;
+		return true;
+	}
+
+	/**
+	 * @brief Destroys the deque. No thread may access it anymore.
+	 */
+	void Destroy() {
+		if (Block != nullptr) {
+			Platform::PlatformFree(Block, false);
+			Block = nullptr;
+		}
+		Mask = 0;
+	}
+
+	/**
+	 * @brief Pushes a value to the bottom. Owner thread only.
+	 *
+	 * @return False if the deque is full.
+	 */
+	bool Push(ElementType value) {
+		int64_t B = Bottom.load(std::memory_order_relaxed);
+		int64_t T = Top.load(std::memory_order_acquire);
+		if (B - T > (int64_t)Mask) {
+			return false;
+		}
+
+		Block[B & Mask].store(value, std::memory_order_relaxed);
+		// Publishes the element to thieves, which read Bottom with acquire.
+		Bottom.store(B + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief Pops the most recently pushed value from the bottom. Owner thread only.
+	 *
+	 * @return False if the deque is empty or the last value was stolen.
+	 */
+	bool Pop(ElementType& out_value) {
+		int64_t B = Bottom.load(std::memory_order_relaxed) - 1;
+		Bottom.store(B, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t T = Top.load(std::memory_order_relaxed);
+
+		if (T > B) {
+			// Empty, restore.
+			Bottom.store(B + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		out_value = Block[B & Mask].load(std::memory_order_relaxed);
+		if (T == B) {
+			// Last element, race against thieves for it.
+			bool Won = Top.compare_exchange_strong(T, T + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			Bottom.store(B + 1, std::memory_order_relaxed);
+			return Won;
+		}
+
+		return true;
+	}
+
+	/**
+	 * @brief Steals the oldest value from the top. Any thread.
+	 *
+	 * @return False if the deque is empty or another thread won the race.
+	 */
+	bool Steal(ElementType& out_value) {
+		int64_t T = Top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t B = Bottom.load(std::memory_order_acquire);
+		if (T >= B) {
+			return false;
+		}
+
+		ElementType Value = Block[T & Mask].load(std::memory_order_relaxed);
+		if (!Top.compare_exchange_strong(T, T + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return false;
+		}
+
+		out_value = Value;
+		return true;
+	}
+
+	/**
+	 * @brief Approximate element count, only a hint when read from other threads.
+	 */
+	size_t Size() const {
+		int64_t B = Bottom.load(std::memory_order_relaxed);
+		int64_t T = Top.load(std::memory_order_relaxed);
+		return B > T ? (size_t)(B - T) : 0;
+	}
+
+	bool IsEmpty() const { return Size() == 0; }
+
+private:
+	// Thieves and the owner contend on Top, keep it away from the owner-only Bottom.
+	alignas(64) std::atomic<int64_t> Top;
+	alignas(64) std::atomic<int64_t> Bottom;
+	size_t Mask;
+	std::atomic<ElementType>* Block;
+};
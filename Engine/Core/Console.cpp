@@ -59,6 +59,15 @@ bool Console::RegisterCommand(const std::string& cmd, unsigned char arg_count, P
 	return true;
 }
 
+void Console::UnregisterCommand(const std::string& cmd) {
+	for (size_t i = 0; i < RegisteredCommands.size(); ++i) {
+		if (RegisteredCommands[i].Name.compare(cmd) == 0) {
+			RegisteredCommands.erase(RegisteredCommands.begin() + i);
+			return;
+		}
+	}
+}
+
 bool Console::ExecuteCommand(const std::string& cmd) {
 	if (cmd.length() == 0) {
 		return false;
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Defines.hpp"
+
+typedef void(*PFN_fiber_start)(void*);
+
+/**
+ * Represents a cooperatively scheduled execution context with its own stack. Switching
+ * between fibers saves and restores registers without going through the OS scheduler.
+ * A thread has to be turned into a fiber before it can switch to any other fiber.
+ * This calls to the platform-spectific fiber implementation.
+ */
+class DAPI Fiber {
+public:
+	Fiber() : InternalData(nullptr) {}
+
+	/**
+	 * Creates a new fiber. It does not run until it is switched to.
+	 * @param start_func The function the fiber runs. Must never return, switch to another fiber instead.
+	 * @param params A pointer to any data to be passed to the start.
+	 * @param stack_size The size of the fiber stack in bytes.
+	 * @returns True if created successfully.
+	 */
+	bool Create(PFN_fiber_start start_func, void* params, size_t stack_size);
+
+	/**
+	 * Turns the calling thread into a fiber, so it can switch to other fibers and be switched back to.
+	 * @returns True if created successfully.
+	 */
+	bool CreateFromThread();
+
+	/**
+	 * Destroys the fiber. It must not be running, except for a fiber created from the calling thread.
+	 */
+	void Destroy();
+
+	/**
+	 * Saves the current context to a fiber and continues with another one.
+	 * @param from The fiber currently running on the calling thread.
+	 * @param to The fiber to continue with.
+	 * @returns True if the fiber was switched to and later switched back.
+	 */
+	static bool Switch(Fiber* from, Fiber* to);
+
+public:
+	void* InternalData;
+};
@@ -3,134 +3,525 @@
 #include "EngineLogger.hpp"
 #include "Platform/Platform.hpp"
 #include "Containers/TString.hpp"
+#include "Memory/MemoryProfiler.h"
+#include "Memory/ScratchAllocator.h"
+
+#include <atomic>
+
+// The address the calling entry point returns to, which attributes allocations to the code asking for them.
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define MEMORY_CALLSITE() _ReturnAddress()
+#else
+#define MEMORY_CALLSITE() __builtin_return_address(0)
+#endif
 
-struct Memory::SMemoryStats Memory::stats;
 size_t Memory::TotalAllocateSize;
 DynamicAllocator Memory::DynamicAlloc;
-size_t Memory::AllocateCount;
+SlabAllocator Memory::SlabAlloc;
+LinearAllocator Memory::FrameArenas[2];
+uint32_t Memory::FrameArenaIndex = 0;
 Mutex Memory::AllocationMutex;
 
+// Marks a block handed out by a thread cache. It sits where the dynamic allocator keeps the size
+// of its own blocks, which can never be this large.
+#define MEMORY_CACHE_TAG 0xFFFFFFFFu
+
+// Roughly the number of bytes a thread cache fetches from, or hands back to, the dynamic allocator at once.
+#define MEMORY_CACHE_BATCH_BYTES KIBIBYTES(16)
+
+// Precedes every cached block, the tag ends right before the block.
+struct SCacheHeader {
+	uint32_t size;
+	unsigned short alignment;
+	unsigned short size_class;
+	uint32_t reserved;
+	uint32_t tag;
+};
+
+static_assert(sizeof(SCacheHeader) == MEMORY_CACHE_ALIGNMENT, "Cached blocks would lose their alignment.");
+
+// A free cached block, linked through its own memory.
+struct SCachedBlock {
+	SCachedBlock* next;
+};
+
+struct SThreadMemoryCache {
+	SThreadMemoryCache();
+	~SThreadMemoryCache();
+
+	SCachedBlock* free_blocks[MEMORY_CACHE_CLASS_COUNT];
+	uint32_t free_counts[MEMORY_CACHE_CLASS_COUNT];
+	// The memory system generation the cached blocks were taken from.
+	uint32_t generation;
+
+	// Only the owning thread writes these, so no read-modify-write is needed. Frees of memory
+	// allocated on another thread make them negative.
+	std::atomic<int64_t> tagged_allocations[eMemory_Type_Max];
+	std::atomic<int64_t> allocation_count;
+
+	SThreadMemoryCache* next;
+};
+
+// Bumped by every initialize and shutdown, cached blocks of an older generation are dropped.
+static std::atomic<uint32_t> CacheGeneration = 0;
+
+// Links the caches of all live threads, so their statistics can be gathered.
+static std::atomic_flag CacheRegistryLock = ATOMIC_FLAG_INIT;
+static SThreadMemoryCache* CacheRegistry = nullptr;
+// The statistics of threads which exited.
+static int64_t RetiredAllocations[eMemory_Type_Max];
+static int64_t RetiredAllocationCount = 0;
+
+static thread_local SThreadMemoryCache ThreadCache;
+
+static void LockCacheRegistry() {
+	while (CacheRegistryLock.test_and_set(std::memory_order_acquire)) {}
+}
+
+static void UnlockCacheRegistry() {
+	CacheRegistryLock.clear(std::memory_order_release);
+}
+
+static unsigned short GetSizeClass(size_t size) {
+	unsigned short SizeClass = 0;
+	while (((size_t)MEMORY_CACHE_ALIGNMENT << SizeClass) < size) {
+		SizeClass++;
+	}
+	return SizeClass;
+}
+
+static size_t GetClassSize(unsigned short size_class) {
+	return (size_t)MEMORY_CACHE_ALIGNMENT << size_class;
+}
+
+static uint32_t GetBatchCount(unsigned short size_class) {
+	size_t Count = MEMORY_CACHE_BATCH_BYTES / GetClassSize(size_class);
+	return (uint32_t)(Count < 4 ? 4 : (Count > 64 ? 64 : Count));
+}
+
+static void TrackAllocation(MemoryType type, int64_t size, int64_t count) {
+	SThreadMemoryCache& Cache = ThreadCache;
+	Cache.tagged_allocations[type].store(Cache.tagged_allocations[type].load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+	Cache.allocation_count.store(Cache.allocation_count.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+}
+
+// Drops the cached blocks if the allocator they came from is gone.
+static void SyncCacheGeneration(SThreadMemoryCache& cache) {
+	uint32_t Generation = CacheGeneration.load(std::memory_order_relaxed);
+	if (cache.generation != Generation) {
+		for (int i = 0; i < MEMORY_CACHE_CLASS_COUNT; ++i) {
+			cache.free_blocks[i] = nullptr;
+			cache.free_counts[i] = 0;
+		}
+		cache.generation = Generation;
+	}
+}
+
+SThreadMemoryCache::SThreadMemoryCache() {
+	for (int i = 0; i < MEMORY_CACHE_CLASS_COUNT; ++i) {
+		free_blocks[i] = nullptr;
+		free_counts[i] = 0;
+	}
+	generation = CacheGeneration.load(std::memory_order_relaxed);
+	for (int i = 0; i < eMemory_Type_Max; ++i) {
+		tagged_allocations[i].store(0, std::memory_order_relaxed);
+	}
+	allocation_count.store(0, std::memory_order_relaxed);
+
+	LockCacheRegistry();
+	next = CacheRegistry;
+	CacheRegistry = this;
+	UnlockCacheRegistry();
+}
+
+SThreadMemoryCache::~SThreadMemoryCache() {
+	// Hand the cached blocks back, unless the allocator they came from is gone.
+	if (generation == CacheGeneration.load(std::memory_order_relaxed) && Memory::AllocationMutex.Lock()) {
+		for (int i = 0; i < MEMORY_CACHE_CLASS_COUNT; ++i) {
+			for (SCachedBlock* Block = free_blocks[i]; Block != nullptr;) {
+				SCachedBlock* Next = Block->next;
+				Memory::DynamicAlloc.FreeAligned((void*)((size_t)Block - sizeof(SCacheHeader)));
+				Block = Next;
+			}
+		}
+		Memory::AllocationMutex.UnLock();
+	}
+
+	LockCacheRegistry();
+	for (SThreadMemoryCache** Link = &CacheRegistry; *Link != nullptr; Link = &(*Link)->next) {
+		if (*Link == this) {
+			*Link = next;
+			break;
+		}
+	}
+	for (int i = 0; i < eMemory_Type_Max; ++i) {
+		RetiredAllocations[i] += tagged_allocations[i].load(std::memory_order_relaxed);
+	}
+	RetiredAllocationCount += allocation_count.load(std::memory_order_relaxed);
+	UnlockCacheRegistry();
+}
+
 bool Memory::Initialize(size_t size) {
-	Platform::PlatformZeroMemory(&stats, sizeof(stats));
-	if (!DynamicAlloc.Create(size)) {
+	if (!DynamicAlloc.Create(size, MEMORY_RESERVE_SIZE)) {
 		LOG_FATAL("Memory system is unable to setup internal allocator. Application can not continue.");
 		return false;
 	}
 
-	AllocateCount = 0;
+	// The object slabs are carved from a single block, so telling their blocks apart takes a range check.
+	size_t SlabCount = size / MEMORY_SLAB_SHARE / SLAB_SIZE;
+	if (SlabCount > 0) {
+		size_t SlabMemorySize = SlabAllocator::GetMemoryRequirement(SlabCount);
+		void* SlabMemory = DynamicAlloc.AllocateAligned(SlabMemorySize, SLAB_MAX_BLOCK_SIZE);
+		if (SlabMemory == nullptr || !SlabAlloc.Create(SlabMemory, SlabMemorySize)) {
+			LOG_WARN("Memory system is unable to setup the object slabs, objects are allocated like any other block.");
+		}
+	}
+
+	size_t FrameArenaSize = size / MEMORY_FRAME_SHARE / 2;
+	for (int i = 0; i < 2 && FrameArenaSize > 0; ++i) {
+		void* FrameMemory = DynamicAlloc.AllocateAligned(FrameArenaSize, 64);
+		if (FrameMemory == nullptr || !FrameArenas[i].Create(FrameMemory, FrameArenaSize)) {
+			LOG_WARN("Memory system is unable to setup the frame arenas, frame memory is allocated like any other block.");
+		}
+	}
+	FrameArenaIndex = 0;
+
+	LockCacheRegistry();
+	for (int i = 0; i < eMemory_Type_Max; ++i) {
+		RetiredAllocations[i] = 0;
+	}
+	RetiredAllocationCount = 0;
+	for (SThreadMemoryCache* Cache = CacheRegistry; Cache != nullptr; Cache = Cache->next) {
+		for (int i = 0; i < eMemory_Type_Max; ++i) {
+			Cache->tagged_allocations[i].store(0, std::memory_order_relaxed);
+		}
+		Cache->allocation_count.store(0, std::memory_order_relaxed);
+	}
+	UnlockCacheRegistry();
+	CacheGeneration.fetch_add(1);
+
 	TotalAllocateSize = size;
 	AllocationMutex.Create();
 
+	if (!MemoryProfiler::Initialize()) {
+		LOG_WARN("Memory system is unable to setup the profiler.");
+	}
+
 	LOG_DEBUG("Memory system successfully allocated %llu bytes.", TotalAllocateSize);
 	return true;
 }
 
 void Memory::Shutdown() {
+	// Whatever the profiler still tracks now was never freed.
+	MemoryProfiler::Shutdown();
+
+	CacheGeneration.fetch_add(1);
+	SlabAlloc.Destroy();
+	FrameArenas[0].Destroy();
+	FrameArenas[1].Destroy();
 	AllocationMutex.Destroy();
+
+	// Everything should be freed by now, whatever is left goes with the heap.
+	size_t LeftSize = DynamicAlloc.GetTotalSpace() - DynamicAlloc.GetFreeSpace();
 	DynamicAlloc.Destroy();
-	AllocateCount = 0;
 	TotalAllocateSize = 0;
 
-	LOG_INFO("Shutdown memory system, left memory: %llu.", DynamicAlloc.GetFreeSpace());
+	LOG_INFO("Shutdown memory system, left memory: %llu.", LeftSize);
 }
 
 void* Memory::Allocate(size_t size, MemoryType type = MemoryType::eMemory_Type_Array) {
-	return AllocateAligned(size, 1, type);
+	return AllocateBlock(size, 1, type, true, MEMORY_CALLSITE());
 }
 
 void* Memory::AllocateAligned(size_t size, unsigned short alignment, MemoryType type) {
+	return AllocateBlock(size, alignment, type, true, MEMORY_CALLSITE());
+}
+
+void* Memory::AllocateUninitialized(size_t size, unsigned short alignment, MemoryType type) {
+	return AllocateBlock(size, alignment, type, false, MEMORY_CALLSITE());
+}
+
+void* Memory::AllocateBlock(size_t size, unsigned short alignment, MemoryType type, bool zero, const void* callsite) {
 	if (type == eMemory_Type_Unknow) {
 		LOG_WARN("Called allocate using eMemory_Type_Unknow. Re-class this allocation.");
 	}
 
+	TrackAllocation(type, (int64_t)size, 1);
+
 	void* Block = nullptr;
-	stats.total_allocated += size;
-	stats.tagged_allocations[type] += size;
-	AllocateCount++;
+	if (size > 0 && size <= MEMORY_CACHE_MAX_SIZE && alignment <= MEMORY_CACHE_ALIGNMENT) {
+		Block = AllocateCached(size, alignment);
+	}
 
-	// Make sure multi-threaded requests don't trample each other.
-	if (!AllocationMutex.Lock()) {
-		LOG_FATAL("Error obtaining mutex lock during allocation.");
+	if (Block == nullptr) {
+		// Make sure multi-threaded requests don't trample each other.
+		if (!AllocationMutex.Lock()) {
+			LOG_FATAL("Error obtaining mutex lock during allocation.");
+			return nullptr;
+		}
+
+		Block = DynamicAlloc.AllocateAligned(size, alignment);
+		AllocationMutex.UnLock();
+	}
+
+	if (Block == nullptr) {
+		LOG_FATAL("Allocate failed.");
 		return nullptr;
 	}
 
-	Block = DynamicAlloc.AllocateAligned(size, alignment);
-	AllocationMutex.UnLock();
+	if (zero) {
+		Platform::PlatformZeroMemory(Block, size);
+	}
 
-	if (Block == nullptr) {
-		LOG_WARN("Allocate by platform. Dynamic allocator memory is not enough!");
-		Block = Platform::PlatformAllocate(size, false);
+	if (MemoryProfiler::IsEnabled()) {
+		MemoryProfiler::OnAllocate(Block, size, alignment, type, callsite);
 	}
 
+	return Block;
+}
+
+void* Memory::AllocateObject(size_t size, unsigned short alignment, MemoryType type) {
+	return AllocateObjectBlock(size, alignment, type, true, MEMORY_CALLSITE());
+}
+
+void* Memory::AllocateObjectUninitialized(size_t size, unsigned short alignment, MemoryType type) {
+	return AllocateObjectBlock(size, alignment, type, false, MEMORY_CALLSITE());
+}
+
+void* Memory::AllocateObjectBlock(size_t size, unsigned short alignment, MemoryType type, bool zero, const void* callsite) {
+	// Slab blocks are aligned to their size, which covers the alignment of any object fitting them.
+	void* Block = size > 0 && size <= SLAB_MAX_BLOCK_SIZE ? SlabAlloc.Allocate(size) : nullptr;
 	if (Block == nullptr) {
-		LOG_FATAL("Allocate failed.");
+		return AllocateBlock(size, alignment, type, zero, callsite);
+	}
+
+	TrackAllocation(type, (int64_t)size, 1);
+	if (zero) {
+		Platform::PlatformZeroMemory(Block, size);
+	}
+	if (MemoryProfiler::IsEnabled()) {
+		MemoryProfiler::OnAllocate(Block, size, alignment, type, callsite);
+	}
+	return Block;
+}
+
+void Memory::BeginFrame() {
+	FrameArenaIndex = (FrameArenaIndex + 1) % 2;
+	FrameArenas[FrameArenaIndex].Reset();
+
+	if (MemoryProfiler::IsEnabled()) {
+		MemoryProfiler::OnFrame();
 	}
+}
 
-	Platform::PlatformZeroMemory(Block, size);
+void* Memory::AllocateFrame(size_t size, unsigned short alignment) {
+	if (size == 0) {
+		return nullptr;
+	}
 
+	void* Block = FrameArenas[FrameArenaIndex].Allocate(size, alignment);
+	if (Block == nullptr) {
+		Block = AllocateBlock(size, alignment, eMemory_Type_Array, true, MEMORY_CALLSITE());
+	}
 	return Block;
 }
 
-void Memory::AllocateReport(size_t size, MemoryType type) {
-	// Make sure multi-threaded requests don't trample each other.
-	if (!AllocationMutex.Lock()) {
-		LOG_FATAL("Error obtaining mutex lock during allocation.");
+void Memory::FreeFrame(void* block, size_t size, unsigned short alignment) {
+	// Frame memory outlives the memory system when a container holding it is destroyed late, nothing left to free then.
+	if (block == nullptr || TotalAllocateSize == 0 || FrameArenas[0].Contains(block) || FrameArenas[1].Contains(block)) {
 		return;
 	}
 
-	stats.total_allocated += size;
-	stats.tagged_allocations[type] += size;
-	AllocateCount++;
+	FreeAligned(block, size, alignment, eMemory_Type_Array);
+}
 
-	AllocationMutex.UnLock();
+void* Memory::AllocateCached(size_t size, unsigned short alignment) {
+	SThreadMemoryCache& Cache = ThreadCache;
+	SyncCacheGeneration(Cache);
+
+	unsigned short SizeClass = GetSizeClass(size);
+	if (Cache.free_blocks[SizeClass] == nullptr) {
+		// Refill a batch at once, so the lock is taken once per batch rather than once per allocation.
+		uint32_t Count = GetBatchCount(SizeClass);
+		size_t BlockSize = sizeof(SCacheHeader) + GetClassSize(SizeClass);
+		if (!AllocationMutex.Lock()) {
+			LOG_FATAL("Error obtaining mutex lock during allocation.");
+			return nullptr;
+		}
+
+		for (uint32_t i = 0; i < Count; ++i) {
+			void* Raw = DynamicAlloc.AllocateAligned(BlockSize, MEMORY_CACHE_ALIGNMENT);
+			if (Raw == nullptr) {
+				break;
+			}
+
+			SCachedBlock* Block = (SCachedBlock*)((size_t)Raw + sizeof(SCacheHeader));
+			Block->next = Cache.free_blocks[SizeClass];
+			Cache.free_blocks[SizeClass] = Block;
+			Cache.free_counts[SizeClass]++;
+		}
+		AllocationMutex.UnLock();
+
+		if (Cache.free_blocks[SizeClass] == nullptr) {
+			return nullptr;
+		}
+	}
+
+	SCachedBlock* Block = Cache.free_blocks[SizeClass];
+	Cache.free_blocks[SizeClass] = Block->next;
+	Cache.free_counts[SizeClass]--;
+
+	SCacheHeader* Header = (SCacheHeader*)((size_t)Block - sizeof(SCacheHeader));
+	Header->size = (uint32_t)size;
+	Header->alignment = alignment;
+	Header->size_class = SizeClass;
+	Header->tag = MEMORY_CACHE_TAG;
+	return Block;
+}
+
+void Memory::AllocateReport(size_t size, MemoryType type) {
+	TrackAllocation(type, (int64_t)size, 1);
+	if (MemoryProfiler::IsEnabled()) {
+		MemoryProfiler::OnAllocate(nullptr, size, 1, type, MEMORY_CALLSITE());
+	}
 }
 
 void  Memory::Free(void* block, size_t size, MemoryType type) {
 	FreeAligned(block, size, 1, type);
 }
 
-void Memory::FreeAligned(void* block, size_t size, unsigned short alignment, MemoryType type) {
+void Memory::FreeAligned(void* block, size_t size, unsigned short /*alignment*/, MemoryType type) {
 	if (type == eMemory_Type_Unknow) {
 		LOG_WARN("Called free using eMemory_Type_Unknow. Re-class this allocation.");
 	}
 
+	TrackAllocation(type, -(int64_t)size, -1);
+	if (MemoryProfiler::IsEnabled()) {
+		MemoryProfiler::OnFree(block, size, type);
+	}
+
+	// Slabs lie within the dynamic allocator's memory, so they are checked for first.
+	if (SlabAlloc.Contains(block)) {
+		SlabAlloc.Free(block);
+		return;
+	}
+
+	if (IsCachedBlock(block)) {
+		FreeCached(block);
+		return;
+	}
+
+	if (!DynamicAlloc.Contains(block)) {
+		if (block != nullptr) {
+			LOG_ERROR("Trying to free block %p, which the memory system did not allocate.", block);
+		}
+		return;
+	}
+
 	// Make sure multi-threaded requests don't trample each other.
 	if (!AllocationMutex.Lock()) {
 		LOG_FATAL("Unable to obtain mutex lock for free operation. Heap corruption is likely.");
 		return;
 	}
 
-	stats.total_allocated -= size;
-	stats.tagged_allocations[type] -= size;
-	AllocateCount--;
-
-	bool Result = DynamicAlloc.FreeAligned(block);
+	DynamicAlloc.FreeAligned(block);
 	AllocationMutex.UnLock();
+}
 
-	if (!Result) {
-		Platform::PlatformFree(block, false);
-	}
+void Memory::FreeCached(void* block) {
+	SThreadMemoryCache& Cache = ThreadCache;
+	SyncCacheGeneration(Cache);
 
-	block = nullptr;
-}
+	// Blocks freed on another thread than they were allocated on simply move to this thread's cache.
+	unsigned short SizeClass = ((SCacheHeader*)((size_t)block - sizeof(SCacheHeader)))->size_class;
+	SCachedBlock* Block = (SCachedBlock*)block;
+	Block->next = Cache.free_blocks[SizeClass];
+	Cache.free_blocks[SizeClass] = Block;
+	Cache.free_counts[SizeClass]++;
+
+	// Hand a batch back once the cache holds two, so threads only freeing don't hoard memory.
+	uint32_t Count = GetBatchCount(SizeClass);
+	if (Cache.free_counts[SizeClass] <= Count * 2) {
+		return;
+	}
 
-void Memory::FreeReport(size_t size, MemoryType type) {
 	if (!AllocationMutex.Lock()) {
 		LOG_FATAL("Unable to obtain mutex lock for free operation. Heap corruption is likely.");
 		return;
 	}
 
-	stats.total_allocated -= size;
-	stats.tagged_allocations[type] -= size;
-	AllocateCount--;
-
+	for (uint32_t i = 0; i < Count; ++i) {
+		SCachedBlock* Released = Cache.free_blocks[SizeClass];
+		Cache.free_blocks[SizeClass] = Released->next;
+		Cache.free_counts[SizeClass]--;
+		DynamicAlloc.FreeAligned((void*)((size_t)Released - sizeof(SCacheHeader)));
+	}
 	AllocationMutex.UnLock();
 }
 
+bool Memory::IsCachedBlock(void* block) {
+	return DynamicAlloc.Contains(block) && *(uint32_t*)((size_t)block - sizeof(uint32_t)) == MEMORY_CACHE_TAG;
+}
+
+void Memory::FreeReport(size_t size, MemoryType type) {
+	TrackAllocation(type, -(int64_t)size, -1);
+	if (MemoryProfiler::IsEnabled()) {
+		MemoryProfiler::OnFree(nullptr, size, type);
+	}
+}
+
 bool Memory::GetAlignmentSize(void* block, size_t* out_size, unsigned short* out_alignment) {
+	if (SlabAlloc.Contains(block)) {
+		*out_size = SlabAlloc.GetBlockSize(block);
+		*out_alignment = (unsigned short)*out_size;
+		return true;
+	}
+
+	if (IsCachedBlock(block)) {
+		SCacheHeader* Header = (SCacheHeader*)((size_t)block - sizeof(SCacheHeader));
+		*out_size = Header->size;
+		*out_alignment = Header->alignment;
+		return true;
+	}
+
 	return DynamicAlloc.GetAlignmentSize(block, out_size, out_alignment);
 }
 
+bool Memory::Owns(void* block) {
+	if (block == nullptr || TotalAllocateSize == 0) {
+		return false;
+	}
+
+	// Slabs and thread caches lie within the dynamic allocator's memory.
+	return DynamicAlloc.Contains(block);
+}
+
+void Memory::GatherStats(SMemoryStats* out_stats) {
+	int64_t Tagged[eMemory_Type_Max];
+	int64_t Count = 0;
+
+	LockCacheRegistry();
+	for (int i = 0; i < eMemory_Type_Max; ++i) {
+		Tagged[i] = RetiredAllocations[i];
+	}
+	Count = RetiredAllocationCount;
+	for (SThreadMemoryCache* Cache = CacheRegistry; Cache != nullptr; Cache = Cache->next) {
+		for (int i = 0; i < eMemory_Type_Max; ++i) {
+			Tagged[i] += Cache->tagged_allocations[i].load(std::memory_order_relaxed);
+		}
+		Count += Cache->allocation_count.load(std::memory_order_relaxed);
+	}
+	UnlockCacheRegistry();
+
+	out_stats->total_allocated = 0;
+	for (int i = 0; i < eMemory_Type_Max; ++i) {
+		out_stats->tagged_allocations[i] = (size_t)Tagged[i];
+		out_stats->total_allocated += (size_t)Tagged[i];
+	}
+	out_stats->allocation_count = (size_t)Count;
+}
+
 void* Memory::Zero(void* block, size_t size) {
 	return Platform::PlatformZeroMemory(block, size);
 }
@@ -163,18 +554,46 @@ const char* Memory::GetUnitForSize(size_t size_bytes, float* out_amount) {
 }
 
 char* Memory::GetMemoryUsageStr() {
+	SMemoryStats Stats;
+	GatherStats(&Stats);
+
 	char buffer[8000] = "\nSystem memory use (Type): \n";
 	size_t offset = strlen(buffer);
 	for (size_t i = 0; i < eMemory_Type_Max; i++) {
 		float amount = 1.0f;
-		const char* Unit = GetUnitForSize(stats.tagged_allocations[i], &amount);
+		const char* Unit = GetUnitForSize(Stats.tagged_allocations[i], &amount);
 		int length = snprintf(buffer + offset, 8000, " %s: %.2f%s\n", MemoryTypeStrings[i], amount, Unit);
 		offset += length;
 	}
 
+	// Occupancy of the object slabs.
+	offset += snprintf(buffer + offset, sizeof(buffer) - offset, "Object slabs (Block size: used/capacity blocks): \n");
+	for (unsigned short i = 0; i < SLAB_CLASS_COUNT; i++) {
+		SSlabClassStats SlabStats;
+		SlabAlloc.GetClassStats(i, &SlabStats);
+		float BlockAmount = 1.0f;
+		const char* BlockUnit = GetUnitForSize(SlabStats.block_size, &BlockAmount);
+		offset += snprintf(buffer + offset, sizeof(buffer) - offset, " %.0f%s: %llu/%llu in %llu slabs\n", BlockAmount, BlockUnit,
+			(unsigned long long)SlabStats.used_blocks, (unsigned long long)SlabStats.capacity, (unsigned long long)SlabStats.slab_count);
+	}
+
+	float ScratchAmount = 1.0f;
+	const char* ScratchUnit = GetUnitForSize(ScratchAllocator::GetCommittedSize(), &ScratchAmount);
+	offset += snprintf(buffer + offset, sizeof(buffer) - offset, "Scratch memory of all threads: %.2f%s\n", ScratchAmount, ScratchUnit);
+
+	for (int i = 0; i < 2; i++) {
+		float UsedAmount = 1.0f;
+		const char* UsedUnit = GetUnitForSize(FrameArenas[i].GetAllocatedSize(), &UsedAmount);
+		float TotalAmount = 1.0f;
+		const char* TotalUnit = GetUnitForSize(FrameArenas[i].GetTotalSize(), &TotalAmount);
+		offset += snprintf(buffer + offset, sizeof(buffer) - offset, "Frame arena %d%s: %.2f%s of %.2f%s\n", i,
+			(uint32_t)i == FrameArenaIndex ? " (current)" : "", UsedAmount, UsedUnit, TotalAmount, TotalUnit);
+	}
+
 	// Compute total usage.
 	{
 		size_t TotalSpace = DynamicAlloc.GetTotalSpace();
+		size_t ReservedSpace = DynamicAlloc.GetReservedSpace();
 		size_t FreeSpace = DynamicAlloc.GetFreeSpace();
 		size_t UsedSpace = TotalSpace - FreeSpace;
 
@@ -184,9 +603,13 @@ char* Memory::GetMemoryUsageStr() {
 		float TotalAmount = 1.0f;
 		const char* TotalUnit = GetUnitForSize(TotalSpace, &TotalAmount);
 
+		float ReservedAmount = 1.0f;
+		const char* ReservedUnit = GetUnitForSize(ReservedSpace, &ReservedAmount);
+
 		double PercentUsed = (double)UsedSpace / (double)TotalSpace;
 
-		snprintf(buffer + offset, 8000, "Total memory usage: %.2f%s of %.2f%s (%d%%%%)\n", UsedAmount, UsedUnit, TotalAmount, TotalUnit, (int)(PercentUsed * 100));
+		snprintf(buffer + offset, 8000, "Total memory usage: %.2f%s of %.2f%s (%d%%%%), up to %.2f%s reserved\n", UsedAmount, UsedUnit, TotalAmount, TotalUnit,
+			(int)(PercentUsed * 100), ReservedAmount, ReservedUnit);
 	}
 
 	char* outString = StringCopy(buffer);
@@ -199,5 +622,7 @@ void Memory::ShowMemoryUsage() {
 }
 
 size_t Memory::GetAllocateCount() { 
-	return AllocateCount; 
+	SMemoryStats Stats;
+	GatherStats(&Stats);
+	return Stats.allocation_count; 
 }
@@ -4,6 +4,8 @@
 #include "EngineLogger.hpp"
 #include "DMutex.hpp"
 #include "Memory/DynamicAllocator.h"
+#include "Memory/SlabAllocator.h"
+#include "Memory/LinearAllocator.h"
 
 enum MemoryType {
 	eMemory_Type_Unknow,
@@ -66,21 +68,79 @@ static const char* MemoryTypeStrings[eMemory_Type_Max]{
 	"System_Font"
 };
 
+// Allocations up to this size with an alignment of at most MEMORY_CACHE_ALIGNMENT are served from per-thread caches.
+#define MEMORY_CACHE_MAX_SIZE 2048
+#define MEMORY_CACHE_ALIGNMENT 16
+// Size classes are the powers of two from 16 bytes up to MEMORY_CACHE_MAX_SIZE.
+#define MEMORY_CACHE_CLASS_COUNT 8
+
+// The address space reserved for the engine heap. The heap starts out with the size passed to Initialize(), and
+// commits more of this as it runs out.
+#define MEMORY_RESERVE_SIZE GIBIBYTES(64ull)
+
+// The share of the memory set aside for the object slabs, one part in this many.
+#define MEMORY_SLAB_SHARE 16
+
+// The share of the memory set aside for the two frame arenas, one part in this many.
+#define MEMORY_FRAME_SHARE 32
+
 class Memory {
+	friend class MemoryProfiler;
+
 private:
 	struct SMemoryStats {
 		size_t total_allocated;
 		size_t tagged_allocations[eMemory_Type_Max];
+		size_t allocation_count;
 	};
 
 public:
+	/**
+	 * @brief Sets up the memory system.
+	 * @param size The size of the engine heap at first, it grows up to MEMORY_RESERVE_SIZE as needed. Slabs and frame arenas are carved from it.
+	 */
 	static DAPI bool Initialize(size_t size);
 	static DAPI void Shutdown();
 
 	static DAPI void* Allocate(size_t size, MemoryType type);
 	static DAPI void* AllocateAligned(size_t size, unsigned short alignment, MemoryType type);
+
+	/**
+	 * @brief Allocates like AllocateAligned() without zeroing the memory, for buffers about to be overwritten as a whole.
+	 */
+	static DAPI void* AllocateUninitialized(size_t size, unsigned short alignment, MemoryType type);
+
+	/**
+	 * @brief Allocates memory for an object from the slab of its size class, so objects of the same size sit
+	 * together. Falls back to AllocateAligned() for objects larger than SLAB_MAX_BLOCK_SIZE or once the slabs are taken.
+	 * Freed by Free() like any other block.
+	 */
+	static DAPI void* AllocateObject(size_t size, unsigned short alignment, MemoryType type);
+
+	/**
+	 * @brief Allocates like AllocateObject() without zeroing the memory, for objects about to be constructed in it.
+	 */
+	static DAPI void* AllocateObjectUninitialized(size_t size, unsigned short alignment, MemoryType type);
 	static DAPI void Free(void* block, size_t size, MemoryType type);
 	static DAPI void FreeAligned(void* block, size_t size, unsigned short alignment, MemoryType type);
+
+	/**
+	 * @brief Starts a new frame. Switches to the other frame arena and frees everything allocated from it two frames ago.
+	 * Call on the main thread while no other thread allocates frame memory.
+	 */
+	static DAPI void BeginFrame();
+
+	/**
+	 * @brief Allocates memory valid for the current and the next frame, by bumping an offset in the current frame arena.
+	 * The memory is not zeroed. Falls back to AllocateAligned() once the arena is used up.
+	 */
+	static DAPI void* AllocateFrame(size_t size, unsigned short alignment);
+
+	/**
+	 * @brief Frees memory from AllocateFrame(). Blocks within a frame arena are left for BeginFrame() to reclaim.
+	 */
+	static DAPI void FreeFrame(void* block, size_t size, unsigned short alignment);
+
 	static DAPI void* Zero(void* block, size_t size);
 	static DAPI void* Copy(void* dst, const void* src, size_t size);
 	static DAPI void* Set(void* dst, int val, size_t size);
@@ -91,24 +151,63 @@ public:
 	static DAPI void FreeReport(size_t size, MemoryType type);
 	static DAPI bool GetAlignmentSize(void* block, size_t* out_size, unsigned short* out_alignment);
 
+	/**
+	 * @brief Checks if the block lies in memory handed out by the memory system, whichever of its allocators served it.
+	 */
+	static DAPI bool Owns(void* block);
+
 	static DAPI size_t GetAllocateCount();
+	static DAPI const char* GetUnitForSize(size_t size_bytes, float* out_amount);
 
 private:
-	static const char* GetUnitForSize(size_t size_bytes, float* out_amount);
+	/**
+	 * @brief Sums the statistics of every thread, including the ones which exited.
+	 */
+	static void GatherStats(SMemoryStats* out_stats);
+
+	/**
+	 * @param callsite The return address of the public entry point, for the memory profiler.
+	 */
+	static void* AllocateBlock(size_t size, unsigned short alignment, MemoryType type, bool zero, const void* callsite);
+
+	/**
+	 * @param callsite The return address of the public entry point, for the memory profiler.
+	 */
+	static void* AllocateObjectBlock(size_t size, unsigned short alignment, MemoryType type, bool zero, const void* callsite);
+
+	/**
+	 * @brief Serves a small allocation from the calling thread's cache, refilling it from the dynamic allocator when empty.
+	 * @returns The block, or nullptr if the dynamic allocator is out of memory.
+	 */
+	static void* AllocateCached(size_t size, unsigned short alignment);
+
+	/**
+	 * @brief Returns a cached block to the calling thread's cache, handing blocks back to the dynamic allocator once it holds too many.
+	 */
+	static void FreeCached(void* block);
+
+	/**
+	 * @brief Checks if the block was handed out by a thread cache.
+	 */
+	static bool IsCachedBlock(void* block);
 
 public:
-	static struct SMemoryStats stats;
 	static size_t TotalAllocateSize;
 	static DynamicAllocator DynamicAlloc;
-	static size_t AllocateCount;
+	static SlabAllocator SlabAlloc;
+
+	// Blocks of one frame stay valid through the next, while the renderer may still read them.
+	static LinearAllocator FrameArenas[2];
+	static uint32_t FrameArenaIndex;
 	
+	// Guards the dynamic allocator. Thread caches only take it to refill or trim in batches.
 	static Mutex AllocationMutex;
 };
 
 
 template<typename T, typename ... Args>
 T* NewObject(Args&& ... args) {
-	T* _NewObject = (T*)Memory::Allocate(sizeof(T), MemoryType::eMemory_Type_Entity);
+	T* _NewObject = (T*)Memory::AllocateObject(sizeof(T), alignof(T), MemoryType::eMemory_Type_Entity);
 	if (_NewObject == nullptr) {
 		LOG_FATAL("Can not create object.");
 		return nullptr;
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Defines.hpp"
+
+/**
+ * A semaphore to be used for synchronization purposes. Threads waiting on a semaphore
+ * are put to sleep by the OS until another thread signals it, which makes it suitable
+ * for waking worker threads without busy polling.
+ */
+class DAPI Semaphore {
+public:
+	Semaphore() : InternalData(nullptr) {}
+
+	/**
+	 * Creates a semaphore.
+	 * @param max_count The maximum count the semaphore can be signaled to.
+	 * @param start_count The initial count of the semaphore.
+	 * @returns True if created successfully.
+	 */
+	bool Create(uint32_t max_count, uint32_t start_count);
+
+	/**
+	 * Destroys the semaphore.
+	 */
+	void Destroy();
+
+	/**
+	 * Increments the semaphore count, waking up one waiting thread if there is any.
+	 * @returns True if signaled successfully.
+	 */
+	bool Signal();
+
+	/**
+	 * Decrements the semaphore count, blocking the calling thread while the count is zero.
+	 * @param timeout_ms The maximum time to wait in milliseconds. INVALID_ID waits forever.
+	 * @returns True if the semaphore was obtained, false on timeout or error.
+	 */
+	bool Wait(uint32_t timeout_ms = INVALID_ID);
+
+public:
+	void* InternalData;
+};
@@ -25,6 +25,13 @@ public:
 	 * Destroys the thread.
 	 */
 	void Destroy();
+
+	/**
+	 * Waits for the thread to return from its start function, then releases its resources.
+	 * Anything the thread uses must stay alive until this returns.
+	 * @return True if the thread was joined.
+	 */
+	bool Join();
 	
 	/**
 	 * Detaches the thread, automatically releasing resources when work is complete.
@@ -51,6 +58,19 @@ public:
 
 	static size_t GetThreadID();
 
+	/**
+	 * Restricts the calling thread to the given logical processors.
+	 * @param processor_mask One bit per logical processor, see SProcessorTopology.
+	 * @return True if the platform applied it.
+	 */
+	static bool SetCurrentAffinity(uint64_t processor_mask);
+
+	/**
+	 * Names the calling thread for debuggers and profilers. Long names may be truncated.
+	 * @param name The name of the thread.
+	 */
+	static void SetCurrentName(const char* name);
+
 public:
 	size_t ThreadID;
 	void* InternalData;
@@ -7,9 +7,11 @@
 #include "Clock.hpp"
 #include "UID.hpp"
 #include "Metrics.hpp"
+#include "DThread.hpp"
 
 #include "IGame.hpp"
 #include "Platform/Platform.hpp"
+#include "Platform/FileSystem.hpp"
 
 #include "Renderer/RendererFrontend.hpp"
 #include "Renderer/Interface/IRenderpass.hpp"
@@ -41,6 +43,9 @@ bool Application::Initialize(){
 
 	UID::Seed(101);
 
+	// The job threads name themselves.
+	Thread::SetCurrentName("Main");
+
 	// Controller
 	Controller::Initialize();
 
@@ -104,51 +109,23 @@ bool Application::Initialize(){
 		return false;
 	}
 
-	// This is really a core count. Subtract 1 to account for the main thread already being in use.
-	bool RenderWithMultithread = Renderer->GetEnabledMutiThread();
-	int ThreadCount = Platform::GetProcessorCount() - 1;
-	if (ThreadCount < 1) {
-		LOG_FATAL("Error: Platform reported processor count (minus one for main thread) as %i. Need at least one additional thread for the job system.", ThreadCount);
-	}
-	else {
-		LOG_INFO("Available threads: %i.", ThreadCount);
-	}
-
-	// Cap the thread count.
-	const int MaxThreadCount = 15;
-	if (ThreadCount > MaxThreadCount) {
-		LOG_INFO("Available threads on the system is %i, but will be capped at %i.", ThreadCount, MaxThreadCount);
-		ThreadCount = MaxThreadCount;
-	}
-
-	// Initialize the job system.
-	// Requires knowledge of renderer multithread support, so should be initialized here.
-	uint32_t JobThreadTypes[15];
-	for (uint32_t i = 0; i < 15; ++i) {
-		JobThreadTypes[i] = (uint32_t)JobType::eGeneral;
-	}
-
-	if (ThreadCount == 1 || !RenderWithMultithread) {
-		// Everything on one job thread.
-		JobThreadTypes[0] |= ((uint32_t)JobType::eGPU_Resource | (uint32_t)JobType::eResource_Load);
-	}
-	else if (ThreadCount == 2) {
-		// Split things between 2 threads.
-		JobThreadTypes[0] |= (uint32_t)JobType::eGPU_Resource;
-		JobThreadTypes[1] |= (uint32_t)JobType::eResource_Load;
-	}
-	else {
-		// Dedicate the first 2 threads to these thing, pass of general tasks to other threads.
-		JobThreadTypes[0] = (uint32_t)JobType::eGPU_Resource;
-		JobThreadTypes[1] = (uint32_t)JobType::eResource_Load;
-	}
-
-	// Job system
-	if (!JobSystem::Initialize(ThreadCount, JobThreadTypes)) {
+	// Job system. Threads are sized and pinned after the processor topology. GPU resource jobs get a thread
+	// of their own with a multithreaded renderer, otherwise they share the resource loading thread.
+	// With MSVC jobs run on fibers, so loaders can wait on the jobs they spawn without blocking a thread. Only its /GT
+	// keeps thread locals fiber safe, other compilers may keep a thread local's address across a switch to another thread.
+	JobSystemConfig JobConfig;
+	JobConfig.dedicated_gpu_thread = Renderer->GetEnabledMutiThread();
+#if defined(_MSC_VER)
+	JobConfig.use_fibers = true;
+#endif
+	if (!JobSystem::Initialize(JobConfig)) {
 		LOG_FATAL("Job system failed to initialize!");
 		return false;
 	}
 
+	// Asynchronous file reads. Falls back to blocking reads where io_uring is not available.
+	FileSystemAsyncInitialize(256);
+
 	// Render system.
 	if (!Renderer->Initialize(GameInst->AppConfig.name, &platform)) {
 		LOG_FATAL("Renderer failed to initialize!");
@@ -263,11 +240,14 @@ bool Application::Run() {
 			double DeltaTime = (CurrentTime - last_time);
 			double FrameStartTime = Platform::PlatformGetAbsoluteTime();
 
+			// Per-frame data of two frames ago is no longer in use.
+			Memory::BeginFrame();
+
 			// Detective file status.
 			GlobalFileWatcher->Update();
 
 			// Update Job system.
-			JobSystem::Update();
+			JobSystem::Update(GameInst->AppConfig.job_completion_budget_ms, GameInst->AppConfig.job_gpu_uploads_per_frame);
 
 			// Update metrics.
 			Metrics::Update(FrameElapsedTime);
@@ -298,7 +278,6 @@ bool Application::Run() {
 				RenderView->OnDestroyPacket(&Packet.views[i]);
 			}
 			Packet.views.clear();
-			std::vector<struct RenderViewPacket>().swap(Packet.views);
 
 			double FrameEndTime = Platform::PlatformGetAbsoluteTime();
 			FrameElapsedTime = FrameEndTime - FrameStartTime;
@@ -338,6 +317,7 @@ bool Application::Run() {
 	GeometrySystem::Shutdown();
 	MaterialSystem::Shutdown();
 	TextureSystem::Shutdown();
+	FileSystemAsyncShutdown();
 	JobSystem::Shutdown();
 	ShaderSystem::Shutdown();
 
@@ -21,6 +21,11 @@ public:
 
 		const char* name = nullptr;
 
+		// Time the main thread spends on job completions per frame, zero for no limit.
+		double job_completion_budget_ms = 2.0;
+		// Completions uploading to the GPU allowed per frame, zero for no limit.
+		uint32_t job_gpu_uploads_per_frame = 4;
+
 		FontSystemConfig FontConfig;
 		std::vector<RenderViewConfig> Renderviews;
 	};
@@ -8,6 +8,7 @@ double Metrics::AvgMS;
 int Metrics::Frames;
 double Metrics::AccumulatedFrameMS;
 double Metrics::FramePerSecond;
+SJobMetrics Metrics::JobMetrics;
 
 void Metrics::Initialize() {
 	Initialized = true;
@@ -70,3 +71,11 @@ void Metrics::Frame(double* outFPS, double* outFrameMS) {
 	*outFPS = FramePerSecond;
 	*outFrameMS = AvgMS;
 }
+
+void Metrics::UpdateJobs(const SJobMetrics& jobMetrics) {
+	JobMetrics = jobMetrics;
+}
+
+const SJobMetrics& Metrics::Jobs() {
+	return JobMetrics;
+}
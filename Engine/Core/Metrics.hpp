@@ -3,6 +3,30 @@
 #include "Defines.hpp"
 
 #define AVG_COUNT 120
+#define METRICS_MAX_JOB_THREADS 64
+
+/**
+ * @brief Job system counters, published by the job system on every update.
+ */
+struct SJobMetrics {
+	// Jobs waiting to start, indexed by JobPriority.
+	uint32_t queued_jobs[3] = { 0, 0, 0 };
+	// Jobs suspended in fiber mode.
+	uint32_t suspended_jobs = 0;
+	// Finished jobs whose callbacks have not run yet.
+	uint32_t pending_results = 0;
+	// Jobs finished since the previous update.
+	uint32_t finished_jobs = 0;
+	// Jobs called off or past their deadline since the previous update, they never ran.
+	uint32_t cancelled_jobs = 0;
+	// Time from submission to start of the jobs finished since the previous update.
+	double avg_wait_ms = 0.0;
+	double max_wait_ms = 0.0;
+	double avg_run_ms = 0.0;
+	uint32_t thread_count = 0;
+	// The share of the previous frame each job thread spent running jobs, from 0 to 1.
+	float thread_utilization[METRICS_MAX_JOB_THREADS] = {};
+};
 
 class DAPI Metrics {
 public:
@@ -36,6 +60,16 @@ public:
 	 */
 	static void Frame(double* outFPS, double* outFrameMS);
 
+	/**
+	 * @brief Stores the latest job system counters.
+	 */
+	static void UpdateJobs(const SJobMetrics& jobMetrics);
+
+	/**
+	 * @brief Returns the job system counters of the previous frame.
+	 */
+	static const SJobMetrics& Jobs();
+
 private:
 	static bool Initialized;
 	static unsigned char FrameAvgCounter;
@@ -44,4 +78,5 @@ private:
 	static int Frames;
 	static double AccumulatedFrameMS;
 	static double FramePerSecond;
+	static SJobMetrics JobMetrics;
 };
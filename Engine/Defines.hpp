@@ -145,6 +145,13 @@ inline bool is_avx2_supported() {
 // Deprecated macros
 #define DEPRECATED(msg) [[deprecated(msg)]]
 
+// Keeps a function out of line, e.g. so thread local reads are not cached across a fiber switch.
+#ifdef _MSC_VER
+#define DNOINLINE __declspec(noinline)
+#else
+#define DNOINLINE __attribute__((noinline))
+#endif
+
 #ifndef CLAMP
 #define CLAMP(value, min, max) (value <= min) ? min : (value >= max) ? max : value;
 #endif
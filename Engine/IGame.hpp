@@ -10,7 +10,8 @@ class IGame {
 private:
 	struct GameFrameData {
 	public:
-		std::vector<GeometryRenderData> WorldGeometries;
+		// Filled every update from the frame arena.
+		TFrameVector<GeometryRenderData> WorldGeometries;
 	};
 
 public:
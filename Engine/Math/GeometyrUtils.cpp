@@ -1,5 +1,10 @@
 ﻿#include "GeometryUtils.hpp"
 #include "Core/EngineLogger.hpp"
+#include "Systems/JobSystem.hpp"
+#include "Memory/ScratchAllocator.h"
+
+// Triangles per parallel chunk. Meshes with fewer triangles are processed serially.
+#define GENERATE_TANGENTS_GRAIN 4096
 
 void GeometryUtils::GenerateNormals(uint32_t vertex_count, Vertex* vertices, uint32_t index_count, uint32_t* indices) {
 	for (uint32_t i = 0; i < index_count; i+=3) {
@@ -19,40 +24,61 @@ void GeometryUtils::GenerateNormals(uint32_t vertex_count, Vertex* vertices, uin
 	}
 }
 
+static Vector4 CalculateTangent(const Vertex* vertices, uint32_t i0, uint32_t i1, uint32_t i2) {
+	Vector3 Edge1 = vertices[i1].position - vertices[i0].position;
+	Vector3 Edge2 = vertices[i2].position - vertices[i0].position;
+
+	double DeltaU1 = vertices[i1].texcoord.x - vertices[i0].texcoord.x;
+	double DeltaV1 = vertices[i1].texcoord.y - vertices[i0].texcoord.y;
+	
+	double DeltaU2 = vertices[i2].texcoord.x - vertices[i0].texcoord.x;
+	double DeltaV2 = vertices[i2].texcoord.y - vertices[i0].texcoord.y;
+	
+	double Divided = (DeltaU1 * DeltaV2 - DeltaU2 * DeltaV1);
+	double FC = 1.0f / Divided;
+
+	Vector3 Tangent = Vector3{
+		static_cast<float>(FC * (DeltaV2 * Edge1.x - DeltaV1 * Edge2.x)),
+		static_cast<float>(FC * (DeltaV2 * Edge1.y - DeltaV1 * Edge2.y)),
+		static_cast<float>(FC * (DeltaV2 * Edge1.z - DeltaV1 * Edge2.z)),
+	};
+
+	Tangent.Normalize();
+
+	double SX = DeltaU1, SY = DeltaU2;
+	double TX = DeltaV1, TY = DeltaV2;
+	double Handedness = ((TX * SY - TY * SX) < 0.0f) ? -1.0f : 1.0f;
+	return Vector4(Tangent, (float)Handedness);
+}
+
 void GeometryUtils::GenerateTangents(uint32_t vertex_count, Vertex* vertices, uint32_t index_count, uint32_t* indices) {
-	for (uint32_t i = 0; i < index_count; i+=3) {
-		uint32_t i0 = indices[i + 0];
-		uint32_t i1 = indices[i + 1];
-		uint32_t i2 = indices[i + 2];
+	uint32_t TriangleCount = index_count / 3;
+	if (TriangleCount <= GENERATE_TANGENTS_GRAIN) {
+		for (uint32_t i = 0; i < index_count; i+=3) {
+			Vector4 T4 = CalculateTangent(vertices, indices[i + 0], indices[i + 1], indices[i + 2]);
+			vertices[indices[i + 0]].tangent = T4;
+			vertices[indices[i + 1]].tangent = T4;
+			vertices[indices[i + 2]].tangent = T4;
+		}
+		return;
+	}
 
-		Vector3 Edge1 = vertices[i1].position - vertices[i0].position;
-		Vector3 Edge2 = vertices[i2].position - vertices[i0].position;
+	// A vertex shared by several triangles takes the tangent of the last one. Calculate the tangents
+	// in parallel first, then write them in triangle order so the result matches the serial path.
+	Vector4* Tangents = (Vector4*)Memory::Allocate(sizeof(Vector4) * TriangleCount, MemoryType::eMemory_Type_Array);
+	JobSystem::ParallelFor(0, TriangleCount, GENERATE_TANGENTS_GRAIN, [=](size_t begin, size_t end) {
+		for (size_t t = begin; t < end; ++t) {
+			Tangents[t] = CalculateTangent(vertices, indices[t * 3 + 0], indices[t * 3 + 1], indices[t * 3 + 2]);
+		}
+	});
 
-		double DeltaU1 = vertices[i1].texcoord.x - vertices[i0].texcoord.x;
-		double DeltaV1 = vertices[i1].texcoord.y - vertices[i0].texcoord.y;
-		
-		double DeltaU2 = vertices[i2].texcoord.x - vertices[i0].texcoord.x;
-		double DeltaV2 = vertices[i2].texcoord.y - vertices[i0].texcoord.y;
-		
-		double Divided = (DeltaU1 * DeltaV2 - DeltaU2 * DeltaV1);
-		double FC = 1.0f / Divided;
-
-		Vector3 Tangent = Vector3{
-			static_cast<float>(FC * (DeltaV2 * Edge1.x - DeltaV1 * Edge2.x)),
-			static_cast<float>(FC * (DeltaV2 * Edge1.y - DeltaV1 * Edge2.y)),
-			static_cast<float>(FC * (DeltaV2 * Edge1.z - DeltaV1 * Edge2.z)),
-		};
-
-		Tangent.Normalize();
-
-		double SX = DeltaU1, SY = DeltaU2;
-		double TX = DeltaV1, TY = DeltaV2;
-		double Handedness = ((TX * SY - TY * SX) < 0.0f) ? -1.0f : 1.0f;
-		Vector4 T4 = Vector4(Tangent, (float)Handedness);
-		vertices[i0].tangent = T4;
-		vertices[i1].tangent = T4;
-		vertices[i2].tangent = T4;
+	for (uint32_t t = 0; t < TriangleCount; ++t) {
+		vertices[indices[t * 3 + 0]].tangent = Tangents[t];
+		vertices[indices[t * 3 + 1]].tangent = Tangents[t];
+		vertices[indices[t * 3 + 2]].tangent = Tangents[t];
 	}
+
+	Memory::Free(Tangents, sizeof(Vector4) * TriangleCount, MemoryType::eMemory_Type_Array);
 }
 
 bool GeometryUtils::VertexEqual(Vertex v0, const Vertex& v1) {
@@ -76,8 +102,9 @@ void GeometryUtils::DeduplicateVertices(uint32_t vertex_count, Vertex* vertices,
 		return;
 	}
 	
-	// Create new arrays for the collection to sit in.
-	Vertex* UniqueVerts = (Vertex*)Memory::Allocate(sizeof(Vertex) * vertex_count, MemoryType::eMemory_Type_Array);
+	// Collect the unique vertices in scratch memory, freed as the scope ends. Only the part filled in is ever read, so it is not cleared.
+	ScratchScope Scope;
+	Vertex* UniqueVerts = Scope.Allocate<Vertex>(vertex_count);
 	*out_vertex_count = 0;
 
 	uint32_t FoundCount = 0;
@@ -101,11 +128,9 @@ void GeometryUtils::DeduplicateVertices(uint32_t vertex_count, Vertex* vertices,
 	}
 
 	// Allocate new vertices array.
-	*out_vertices = (Vertex*)Memory::Allocate(sizeof(Vertex) * (*out_vertex_count), MemoryType::eMemory_Type_Array);
+	*out_vertices = (Vertex*)Memory::AllocateUninitialized(sizeof(Vertex) * (*out_vertex_count), alignof(Vertex), MemoryType::eMemory_Type_Array);
 	// Copy over unique.
 	Memory::Copy(*out_vertices, UniqueVerts, sizeof(Vertex) * (*out_vertex_count));
-	// Destroy temp array.
-	Memory::Free(UniqueVerts, sizeof(Vertex) * vertex_count, MemoryType::eMemory_Type_Array);
 
 	uint32_t RemovedCount = vertex_count - *out_vertex_count;
 	LOG_DEBUG("Geometry system de-duplicate vertices: removed %d vertices, origin/now %d/%d.", RemovedCount, vertex_count, *out_vertex_count);
@@ -12,39 +12,68 @@ struct AllocHeader {
 	unsigned short alignment;
 };
 
-bool DynamicAllocator::Create(size_t total_size) {
+bool DynamicAllocator::Create(size_t total_size, size_t reserve_size) {
 	if (total_size < 1) {
 		LOG_ERROR("Dynamic allocator create can not have a total_size of 0. Failed.");
 		return false;
 	}
 
-	TotalSize = total_size;
-	if (!List.Create(TotalSize)) {
+	// Whole chunks only, so huge pages can back all of the memory.
+	TotalSize = PaddingAligned(total_size, DYNAMIC_ALLOCATOR_CHUNK_SIZE);
+	ReservedSize = PaddingAligned(DMAX(reserve_size, TotalSize), DYNAMIC_ALLOCATOR_CHUNK_SIZE);
+	MemoryBlock = Platform::PlatformReserveMemory(ReservedSize);
+	if (MemoryBlock == nullptr) {
+		LOG_FATAL("DynamicAllocator::Create() Cannot reserve %llu bytes of address space for dynamic allocator.", ReservedSize);
 		return false;
 	}
-	
-	MemoryBlock = Platform::PlatformAllocate(total_size, false);
-	if (MemoryBlock == nullptr) {
+
+	// Freshly committed memory reads as zero, no need to clear it.
+	if (!Platform::PlatformCommitMemory(MemoryBlock, TotalSize, true) || !List.Create(TotalSize)) {
 		LOG_FATAL("DynamicAllocator::Create() Cannot allocate enough memory for dynamic allocator.");
+		Platform::PlatformReleaseMemory(MemoryBlock, ReservedSize);
+		MemoryBlock = nullptr;
 		return false;
 	}
 
-	Platform::PlatformSetMemory(MemoryBlock, 0, total_size);
 	return true;
 }
 
 bool DynamicAllocator::Destroy() {
 	if (MemoryBlock != nullptr) {
 		List.Destroy();
-		Platform::PlatformFree(MemoryBlock, false);
+		Platform::PlatformReleaseMemory(MemoryBlock, ReservedSize);
 		MemoryBlock = nullptr;
 		TotalSize = 0;
+		ReservedSize = 0;
 		return true;
 	}
 
 	return false;
 }
 
+bool DynamicAllocator::Grow(size_t required_size) {
+	// The free block at the end joins the new memory, so the block may fit even if less than its size is left.
+	size_t GrowSize = PaddingAligned(DMAX(required_size, (size_t)DYNAMIC_ALLOCATOR_GROW_SIZE), DYNAMIC_ALLOCATOR_CHUNK_SIZE);
+	GrowSize = DMIN(GrowSize, ReservedSize - TotalSize);
+	if (GrowSize == 0) {
+		return false;
+	}
+
+	if (!Platform::PlatformCommitMemory((void*)((size_t)MemoryBlock + TotalSize), GrowSize, true)) {
+		LOG_ERROR("DynamicAllocator::Grow() Cannot commit %llu more bytes.", GrowSize);
+		return false;
+	}
+
+	if (!List.Resize(TotalSize + GrowSize)) {
+		LOG_ERROR("DynamicAllocator::Grow() Cannot resize the free list.");
+		return false;
+	}
+
+	TotalSize += GrowSize;
+	LOG_DEBUG("Dynamic allocator grew to %llu of %llu reserved bytes.", TotalSize, ReservedSize);
+	return true;
+}
+
 void* DynamicAllocator::Allocate(size_t size) {
 	return AllocateAligned(size, 1);
 }
@@ -61,7 +90,7 @@ void* DynamicAllocator::AllocateAligned(size_t size, unsigned short alignment) {
 		ASSERT(RequiredSize < 4294967295U);
 
 		size_t BaseOffset = 0;
-		if (List.AllocateBlock(RequiredSize, &BaseOffset)) {
+		if (List.AllocateBlock(RequiredSize, &BaseOffset) || (Grow(RequiredSize) && List.AllocateBlock(RequiredSize, &BaseOffset))) {
 			void* ptr = (void*)((size_t)MemoryBlock + BaseOffset);
 			// Start the alignment after enough space to hold a u32. This allows for the u32 to be stored
 			// immediately before the user block, while maintaining alignment on said user block.
@@ -80,8 +109,8 @@ void* DynamicAllocator::AllocateAligned(size_t size, unsigned short alignment) {
 		else {
 			LOG_ERROR("DynamicAllocator::AllocateAligned() allocate no blocks of memory large enough to allocate from.");
 			size_t available = List.GetFreeSpace();
-			LOG_ERROR("Requested size: %llu, Total space available: %llu.", size, available);
-			// TODO: Report fragmentation?
+			LOG_ERROR("Requested size: %llu, Total space available: %llu, largest free block: %llu, reserved: %llu.", size, available,
+				List.GetLargestFreeBlock(), ReservedSize);
 			return nullptr;
 		}
 	}
@@ -90,10 +119,6 @@ void* DynamicAllocator::AllocateAligned(size_t size, unsigned short alignment) {
 	return nullptr;
 }
 
-bool DynamicAllocator::Free(void* block, size_t size) {
-	return FreeAligned(block);
-}
-
 bool DynamicAllocator::FreeAligned(void* block) {
 	if (block == nullptr || MemoryBlock == nullptr) {
 		LOG_ERROR("DynamicAllocator::FreeAligned(): Free requires a valid block (0x%p).", block);
@@ -128,6 +153,10 @@ bool DynamicAllocator::GetAlignmentSize(void* block, size_t* out_size, unsigned
 	return true;
 }
 
+bool DynamicAllocator::Contains(const void* block) const {
+	return MemoryBlock != nullptr && block >= MemoryBlock && block < (const void*)((size_t)MemoryBlock + ReservedSize);
+}
+
 size_t DynamicAllocator::GetTotalSpace() {
 	return TotalSize;
 }
@@ -136,6 +165,10 @@ size_t DynamicAllocator::GetFreeSpace() {
 	return List.GetFreeSpace();
 }
 
+size_t DynamicAllocator::GetLargestFreeBlock() {
+	return List.GetLargestFreeBlock();
+}
+
 size_t DynamicAllocator::AllocatorHeaderSize() {
 	// Enough space for a header and size storage.
 	return sizeof(AllocHeader) + DSIZE_STORAGE;
@@ -14,17 +14,28 @@
 #include "Defines.hpp"
 #include "Containers/Freelist.hpp"
 
+// Memory is committed in multiples of this, the size of a huge page.
+#define DYNAMIC_ALLOCATOR_CHUNK_SIZE MEBIBYTES(2)
+// The least the allocator grows by once it runs out, so growing stays rare.
+#define DYNAMIC_ALLOCATOR_GROW_SIZE MEBIBYTES(64)
+
+/**
+ * @brief Hands out blocks of any size from a range of address space reserved up front. Only part of the range is
+ * committed at first, more is committed as the allocator runs out, so blocks never move and never come from elsewhere.
+ * Memory is committed in huge pages where the platform offers them.
+ */
 class DAPI DynamicAllocator {
 public:
-	DynamicAllocator() : TotalSize(0), MemoryBlock(nullptr) {}
+	DynamicAllocator() : TotalSize(0), ReservedSize(0), MemoryBlock(nullptr) {}
 public:					 
 	  /**					
 	 * @brief Creates a new dynamic allocator.
 	 * 
-	 * @param total_size The total size in bytes the allocator should hold. Note this size does not include the size of the internal state.
+	 * @param total_size The size in bytes committed right away. Note this size does not include the size of the internal state.
+	 * @param reserve_size The size in bytes the allocator may grow to. Reserving only takes address space.
 	 * @return True on success.
 	 */
-	bool Create(size_t total_size);
+	bool Create(size_t total_size, size_t reserve_size = 0);
 
 	/**
 	 * @brief Destroys the allocator.
@@ -50,14 +61,6 @@ public:
 	 */
 	void* AllocateAligned(size_t size, unsigned short alignment);
 
-	/**
-	 * @brief Free the given block of memory.
-	 *
-	 * @param block The block to be freed. Must have been allocated by the allocator.
-	 * @param size The size in bytes to be allocated.
-	 */
-	bool Free(void* block, size_t size);
-
 	/**
 	 * @brief Free the given block of memory.
 	 *
@@ -75,6 +78,15 @@ public:
 	 */
 	bool GetAlignmentSize(void* block, size_t* out_size, unsigned short* out_alignment);
 
+	/**
+	 * @brief Checks if the block lies within the memory of the allocator. Safe to call without the lock guarding the
+	 * allocator, the reserved range never changes.
+	 * 
+	 * @param block The block of memory.
+	 * @return True if the allocator handed it out.
+	 */
+	bool Contains(const void* block) const;
+
 	/**
 	 * @brief Obtains the amount of free space left in the allocator.
 	 * 
@@ -82,6 +94,13 @@ public:
 	 */
 	size_t GetFreeSpace();
 
+	/**
+	 * @brief Obtains the size of the largest free block, the largest allocation that fits without growing.
+	 *
+	 * @return The size in bytes.
+	 */
+	size_t GetLargestFreeBlock();
+
 	/**
 	 * @brief Obtains the amount of total space left in the allocator.
 	 *
@@ -89,13 +108,30 @@ public:
 	 */
 	size_t GetTotalSpace();
 
+	/**
+	 * @brief Obtains the size the allocator may grow to.
+	 *
+	 * @return The reserved size in bytes.
+	 */
+	size_t GetReservedSpace() const { return ReservedSize; }
+
 	/**
 	 * Obtains the size of the internal allocation header. This is readlly only used for unit testing purposes. 
 	 */
 	size_t AllocatorHeaderSize();
 
 private:
+	/**
+	 * @brief Commits more of the reserved range, enough for a block of the given size.
+	 * 
+	 * @return True if the allocator grew.
+	 */
+	bool Grow(size_t required_size);
+
+private:
+	// The committed size, the free list covers exactly this much.
 	size_t TotalSize;
+	size_t ReservedSize;
 	Freelist List;
 	void* MemoryBlock;
 };
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Core/DMemory.hpp"
+
+#include <new>
+#include <vector>
+#include <unordered_map>
+
+/**
+ * @brief Standard allocator handing out memory of the engine heap under a memory tag, so the memory of standard
+ * containers shows up in the memory statistics and the profiler. Single elements, like the nodes of maps and lists,
+ * come from the object slabs and sit together. For per frame or import temporaries see TFrameAllocator and TScratchAllocator.
+ * Containers using it must only live while the memory system runs, so systems create them in Initialize() and destroy
+ * them in Shutdown() rather than holding them statically.
+ */
+template<typename T, MemoryType Type>
+class TEngineAllocator {
+public:
+	using value_type = T;
+
+	template<typename U>
+	struct rebind {
+		using other = TEngineAllocator<U, Type>;
+	};
+
+	TEngineAllocator() noexcept {}
+	template<typename U>
+	TEngineAllocator(const TEngineAllocator<U, Type>&) noexcept {}
+
+	T* allocate(size_t n) {
+		if (Memory::TotalAllocateSize == 0) {
+			LOG_ERROR("TEngineAllocator::allocate() called while the memory system is not running.");
+			throw std::bad_alloc();
+		}
+
+		if (n > MEMORY_RESERVE_SIZE / sizeof(T)) {
+			throw std::bad_alloc();
+		}
+
+		T* Block = nullptr;
+		if (n == 1) {
+			Block = (T*)Memory::AllocateObject(sizeof(T), (unsigned short)alignof(T), Type);
+		}
+		else {
+			Block = (T*)Memory::AllocateUninitialized(n * sizeof(T), (unsigned short)alignof(T), Type);
+		}
+
+		if (Block == nullptr) {
+			throw std::bad_alloc();
+		}
+		return Block;
+	}
+
+	void deallocate(T* p, size_t n) noexcept {
+		Memory::FreeAligned(p, n * sizeof(T), (unsigned short)alignof(T), Type);
+	}
+
+	template<typename U>
+	bool operator==(const TEngineAllocator<U, Type>&) const noexcept { return true; }
+	template<typename U>
+	bool operator!=(const TEngineAllocator<U, Type>&) const noexcept { return false; }
+};
+
+template<typename T, MemoryType Type>
+using TEngineVector = std::vector<T, TEngineAllocator<T, Type>>;
+
+template<typename Key, typename Value, MemoryType Type>
+using TEngineUnorderedMap = std::unordered_map<Key, Value, std::hash<Key>, std::equal_to<Key>, TEngineAllocator<std::pair<const Key, Value>, Type>>;
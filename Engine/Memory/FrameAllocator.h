@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Core/DMemory.hpp"
+
+#include <vector>
+
+/**
+ * @brief Standard allocator handing out memory of the current frame arena, see Memory::AllocateFrame().
+ * Containers using it must be emptied or dropped within a frame of being filled, after that their memory is reused.
+ */
+template<typename T>
+class TFrameAllocator {
+public:
+	using value_type = T;
+
+	TFrameAllocator() noexcept {}
+	template<typename U>
+	TFrameAllocator(const TFrameAllocator<U>&) noexcept {}
+
+	T* allocate(size_t n) {
+		return (T*)Memory::AllocateFrame(n * sizeof(T), (unsigned short)alignof(T));
+	}
+
+	void deallocate(T* p, size_t n) noexcept {
+		Memory::FreeFrame(p, n * sizeof(T), (unsigned short)alignof(T));
+	}
+
+	template<typename U>
+	bool operator==(const TFrameAllocator<U>&) const noexcept { return true; }
+	template<typename U>
+	bool operator!=(const TFrameAllocator<U>&) const noexcept { return false; }
+};
+
+template<typename T>
+using TFrameVector = std::vector<T, TFrameAllocator<T>>;
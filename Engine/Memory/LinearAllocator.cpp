@@ -0,0 +1,48 @@
+#include "LinearAllocator.h"
+
+#include "Core/EngineLogger.hpp"
+
+bool LinearAllocator::Create(void* memory, size_t size) {
+	if (memory == nullptr || size == 0) {
+		LOG_ERROR("LinearAllocator::Create() requires valid memory.");
+		return false;
+	}
+
+	MemoryBlock = memory;
+	TotalSize = size;
+	Offset.store(0, std::memory_order_relaxed);
+	return true;
+}
+
+void LinearAllocator::Destroy() {
+	MemoryBlock = nullptr;
+	TotalSize = 0;
+	Offset.store(0, std::memory_order_relaxed);
+}
+
+void* LinearAllocator::Allocate(size_t size, unsigned short alignment) {
+	if (MemoryBlock == nullptr || size == 0) {
+		return nullptr;
+	}
+
+	size_t Alignment = alignment > 0 ? alignment : 1;
+	size_t Base = (size_t)MemoryBlock;
+	size_t Current = Offset.load(std::memory_order_relaxed);
+	size_t Start = 0;
+	do {
+		Start = ((Base + Current + Alignment - 1) & ~(Alignment - 1)) - Base;
+		if (Start + size > TotalSize) {
+			return nullptr;
+		}
+	} while (!Offset.compare_exchange_weak(Current, Start + size, std::memory_order_relaxed));
+
+	return (void*)(Base + Start);
+}
+
+void LinearAllocator::Reset() {
+	Offset.store(0, std::memory_order_relaxed);
+}
+
+bool LinearAllocator::Contains(const void* block) const {
+	return MemoryBlock != nullptr && block >= MemoryBlock && block < (const void*)((size_t)MemoryBlock + TotalSize);
+}
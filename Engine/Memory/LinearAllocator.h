@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Defines.hpp"
+
+#include <atomic>
+
+/**
+ * @brief Hands out memory by bumping an offset, and frees all of it at once by resetting the offset.
+ * Allocating is thread safe, resetting is not and must not race with allocations.
+ */
+class DAPI LinearAllocator {
+public:
+	LinearAllocator() : MemoryBlock(nullptr), TotalSize(0), Offset(0) {}
+
+public:
+	/**
+	 * @brief Creates the allocator on top of the given memory, which it does not own.
+	 *
+	 * @param memory The memory to hand out.
+	 * @param size The size of the memory in bytes.
+	 * @return True on success.
+	 */
+	bool Create(void* memory, size_t size);
+
+	/**
+	 * @brief Destroys the allocator. The blocks handed out become invalid.
+	 */
+	void Destroy();
+
+	/**
+	 * @brief Allocates a block following the previous one.
+	 *
+	 * @param size The size in bytes.
+	 * @param alignment The alignment, a power of two.
+	 * @return The block, or nullptr once the memory is used up.
+	 */
+	void* Allocate(size_t size, unsigned short alignment);
+
+	/**
+	 * @brief Frees every block at once.
+	 */
+	void Reset();
+
+	/**
+	 * @brief Checks if the block lies within the memory of the allocator.
+	 */
+	bool Contains(const void* block) const;
+
+	size_t GetAllocatedSize() const { return Offset.load(std::memory_order_relaxed); }
+	size_t GetTotalSize() const { return TotalSize; }
+
+private:
+	void* MemoryBlock;
+	size_t TotalSize;
+	std::atomic<size_t> Offset;
+};
@@ -0,0 +1,390 @@
+#include "MemoryProfiler.h"
+
+#include "Core/DMutex.hpp"
+#include "Core/Console.hpp"
+#include "Core/EngineLogger.hpp"
+#include "Platform/Platform.hpp"
+#include "Platform/FileSystem.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The report lists this many outstanding allocations at most, largest first.
+#define MEMORY_PROFILE_MAX_LISTED 4096
+
+struct SAllocationRecord {
+	size_t size;
+	MemoryType type;
+	const void* callsite;
+	uint64_t frame;
+};
+
+struct SCallsiteProfile {
+	const void* callsite;
+	// The tag of the first allocation seen, callsites rarely use more than one.
+	MemoryType type;
+	size_t allocation_count;
+	size_t allocated_bytes;
+	size_t live_count;
+	size_t live_bytes;
+};
+
+struct SOutstandingAllocation {
+	const void* block;
+	SAllocationRecord record;
+};
+
+std::atomic<bool> MemoryProfiler::Enabled = false;
+
+// Guards everything below. The containers allocate from the C runtime, so recording never recurses into the memory system.
+static Mutex ProfileMutex;
+static std::unordered_map<const void*, SAllocationRecord> Records;
+static std::unordered_map<const void*, SCallsiteProfile> Callsites;
+static SMemoryTagProfile Tags[eMemory_Type_Max];
+static size_t FrameAllocations[eMemory_Type_Max];
+static size_t FrameBytes[eMemory_Type_Max];
+static uint64_t FrameCount = 0;
+static size_t SizeMismatches = 0;
+// Written with C stdio, which never allocates from the memory system while the lock is held.
+static FILE* TraceFile = nullptr;
+
+static void OnMemoryProfileCommand(CommandContext context) {
+	// memory_profile-<on|off|report|trace>
+	std::string Action = context.Arguments.empty() ? "report" : context.Arguments[0];
+	if (Action == "on") {
+		MemoryProfiler::SetEnabled(true);
+		LOG_INFO("Memory profiling started.");
+	}
+	else if (Action == "off") {
+		MemoryProfiler::SetEnabled(false);
+		LOG_INFO("Memory profiling stopped.");
+	}
+	else if (Action == "report") {
+		if (!MemoryProfiler::IsEnabled()) {
+			LOG_WARN("Memory profiling is off, start it with memory_profile-on.");
+			return;
+		}
+
+		if (MemoryProfiler::WriteReport(MEMORY_PROFILE_REPORT_PATH)) {
+			LOG_INFO("Wrote memory profile to %s.", MEMORY_PROFILE_REPORT_PATH);
+		}
+	}
+	else if (Action == "trace") {
+		if (MemoryProfiler::StartTrace(MEMORY_PROFILE_TRACE_PATH)) {
+			LOG_INFO("Recording allocations to %s until memory_profile-off.", MEMORY_PROFILE_TRACE_PATH);
+		}
+	}
+	else {
+		LOG_ERROR("Unknown memory_profile argument '%s', expected on, off, report or trace.", Action.c_str());
+	}
+}
+
+static std::string DescribeCallsite(const void* callsite) {
+	char Name[256];
+	if (Platform::PlatformGetSymbolName(callsite, Name, sizeof(Name))) {
+		return Name;
+	}
+
+	snprintf(Name, sizeof(Name), "%p", callsite);
+	return Name;
+}
+
+static std::string DescribeSize(size_t size) {
+	float Amount = 1.0f;
+	const char* Unit = Memory::GetUnitForSize(size, &Amount);
+	char Text[32];
+	snprintf(Text, sizeof(Text), "%.2f%s", Amount, Unit);
+	return Text;
+}
+
+bool MemoryProfiler::Initialize() {
+	if (!ProfileMutex.Create()) {
+		LOG_ERROR("Unable to create the memory profiler mutex.");
+		return false;
+	}
+
+	Console::RegisterCommand("memory_profile", 1, OnMemoryProfileCommand);
+
+#ifdef ENABLE_MEMORY_PROFILE
+	SetEnabled(true);
+#endif
+	return true;
+}
+
+void MemoryProfiler::Shutdown() {
+	if (IsEnabled()) {
+		SMemoryProfileSummary Summary;
+		GetSummary(&Summary);
+		if (Summary.outstanding_count > 0) {
+			std::vector<SCallsiteProfile> Leaking;
+			ProfileMutex.Lock();
+			for (const auto& Entry : Callsites) {
+				if (Entry.second.live_count > 0) {
+					Leaking.push_back(Entry.second);
+				}
+			}
+			ProfileMutex.UnLock();
+
+			std::sort(Leaking.begin(), Leaking.end(), [](const SCallsiteProfile& a, const SCallsiteProfile& b) { return a.live_bytes > b.live_bytes; });
+			LOG_WARN("%llu allocations (%s) are still outstanding at shutdown, see %s.", (unsigned long long)Summary.outstanding_count,
+				DescribeSize(Summary.outstanding_bytes).c_str(), MEMORY_PROFILE_REPORT_PATH);
+			for (size_t i = 0; i < Leaking.size() && i < MEMORY_PROFILE_TOP_CALLSITES; ++i) {
+				LOG_WARN("  %s [%s]: %llu blocks, %s.", DescribeCallsite(Leaking[i].callsite).c_str(), MemoryTypeStrings[Leaking[i].type],
+					(unsigned long long)Leaking[i].live_count, DescribeSize(Leaking[i].live_bytes).c_str());
+			}
+		}
+
+		WriteReport(MEMORY_PROFILE_REPORT_PATH);
+		SetEnabled(false);
+	}
+
+	Console::UnregisterCommand("memory_profile");
+	ProfileMutex.Destroy();
+}
+
+void MemoryProfiler::SetEnabled(bool enabled) {
+	Memory::SMemoryStats Stats;
+	if (enabled) {
+		Memory::GatherStats(&Stats);
+	}
+
+	ProfileMutex.Lock();
+	Enabled.store(enabled, std::memory_order_relaxed);
+	std::unordered_map<const void*, SAllocationRecord>().swap(Records);
+	std::unordered_map<const void*, SCallsiteProfile>().swap(Callsites);
+	for (int i = 0; i < eMemory_Type_Max; ++i) {
+		Tags[i] = SMemoryTagProfile();
+		Tags[i].current = enabled ? Stats.tagged_allocations[i] : 0;
+		Tags[i].peak = Tags[i].current;
+		FrameAllocations[i] = 0;
+		FrameBytes[i] = 0;
+	}
+	FrameCount = 0;
+	SizeMismatches = 0;
+	if (TraceFile != nullptr) {
+		fclose(TraceFile);
+		TraceFile = nullptr;
+	}
+	ProfileMutex.UnLock();
+}
+
+bool MemoryProfiler::StartTrace(const char* path) {
+	if (!IsEnabled()) {
+		SetEnabled(true);
+	}
+
+	FILE* File = fopen(path, "w");
+	if (File == nullptr) {
+		LOG_ERROR("Unable to open %s to record allocations to.", path);
+		return false;
+	}
+
+	ProfileMutex.Lock();
+	if (TraceFile != nullptr) {
+		fclose(TraceFile);
+	}
+	TraceFile = File;
+	ProfileMutex.UnLock();
+	return true;
+}
+
+void MemoryProfiler::OnAllocate(const void* block, size_t size, unsigned short alignment, MemoryType type, const void* callsite) {
+	if (!ProfileMutex.Lock()) {
+		return;
+	}
+
+	// Profiling may have stopped since the caller checked.
+	if (IsEnabled()) {
+		SMemoryTagProfile& Tag = Tags[type];
+		Tag.current += size;
+		Tag.peak = DMAX(Tag.peak, Tag.current);
+		Tag.allocation_count++;
+		FrameAllocations[type]++;
+		FrameBytes[type] += size;
+
+		if (block != nullptr) {
+			Records[block] = { size, type, callsite, FrameCount };
+
+			auto Inserted = Callsites.emplace(callsite, SCallsiteProfile{ callsite, type, 0, 0, 0, 0 });
+			SCallsiteProfile& Site = Inserted.first->second;
+			Site.allocation_count++;
+			Site.allocated_bytes += size;
+			Site.live_count++;
+			Site.live_bytes += size;
+
+			if (TraceFile != nullptr) {
+				fprintf(TraceFile, "a %p %llu %u\n", block, (unsigned long long)size, (unsigned int)alignment);
+			}
+		}
+	}
+
+	ProfileMutex.UnLock();
+}
+
+void MemoryProfiler::OnFree(const void* block, size_t size, MemoryType type) {
+	if (!ProfileMutex.Lock()) {
+		return;
+	}
+
+	bool Mismatch = false;
+	SAllocationRecord Record = {};
+	size_t MismatchIndex = 0;
+	if (IsEnabled()) {
+		// Blocks allocated before profiling started have no record, the size passed is all there is.
+		size_t FreedSize = size;
+		MemoryType FreedType = type;
+		auto Found = block != nullptr ? Records.find(block) : Records.end();
+		if (Found != Records.end()) {
+			Record = Found->second;
+			Records.erase(Found);
+			FreedSize = Record.size;
+			FreedType = Record.type;
+
+			SCallsiteProfile& Site = Callsites[Record.callsite];
+			Site.live_count--;
+			Site.live_bytes -= Record.size;
+
+			if (Record.size != size || Record.type != type) {
+				Mismatch = true;
+				MismatchIndex = SizeMismatches++;
+			}
+		}
+
+		SMemoryTagProfile& Tag = Tags[FreedType];
+		Tag.current -= DMIN(Tag.current, FreedSize);
+		Tag.free_count++;
+
+		if (TraceFile != nullptr && block != nullptr) {
+			fprintf(TraceFile, "f %p\n", block);
+		}
+	}
+
+	ProfileMutex.UnLock();
+
+	if (Mismatch && MismatchIndex < MEMORY_PROFILE_MISMATCH_LOG_COUNT) {
+		LOG_WARN("Freed %p as %llu bytes of %s, but it was allocated as %llu bytes of %s by %s.", block, (unsigned long long)size,
+			MemoryTypeStrings[type], (unsigned long long)Record.size, MemoryTypeStrings[Record.type], DescribeCallsite(Record.callsite).c_str());
+	}
+}
+
+void MemoryProfiler::OnFrame() {
+	if (!ProfileMutex.Lock()) {
+		return;
+	}
+
+	for (int i = 0; i < eMemory_Type_Max; ++i) {
+		SMemoryTagProfile& Tag = Tags[i];
+		Tag.last_frame_allocations = FrameAllocations[i];
+		Tag.last_frame_bytes = FrameBytes[i];
+		Tag.peak_frame_allocations = DMAX(Tag.peak_frame_allocations, FrameAllocations[i]);
+		Tag.peak_frame_bytes = DMAX(Tag.peak_frame_bytes, FrameBytes[i]);
+		FrameAllocations[i] = 0;
+		FrameBytes[i] = 0;
+	}
+	FrameCount++;
+
+	ProfileMutex.UnLock();
+}
+
+void MemoryProfiler::GetSummary(SMemoryProfileSummary* out_summary) {
+	ProfileMutex.Lock();
+	out_summary->outstanding_count = Records.size();
+	out_summary->outstanding_bytes = 0;
+	for (const auto& Entry : Callsites) {
+		out_summary->outstanding_bytes += Entry.second.live_bytes;
+	}
+	out_summary->size_mismatches = SizeMismatches;
+	out_summary->callsite_count = Callsites.size();
+	out_summary->frame_count = FrameCount;
+	for (int i = 0; i < eMemory_Type_Max; ++i) {
+		out_summary->tags[i] = Tags[i];
+	}
+	ProfileMutex.UnLock();
+}
+
+bool MemoryProfiler::WriteReport(const char* path) {
+	// Copy what is needed and format without the lock, looking up symbols takes a while.
+	SMemoryProfileSummary Summary;
+	std::vector<SCallsiteProfile> Sites;
+	std::vector<SOutstandingAllocation> Outstanding;
+	GetSummary(&Summary);
+	ProfileMutex.Lock();
+	Sites.reserve(Callsites.size());
+	for (const auto& Entry : Callsites) {
+		Sites.push_back(Entry.second);
+	}
+	Outstanding.reserve(Records.size());
+	for (const auto& Entry : Records) {
+		Outstanding.push_back({ Entry.first, Entry.second });
+	}
+	ProfileMutex.UnLock();
+
+	char Line[512];
+	std::string Report;
+	snprintf(Line, sizeof(Line), "Memory profile over %llu frames\nOutstanding: %llu allocations, %s\nFree size mismatches: %llu\n\n",
+		(unsigned long long)Summary.frame_count, (unsigned long long)Summary.outstanding_count, DescribeSize(Summary.outstanding_bytes).c_str(),
+		(unsigned long long)Summary.size_mismatches);
+	Report += Line;
+
+	Report += "Tags (current, peak, allocations, frees, last frame, most in a frame):\n";
+	for (int i = 0; i < eMemory_Type_Max; ++i) {
+		const SMemoryTagProfile& Tag = Summary.tags[i];
+		if (Tag.peak == 0 && Tag.allocation_count == 0) {
+			continue;
+		}
+
+		snprintf(Line, sizeof(Line), " %s: %s, %s, %llu, %llu, %llu (%s), %llu (%s)\n", MemoryTypeStrings[i], DescribeSize(Tag.current).c_str(),
+			DescribeSize(Tag.peak).c_str(), (unsigned long long)Tag.allocation_count, (unsigned long long)Tag.free_count,
+			(unsigned long long)Tag.last_frame_allocations, DescribeSize(Tag.last_frame_bytes).c_str(),
+			(unsigned long long)Tag.peak_frame_allocations, DescribeSize(Tag.peak_frame_bytes).c_str());
+		Report += Line;
+	}
+
+	auto WriteCallsites = [&](const char* title) {
+		Report += title;
+		for (size_t i = 0; i < Sites.size() && i < MEMORY_PROFILE_TOP_CALLSITES; ++i) {
+			const SCallsiteProfile& Site = Sites[i];
+			snprintf(Line, sizeof(Line), " %s [%s]: %llu allocations, %s in total, %llu live, %s\n", DescribeCallsite(Site.callsite).c_str(),
+				MemoryTypeStrings[Site.type], (unsigned long long)Site.allocation_count, DescribeSize(Site.allocated_bytes).c_str(),
+				(unsigned long long)Site.live_count, DescribeSize(Site.live_bytes).c_str());
+			Report += Line;
+		}
+	};
+
+	std::sort(Sites.begin(), Sites.end(), [](const SCallsiteProfile& a, const SCallsiteProfile& b) { return a.allocation_count > b.allocation_count; });
+	WriteCallsites("\nCallsites by allocations:\n");
+	std::sort(Sites.begin(), Sites.end(), [](const SCallsiteProfile& a, const SCallsiteProfile& b) { return a.live_bytes > b.live_bytes; });
+	WriteCallsites("\nCallsites by live bytes:\n");
+
+	std::sort(Outstanding.begin(), Outstanding.end(), [](const SOutstandingAllocation& a, const SOutstandingAllocation& b) { return a.record.size > b.record.size; });
+	Report += "\nOutstanding allocations (block, size, tag, frame, callsite):\n";
+	for (size_t i = 0; i < Outstanding.size() && i < MEMORY_PROFILE_MAX_LISTED; ++i) {
+		const SAllocationRecord& Record = Outstanding[i].record;
+		snprintf(Line, sizeof(Line), " %p, %llu, %s, %llu, %s\n", Outstanding[i].block, (unsigned long long)Record.size, MemoryTypeStrings[Record.type],
+			(unsigned long long)Record.frame, DescribeCallsite(Record.callsite).c_str());
+		Report += Line;
+	}
+	if (Outstanding.size() > MEMORY_PROFILE_MAX_LISTED) {
+		snprintf(Line, sizeof(Line), " ... and %llu smaller ones\n", (unsigned long long)(Outstanding.size() - MEMORY_PROFILE_MAX_LISTED));
+		Report += Line;
+	}
+
+	FileHandle Handle;
+	if (!FileSystemOpen(path, eFile_Mode_Write, false, &Handle)) {
+		LOG_ERROR("Unable to open %s to write the memory profile.", path);
+		return false;
+	}
+
+	size_t Written = 0;
+	bool Result = FileSystemWrite(&Handle, Report.size(), (void*)Report.data(), &Written) && Written == Report.size();
+	FileSystemClose(&Handle);
+	if (!Result) {
+		LOG_ERROR("Failed to write the memory profile to %s.", path);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Core/DMemory.hpp"
+
+#include <atomic>
+
+// The file the memory_profile console command and the shutdown leak dump write to.
+#define MEMORY_PROFILE_REPORT_PATH "memory_report.txt"
+// The file the memory_profile-trace console command records allocations to.
+#define MEMORY_PROFILE_TRACE_PATH "memory_trace.txt"
+// The number of callsites listed per table of the report, and in the leak summary logged at shutdown.
+#define MEMORY_PROFILE_TOP_CALLSITES 16
+// Free size mismatches are logged until this many were seen, later ones are only counted.
+#define MEMORY_PROFILE_MISMATCH_LOG_COUNT 16
+
+struct SMemoryTagProfile {
+	size_t current;
+	size_t peak;
+	size_t allocation_count;
+	size_t free_count;
+	// Allocations during the last finished frame, and the most during any frame.
+	size_t last_frame_allocations;
+	size_t last_frame_bytes;
+	size_t peak_frame_allocations;
+	size_t peak_frame_bytes;
+};
+
+struct SMemoryProfileSummary {
+	size_t outstanding_count;
+	size_t outstanding_bytes;
+	size_t size_mismatches;
+	size_t callsite_count;
+	uint64_t frame_count;
+	SMemoryTagProfile tags[eMemory_Type_Max];
+};
+
+/**
+ * @brief Optional profiling of the memory system. While enabled, every allocation is recorded with its size, tag and
+ * the code that asked for it, which attributes allocations to callsites, catches frees passing the wrong size and
+ * lists the blocks still outstanding. Tags additionally track their peak and the allocations per frame.
+ * Starts enabled when built with ENABLE_MEMORY_PROFILE, and can be toggled by the memory_profile console command.
+ * Allocations can also be recorded to a trace, for replaying a real run in the allocator benchmarks.
+ */
+class DAPI MemoryProfiler {
+public:
+	static bool Initialize();
+
+	/**
+	 * @brief Logs the allocations still outstanding and writes the report, if enabled. Called before the allocators go away.
+	 */
+	static void Shutdown();
+
+	/**
+	 * @brief Starts or stops recording. Starting drops the records of a previous run, tags start from their current size.
+	 * Blocks allocated while disabled are not tracked, freeing them later is fine.
+	 */
+	static void SetEnabled(bool enabled);
+	static bool IsEnabled() { return Enabled.load(std::memory_order_relaxed); }
+
+	/**
+	 * @brief Starts recording every allocation and free to a text file, in the order they happen. Lines read
+	 * "a <block> <size> <alignment>" and "f <block>". Starts profiling if it is off, stopping it ends the trace.
+	 * @returns True if the file could be opened.
+	 */
+	static bool StartTrace(const char* path);
+
+	/**
+	 * @brief Records an allocation. A null block only counts towards the tag, for memory reported by Memory::AllocateReport().
+	 * @param callsite The return address of the memory system entry point that was called.
+	 */
+	static void OnAllocate(const void* block, size_t size, unsigned short alignment, MemoryType type, const void* callsite);
+
+	/**
+	 * @brief Drops the record of a block, reporting a size or tag differing from the one it was allocated with.
+	 */
+	static void OnFree(const void* block, size_t size, MemoryType type);
+
+	/**
+	 * @brief Closes the allocation counts of a frame. Called by Memory::BeginFrame().
+	 */
+	static void OnFrame();
+
+	/**
+	 * @brief Writes the per tag statistics, the busiest callsites and the outstanding allocations to a text file.
+	 * @returns True if written.
+	 */
+	static bool WriteReport(const char* path);
+
+	static void GetSummary(SMemoryProfileSummary* out_summary);
+
+private:
+	static std::atomic<bool> Enabled;
+};
@@ -0,0 +1,202 @@
+#include "ScratchAllocator.h"
+
+#include "Core/EngineLogger.hpp"
+#include "Platform/Platform.hpp"
+
+#include <atomic>
+#include <cstring>
+
+// Blocks start and end on multiples of this, so blocks freed next to each other leave no gaps and merge.
+#define SCRATCH_GRANULARITY 16
+
+static std::atomic<size_t> CommittedSize = 0;
+
+// The range is reserved on first use, threads never asking for scratch memory take no address space.
+static thread_local SScratchStack ThreadStack;
+// Set while a job fiber runs on the thread.
+static thread_local SScratchStack* CurrentStack = nullptr;
+
+SScratchStack::~SScratchStack() {
+	ScratchAllocator::ReleaseStack(this);
+}
+
+static SScratchStack& GetCurrentStack() {
+	return CurrentStack != nullptr ? *CurrentStack : ThreadStack;
+}
+
+static void RemoveFreeRange(SScratchStack& stack, uint32_t index) {
+	stack.free_range_count--;
+	memmove(&stack.free_ranges[index], &stack.free_ranges[index + 1], (stack.free_range_count - index) * sizeof(SScratchRange));
+}
+
+static void AddFreeRange(SScratchStack& stack, size_t offset, size_t size) {
+	if (size == 0) {
+		return;
+	}
+
+	uint32_t Index = 0;
+	while (Index < stack.free_range_count && stack.free_ranges[Index].offset < offset) {
+		Index++;
+	}
+
+	bool MergePrevious = Index > 0 && stack.free_ranges[Index - 1].offset + stack.free_ranges[Index - 1].size == offset;
+	bool MergeNext = Index < stack.free_range_count && stack.free_ranges[Index].offset == offset + size;
+	if (MergePrevious && MergeNext) {
+		stack.free_ranges[Index - 1].size += size + stack.free_ranges[Index].size;
+		RemoveFreeRange(stack, Index);
+	}
+	else if (MergePrevious) {
+		stack.free_ranges[Index - 1].size += size;
+	}
+	else if (MergeNext) {
+		stack.free_ranges[Index].offset = offset;
+		stack.free_ranges[Index].size += size;
+	}
+	else if (stack.free_range_count < SCRATCH_FREE_RANGE_COUNT) {
+		memmove(&stack.free_ranges[Index + 1], &stack.free_ranges[Index], (stack.free_range_count - Index) * sizeof(SScratchRange));
+		stack.free_ranges[Index] = SScratchRange{ offset, size };
+		stack.free_range_count++;
+	}
+}
+
+// Lowers the top past freed ranges right below it, as long as they lie above the latest marker.
+static void PopFreeRanges(SScratchStack& stack) {
+	while (stack.free_range_count > 0) {
+		SScratchRange& Last = stack.free_ranges[stack.free_range_count - 1];
+		if (Last.offset + Last.size != stack.offset || Last.offset < stack.reuse_floor) {
+			break;
+		}
+
+		stack.offset = Last.offset;
+		stack.free_range_count--;
+	}
+}
+
+void* ScratchAllocator::Allocate(size_t size, unsigned short alignment) {
+	SScratchStack& Stack = GetCurrentStack();
+	if (Stack.memory == nullptr) {
+		Stack.memory = (char*)Platform::PlatformReserveMemory(SCRATCH_RESERVE_SIZE);
+		if (Stack.memory == nullptr) {
+			LOG_FATAL("Unable to reserve %llu bytes of address space for scratch memory.", (unsigned long long)SCRATCH_RESERVE_SIZE);
+			return nullptr;
+		}
+	}
+
+	size_t Granularity = DMAX((size_t)alignment, (size_t)SCRATCH_GRANULARITY);
+	size = PaddingAligned(size, SCRATCH_GRANULARITY);
+
+	// Reuse a freed block above the latest marker first.
+	for (uint32_t i = 0; i < Stack.free_range_count; ++i) {
+		SScratchRange Range = Stack.free_ranges[i];
+		size_t RangeEnd = Range.offset + Range.size;
+		size_t Start = PaddingAligned((size_t)Stack.memory + DMAX(Range.offset, Stack.reuse_floor), Granularity) - (size_t)Stack.memory;
+		if (Start + size > RangeEnd) {
+			continue;
+		}
+
+		RemoveFreeRange(Stack, i);
+		AddFreeRange(Stack, Range.offset, Start - Range.offset);
+		AddFreeRange(Stack, Start + size, RangeEnd - (Start + size));
+		return Stack.memory + Start;
+	}
+
+	size_t Start = PaddingAligned((size_t)Stack.memory + Stack.offset, Granularity) - (size_t)Stack.memory;
+	size_t End = Start + size;
+	if (End > SCRATCH_RESERVE_SIZE) {
+		LOG_ERROR("Scratch memory exhausted, %llu bytes requested with %llu of %llu in use.", (unsigned long long)size,
+			(unsigned long long)Stack.offset, (unsigned long long)SCRATCH_RESERVE_SIZE);
+		return nullptr;
+	}
+
+	if (End > Stack.committed) {
+		size_t Committed = DMIN(PaddingAligned(End, SCRATCH_COMMIT_SIZE), (size_t)SCRATCH_RESERVE_SIZE);
+		if (!Platform::PlatformCommitMemory(Stack.memory + Stack.committed, Committed - Stack.committed, true)) {
+			LOG_FATAL("Unable to commit %llu bytes of scratch memory.", (unsigned long long)(Committed - Stack.committed));
+			return nullptr;
+		}
+
+		CommittedSize.fetch_add(Committed - Stack.committed, std::memory_order_relaxed);
+		Stack.committed = Committed;
+	}
+
+	// Padding in front of an over-aligned block can be reused like a freed block.
+	AddFreeRange(Stack, Stack.offset, Start - Stack.offset);
+	Stack.offset = End;
+	return Stack.memory + Start;
+}
+
+void ScratchAllocator::Free(void* block, size_t size) {
+	if (block == nullptr) {
+		return;
+	}
+
+	SScratchStack& Stack = GetCurrentStack();
+	if ((char*)block < Stack.memory || (char*)block >= Stack.memory + SCRATCH_RESERVE_SIZE) {
+		LOG_ERROR("Freeing block %p, which is not from the current scratch stack.", block);
+		return;
+	}
+
+	size_t Start = (char*)block - Stack.memory;
+	size_t End = Start + PaddingAligned(size, SCRATCH_GRANULARITY);
+	if (End > Stack.offset) {
+		// Already freed by a rewind.
+		return;
+	}
+
+	if (End == Stack.offset && Start >= Stack.reuse_floor) {
+		Stack.offset = Start;
+		PopFreeRanges(Stack);
+		return;
+	}
+
+	AddFreeRange(Stack, Start, End - Start);
+}
+
+size_t ScratchAllocator::GetMarker() {
+	SScratchStack& Stack = GetCurrentStack();
+	Stack.reuse_floor = Stack.offset;
+	return Stack.offset;
+}
+
+void ScratchAllocator::Rewind(size_t marker) {
+	SScratchStack& Stack = GetCurrentStack();
+	if (marker > Stack.offset) {
+		LOG_ERROR("Rewinding scratch memory to %llu, past its top at %llu. Was a marker taken on another thread?",
+			(unsigned long long)marker, (unsigned long long)Stack.offset);
+		return;
+	}
+
+	Stack.offset = marker;
+	Stack.reuse_floor = DMIN(Stack.reuse_floor, marker);
+	while (Stack.free_range_count > 0 && Stack.free_ranges[Stack.free_range_count - 1].offset >= marker) {
+		Stack.free_range_count--;
+	}
+	if (Stack.free_range_count > 0) {
+		SScratchRange& Last = Stack.free_ranges[Stack.free_range_count - 1];
+		Last.size = DMIN(Last.size, marker - Last.offset);
+	}
+	PopFreeRanges(Stack);
+}
+
+size_t ScratchAllocator::GetCommittedSize() {
+	return CommittedSize.load(std::memory_order_relaxed);
+}
+
+SScratchStack* ScratchAllocator::SetCurrentStack(SScratchStack* stack) {
+	SScratchStack* Previous = CurrentStack;
+	CurrentStack = stack;
+	return Previous;
+}
+
+void ScratchAllocator::ReleaseStack(SScratchStack* stack) {
+	if (stack->memory != nullptr) {
+		Platform::PlatformReleaseMemory(stack->memory, SCRATCH_RESERVE_SIZE);
+		CommittedSize.fetch_sub(stack->committed, std::memory_order_relaxed);
+	}
+
+	stack->memory = nullptr;
+	stack->offset = 0;
+	stack->committed = 0;
+	stack->reuse_floor = 0;
+	stack->free_range_count = 0;
+}
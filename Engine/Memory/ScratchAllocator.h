@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Defines.hpp"
+
+#include <new>
+#include <vector>
+
+// The address space every scratch stack reserves, committed only as far as it is used.
+#define SCRATCH_RESERVE_SIZE GIBIBYTES(4ull)
+// Scratch memory is committed in multiples of this, the size of a huge page.
+#define SCRATCH_COMMIT_SIZE MEBIBYTES(2)
+// Blocks freed below the top of a stack are kept in this many ranges for reuse. Further ones wait for the next rewind.
+#define SCRATCH_FREE_RANGE_COUNT 16
+
+struct SScratchRange {
+	size_t offset;
+	size_t size;
+};
+
+/**
+ * @brief A stack of scratch memory. Threads get one on first use, job fibers carry one each.
+ */
+struct DAPI SScratchStack {
+	~SScratchStack();
+
+	char* memory = nullptr;
+	size_t offset = 0;
+	size_t committed = 0;
+	// Freed blocks are only reused at or above this offset, the latest marker taken, so a rewind frees them for sure.
+	size_t reuse_floor = 0;
+	// Freed blocks below offset, sorted by offset. Neighbouring ranges are merged.
+	SScratchRange free_ranges[SCRATCH_FREE_RANGE_COUNT];
+	uint32_t free_range_count = 0;
+};
+
+/**
+ * @brief Stack of temporary memory for the calling thread, or for the running job in fiber mode. Allocating bumps an
+ * offset, rewinding to a marker taken earlier frees everything allocated since at once. Meant for the temporaries of
+ * loaders and importers, which would otherwise churn the engine heap. Memory once committed stays with the stack, so
+ * later imports reuse it.
+ */
+class DAPI ScratchAllocator {
+public:
+	/**
+	 * @brief Allocates from the current scratch stack. The memory is not zeroed.
+	 *
+	 * @param size The size in bytes.
+	 * @param alignment The alignment, a power of two.
+	 * @return The block, or nullptr once the reserved range is used up.
+	 */
+	static void* Allocate(size_t size, unsigned short alignment);
+
+	/**
+	 * @brief Hands a block back before the next rewind. The top block pops off the stack, others are reused by later
+	 * allocations of the same stack.
+	 *
+	 * @param size The size passed to Allocate().
+	 */
+	static void Free(void* block, size_t size);
+
+	/**
+	 * @brief Obtains the current top of the current scratch stack, to rewind to later.
+	 */
+	static size_t GetMarker();
+
+	/**
+	 * @brief Frees everything allocated from the current stack since the marker was taken.
+	 */
+	static void Rewind(size_t marker);
+
+	/**
+	 * @brief Obtains the scratch memory committed by all stacks together.
+	 */
+	static size_t GetCommittedSize();
+
+	/**
+	 * @brief Makes the given stack the calling thread's current one, the job system does so around running a fiber.
+	 *
+	 * @param stack The stack, or nullptr for the thread's own.
+	 * @return The stack current before.
+	 */
+	static SScratchStack* SetCurrentStack(SScratchStack* stack);
+
+	/**
+	 * @brief Returns the stack's memory to the system, leaving it empty for reuse.
+	 */
+	static void ReleaseStack(SScratchStack* stack);
+};
+
+/**
+ * @brief Rewinds the current scratch stack to where it was when the scope began. Jobs running on fibers have a stack
+ * of their own, so a scope may span a job wait even if the job resumes on another thread.
+ */
+class ScratchScope {
+public:
+	ScratchScope() : Marker(ScratchAllocator::GetMarker()) {}
+	~ScratchScope() { ScratchAllocator::Rewind(Marker); }
+
+	ScratchScope(const ScratchScope&) = delete;
+	ScratchScope& operator=(const ScratchScope&) = delete;
+
+	template<typename T>
+	T* Allocate(size_t count) {
+		return (T*)ScratchAllocator::Allocate(count * sizeof(T), (unsigned short)alignof(T));
+	}
+
+private:
+	size_t Marker;
+};
+
+/**
+ * @brief Standard allocator handing out memory of the current scratch stack. Blocks a container lets go of, like the
+ * old buffer when a vector grows, are reused by later allocations. Containers using it must still be dropped or emptied
+ * before the scope or marker they were filled under ends.
+ */
+template<typename T>
+class TScratchAllocator {
+public:
+	using value_type = T;
+
+	TScratchAllocator() noexcept {}
+	template<typename U>
+	TScratchAllocator(const TScratchAllocator<U>&) noexcept {}
+
+	T* allocate(size_t n) {
+		if (n > SCRATCH_RESERVE_SIZE / sizeof(T)) {
+			throw std::bad_alloc();
+		}
+
+		T* Block = (T*)ScratchAllocator::Allocate(n * sizeof(T), (unsigned short)alignof(T));
+		if (Block == nullptr) {
+			throw std::bad_alloc();
+		}
+		return Block;
+	}
+
+	void deallocate(T* p, size_t n) noexcept {
+		ScratchAllocator::Free(p, n * sizeof(T));
+	}
+
+	template<typename U>
+	bool operator==(const TScratchAllocator<U>&) const noexcept { return true; }
+	template<typename U>
+	bool operator!=(const TScratchAllocator<U>&) const noexcept { return false; }
+};
+
+template<typename T>
+using TScratchVector = std::vector<T, TScratchAllocator<T>>;
@@ -0,0 +1,216 @@
+#include "SlabAllocator.h"
+
+#include "Core/EngineLogger.hpp"
+
+#include <new>
+
+static unsigned short GetSlabClass(size_t size) {
+	unsigned short SizeClass = 0;
+	while (((size_t)SLAB_MIN_BLOCK_SIZE << SizeClass) < size) {
+		SizeClass++;
+	}
+	return SizeClass;
+}
+
+static size_t GetSlabBlockSize(unsigned short size_class) {
+	return (size_t)SLAB_MIN_BLOCK_SIZE << size_class;
+}
+
+size_t SlabAllocator::GetMemoryRequirement(size_t slab_count) {
+	return slab_count * (SLAB_SIZE + sizeof(SSlab));
+}
+
+bool SlabAllocator::Create(void* memory, size_t size) {
+	if (memory == nullptr || size < GetMemoryRequirement(1)) {
+		LOG_ERROR("SlabAllocator::Create() requires memory for at least one slab.");
+		return false;
+	}
+
+	// The slabs come first, so every one of them starts aligned. Their bookkeeping follows.
+	MemoryBlock = memory;
+	TotalSize = size;
+	SlabCount = size / (SLAB_SIZE + sizeof(SSlab));
+	Slabs = (SSlab*)((size_t)memory + SlabCount * SLAB_SIZE);
+	for (size_t i = 0; i < SlabCount; ++i) {
+		new(&Slabs[i]) SSlab();
+	}
+
+	EmptySlabs = nullptr;
+	UnusedSlabIndex = 0;
+	EmptySlabMutex.Create();
+	for (int i = 0; i < SLAB_CLASS_COUNT; ++i) {
+		ClassMutexes[i].Create();
+		PartialSlabs[i] = nullptr;
+		ClassSlabCounts[i] = 0;
+		ClassUsedBlocks[i] = 0;
+	}
+
+	return true;
+}
+
+void SlabAllocator::Destroy() {
+	if (MemoryBlock == nullptr) {
+		return;
+	}
+
+	EmptySlabMutex.Destroy();
+	for (int i = 0; i < SLAB_CLASS_COUNT; ++i) {
+		ClassMutexes[i].Destroy();
+	}
+
+	MemoryBlock = nullptr;
+	TotalSize = 0;
+	SlabCount = 0;
+	Slabs = nullptr;
+}
+
+void* SlabAllocator::GetSlabMemory(const SSlab* slab) const {
+	return (void*)((size_t)MemoryBlock + (size_t)(slab - Slabs) * SLAB_SIZE);
+}
+
+SSlab* SlabAllocator::AcquireSlab(unsigned short size_class) {
+	if (!EmptySlabMutex.Lock()) {
+		LOG_FATAL("Error obtaining mutex lock during slab allocation.");
+		return nullptr;
+	}
+
+	SSlab* Slab = EmptySlabs;
+	if (Slab != nullptr) {
+		EmptySlabs = Slab->next;
+	}
+	else if (UnusedSlabIndex < SlabCount) {
+		Slab = &Slabs[UnusedSlabIndex++];
+	}
+	EmptySlabMutex.UnLock();
+
+	if (Slab == nullptr) {
+		return nullptr;
+	}
+
+	*Slab = SSlab();
+	Slab->size_class = size_class;
+	return Slab;
+}
+
+void* SlabAllocator::Allocate(size_t size) {
+	if (MemoryBlock == nullptr || size > SLAB_MAX_BLOCK_SIZE) {
+		return nullptr;
+	}
+
+	unsigned short SizeClass = GetSlabClass(size);
+	size_t BlockSize = GetSlabBlockSize(SizeClass);
+	if (!ClassMutexes[SizeClass].Lock()) {
+		LOG_FATAL("Error obtaining mutex lock during slab allocation.");
+		return nullptr;
+	}
+
+	SSlab* Slab = PartialSlabs[SizeClass];
+	if (Slab == nullptr) {
+		Slab = AcquireSlab(SizeClass);
+		if (Slab == nullptr) {
+			ClassMutexes[SizeClass].UnLock();
+			return nullptr;
+		}
+
+		Slab->in_partial_list = true;
+		PartialSlabs[SizeClass] = Slab;
+		ClassSlabCounts[SizeClass]++;
+	}
+
+	// Reuse a freed block first, so a slab is only carved further once all of its earlier blocks are taken.
+	void* Block = Slab->free_blocks;
+	if (Block != nullptr) {
+		Slab->free_blocks = *(void**)Block;
+	}
+	else {
+		Block = (void*)((size_t)GetSlabMemory(Slab) + Slab->carved_count * BlockSize);
+		Slab->carved_count++;
+	}
+	Slab->used_count++;
+	ClassUsedBlocks[SizeClass]++;
+
+	if (Slab->used_count == SLAB_SIZE / BlockSize) {
+		PartialSlabs[SizeClass] = Slab->next;
+		if (Slab->next != nullptr) {
+			Slab->next->prev = nullptr;
+		}
+		Slab->next = nullptr;
+		Slab->in_partial_list = false;
+	}
+
+	ClassMutexes[SizeClass].UnLock();
+	return Block;
+}
+
+void SlabAllocator::Free(void* block) {
+	if (!Contains(block)) {
+		LOG_ERROR("SlabAllocator::Free(): Trying to release block (0x%p) outside of the slabs.", block);
+		return;
+	}
+
+	SSlab* Slab = &Slabs[((size_t)block - (size_t)MemoryBlock) / SLAB_SIZE];
+	unsigned short SizeClass = Slab->size_class;
+	if (!ClassMutexes[SizeClass].Lock()) {
+		LOG_FATAL("Unable to obtain mutex lock for slab free operation. Heap corruption is likely.");
+		return;
+	}
+
+	*(void**)block = Slab->free_blocks;
+	Slab->free_blocks = block;
+	Slab->used_count--;
+	ClassUsedBlocks[SizeClass]--;
+
+	if (!Slab->in_partial_list) {
+		Slab->in_partial_list = true;
+		Slab->prev = nullptr;
+		Slab->next = PartialSlabs[SizeClass];
+		if (Slab->next != nullptr) {
+			Slab->next->prev = Slab;
+		}
+		PartialSlabs[SizeClass] = Slab;
+	}
+
+	// Empty slabs go back for any class to use, except the last one of the class to avoid churn.
+	bool Release = Slab->used_count == 0 && (Slab->next != nullptr || Slab->prev != nullptr);
+	if (Release) {
+		if (Slab->prev != nullptr) {
+			Slab->prev->next = Slab->next;
+		}
+		else {
+			PartialSlabs[SizeClass] = Slab->next;
+		}
+		if (Slab->next != nullptr) {
+			Slab->next->prev = Slab->prev;
+		}
+		ClassSlabCounts[SizeClass]--;
+	}
+	ClassMutexes[SizeClass].UnLock();
+
+	if (Release) {
+		EmptySlabMutex.Lock();
+		Slab->next = EmptySlabs;
+		EmptySlabs = Slab;
+		EmptySlabMutex.UnLock();
+	}
+}
+
+bool SlabAllocator::Contains(const void* block) const {
+	return MemoryBlock != nullptr && block >= MemoryBlock && block < (const void*)((size_t)MemoryBlock + SlabCount * SLAB_SIZE);
+}
+
+size_t SlabAllocator::GetBlockSize(const void* block) const {
+	return GetSlabBlockSize(Slabs[((size_t)block - (size_t)MemoryBlock) / SLAB_SIZE].size_class);
+}
+
+void SlabAllocator::GetClassStats(unsigned short size_class, SSlabClassStats* out_stats) {
+	*out_stats = SSlabClassStats();
+	out_stats->block_size = GetSlabBlockSize(size_class);
+	if (MemoryBlock == nullptr || !ClassMutexes[size_class].Lock()) {
+		return;
+	}
+
+	out_stats->slab_count = ClassSlabCounts[size_class];
+	out_stats->used_blocks = ClassUsedBlocks[size_class];
+	ClassMutexes[size_class].UnLock();
+	out_stats->capacity = out_stats->slab_count * (SLAB_SIZE / out_stats->block_size);
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Defines.hpp"
+#include "Core/DMutex.hpp"
+
+// Every slab holds blocks of a single size class.
+#define SLAB_SIZE KIBIBYTES(64)
+// Size classes are the powers of two from SLAB_MIN_BLOCK_SIZE up to SLAB_MAX_BLOCK_SIZE.
+#define SLAB_MIN_BLOCK_SIZE 16
+#define SLAB_MAX_BLOCK_SIZE KIBIBYTES(4)
+#define SLAB_CLASS_COUNT 9
+
+struct SSlab {
+	// The next free block handed back, blocks never handed out are carved from the unused tail instead.
+	void* free_blocks = nullptr;
+	uint32_t carved_count = 0;
+	uint32_t used_count = 0;
+	unsigned short size_class = 0;
+	bool in_partial_list = false;
+	// Links slabs of a class with free blocks, or slabs not given to any class.
+	SSlab* next = nullptr;
+	SSlab* prev = nullptr;
+};
+
+struct SSlabClassStats {
+	size_t block_size = 0;
+	size_t slab_count = 0;
+	size_t used_blocks = 0;
+	size_t capacity = 0;
+};
+
+/**
+ * @brief Hands out fixed size blocks from slabs of one size class each, in constant time.
+ * Objects of the same size end up next to each other. Thread safe, every class has a lock of its own.
+ */
+class DAPI SlabAllocator {
+public:
+	SlabAllocator() : MemoryBlock(nullptr), TotalSize(0), SlabCount(0), Slabs(nullptr), EmptySlabs(nullptr), UnusedSlabIndex(0) {}
+
+public:
+	/**
+	 * @brief Creates the allocator on top of the given memory, which it does not own.
+	 *
+	 * @param memory The memory to carve slabs from. Aligned to SLAB_MAX_BLOCK_SIZE.
+	 * @param size The size of the memory in bytes, holding SLAB_SIZE per slab plus an SSlab for each.
+	 * @return True on success.
+	 */
+	bool Create(void* memory, size_t size);
+
+	/**
+	 * @brief Destroys the allocator. The blocks handed out become invalid.
+	 */
+	void Destroy();
+
+	/**
+	 * @brief Obtains the memory size needed to hold the given number of slabs.
+	 */
+	static size_t GetMemoryRequirement(size_t slab_count);
+
+	/**
+	 * @brief Allocates a block of the smallest class holding the given size, aligned to its class size.
+	 *
+	 * @param size The size in bytes, at most SLAB_MAX_BLOCK_SIZE.
+	 * @return The block, or nullptr if every slab is taken.
+	 */
+	void* Allocate(size_t size);
+
+	/**
+	 * @brief Frees a block handed out by Allocate().
+	 *
+	 * @param block The block to be freed.
+	 */
+	void Free(void* block);
+
+	/**
+	 * @brief Checks if the block lies within the slabs of the allocator.
+	 */
+	bool Contains(const void* block) const;
+
+	/**
+	 * @brief Obtains the size of the class the block belongs to.
+	 */
+	size_t GetBlockSize(const void* block) const;
+
+	/**
+	 * @brief Obtains the occupancy of a size class.
+	 *
+	 * @param size_class The class, below SLAB_CLASS_COUNT.
+	 * @param out_stats A pointer to hold the occupancy.
+	 */
+	void GetClassStats(unsigned short size_class, SSlabClassStats* out_stats);
+
+private:
+	SSlab* AcquireSlab(unsigned short size_class);
+	void* GetSlabMemory(const SSlab* slab) const;
+
+private:
+	void* MemoryBlock;
+	size_t TotalSize;
+	size_t SlabCount;
+	SSlab* Slabs;
+
+	// Slabs not given to any class, and the first slab never used at all.
+	Mutex EmptySlabMutex;
+	SSlab* EmptySlabs;
+	size_t UnusedSlabIndex;
+
+	// Slabs with free blocks, per class.
+	Mutex ClassMutexes[SLAB_CLASS_COUNT];
+	SSlab* PartialSlabs[SLAB_CLASS_COUNT];
+	size_t ClassSlabCounts[SLAB_CLASS_COUNT];
+	size_t ClassUsedBlocks[SLAB_CLASS_COUNT];
+};
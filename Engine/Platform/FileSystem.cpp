@@ -149,4 +149,45 @@ bool FileSystemWrite(FileHandle* handle, size_t data_size, void* data, size_t* o
 	}
 
 	return false;
-}
\ No newline at end of file
+}
+
+void FileSystemFreeReadResult(FileReadResult* result) {
+	if (result->data != nullptr) {
+		Memory::Free(result->data, result->size + 1, MemoryType::eMemory_Type_Resource);
+		result->data = nullptr;
+	}
+	result->size = 0;
+	result->success = false;
+}
+
+#if !defined(DPLATFORM_LINUX)
+// No asynchronous backend on this platform yet, reads complete on the calling thread.
+bool FileSystemAsyncInitialize(unsigned int queue_depth) {
+	return false;
+}
+
+void FileSystemAsyncShutdown() {
+
+}
+
+bool FileSystemReadAsync(const char* path, FileReadResult* out_result, PFN_FileReadComplete on_complete, void* context) {
+	FileHandle Handle;
+	if (!FileSystemOpen(path, eFile_Mode_Read, true, &Handle)) {
+		return false;
+	}
+
+	*out_result = FileReadResult();
+	size_t Size = 0;
+	if (FileSystemSize(&Handle, &Size)) {
+		out_result->data = (unsigned char*)Memory::Allocate(Size + 1, MemoryType::eMemory_Type_Resource);
+		out_result->size = Size;
+		size_t BytesRead = 0;
+		out_result->success = Size == 0 || FileSystemRead(&Handle, Size, out_result->data, &BytesRead);
+		out_result->data[Size] = '\0';
+	}
+	FileSystemClose(&Handle);
+
+	on_complete(out_result, context);
+	return true;
+}
+#endif
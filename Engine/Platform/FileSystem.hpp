@@ -95,3 +95,49 @@ DAPI bool FileSystemReadAllText(FileHandle* handle,char* out_text, size_t* out_b
 
 DAPI bool FileSystemWrite(FileHandle* handle, size_t data_size, void* data, size_t* out_bytes_written);
 
+/*
+* The outcome of an asynchronous file read.
+*/
+struct FileReadResult {
+	// The file contents followed by a terminating zero, so text can be parsed in place.
+	// Must be freed with FileSystemFreeReadResult().
+	unsigned char* data = nullptr;
+	// The size of the file, not counting the terminating zero.
+	size_t size = 0;
+	bool success = false;
+};
+
+/*
+* Called once an asynchronous read finished, on the thread reaping I/O completions.
+* Should return quickly, any processing of the data belongs in a job.
+*/
+typedef void(*PFN_FileReadComplete)(FileReadResult* result, void* context);
+
+/*
+* Starts the asynchronous file reads. On Linux they go through io_uring, so many reads can be
+* in flight without occupying a thread each. Elsewhere, or if io_uring is not available,
+* reads block the calling thread instead.
+* @param queue_depth The maximum number of reads in flight. Further reads wait for a free slot.
+* @returns True if reads are asynchronous, false if they fall back to blocking.
+*/
+DAPI bool FileSystemAsyncInitialize(unsigned int queue_depth);
+
+/*
+* Waits for the reads in flight to finish and stops the asynchronous file reads.
+*/
+DAPI void FileSystemAsyncShutdown();
+
+/*
+* Reads a whole file without blocking the calling thread.
+* @param path The path of the file to be read. Only used before the call returns.
+* @param out_result A pointer to a FileReadResult filled in before on_complete is called. Must stay alive until then.
+* @param on_complete Called once the read finished, whether it succeeded or not.
+* @param context Passed on to on_complete.
+* @returns True if the read was started. If not, on_complete is never called.
+*/
+DAPI bool FileSystemReadAsync(const char* path, FileReadResult* out_result, PFN_FileReadComplete on_complete, void* context);
+
+/*
+* Frees the data of a finished asynchronous read.
+*/
+DAPI void FileSystemFreeReadResult(FileReadResult* result);
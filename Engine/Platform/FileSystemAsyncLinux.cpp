@@ -0,0 +1,427 @@
+#include "FileSystem.hpp"
+
+#if defined(DPLATFORM_LINUX)
+
+#include "Core/EngineLogger.hpp"
+#include "Core/DMemory.hpp"
+#include "Core/DMutex.hpp"
+#include "Core/DThread.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+
+// A single read request may not exceed this, larger files are read in several requests.
+#define ASYNC_READ_CHUNK_SIZE (1u << 30)
+
+// The user data of the request which tells the completion thread to stop.
+#define ASYNC_READ_STOP 0
+
+struct AsyncRead {
+	int fd = -1;
+	FileReadResult* result = nullptr;
+	PFN_FileReadComplete on_complete = nullptr;
+	void* context = nullptr;
+	// The number of bytes read so far.
+	size_t offset = 0;
+	// Links reads waiting for a free slot.
+	AsyncRead* next = nullptr;
+};
+
+// The kernel and user space share the rings, the kernel advances the SQ head and CQ tail.
+struct AsyncRing {
+	int fd = -1;
+	unsigned int depth = 0;
+
+	void* sq_ring = nullptr;
+	size_t sq_ring_size = 0;
+	unsigned int* sq_head = nullptr;
+	unsigned int* sq_tail = nullptr;
+	unsigned int* sq_mask = nullptr;
+	unsigned int* sq_array = nullptr;
+	io_uring_sqe* sqes = nullptr;
+	size_t sqes_size = 0;
+
+	void* cq_ring = nullptr;
+	size_t cq_ring_size = 0;
+	unsigned int* cq_head = nullptr;
+	unsigned int* cq_tail = nullptr;
+	unsigned int* cq_mask = nullptr;
+	io_uring_cqe* cqes = nullptr;
+
+	// Guards the submission queue, the reads in flight and the waiting reads.
+	Mutex submit_mutex;
+	unsigned int in_flight = 0;
+	AsyncRead* waiting_head = nullptr;
+	AsyncRead* waiting_tail = nullptr;
+	bool stopping = false;
+
+	Thread completion_thread;
+};
+
+static AsyncRing* Ring = nullptr;
+
+static int RingSetup(unsigned int entries, io_uring_params* params) {
+	return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int RingEnter(int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags) {
+	return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+
+static void DestroyRing(AsyncRing* ring) {
+	if (ring->sqes != nullptr) {
+		munmap(ring->sqes, ring->sqes_size);
+	}
+	if (ring->cq_ring != nullptr && ring->cq_ring != ring->sq_ring) {
+		munmap(ring->cq_ring, ring->cq_ring_size);
+	}
+	if (ring->sq_ring != nullptr) {
+		munmap(ring->sq_ring, ring->sq_ring_size);
+	}
+	if (ring->fd >= 0) {
+		close(ring->fd);
+	}
+	ring->submit_mutex.Destroy();
+	DeleteObject(ring);
+}
+
+// Queues one request, the caller holds the submit mutex. The ring holds a slot more than the depth for the stop request.
+// Returns false if the kernel refused it, the request is then taken back off the queue.
+static bool PushRequest(AsyncRing* ring, uint8_t opcode, int fd, void* buffer, unsigned int length, size_t offset, uint64_t user_data) {
+	unsigned int Tail = *ring->sq_tail;
+	unsigned int Index = Tail & *ring->sq_mask;
+	io_uring_sqe* Sqe = &ring->sqes[Index];
+	memset(Sqe, 0, sizeof(io_uring_sqe));
+	Sqe->opcode = opcode;
+	Sqe->fd = fd;
+	Sqe->addr = (uint64_t)(uintptr_t)buffer;
+	Sqe->len = length;
+	Sqe->off = offset;
+	Sqe->user_data = user_data;
+	ring->sq_array[Index] = Index;
+	__atomic_store_n(ring->sq_tail, Tail + 1, __ATOMIC_RELEASE);
+
+	while (RingEnter(ring->fd, 1, 0, 0) < 0) {
+		if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+			continue;
+		}
+
+		LOG_ERROR("Submitting a file read failed: %s.", strerror(errno));
+		// Requests are only consumed while entering the ring, so a refused one is still queued. Left there,
+		// the next submission would hand it to the kernel along with its own.
+		if (__atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) == Tail) {
+			__atomic_store_n(ring->sq_tail, Tail, __ATOMIC_RELEASE);
+		}
+		return false;
+	}
+
+	return true;
+}
+
+// Returns false if the read could not be submitted, the caller then fails it once it released the submit mutex.
+static bool PushRead(AsyncRing* ring, AsyncRead* read) {
+	size_t Remaining = read->result->size - read->offset;
+	unsigned int Length = Remaining > ASYNC_READ_CHUNK_SIZE ? ASYNC_READ_CHUNK_SIZE : (unsigned int)Remaining;
+	if (!PushRequest(ring, IORING_OP_READ, read->fd, read->result->data + read->offset, Length, read->offset, (uint64_t)(uintptr_t)read)) {
+		return false;
+	}
+
+	ring->in_flight++;
+	return true;
+}
+
+// Submits the read, or parks it until a read in flight finished. The caller holds the submit mutex.
+static bool SubmitRead(AsyncRing* ring, AsyncRead* read) {
+	if (ring->in_flight >= ring->depth) {
+		read->next = nullptr;
+		if (ring->waiting_tail != nullptr) {
+			ring->waiting_tail->next = read;
+		}
+		else {
+			ring->waiting_head = read;
+		}
+		ring->waiting_tail = read;
+		return true;
+	}
+
+	return PushRead(ring, read);
+}
+
+static void FinishRead(AsyncRead* read, bool success) {
+	close(read->fd);
+	read->result->success = success;
+	read->on_complete(read->result, read->context);
+	DeleteObject(read);
+}
+
+// Reads the rest of the file on this thread, for kernels lacking IORING_OP_READ.
+static bool ReadRemaining(AsyncRead* read) {
+	while (read->offset < read->result->size) {
+		ssize_t BytesRead = pread(read->fd, read->result->data + read->offset, read->result->size - read->offset, read->offset);
+		if (BytesRead < 0 && errno == EINTR) {
+			continue;
+		}
+		if (BytesRead <= 0) {
+			return false;
+		}
+		read->offset += (size_t)BytesRead;
+	}
+
+	return true;
+}
+
+// Handles one completed request. Returns the read to submit again if it was short, nullptr otherwise.
+static AsyncRead* CompleteRead(AsyncRead* read, int result) {
+	if (result == -EINTR || result == -EAGAIN) {
+		return read;
+	}
+
+	if (result == -EINVAL || result == -EOPNOTSUPP) {
+		FinishRead(read, ReadRemaining(read));
+		return nullptr;
+	}
+
+	if (result < 0) {
+		LOG_ERROR("Asynchronous file read failed: %s.", strerror(-result));
+		FinishRead(read, false);
+		return nullptr;
+	}
+
+	if (result == 0) {
+		// The file shrank since it was opened.
+		read->result->size = read->offset;
+		read->result->data[read->offset] = '\0';
+		FinishRead(read, true);
+		return nullptr;
+	}
+
+	read->offset += (size_t)result;
+	if (read->offset < read->result->size) {
+		return read;
+	}
+
+	FinishRead(read, true);
+	return nullptr;
+}
+
+static unsigned int RunCompletionThread(void* params) {
+	AsyncRing* RingState = (AsyncRing*)params;
+	Thread::SetCurrentName("FileIO");
+
+	while (true) {
+		int Entered = RingEnter(RingState->fd, 0, 1, IORING_ENTER_GETEVENTS);
+		if (Entered < 0 && errno != EINTR) {
+			LOG_ERROR("Waiting for file reads failed: %s.", strerror(errno));
+		}
+
+		// The kernel advances the tail, this thread is the only one consuming.
+		unsigned int Head = *RingState->cq_head;
+		unsigned int Tail = __atomic_load_n(RingState->cq_tail, __ATOMIC_ACQUIRE);
+		while (Head != Tail) {
+			io_uring_cqe* Cqe = &RingState->cqes[Head & *RingState->cq_mask];
+			uint64_t UserData = Cqe->user_data;
+			int Result = Cqe->res;
+			Head++;
+			// Hand the slot back before running the callback, which may take a while.
+			__atomic_store_n(RingState->cq_head, Head, __ATOMIC_RELEASE);
+
+			if (UserData == ASYNC_READ_STOP) {
+				continue;
+			}
+
+			// Taking the mutex also orders the submitting thread's writes before the read is finished here.
+			RingState->submit_mutex.Lock();
+			RingState->in_flight--;
+			RingState->submit_mutex.UnLock();
+
+			AsyncRead* Retry = CompleteRead((AsyncRead*)(uintptr_t)UserData, Result);
+			if (Retry != nullptr) {
+				RingState->submit_mutex.Lock();
+				bool Pushed = PushRead(RingState, Retry);
+				RingState->submit_mutex.UnLock();
+				if (!Pushed) {
+					FinishRead(Retry, false);
+				}
+			}
+		}
+
+		// Reads the kernel refused are failed once the mutex is released, their callbacks may submit reads.
+		AsyncRead* Failed = nullptr;
+		RingState->submit_mutex.Lock();
+		while (RingState->waiting_head != nullptr && RingState->in_flight < RingState->depth) {
+			AsyncRead* Read = RingState->waiting_head;
+			RingState->waiting_head = Read->next;
+			if (RingState->waiting_head == nullptr) {
+				RingState->waiting_tail = nullptr;
+			}
+			if (!PushRead(RingState, Read)) {
+				Read->next = Failed;
+				Failed = Read;
+			}
+		}
+		bool Done = RingState->stopping && RingState->in_flight == 0 && RingState->waiting_head == nullptr;
+		RingState->submit_mutex.UnLock();
+
+		while (Failed != nullptr) {
+			AsyncRead* Next = Failed->next;
+			FinishRead(Failed, false);
+			Failed = Next;
+		}
+
+		if (Done) {
+			break;
+		}
+	}
+
+	return 0;
+}
+
+bool FileSystemAsyncInitialize(unsigned int queue_depth) {
+	if (Ring != nullptr) {
+		return true;
+	}
+
+	AsyncRing* NewRing = NewObject<AsyncRing>();
+	NewRing->depth = queue_depth > 0 ? queue_depth : 1;
+	if (!NewRing->submit_mutex.Create()) {
+		DeleteObject(NewRing);
+		return false;
+	}
+
+	io_uring_params Params;
+	memset(&Params, 0, sizeof(Params));
+	NewRing->fd = RingSetup(NewRing->depth + 1, &Params);
+	if (NewRing->fd < 0) {
+		LOG_WARN("io_uring is not available (%s), file reads will block.", strerror(errno));
+		DestroyRing(NewRing);
+		return false;
+	}
+
+	NewRing->sq_ring_size = Params.sq_off.array + Params.sq_entries * sizeof(unsigned int);
+	NewRing->cq_ring_size = Params.cq_off.cqes + Params.cq_entries * sizeof(io_uring_cqe);
+	bool SingleMap = (Params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (SingleMap) {
+		NewRing->sq_ring_size = NewRing->cq_ring_size = DMAX(NewRing->sq_ring_size, NewRing->cq_ring_size);
+	}
+
+	void* SqRing = mmap(nullptr, NewRing->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, NewRing->fd, IORING_OFF_SQ_RING);
+	if (SqRing == MAP_FAILED) {
+		LOG_WARN("Failed to map the io_uring submission queue, file reads will block.");
+		DestroyRing(NewRing);
+		return false;
+	}
+	NewRing->sq_ring = SqRing;
+
+	void* CqRing = SqRing;
+	if (!SingleMap) {
+		CqRing = mmap(nullptr, NewRing->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, NewRing->fd, IORING_OFF_CQ_RING);
+		if (CqRing == MAP_FAILED) {
+			LOG_WARN("Failed to map the io_uring completion queue, file reads will block.");
+			DestroyRing(NewRing);
+			return false;
+		}
+	}
+	NewRing->cq_ring = CqRing;
+
+	NewRing->sqes_size = Params.sq_entries * sizeof(io_uring_sqe);
+	void* Sqes = mmap(nullptr, NewRing->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, NewRing->fd, IORING_OFF_SQES);
+	if (Sqes == MAP_FAILED) {
+		LOG_WARN("Failed to map the io_uring submission entries, file reads will block.");
+		DestroyRing(NewRing);
+		return false;
+	}
+	NewRing->sqes = (io_uring_sqe*)Sqes;
+
+	char* Sq = (char*)SqRing;
+	NewRing->sq_head = (unsigned int*)(Sq + Params.sq_off.head);
+	NewRing->sq_tail = (unsigned int*)(Sq + Params.sq_off.tail);
+	NewRing->sq_mask = (unsigned int*)(Sq + Params.sq_off.ring_mask);
+	NewRing->sq_array = (unsigned int*)(Sq + Params.sq_off.array);
+	char* Cq = (char*)CqRing;
+	NewRing->cq_head = (unsigned int*)(Cq + Params.cq_off.head);
+	NewRing->cq_tail = (unsigned int*)(Cq + Params.cq_off.tail);
+	NewRing->cq_mask = (unsigned int*)(Cq + Params.cq_off.ring_mask);
+	NewRing->cqes = (io_uring_cqe*)(Cq + Params.cq_off.cqes);
+
+	if (!NewRing->completion_thread.Create(RunCompletionThread, NewRing, false)) {
+		LOG_WARN("Failed to create the file read thread, file reads will block.");
+		DestroyRing(NewRing);
+		return false;
+	}
+
+	Ring = NewRing;
+	LOG_INFO("Asynchronous file reads use io_uring with %u reads in flight.", NewRing->depth);
+	return true;
+}
+
+void FileSystemAsyncShutdown() {
+	if (Ring == nullptr) {
+		return;
+	}
+
+	// The completion thread leaves once the stop request came back and every read finished.
+	Ring->submit_mutex.Lock();
+	Ring->stopping = true;
+	// Refused only if the ring is broken, then the thread's own waits fail too and it sees the stop flag anyway.
+	PushRequest(Ring, IORING_OP_NOP, -1, nullptr, 0, 0, ASYNC_READ_STOP);
+	Ring->submit_mutex.UnLock();
+
+	// The thread reads the rings until it returns, only then may they be unmapped.
+	Ring->completion_thread.Join();
+	DestroyRing(Ring);
+	Ring = nullptr;
+}
+
+bool FileSystemReadAsync(const char* path, FileReadResult* out_result, PFN_FileReadComplete on_complete, void* context) {
+	// Opening rarely blocks for long, only the read itself goes through the ring.
+	int Fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (Fd < 0) {
+		LOG_ERROR("Failed to open file '%s' for an asynchronous read.", path);
+		return false;
+	}
+
+	struct stat Stat;
+	if (fstat(Fd, &Stat) != 0) {
+		LOG_ERROR("Failed to read the size of file '%s'.", path);
+		close(Fd);
+		return false;
+	}
+
+	*out_result = FileReadResult();
+	out_result->size = (size_t)Stat.st_size;
+	out_result->data = (unsigned char*)Memory::Allocate(out_result->size + 1, MemoryType::eMemory_Type_Resource);
+	if (out_result->data == nullptr) {
+		LOG_ERROR("Failed to allocate %llu bytes to read file '%s'.", (unsigned long long)out_result->size + 1, path);
+		out_result->size = 0;
+		close(Fd);
+		return false;
+	}
+	out_result->data[out_result->size] = '\0';
+
+	AsyncRead* Read = NewObject<AsyncRead>();
+	Read->fd = Fd;
+	Read->result = out_result;
+	Read->on_complete = on_complete;
+	Read->context = context;
+
+	if (Ring == nullptr || out_result->size == 0) {
+		FinishRead(Read, ReadRemaining(Read));
+		return true;
+	}
+
+	Ring->submit_mutex.Lock();
+	bool Submitted = SubmitRead(Ring, Read);
+	Ring->submit_mutex.UnLock();
+	if (!Submitted) {
+		FinishRead(Read, false);
+	}
+	return true;
+}
+
+#endif
@@ -6,6 +6,21 @@ struct SPlatformState{
 	void* internalState = nullptr;
 };
 
+// Affinity masks hold one bit per logical processor, so only the first 64 can be told apart.
+#define MAX_PROCESSOR_CORES 64
+
+/**
+ * @brief Describes how the logical processors the process may run on map to physical cores.
+ */
+struct SProcessorTopology {
+	// Every hardware thread counts as one logical processor.
+	int logical_count = 0;
+	// Hardware threads of one core share its execution units.
+	int core_count = 0;
+	// The logical processors of each core, one bit each. All zero if the platform does not tell.
+	uint64_t core_masks[MAX_PROCESSOR_CORES] = {};
+};
+
 class DAPI Platform {
 public:
 	Platform() {};
@@ -20,6 +35,42 @@ public:
 	static void* PlatformAllocate(size_t size, bool aligned);
 	static void PlatformFree(void* block, bool aligned);
 
+	static size_t PlatformGetPageSize();
+
+	/**
+	 * @brief Reserves a range of address space without backing it by memory. Parts of it are committed before use.
+	 * @param size The size in bytes, a multiple of PlatformGetPageSize().
+	 * @returns The start of the range, or nullptr on failure.
+	 */
+	static void* PlatformReserveMemory(size_t size);
+
+	/**
+	 * @brief Backs part of a reserved range by memory, which reads as zero.
+	 * @param huge_pages Asks for huge pages where the OS hands them out for such memory, the block and size should then be
+	 * multiples of 2MiB. Regular pages are used otherwise.
+	 * @returns True on success.
+	 */
+	static bool PlatformCommitMemory(void* block, size_t size, bool huge_pages);
+
+	/**
+	 * @brief Returns a range from PlatformReserveMemory() to the OS, committed or not.
+	 * @param size The size passed to PlatformReserveMemory().
+	 */
+	static void PlatformReleaseMemory(void* block, size_t size);
+
+	/**
+	 * @brief Obtains the physical memory the process occupies right now, its resident set.
+	 * @returns The size in bytes, or 0 if the platform does not tell.
+	 */
+	static size_t PlatformGetResidentMemory();
+
+	/**
+	 * @brief Looks up the function containing a code address, for diagnostics.
+	 * @param out_name Receives the name, with the offset into the function.
+	 * @returns False if no symbol is known for the address.
+	 */
+	static bool PlatformGetSymbolName(const void* address, char* out_name, size_t length);
+
 	static void* PlatformZeroMemory(void* block, size_t size);
 	static void* PlatformCopyMemory(void* dst, const void* src, size_t size);
 	static void* PlatformSetMemory(void* dst, int val, size_t size);
@@ -32,5 +83,13 @@ public:
 	static void PlatformSleep(size_t ms);
 
 	static int GetProcessorCount();
+
+	/**
+	 * @brief Queries the physical cores and their logical processors. Falls back to one core per
+	 * logical processor, without masks, where the platform does not tell.
+	 * @param out_topology Filled with the topology.
+	 * @returns True if the core layout is known.
+	 */
+	static bool GetProcessorTopology(SProcessorTopology* out_topology);
 };
 
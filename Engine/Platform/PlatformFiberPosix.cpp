@@ -0,0 +1,108 @@
+// NOTE: ucontext is deprecated on macOS and only declared correctly when the X/Open API is
+// requested before any system header is included, otherwise ucontext_t is too small.
+#if defined(__APPLE__)
+#define _XOPEN_SOURCE 600
+#define _DARWIN_C_SOURCE
+#endif
+
+#include "Platform.hpp"
+
+#if defined(DPLATFORM_MACOS) || defined(DPLATFORM_LINUX)
+
+#include "Core/DFiber.hpp"
+#include "Core/EngineLogger.hpp"
+
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+struct PosixFiber {
+	ucontext_t context;
+	PFN_fiber_start start_func;
+	void* params;
+	// The mapping holding the stack, including the guard page below it.
+	void* mapping;
+	size_t mapping_size;
+};
+
+// makecontext only passes int arguments, so the pointer is passed in two halves.
+static void PosixFiberProc(unsigned int low, unsigned int high) {
+	PosixFiber* Fib = (PosixFiber*)(uintptr_t)(((uint64_t)high << 32) | (uint64_t)low);
+	Fib->start_func(Fib->params);
+
+	// There is no context to return to.
+	LOG_FATAL("Fiber returned from its start function.");
+	abort();
+}
+
+bool Fiber::Create(PFN_fiber_start start_func, void* params, size_t stack_size) {
+	size_t PageSize = (size_t)sysconf(_SC_PAGESIZE);
+	stack_size = (stack_size + PageSize - 1) & ~(PageSize - 1);
+
+	PosixFiber* Fib = (PosixFiber*)Platform::PlatformAllocate(sizeof(PosixFiber), false);
+	Platform::PlatformZeroMemory(Fib, sizeof(PosixFiber));
+	Fib->start_func = start_func;
+	Fib->params = params;
+
+	// Stack pages are only committed once touched. The lowest page is a guard page, so an
+	// overflow crashes right away instead of corrupting memory.
+	Fib->mapping_size = stack_size + PageSize;
+	Fib->mapping = mmap(nullptr, Fib->mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+	if (Fib->mapping == MAP_FAILED) {
+		LOG_ERROR("Unable to allocate fiber stack.");
+		Fib->mapping = nullptr;
+		Platform::PlatformFree(Fib, false);
+		return false;
+	}
+	mprotect(Fib->mapping, PageSize, PROT_NONE);
+
+	if (getcontext(&Fib->context) != 0) {
+		LOG_ERROR("Unable to create fiber context.");
+		munmap(Fib->mapping, Fib->mapping_size);
+		Platform::PlatformFree(Fib, false);
+		return false;
+	}
+
+	Fib->context.uc_stack.ss_sp = (char*)Fib->mapping + PageSize;
+	Fib->context.uc_stack.ss_size = stack_size;
+	Fib->context.uc_link = nullptr;
+	uint64_t Address = (uint64_t)(uintptr_t)Fib;
+	makecontext(&Fib->context, (void(*)())PosixFiberProc, 2, (unsigned int)(Address & 0xFFFFFFFF), (unsigned int)(Address >> 32));
+
+	InternalData = Fib;
+	return true;
+}
+
+bool Fiber::CreateFromThread() {
+	// The context is filled in by the first switch away from the thread.
+	PosixFiber* Fib = (PosixFiber*)Platform::PlatformAllocate(sizeof(PosixFiber), false);
+	Platform::PlatformZeroMemory(Fib, sizeof(PosixFiber));
+	InternalData = Fib;
+	return true;
+}
+
+void Fiber::Destroy() {
+	if (InternalData == nullptr) {
+		return;
+	}
+
+	PosixFiber* Fib = (PosixFiber*)InternalData;
+	if (Fib->mapping != nullptr) {
+		munmap(Fib->mapping, Fib->mapping_size);
+	}
+
+	Platform::PlatformFree(Fib, false);
+	InternalData = nullptr;
+}
+
+bool Fiber::Switch(Fiber* from, Fiber* to) {
+	if (from == nullptr || from->InternalData == nullptr || to == nullptr || to->InternalData == nullptr) {
+		return false;
+	}
+
+	return swapcontext(&((PosixFiber*)from->InternalData)->context, &((PosixFiber*)to->InternalData)->context) == 0;
+}
+
+#endif
@@ -6,10 +6,12 @@
 #include "Core/Event.hpp"
 #include "Core/DThread.hpp"
 #include "Core/DMutex.hpp"
+#include "Core/DSemaphore.hpp"
 #include "Renderer/Vulkan/VulkanPlatform.hpp"
 #include "Renderer/Vulkan/VulkanContext.hpp"
 
 #include <mach/mach_time.h>
+#include <mach/mach.h>
 #include <crt_externs.h>
 
 #import <Foundation/Foundation.h>
@@ -18,6 +20,9 @@
 
 #include <pthread.h>
 #include <errno.h>	// For error reporting
+#include <sys/mman.h>
+#include <unistd.h>
+#include <dlfcn.h>
 
 // For surface creation
 #define VK_USE_PLATFORM_METAL_EXT
@@ -474,6 +479,44 @@ void Platform::PlatformFree(void* block, bool aligned){
 	free(block);
 }
 
+size_t Platform::PlatformGetPageSize() {
+	return (size_t)sysconf(_SC_PAGESIZE);
+}
+
+void* Platform::PlatformReserveMemory(size_t size) {
+	void* Block = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANON, -1, 0);
+	return Block != MAP_FAILED ? Block : nullptr;
+}
+
+bool Platform::PlatformCommitMemory(void* block, size_t size, bool huge_pages) {
+	// Superpages can only be asked for when mapping, not for part of a reserved range.
+	return mprotect(block, size, PROT_READ | PROT_WRITE) == 0;
+}
+
+void Platform::PlatformReleaseMemory(void* block, size_t size) {
+	munmap(block, size);
+}
+
+size_t Platform::PlatformGetResidentMemory() {
+	mach_task_basic_info_data_t Info;
+	mach_msg_type_number_t Count = MACH_TASK_BASIC_INFO_COUNT;
+	if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&Info, &Count) != KERN_SUCCESS) {
+		return 0;
+	}
+
+	return (size_t)Info.resident_size;
+}
+
+bool Platform::PlatformGetSymbolName(const void* address, char* out_name, size_t length) {
+	Dl_info Info;
+	if (dladdr(address, &Info) == 0 || Info.dli_sname == nullptr) {
+		return false;
+	}
+
+	snprintf(out_name, length, "%s+%#llx", Info.dli_sname, (unsigned long long)((size_t)address - (size_t)Info.dli_saddr));
+	return true;
+}
+
 void* Platform::PlatformZeroMemory(void* block, size_t size) {
 	return memset(block, 0, size);
 }
@@ -526,6 +569,26 @@ int Platform::GetProcessorCount(){
 	return (int)[[NSProcessInfo processInfo]processorCount];
 }
 
+bool Platform::GetProcessorTopology(SProcessorTopology* out_topology){
+	*out_topology = SProcessorTopology();
+	out_topology->logical_count = GetProcessorCount();
+
+	// Only count the performance cores on Apple silicon, efficiency cores are too slow for frame work.
+	int Cores = 0;
+	size_t Size = sizeof(Cores);
+	if (sysctlbyname("hw.perflevel0.physicalcpu", &Cores, &Size, nullptr, 0) != 0 || Cores <= 0) {
+		Size = sizeof(Cores);
+		if (sysctlbyname("hw.physicalcpu", &Cores, &Size, nullptr, 0) != 0 || Cores <= 0) {
+			out_topology->core_count = out_topology->logical_count;
+			return false;
+		}
+	}
+
+	// NOTE: macOS does not expose which logical processor belongs to which core, and does not support pinning either.
+	out_topology->core_count = DMIN(Cores, MAX_PROCESSOR_CORES);
+	return true;
+}
+
 // Vulkan
 bool PlatformCreateVulkanSurface(SPlatformState* plat_state, VulkanContext* context) {
 	// Simple cold-cast to then know type
@@ -608,6 +671,21 @@ void Thread::Destroy() {
 	Cancel();
 }
 
+bool Thread::Join() {
+	if (InternalData == nullptr) {
+		return false;
+	}
+
+	int Result = pthread_join((pthread_t)ThreadID, nullptr);
+	if (Result != 0) {
+		LOG_ERROR("Failed to join thread %#x: errno=%i", ThreadID, Result);
+	}
+	Platform::PlatformFree(InternalData, false);
+	InternalData = nullptr;
+	ThreadID = 0;
+	return Result == 0;
+}
+
 void Thread::Detach() {
 	if (InternalData == nullptr) {
 		return;
@@ -668,6 +746,15 @@ size_t Thread::GetThreadID() {
 
 	return (size_t)pthread_self();
 }
+
+bool Thread::SetCurrentAffinity(uint64_t processor_mask) {
+	// Threads cannot be pinned on macOS, the scheduler decides.
+	return false;
+}
+
+void Thread::SetCurrentName(const char* name) {
+	pthread_setname_np(name);
+}
 // NOTE: End Threads
 
 // NOTE: Begin mutexs
@@ -772,6 +859,53 @@ bool Mutex::UnLock() {
 
 // NOTE: End mutexs.
 
+// NOTE: Begin semaphores
+bool Semaphore::Create(uint32_t max_count, uint32_t start_count) {
+	// NOTE: Dispatch semaphores have no upper bound, so max_count is ignored here.
+	dispatch_semaphore_t Sem = dispatch_semaphore_create((long)start_count);
+	if (Sem == nullptr) {
+		LOG_ERROR("Semaphore creation failure!");
+		return false;
+	}
+
+	InternalData = (void*)Sem;
+	return true;
+}
+
+void Semaphore::Destroy() {
+	if (InternalData == nullptr) {
+		return;
+	}
+
+	dispatch_release((dispatch_semaphore_t)InternalData);
+	InternalData = nullptr;
+}
+
+bool Semaphore::Signal() {
+	if (InternalData == nullptr) {
+		return false;
+	}
+
+	dispatch_semaphore_signal((dispatch_semaphore_t)InternalData);
+	return true;
+}
+
+bool Semaphore::Wait(uint32_t timeout_ms) {
+	if (InternalData == nullptr) {
+		return false;
+	}
+
+	dispatch_time_t Timeout = DISPATCH_TIME_FOREVER;
+	if (timeout_ms != INVALID_ID) {
+		Timeout = dispatch_time(DISPATCH_TIME_NOW, (int64_t)timeout_ms * NSEC_PER_MSEC);
+	}
+
+	// Returns non-zero if the timeout occurred.
+	return dispatch_semaphore_wait((dispatch_semaphore_t)InternalData, Timeout) == 0;
+}
+
+// NOTE: End semaphores.
+
 enum class eKeys TranslateKeyCode(uint32_t ns_keycode) {
 	// https://boredzo.org/blog/wp-content/uploads/2007/05/IMTx-virtual-keycodes.pdf
 	// https://learn.microsoft.com/en-us/windows/win32/inputdev/virtual-key-codes
@@ -0,0 +1,80 @@
+// NOTE: MAP_HUGETLB and MADV_HUGEPAGE are Linux extensions.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "Platform.hpp"
+
+#if defined(DPLATFORM_LINUX)
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <stdio.h>
+
+// The size of the huge pages asked for, the default on x86-64 and most arm64 kernels.
+#define LINUX_HUGE_PAGE_SIZE MEBIBYTES(2)
+
+size_t Platform::PlatformGetPageSize() {
+	return (size_t)sysconf(_SC_PAGESIZE);
+}
+
+void* Platform::PlatformReserveMemory(size_t size) {
+	// Reserve a huge page more and trim both ends, so the range starts on a huge page boundary.
+	size_t ReservedSize = size + LINUX_HUGE_PAGE_SIZE;
+	void* Reserved = mmap(nullptr, ReservedSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (Reserved == MAP_FAILED) {
+		return nullptr;
+	}
+
+	size_t Start = PaddingAligned((size_t)Reserved, LINUX_HUGE_PAGE_SIZE);
+	size_t Head = Start - (size_t)Reserved;
+	if (Head > 0) {
+		munmap(Reserved, Head);
+	}
+	size_t Tail = ReservedSize - Head - size;
+	if (Tail > 0) {
+		munmap((void*)(Start + size), Tail);
+	}
+	return (void*)Start;
+}
+
+bool Platform::PlatformCommitMemory(void* block, size_t size, bool huge_pages) {
+	bool HugeAligned = ((size_t)block % LINUX_HUGE_PAGE_SIZE) == 0 && (size % LINUX_HUGE_PAGE_SIZE) == 0;
+	if (huge_pages && HugeAligned) {
+		// Explicit huge pages, if the administrator set some aside. Regular pages are mapped over the range otherwise.
+		void* Huge = mmap(block, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_HUGETLB, -1, 0);
+		if (Huge != MAP_FAILED) {
+			return true;
+		}
+	}
+
+	void* Block = mmap(block, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+	if (Block == MAP_FAILED) {
+		return false;
+	}
+
+	if (huge_pages && HugeAligned) {
+		// Otherwise transparent huge pages, the kernel backs the range by them as it can. Only a hint, failing is fine.
+		madvise(block, size, MADV_HUGEPAGE);
+	}
+	return true;
+}
+
+void Platform::PlatformReleaseMemory(void* block, size_t size) {
+	munmap(block, size);
+}
+
+size_t Platform::PlatformGetResidentMemory() {
+	// The second field is the resident set, in pages.
+	FILE* File = fopen("/proc/self/statm", "r");
+	if (File == nullptr) {
+		return 0;
+	}
+
+	unsigned long long Size = 0, Resident = 0;
+	int Read = fscanf(File, "%llu %llu", &Size, &Resident);
+	fclose(File);
+	return Read == 2 ? (size_t)Resident * PlatformGetPageSize() : 0;
+}
+
+#endif
@@ -0,0 +1,266 @@
+// NOTE: pthread_setaffinity_np and pthread_setname_np are GNU extensions.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "Platform.hpp"
+
+#if defined(DPLATFORM_LINUX)
+
+#include "Core/DThread.hpp"
+#include "Core/DMutex.hpp"
+#include "Core/EngineLogger.hpp"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Reads a single integer from a sysfs file.
+static bool ReadTopologyValue(int cpu, const char* file, int* out_value) {
+	char Path[128];
+	snprintf(Path, sizeof(Path), "/sys/devices/system/cpu/cpu%i/topology/%s", cpu, file);
+	FILE* File = fopen(Path, "r");
+	if (File == nullptr) {
+		return false;
+	}
+
+	bool Result = fscanf(File, "%i", out_value) == 1;
+	fclose(File);
+	return Result;
+}
+
+bool Platform::GetProcessorTopology(SProcessorTopology* out_topology) {
+	*out_topology = SProcessorTopology();
+
+	// Only the processors this process may run on count, containers and taskset restrict them.
+	cpu_set_t Allowed;
+	CPU_ZERO(&Allowed);
+	if (sched_getaffinity(0, sizeof(Allowed), &Allowed) != 0) {
+		out_topology->logical_count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+		out_topology->core_count = out_topology->logical_count;
+		return false;
+	}
+
+	// Hardware threads reporting the same package and core id share a core.
+	int CorePackages[MAX_PROCESSOR_CORES];
+	int CoreIDs[MAX_PROCESSOR_CORES];
+	bool Known = true;
+	for (int Cpu = 0; Cpu < MAX_PROCESSOR_CORES; ++Cpu) {
+		if (!CPU_ISSET(Cpu, &Allowed)) {
+			continue;
+		}
+
+		out_topology->logical_count++;
+		int Package = 0;
+		int CoreID = Cpu;
+		if (!ReadTopologyValue(Cpu, "physical_package_id", &Package) || !ReadTopologyValue(Cpu, "core_id", &CoreID)) {
+			// Without sysfs every logical processor is taken for a core of its own.
+			Known = false;
+			Package = -1;
+			CoreID = Cpu;
+		}
+
+		int Core = 0;
+		while (Core < out_topology->core_count && (CorePackages[Core] != Package || CoreIDs[Core] != CoreID)) {
+			Core++;
+		}
+		if (Core == out_topology->core_count) {
+			CorePackages[Core] = Package;
+			CoreIDs[Core] = CoreID;
+			out_topology->core_count++;
+		}
+		out_topology->core_masks[Core] |= 1ull << Cpu;
+	}
+
+	if (out_topology->core_count == 0) {
+		out_topology->logical_count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+		out_topology->core_count = out_topology->logical_count;
+		return false;
+	}
+
+	return Known;
+}
+
+// NOTE: Begin Threads
+// InternalData holds the pthread handle while the thread is joinable, and stays null for detached threads.
+bool Thread::Create(PFN_thread_start start_func, void* params, bool auto_detach) {
+	if (!start_func) {
+		return false;
+	}
+
+	// pthread_create uses a function pointer that returns void*, so cold-cast to this type.
+	pthread_t Handle;
+	int Result = pthread_create(&Handle, nullptr, (void* (*)(void*))start_func, params);
+	if (Result != 0) {
+		LOG_ERROR("Failed to create thread: errno=%i", Result);
+		return false;
+	}
+	ThreadID = (size_t)Handle;
+	LOG_DEBUG("Starting process on thread id: %#x", ThreadID);
+
+	if (auto_detach) {
+		pthread_detach(Handle);
+		return true;
+	}
+
+	InternalData = malloc(sizeof(pthread_t));
+	*(pthread_t*)InternalData = Handle;
+	return true;
+}
+
+void Thread::Destroy() {
+	if (InternalData == nullptr) {
+		return;
+	}
+
+	Cancel();
+}
+
+bool Thread::Join() {
+	if (InternalData == nullptr) {
+		return false;
+	}
+
+	int Result = pthread_join(*(pthread_t*)InternalData, nullptr);
+	if (Result != 0) {
+		LOG_ERROR("Failed to join thread %#x: errno=%i", ThreadID, Result);
+	}
+	free(InternalData);
+	InternalData = nullptr;
+	ThreadID = 0;
+	return Result == 0;
+}
+
+void Thread::Detach() {
+	if (InternalData == nullptr) {
+		return;
+	}
+
+	int Result = pthread_detach(*(pthread_t*)InternalData);
+	if (Result != 0) {
+		LOG_ERROR("Failed to detach thread %#x: errno=%i", ThreadID, Result);
+	}
+	free(InternalData);
+	InternalData = nullptr;
+}
+
+void Thread::Cancel() {
+	if (InternalData == nullptr) {
+		return;
+	}
+
+	// The handle is released right away, so the thread cleans up after itself once the cancel takes effect.
+	pthread_t Handle = *(pthread_t*)InternalData;
+	int Result = pthread_cancel(Handle);
+	if (Result != 0) {
+		LOG_ERROR("Failed to cancel thread %#x: errno=%i", ThreadID, Result);
+	}
+	pthread_detach(Handle);
+	free(InternalData);
+	InternalData = nullptr;
+	ThreadID = 0;
+}
+
+bool Thread::IsActive() const {
+	return InternalData != nullptr;
+}
+
+void Thread::Sleep(size_t ms) {
+	timespec Time;
+	Time.tv_sec = ms / 1000;
+	Time.tv_nsec = (ms % 1000) * 1000 * 1000;
+	while (nanosleep(&Time, &Time) != 0 && errno == EINTR) {
+	}
+}
+
+size_t Thread::GetThreadID() {
+	return (size_t)pthread_self();
+}
+
+bool Thread::SetCurrentAffinity(uint64_t processor_mask) {
+	cpu_set_t Set;
+	CPU_ZERO(&Set);
+	for (int Cpu = 0; Cpu < MAX_PROCESSOR_CORES; ++Cpu) {
+		if ((processor_mask & (1ull << Cpu)) != 0) {
+			CPU_SET(Cpu, &Set);
+		}
+	}
+
+	return pthread_setaffinity_np(pthread_self(), sizeof(Set), &Set) == 0;
+}
+
+void Thread::SetCurrentName(const char* name) {
+	// Linux thread names hold 15 characters at most.
+	char ShortName[16];
+	strncpy(ShortName, name, sizeof(ShortName) - 1);
+	ShortName[sizeof(ShortName) - 1] = '\0';
+	pthread_setname_np(pthread_self(), ShortName);
+}
+// NOTE: End Threads
+
+// NOTE: Begin mutexs
+bool Mutex::Create() {
+	pthread_mutexattr_t MutexAttr;
+	pthread_mutexattr_init(&MutexAttr);
+	pthread_mutexattr_settype(&MutexAttr, PTHREAD_MUTEX_RECURSIVE);
+
+	// The mutex is initialized where it stays, pthread mutexes may not be copied.
+	pthread_mutex_t* Handle = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t));
+	int Result = pthread_mutex_init(Handle, &MutexAttr);
+	pthread_mutexattr_destroy(&MutexAttr);
+	if (Result != 0) {
+		LOG_ERROR("Mutex creation failure! errno=%i", Result);
+		free(Handle);
+		return false;
+	}
+
+	InternalData = Handle;
+	return true;
+}
+
+void Mutex::Destroy() {
+	if (InternalData == nullptr) {
+		return;
+	}
+
+	int Result = pthread_mutex_destroy((pthread_mutex_t*)InternalData);
+	if (Result != 0) {
+		LOG_ERROR("Unable to destroy mutex: errno=%i", Result);
+	}
+	free(InternalData);
+	InternalData = nullptr;
+}
+
+bool Mutex::Lock() {
+	if (InternalData == nullptr) {
+		return false;
+	}
+
+	int Result = pthread_mutex_lock((pthread_mutex_t*)InternalData);
+	if (Result != 0) {
+		LOG_ERROR("Unable to obtain mutex lock: errno=%i", Result);
+		return false;
+	}
+	return true;
+}
+
+bool Mutex::UnLock() {
+	if (InternalData == nullptr) {
+		return false;
+	}
+
+	int Result = pthread_mutex_unlock((pthread_mutex_t*)InternalData);
+	if (Result != 0) {
+		LOG_ERROR("Unable to release mutex lock: errno=%i", Result);
+		return false;
+	}
+	return true;
+}
+// NOTE: End mutexs
+
+#endif
@@ -6,11 +6,15 @@
 #include "Core/Event.hpp"
 #include "Core/DThread.hpp"
 #include "Core/DMutex.hpp"
+#include "Core/DSemaphore.hpp"
+#include "Core/DFiber.hpp"
 #include "Renderer/Vulkan/VulkanPlatform.hpp"
 #include "Renderer/Vulkan/VulkanContext.hpp"
 
 #include <windows.h>
 #include <windowsx.h>
+#include <dbghelp.h>
+#include <psapi.h>
 #include <vulkan/vulkan_win32.h>
 
 struct SInternalState {
@@ -131,6 +135,60 @@ void Platform::PlatformFree(void* block, bool aligned) {
 	free(block);
 }
 
+size_t Platform::PlatformGetPageSize() {
+	SYSTEM_INFO Info;
+	GetSystemInfo(&Info);
+	return (size_t)Info.dwPageSize;
+}
+
+void* Platform::PlatformReserveMemory(size_t size) {
+	return VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+bool Platform::PlatformCommitMemory(void* block, size_t size, bool huge_pages) {
+	// Large pages need a privilege and can't be committed into a reserved range, regular pages it is.
+	return VirtualAlloc(block, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+}
+
+void Platform::PlatformReleaseMemory(void* block, size_t size) {
+	VirtualFree(block, 0, MEM_RELEASE);
+}
+
+size_t Platform::PlatformGetResidentMemory() {
+	PROCESS_MEMORY_COUNTERS Counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters))) {
+		return 0;
+	}
+
+	return (size_t)Counters.WorkingSetSize;
+}
+
+bool Platform::PlatformGetSymbolName(const void* address, char* out_name, size_t length) {
+	// DbgHelp is single threaded.
+	static SRWLOCK SymbolLock = SRWLOCK_INIT;
+	static bool SymbolsLoaded = SymInitialize(GetCurrentProcess(), nullptr, TRUE) == TRUE;
+	if (!SymbolsLoaded) {
+		return false;
+	}
+
+	char Buffer[sizeof(SYMBOL_INFO) + MAX_SYM_NAME];
+	SYMBOL_INFO* Symbol = (SYMBOL_INFO*)Buffer;
+	memset(Symbol, 0, sizeof(SYMBOL_INFO));
+	Symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+	Symbol->MaxNameLen = MAX_SYM_NAME;
+
+	DWORD64 Displacement = 0;
+	AcquireSRWLockExclusive(&SymbolLock);
+	bool Found = SymFromAddr(GetCurrentProcess(), (DWORD64)address, &Displacement, Symbol) == TRUE;
+	ReleaseSRWLockExclusive(&SymbolLock);
+	if (!Found) {
+		return false;
+	}
+
+	snprintf(out_name, length, "%s+%#llx", Symbol->Name, (unsigned long long)Displacement);
+	return true;
+}
+
 void* Platform::PlatformZeroMemory(void* block, size_t size) {
 	return memset(block, 0, size);
 }
@@ -182,6 +240,38 @@ int Platform::GetProcessorCount() {
 	return SystemInfo.dwNumberOfProcessors;
 }
 
+bool Platform::GetProcessorTopology(SProcessorTopology* out_topology) {
+	*out_topology = SProcessorTopology();
+
+	// Only processor group 0 is looked at, affinity masks cannot address the others.
+	DWORD_PTR ProcessMask = 0;
+	DWORD_PTR SystemMask = 0;
+	GetProcessAffinityMask(GetCurrentProcess(), &ProcessMask, &SystemMask);
+
+	DWORD Length = 0;
+	GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &Length);
+	unsigned char* Buffer = (unsigned char*)Platform::PlatformAllocate(Length, false);
+	if (Buffer == nullptr || !GetLogicalProcessorInformationEx(RelationProcessorCore, (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)Buffer, &Length)) {
+		Platform::PlatformFree(Buffer, false);
+		out_topology->logical_count = GetProcessorCount();
+		out_topology->core_count = out_topology->logical_count;
+		return false;
+	}
+
+	for (DWORD Offset = 0; Offset < Length;) {
+		PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX Info = (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)(Buffer + Offset);
+		uint64_t CoreMask = Info->Processor.GroupMask[0].Group == 0 ? (uint64_t)(Info->Processor.GroupMask[0].Mask & ProcessMask) : 0;
+		if (CoreMask != 0 && out_topology->core_count < MAX_PROCESSOR_CORES) {
+			out_topology->core_masks[out_topology->core_count++] = CoreMask;
+			out_topology->logical_count += (int)__popcnt64(CoreMask);
+		}
+		Offset += Info->Size;
+	}
+
+	Platform::PlatformFree(Buffer, false);
+	return out_topology->core_count > 0;
+}
+
 // NOTE: Begin Threads
 bool Thread::Create(PFN_thread_start start_func, void* params, bool auto_detach) {
 	if (!start_func) {
@@ -220,6 +310,18 @@ void Thread::Destroy() {
 	}
 }
 
+bool Thread::Join() {
+	if (InternalData == nullptr) {
+		return false;
+	}
+
+	bool Result = WaitForSingleObject((HANDLE)InternalData, INFINITE) == WAIT_OBJECT_0;
+	CloseHandle((HANDLE)InternalData);
+	InternalData = nullptr;
+	ThreadID = 0;
+	return Result;
+}
+
 void Thread::Detach() {
 	if (InternalData == nullptr) {
 		return;
@@ -257,6 +359,18 @@ void Thread::Sleep(size_t ms) {
 size_t Thread::GetThreadID() {
 	return (size_t)GetCurrentThreadId();
 }
+
+bool Thread::SetCurrentAffinity(uint64_t processor_mask) {
+	return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)processor_mask) != 0;
+}
+
+void Thread::SetCurrentName(const char* name) {
+	// Available from Windows 10 1607, shows up in debuggers and in ETW traces.
+	wchar_t WideName[64];
+	if (MultiByteToWideChar(CP_UTF8, 0, name, -1, WideName, 64) > 0) {
+		SetThreadDescription(GetCurrentThread(), WideName);
+	}
+}
 // NOTE: End Threads
 
 // NOTE: Begin mutexs
@@ -309,6 +423,133 @@ bool Mutex::UnLock() {
 
 // NOTE: End mutexs.
 
+// NOTE: Begin semaphores
+bool Semaphore::Create(uint32_t max_count, uint32_t start_count) {
+	InternalData = CreateSemaphoreA(0, (LONG)start_count, (LONG)max_count, 0);
+	if (InternalData == nullptr) {
+		LOG_FATAL("Unable to create semaphore.");
+		return false;
+	}
+
+	return true;
+}
+
+void Semaphore::Destroy() {
+	if (InternalData == nullptr) {
+		return;
+	}
+
+	CloseHandle((HANDLE)InternalData);
+	InternalData = nullptr;
+}
+
+bool Semaphore::Signal() {
+	if (InternalData == nullptr) {
+		return false;
+	}
+
+	// NOTE: Fails if the count would exceed the maximum count, which just means enough signals are pending.
+	return ReleaseSemaphore((HANDLE)InternalData, 1, 0) != 0;
+}
+
+bool Semaphore::Wait(uint32_t timeout_ms) {
+	if (InternalData == nullptr) {
+		return false;
+	}
+
+	DWORD Result = WaitForSingleObject((HANDLE)InternalData, timeout_ms == INVALID_ID ? INFINITE : (DWORD)timeout_ms);
+	switch (Result) {
+	case WAIT_OBJECT_0:
+		return true;
+	case WAIT_TIMEOUT:
+		return false;
+	default:
+		LOG_ERROR("Semaphore wait failed.");
+		return false;
+	}
+}
+
+// NOTE: End semaphores.
+
+// NOTE: Begin fibers
+struct Win32Fiber {
+	LPVOID handle;
+	PFN_fiber_start start_func;
+	void* params;
+	bool from_thread;
+};
+
+static VOID WINAPI Win32FiberProc(LPVOID param) {
+	Win32Fiber* Fib = (Win32Fiber*)param;
+	Fib->start_func(Fib->params);
+
+	// Returning from a fiber procedure exits the whole thread.
+	LOG_FATAL("Fiber returned from its start function.");
+}
+
+bool Fiber::Create(PFN_fiber_start start_func, void* params, size_t stack_size) {
+	Win32Fiber* Fib = (Win32Fiber*)Platform::PlatformAllocate(sizeof(Win32Fiber), false);
+	Fib->start_func = start_func;
+	Fib->params = params;
+	Fib->from_thread = false;
+	Fib->handle = CreateFiberEx(stack_size, stack_size, FIBER_FLAG_FLOAT_SWITCH, Win32FiberProc, Fib);
+	if (Fib->handle == nullptr) {
+		LOG_ERROR("Unable to create fiber.");
+		Platform::PlatformFree(Fib, false);
+		return false;
+	}
+
+	InternalData = Fib;
+	return true;
+}
+
+bool Fiber::CreateFromThread() {
+	Win32Fiber* Fib = (Win32Fiber*)Platform::PlatformAllocate(sizeof(Win32Fiber), false);
+	Fib->start_func = nullptr;
+	Fib->params = nullptr;
+	// Only a thread converted here is converted back by Destroy().
+	Fib->from_thread = !IsThreadAFiber();
+	// FIBER_FLAG_FLOAT_SWITCH keeps the floating point state per fiber.
+	Fib->handle = Fib->from_thread ? ConvertThreadToFiberEx(nullptr, FIBER_FLAG_FLOAT_SWITCH) : GetCurrentFiber();
+	if (Fib->handle == nullptr) {
+		LOG_ERROR("Unable to convert thread to fiber.");
+		Platform::PlatformFree(Fib, false);
+		return false;
+	}
+
+	InternalData = Fib;
+	return true;
+}
+
+void Fiber::Destroy() {
+	if (InternalData == nullptr) {
+		return;
+	}
+
+	Win32Fiber* Fib = (Win32Fiber*)InternalData;
+	if (Fib->from_thread) {
+		ConvertFiberToThread();
+	}
+	else {
+		DeleteFiber(Fib->handle);
+	}
+
+	Platform::PlatformFree(Fib, false);
+	InternalData = nullptr;
+}
+
+bool Fiber::Switch(Fiber* from, Fiber* to) {
+	if (to == nullptr || to->InternalData == nullptr) {
+		return false;
+	}
+
+	// NOTE: Windows keeps track of the running fiber itself, so the current one does not need to be passed.
+	SwitchToFiber(((Win32Fiber*)to->InternalData)->handle);
+	return true;
+}
+
+// NOTE: End fibers.
+
 LRESULT CALLBACK win32_process_message(HWND hwnd, UINT32 msg, WPARAM w_param, LPARAM l_param) {
 	switch (msg) {
 		case WM_ERASEBKGND:
@@ -5,6 +5,7 @@
 #include "Containers/TArray.hpp"
 #include "Resources/Shader.hpp"
 #include "Renderer/Interface/IRenderbuffer.hpp"
+#include "Memory/FrameAllocator.h"
 
 #include <vector>
 #include <functional>
@@ -76,7 +77,7 @@ struct SRenderViewPassConfig {
 struct SRenderPacket {
 	double delta_time = 0.0;
 	unsigned short view_count = 0;
-	std::vector<struct RenderViewPacket> views;
+	TFrameVector<struct RenderViewPacket> views;
 };
 
 struct RenderTarget {
@@ -93,7 +94,7 @@ public:
 		Meshes = data.Meshes;
 	}
 
-	std::vector<GeometryRenderData> Meshes;
+	TFrameVector<GeometryRenderData> Meshes;
 	float GlobalTime;
 };
 
@@ -128,7 +129,7 @@ public:
 		Texts = data.Texts;
 	}
 
-	std::vector<GeometryRenderData> WorldMeshData;
+	TFrameVector<GeometryRenderData> WorldMeshData;
 	MeshPacketData UIMeshData;
 	uint32_t UIGeometryCount = 0;
 	// TODO: Temp.
@@ -280,15 +280,9 @@ void RenderViewPick::OnDestroyPacket(struct RenderViewPacket* packet) {
 		packet->geometries[i].geometry = nullptr;
 	}
 	packet->geometries.clear();
-	std::vector<GeometryRenderData>().swap(packet->geometries);
 
 	if (packet->extended_data) {
 		PickPacketData* PacketData = (PickPacketData*)packet->extended_data;
-		if (!PacketData->WorldMeshData.empty()) {
-			PacketData->WorldMeshData.clear();
-			std::vector<GeometryRenderData>().swap(PacketData->WorldMeshData);
-		}
-
 		DeleteObject(PacketData);
 		packet->extended_data = nullptr;
 	}
@@ -134,21 +134,16 @@ bool RenderViewUI::OnBuildPacket(IRenderviewPacketData* data, struct RenderViewP
 }
 
 void RenderViewUI::OnDestroyPacket(struct RenderViewPacket* packet) {
-	// No much to do here, just zero mem.
+	// The frame arena reclaims the geometries.
 	packet->geometries.clear();
-	std::vector<GeometryRenderData>().swap(packet->geometries);
 
 	if (packet->extended_data) {
+		// The text and mesh lists come from the frame arena as well, unless it ran out.
 		UIPacketData* PacketData = (UIPacketData*)packet->extended_data;
-		if (PacketData->Textes != nullptr) {
-			Memory::Free(PacketData->Textes, sizeof(UIText) * PacketData->textCount, MemoryType::eMemory_Type_Array);
-			PacketData->Textes = nullptr;
-		}
-
-		if (PacketData->meshData.meshes != nullptr) {
-			Memory::Free(PacketData->meshData.meshes, sizeof(Mesh) * PacketData->meshData.mesh_count, MemoryType::eMemory_Type_Array);
-			PacketData->meshData.meshes = nullptr;
-		}
+		Memory::FreeFrame(PacketData->Textes, sizeof(UIText*) * PacketData->textCount, alignof(UIText*));
+		PacketData->Textes = nullptr;
+		Memory::FreeFrame(PacketData->meshData.meshes, sizeof(Mesh*) * PacketData->meshData.mesh_count, alignof(Mesh*));
+		PacketData->meshData.meshes = nullptr;
 
 		DeleteObject(packet->extended_data);
 		packet->extended_data = nullptr;
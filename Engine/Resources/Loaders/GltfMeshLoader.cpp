@@ -7,6 +7,7 @@
 #include "Systems/ResourceSystem.h"
 #include "Systems/GeometrySystem.h"
 #include "Math/GeometryUtils.hpp"
+#include "Memory/ScratchAllocator.h"
 
 #include <stdio.h>	//sscanf
 
@@ -26,14 +27,17 @@ Matrix4  GetGLTFNodeTransform(const std::unordered_map<size_t, Matrix4>& transfo
 	return SelfTransform;
 }
 
-bool MeshLoader::ImportGltfFile(const std::string& obj_file, const char* out_dsm_filename, std::vector<SGeometryConfig>& out_geometries) {
+bool MeshLoader::ImportGltfFile(const FileReadResult* gltf_file, const std::string& obj_file, const char* out_dsm_filename, std::vector<SGeometryConfig>& out_geometries) {
 	tinygltf::Model model;
 	tinygltf::TinyGLTF loader;
 	std::string err;
 	std::string warn;
 
-	// 加载 GLTF 文件
-	bool success = loader.LoadASCIIFromFile(&model, &err, &warn, obj_file);
+	// 加载 GLTF 文件. The file is already read, buffers it refers to are still read by tinygltf, relative to its directory.
+	char BaseDir[512];
+	Memory::Zero(BaseDir, sizeof(BaseDir));
+	StringDirectoryFromPath(BaseDir, obj_file.c_str());
+	bool success = loader.LoadASCIIFromString(&model, &err, &warn, (const char*)gltf_file->data, (unsigned int)gltf_file->size, BaseDir);
 	if (!success) {
 		LOG_INFO("Failed to load GLTF model: ", err.c_str());
 		return false;
@@ -213,20 +217,20 @@ bool MeshLoader::ProcessGltfMaterial(const tinygltf::Model& model, const char* o
 
 bool MeshLoader::ProcessGltfMesh(size_t meshIndex, const tinygltf::Model& model, const std::vector<SMaterialConfig>& materialConfigs, 
 	const std::unordered_map<size_t, int>& nodeParentMap, const std::unordered_map<size_t, Matrix4>& mapMeshMat, std::vector<SGeometryConfig>& out_geometries) {
+	// The attributes only live until the geometries are built, in scratch memory freed as the scope ends.
+	ScratchScope Scope;
 	// Positions
-	std::vector<Vector3> Positions;
+	TScratchVector<Vector3> Positions;
 	Positions.reserve(65535);
 	// Normals
-	std::vector<Vector3> Normals;
+	TScratchVector<Vector3> Normals;
 	Normals.reserve(65535);
 	// Texcoords
-	std::vector<Vector2f> Texcoords;
+	TScratchVector<Vector2f> Texcoords;
 	Texcoords.reserve(65535);
 	// Tangents
-	std::vector<Vector3> Tangents;
+	TScratchVector<Vector3> Tangents;
 	Tangents.reserve(65535);
-	// Indices
-	std::vector<uint32_t> Indices;
 
 	const auto& mesh = model.meshes[meshIndex];
 
@@ -415,11 +419,5 @@ bool MeshLoader::ProcessGltfMesh(size_t meshIndex, const tinygltf::Model& model,
 		GroupData.Faces.clear();
 	}
 
-	std::vector<Vector3>().swap(Positions);
-	std::vector<Vector3>().swap(Normals);
-	std::vector<Vector2f>().swap(Texcoords);
-	std::vector<Vector3>().swap(Tangents);
-	std::vector<uint32_t>().swap(Indices);
-
 	return true;
 }
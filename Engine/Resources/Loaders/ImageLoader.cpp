@@ -5,6 +5,7 @@
 #include "Core/DMemory.hpp"
 #include "Core/EngineLogger.hpp"
 #include "Containers/TString.hpp"
+#include "Systems/JobSystem.hpp"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -57,43 +58,19 @@ bool ImageLoader::Load(const std::string& name, void* params, Resource* resource
 	resource->Name = name;
 	resource->FullPath = FullFilePath;
 
-	FileHandle f;
-	if (!FileSystemOpen(FullFilePath, FileMode::eFile_Mode_Read, true, &f)) {
-		LOG_ERROR("Unable to read file: %s.", FullFilePath);
-		FileSystemClose(&f);
-		return false;
-	}
-
-	size_t FileSize = 0;
-	if (!FileSystemSize(&f, &FileSize)) {
-		LOG_ERROR("Unable to get size of file: %s.", FullFilePath);
-		FileSystemClose(&f);
-		return false;
-	}
-
-	int Width, Height, ChannelCount;
-	unsigned char* RawData = (unsigned char*)Memory::Allocate(FileSize, MemoryType::eMemory_Type_Texture);
-	if (RawData == nullptr) {
-		LOG_ERROR("Image resource loader failed to load file: '%s'.", FullFilePath);
-		FileSystemClose(&f);
-		return false;
-	}
-
-	size_t BytesRead = 0;
-	bool ReadResult = FileSystemReadAllBytes(&f, RawData, &BytesRead);
-	FileSystemClose(&f);
-
-	if (!ReadResult) {
+	// Waiting on the read suspends the loading job in fiber mode, otherwise the thread runs other jobs meanwhile.
+	FileReadResult File;
+	JobHandle Read = JobSystem::ReadFile(FullFilePath, &File);
+	Read.Wait();
+	if (!Read.Succeeded()) {
 		LOG_ERROR("Unable to read file: '%s'.", FullFilePath);
+		FileSystemFreeReadResult(&File);
 		return false;
 	}
 
-	if (BytesRead != FileSize) {
-		LOG_ERROR("File size if %llu does not match expected: %llu.", BytesRead, FileSize);
-		return false;
-	}
-	
-	unsigned char* Data = stbi_load_from_memory(RawData, (int)FileSize, &Width, &Height, &ChannelCount, RequiredChannelCount);
+	int Width, Height, ChannelCount;
+	unsigned char* Data = stbi_load_from_memory(File.data, (int)File.size, &Width, &Height, &ChannelCount, RequiredChannelCount);
+	FileSystemFreeReadResult(&File);
 	if (Data == nullptr) {
 		LOG_ERROR("Image resource loader failed to load file: '%s'.", FullFilePath);
 		return false;
@@ -109,9 +86,6 @@ bool ImageLoader::Load(const std::string& name, void* params, Resource* resource
 	resource->DataSize = sizeof(ImageResourceData);
 	resource->DataCount = 1;
 
-	Memory::Free(RawData, FileSize, MemoryType::eMemory_Type_Texture);
-	RawData = nullptr;
-
 	return true;
 }
 
@@ -8,10 +8,57 @@
 #include "Systems/ResourceSystem.h"
 #include "Systems/GeometrySystem.h"
 #include "Math/GeometryUtils.hpp"
+#include "Systems/JobSystem.hpp"
+#include "Memory/ScratchAllocator.h"
 
 #include <vector>
 #include <stdio.h>	//sscanf
 
+// Reads the whole file. Waiting on the read suspends the loading job in fiber mode, otherwise the thread runs other jobs meanwhile.
+static bool ReadMeshFile(const char* path, FileReadResult* out_file) {
+	JobHandle Read = JobSystem::ReadFile(path, out_file);
+	Read.Wait();
+	if (!Read.Succeeded()) {
+		FileSystemFreeReadResult(out_file);
+		return false;
+	}
+
+	return true;
+}
+
+// Reads the next line of a file read into memory like fgets() would from a file opened as text, line feed included.
+static bool ReadMeshFileLine(const FileReadResult* file, size_t* offset, int max_length, char* line_buf, size_t* length) {
+	if (*offset >= file->size || max_length <= 0) {
+		return false;
+	}
+
+	size_t Length = 0;
+	while (*offset < file->size && Length + 1 < (size_t)max_length) {
+		char c = (char)file->data[(*offset)++];
+		if (c == '\r' && *offset < file->size && file->data[*offset] == '\n') {
+			continue;
+		}
+		line_buf[Length++] = c;
+		if (c == '\n') {
+			break;
+		}
+	}
+	line_buf[Length] = '\0';
+	*length = Length;
+	return true;
+}
+
+// Copies the next bytes of a file read into memory. Returns false if the file ends before.
+static bool ReadMeshFileBytes(const FileReadResult* file, size_t* offset, size_t size, void* out_data) {
+	if (size > file->size - *offset) {
+		return false;
+	}
+
+	Memory::Copy(out_data, file->data + *offset, size);
+	*offset += size;
+	return true;
+}
+
 MeshLoader::MeshLoader() {
 	Type = ResourceType::eResource_type_Static_Mesh;
 	TypePath = "Models";
@@ -23,7 +70,6 @@ bool MeshLoader::Load(const std::string& name, void* params, Resource* resource)
 	}
 
 	const char* FormatStr = "%s/%s/%s%s";
-	FileHandle f;
 
 #define SUPPORTED_FILETYPE_COUNT 3
 	SupportedMeshFileType SupportedFileTypes[SUPPORTED_FILETYPE_COUNT];
@@ -36,12 +82,10 @@ bool MeshLoader::Load(const std::string& name, void* params, Resource* resource)
 	// Try each supported extension.
 	for (uint32_t i = 0; i < SUPPORTED_FILETYPE_COUNT; ++i) {
 		StringFormat(FullFilePath, 512, FormatStr, ResourceSystem::GetRootPath(), TypePath.c_str(), name.c_str(), SupportedFileTypes[i].extension);
-		// If the file exists, open it and stop finding.
+		// If the file exists, stop finding.
 		if (FileSystemExists(FullFilePath)) {
-			if (FileSystemOpen(FullFilePath, FileMode::eFile_Mode_Read, SupportedFileTypes[i].is_binary, &f)) {
-				Type = SupportedFileTypes[i].type;
-				break;
-			}
+			Type = SupportedFileTypes[i].type;
+			break;
 		}
 	}
 
@@ -50,6 +94,12 @@ bool MeshLoader::Load(const std::string& name, void* params, Resource* resource)
 		return false;
 	}
 
+	FileReadResult File;
+	if (!ReadMeshFile(FullFilePath, &File)) {
+		LOG_ERROR("Unable to read mesh file '%s'.", FullFilePath);
+		return false;
+	}
+
 	resource->FullPath = std::string(FullFilePath);
 	resource->Name = std::move(name);
 
@@ -63,17 +113,17 @@ bool MeshLoader::Load(const std::string& name, void* params, Resource* resource)
 		// Generate the dsm filename.
 		char DsmFileName[512];
 		StringFormat(DsmFileName, 512, "%s/%s/%s%s", ResourceSystem::GetRootPath(), TypePath.c_str(), name.c_str(), ".dsm");
-		Result = ImportGltfFile(FullFilePath, DsmFileName, ResourceDatas);
+		Result = ImportGltfFile(&File, FullFilePath, DsmFileName, ResourceDatas);
 	}break;
 	case MeshFileType::eMesh_File_Type_OBJ:
 	{
 		// Generate the dsm filename.
 		char DsmFileName[512];
 		StringFormat(DsmFileName, 512, "%s/%s/%s%s", ResourceSystem::GetRootPath(), TypePath.c_str(), name.c_str(), ".dsm");
-		Result = ImportObjFile(&f, DsmFileName, ResourceDatas);
+		Result = ImportObjFile(&File, DsmFileName, ResourceDatas);
 	}break;
 	case MeshFileType::eMesh_File_Type_DSM:
-		Result = LoadDsmFile(&f, ResourceDatas);
+		Result = LoadDsmFile(&File, ResourceDatas);
 		break;
 	case MeshFileType::eMesh_File_Type_Not_Found:
 		LOG_ERROR("Unable to find mesh of supported type called '%s'.", name.c_str());
@@ -81,7 +131,7 @@ bool MeshLoader::Load(const std::string& name, void* params, Resource* resource)
 		break;
 	}
 
-	FileSystemClose(&f);
+	FileSystemFreeReadResult(&File);
 
 	if (!Result) {
 		LOG_ERROR("Failed to process mesh file '%s'.", FullFilePath);
@@ -120,16 +170,19 @@ void MeshLoader::Unload(Resource* resource) {
 	resource = nullptr;
 }
 
-bool MeshLoader::ImportObjFile(FileHandle* obj_file, const char* out_dsm_filename, std::vector<SGeometryConfig>& out_geometries) {
+bool MeshLoader::ImportObjFile(const FileReadResult* obj_file, const char* out_dsm_filename, std::vector<SGeometryConfig>& out_geometries) {
+	// The parsed data only lives until the geometries are built, in scratch memory freed all at once.
+	size_t ScratchMarker = ScratchAllocator::GetMarker();
+
 	// Positions
-	std::vector<Vector3> Positions;
+	TScratchVector<Vector3> Positions;
 	// Normals
-	std::vector<Vector3> Normals;
+	TScratchVector<Vector3> Normals;
 	// Texcoords
-	std::vector<Vector2f> Texcoords;
+	TScratchVector<Vector2f> Texcoords;
 
 	//Groups
-	std::vector<MeshGroupData> Groups;
+	TScratchVector<MeshGroupData> Groups;
 
 	// Default name is filename.
 	char name[512] = "";
@@ -139,13 +192,13 @@ bool MeshLoader::ImportObjFile(FileHandle* obj_file, const char* out_dsm_filenam
 	char MaterialNames[32][64] = {0};
 
 	char LineBuf[512] = "";
-	char* p = &LineBuf[0];
 	size_t LineLength = 0;
+	size_t Offset = 0;
 
 	// index 0 is previous, 1 is previous before that.
 	char PrevFirstChars[2] = { '\0', '\0'};
 	while (true) {
-		if (!FileSystemReadLine(obj_file, 511, &p, &LineLength)) {
+		if (!ReadMeshFileLine(obj_file, &Offset, 511, LineBuf, &LineLength)) {
 			break;
 		}
 
@@ -373,10 +426,12 @@ bool MeshLoader::ImportObjFile(FileHandle* obj_file, const char* out_dsm_filenam
 		Groups[i].Faces.clear();
 	}
 
-	Groups.clear();
-	Positions.clear();
-	Normals.clear();
-	Texcoords.clear();
+	// Release the scratch memory before de-duplicating, which waits for jobs.
+	TScratchVector<Vector3>().swap(Positions);
+	TScratchVector<Vector3>().swap(Normals);
+	TScratchVector<Vector2f>().swap(Texcoords);
+	TScratchVector<MeshGroupData>().swap(Groups);
+	ScratchAllocator::Rewind(ScratchMarker);
 
 	if (strlen(MaterialFileName) > 0) {
 		// Load up the material file.
@@ -394,11 +449,6 @@ bool MeshLoader::ImportObjFile(FileHandle* obj_file, const char* out_dsm_filenam
 	// De-duplicate geometry.
 	DeduplicateGeometry(out_geometries);
 
-	std::vector<Vector3>().swap(Positions);
-	std::vector<Vector3>().swap(Normals);
-	std::vector<Vector2f>().swap(Texcoords);
-	std::vector<MeshGroupData>().swap(Groups);
-
 	// Output a .dsm file, which will be loaded in the future.
 	return WriteDsmFile(out_dsm_filename, name, out_geometries);
 }
@@ -407,8 +457,8 @@ bool MeshLoader::ImportObjMaterialLibraryFile(const char* mtl_file_path) {
 	LOG_DEBUG("Importing obj .mtl file '%s'.", mtl_file_path);
 
 	// Grab the .mtl file, if it exists, and read the material information.
-	FileHandle MtlFile;
-	if (!FileSystemOpen(mtl_file_path, FileMode::eFile_Mode_Read, false, &MtlFile)) {
+	FileReadResult MtlFile;
+	if (!ReadMeshFile(mtl_file_path, &MtlFile)) {
 		LOG_ERROR("Unable to open mtl file: '%s'", mtl_file_path);
 		return false;
 	}
@@ -417,10 +467,10 @@ bool MeshLoader::ImportObjMaterialLibraryFile(const char* mtl_file_path) {
 	bool HitName = false;
 	char* Line = nullptr;
 	char LineBuf[512];
-	char* p = &LineBuf[0];
 	size_t LineLength = 0;
+	size_t Offset = 0;
 	while (true) {
-		if (!FileSystemReadLine(&MtlFile, 512, &p, &LineLength)) {
+		if (!ReadMeshFileLine(&MtlFile, &Offset, 512, LineBuf, &LineLength)) {
 			break;
 		}
 
@@ -553,6 +603,7 @@ bool MeshLoader::ImportObjMaterialLibraryFile(const char* mtl_file_path) {
 					// Write out a dmt file and move on.
 					if (!WriteDmtFile(mtl_file_path, &CurrentConfig)) {
 						LOG_ERROR("Unable to write dmt file.");
+						FileSystemFreeReadResult(&MtlFile);
 						return false;
 					}
 
@@ -566,6 +617,7 @@ bool MeshLoader::ImportObjMaterialLibraryFile(const char* mtl_file_path) {
 		}
 		}
 	}	// Each line
+	FileSystemFreeReadResult(&MtlFile);
 
 	// Write out the remaining dmt file.
 	// NOTE: Hardcoding default material shader name because all objects imported this way
@@ -581,21 +633,28 @@ bool MeshLoader::ImportObjMaterialLibraryFile(const char* mtl_file_path) {
 		return false;
 	}
 
-	FileSystemClose(&MtlFile);
 	return true;
 }
 
-void MeshLoader::ProcessSubobject(std::vector<Vector3>& positions, std::vector<Vector3>& normals, std::vector<Vector2f>& texcoords, std::vector<MeshFaceData>& faces, SGeometryConfig* out_data) {
-	std::vector<uint32_t> Indices;
-	std::vector<Vertex> Vertices;
-	Indices.reserve(65535);
-	Vertices.reserve(65535);
+void MeshLoader::ProcessSubobject(TScratchVector<Vector3>& positions, TScratchVector<Vector3>& normals, TScratchVector<Vector2f>& texcoords, TScratchVector<MeshFaceData>& faces, SGeometryConfig* out_data) {
+	size_t FaceCount = faces.size();
+
+	// Every corner of a face becomes a vertex of its own, de-duplicating merges them later.
+	// The counts are known up front, so the arrays are filled in place.
+	out_data->vertex_count = (uint32_t)(FaceCount * 3);
+	out_data->vertex_size = sizeof(Vertex);
+	out_data->vertices = Memory::AllocateUninitialized(out_data->vertex_count * out_data->vertex_size, alignof(Vertex), MemoryType::eMemory_Type_Array);
+	Vertex* Vertices = (Vertex*)out_data->vertices;
+
+	out_data->index_count = (uint32_t)(FaceCount * 3);
+	out_data->index_size = sizeof(uint32_t);
+	out_data->indices = Memory::AllocateUninitialized(out_data->index_count * out_data->index_size, alignof(uint32_t), MemoryType::eMemory_Type_Array);
+	uint32_t* Indices = (uint32_t*)out_data->indices;
 	
 	bool ExtentSet = false;
 	Memory::Zero(&out_data->min_extents, sizeof(Vector3));
 	Memory::Zero(&out_data->max_extents, sizeof(Vector3));
-	
-	size_t FaceCount = faces.size();
+
 	size_t NormalCount = normals.size();
 	size_t TexcoordCount = texcoords.size();
 
@@ -633,7 +692,7 @@ void MeshLoader::ProcessSubobject(std::vector<Vector3>& positions, std::vector<V
 		// Each vertex
 		for (size_t i = 0; i < 3; ++i) {
 			MeshVertexIndexData IndexData = faces[f].vertices[i];
-			Indices.push_back((uint32_t)(i + (f * 3)));
+			Indices[f * 3 + i] = (uint32_t)(i + (f * 3));
 
 			Vertex Vert;
 			Vector3 Pos = positions[IndexData.position_index];
@@ -679,7 +738,7 @@ void MeshLoader::ProcessSubobject(std::vector<Vector3>& positions, std::vector<V
 
 			// TODO: Color
 			Vert.color = Vector4(1, 1, 1, 1);
-			Vertices.push_back(Vert);
+			new (&Vertices[f * 3 + i]) Vertex(Vert);
 		}
 	}
 
@@ -687,19 +746,6 @@ void MeshLoader::ProcessSubobject(std::vector<Vector3>& positions, std::vector<V
 	for (unsigned short i = 0; i < 3; ++i) {
 		out_data->center.elements[i] = (out_data->min_extents.elements[i] + out_data->max_extents.elements[i]) / 2.0f;
 	}
-
-	out_data->vertex_count = (uint32_t)Vertices.size();
-	out_data->vertex_size = sizeof(Vertex);
-	out_data->vertices = Memory::Allocate(out_data->vertex_count * out_data->vertex_size, MemoryType::eMemory_Type_Array);
-	Memory::Copy(out_data->vertices, Vertices.data(), out_data->vertex_count * out_data->vertex_size);
-
-	out_data->index_count = (uint32_t)Indices.size();
-	out_data->index_size = sizeof(uint32_t);
-	out_data->indices = Memory::Allocate(out_data->index_count * out_data->index_size, MemoryType::eMemory_Type_Array);
-	Memory::Copy(out_data->indices, Indices.data(), out_data->index_count * out_data->index_size);
-
-	std::vector<uint32_t>().swap(Indices);
-	std::vector<Vertex>().swap(Vertices);
 }	
 
 bool MeshLoader::WriteDmtFile(const char* mtl_file_path, SMaterialConfig* config) {
@@ -764,67 +810,86 @@ bool MeshLoader::WriteDmtFile(const char* mtl_file_path, SMaterialConfig* config
 	return true;
 }
 
-bool MeshLoader::LoadDsmFile(FileHandle* dsm_file, std::vector<SGeometryConfig>& out_geometries) {
+bool MeshLoader::LoadDsmFile(const FileReadResult* dsm_file, std::vector<SGeometryConfig>& out_geometries) {
 	// Version
-	size_t BytesRead = 0;
+	size_t Offset = 0;
+	bool Read = true;
 	unsigned short Version = 0;
-	FileSystemRead(dsm_file, sizeof(unsigned short), &Version, &BytesRead);
+	Read &= ReadMeshFileBytes(dsm_file, &Offset, sizeof(unsigned short), &Version);
 
 	// Name length
 	uint32_t NameLength = 0;
-	FileSystemRead(dsm_file, sizeof(uint32_t), &NameLength, &BytesRead);
+	Read &= ReadMeshFileBytes(dsm_file, &Offset, sizeof(uint32_t), &NameLength);
 	// Name + terminator
 	char name[256];
-	FileSystemRead(dsm_file, sizeof(char) * NameLength, name, &BytesRead);
+	if (!Read || NameLength > sizeof(name) || !ReadMeshFileBytes(dsm_file, &Offset, sizeof(char) * NameLength, name)) {
+		LOG_ERROR("Mesh file is truncated.");
+		return false;
+	}
 
 	//Geometry count.
 	uint32_t GeometryCount = 0;
-	FileSystemRead(dsm_file, sizeof(uint32_t), &GeometryCount, &BytesRead);
+	Read &= ReadMeshFileBytes(dsm_file, &Offset, sizeof(uint32_t), &GeometryCount);
 
 	// Each geometry.
-	for (uint32_t i = 0; i < GeometryCount; ++i) {
+	for (uint32_t i = 0; i < GeometryCount && Read; ++i) {
 		SGeometryConfig g;
 
 		// Vertices (size/count/array)
-		FileSystemRead(dsm_file, sizeof(uint32_t), &g.vertex_size, &BytesRead);
-		FileSystemRead(dsm_file, sizeof(uint32_t), &g.vertex_count, &BytesRead);
-		g.vertices = Memory::Allocate(g.vertex_count * g.vertex_size, MemoryType::eMemory_Type_Array);
-		FileSystemRead(dsm_file, g.vertex_count * g.vertex_size, g.vertices, &BytesRead);
+		Read &= ReadMeshFileBytes(dsm_file, &Offset, sizeof(uint32_t), &g.vertex_size);
+		Read &= ReadMeshFileBytes(dsm_file, &Offset, sizeof(uint32_t), &g.vertex_count);
+		// Vertices and indices are read over right away, no need to clear them.
+		g.vertices = Memory::AllocateUninitialized(g.vertex_count * g.vertex_size, alignof(Vertex), MemoryType::eMemory_Type_Array);
+		Read &= ReadMeshFileBytes(dsm_file, &Offset, g.vertex_count * g.vertex_size, g.vertices);
 
 		// Indices (size/count/array)
-		FileSystemRead(dsm_file, sizeof(uint32_t), &g.index_size, &BytesRead);
-		FileSystemRead(dsm_file, sizeof(uint32_t), &g.index_count, &BytesRead);
-		g.indices = Memory::Allocate(g.index_count * g.index_size, MemoryType::eMemory_Type_Array);
-		FileSystemRead(dsm_file, g.index_count * g.index_size, g.indices, &BytesRead);
+		Read &= ReadMeshFileBytes(dsm_file, &Offset, sizeof(uint32_t), &g.index_size);
+		Read &= ReadMeshFileBytes(dsm_file, &Offset, sizeof(uint32_t), &g.index_count);
+		g.indices = Memory::AllocateUninitialized(g.index_count * g.index_size, alignof(uint32_t), MemoryType::eMemory_Type_Array);
+		Read &= ReadMeshFileBytes(dsm_file, &Offset, g.index_count * g.index_size, g.indices);
 
-		// Name
+		// Name, its terminator included.
 		uint32_t GNameLength = 0;
-		FileSystemRead(dsm_file, sizeof(uint32_t), &GNameLength, &BytesRead);
-		char* gn = (char*)Memory::Allocate(sizeof(char) * GNameLength, MemoryType::eMemory_Type_String);
-		FileSystemRead(dsm_file, sizeof(char) * GNameLength, gn, &BytesRead);
-		g.name = std::string(gn);
-		Memory::Free(gn, sizeof(char) * GNameLength, MemoryType::eMemory_Type_String);
+		Read &= ReadMeshFileBytes(dsm_file, &Offset, sizeof(uint32_t), &GNameLength);
+		if (Read && GNameLength <= dsm_file->size - Offset) {
+			g.name = std::string((const char*)dsm_file->data + Offset, strnlen((const char*)dsm_file->data + Offset, GNameLength));
+			Offset += GNameLength;
+		}
+		else {
+			Read = false;
+		}
 
 		// Material name.
 		uint32_t MNameLength = 0;
-		FileSystemRead(dsm_file, sizeof(uint32_t), &MNameLength, &BytesRead);
-		char* mn = (char*)Memory::Allocate(sizeof(char) * MNameLength, MemoryType::eMemory_Type_String);
-		FileSystemRead(dsm_file, sizeof(char) * MNameLength, mn, &BytesRead);
-		g.material_name = std::string(mn);
-		Memory::Free(mn, sizeof(char) * MNameLength, MemoryType::eMemory_Type_String);
+		Read &= ReadMeshFileBytes(dsm_file, &Offset, sizeof(uint32_t), &MNameLength);
+		if (Read && MNameLength <= dsm_file->size - Offset) {
+			g.material_name = std::string((const char*)dsm_file->data + Offset, strnlen((const char*)dsm_file->data + Offset, MNameLength));
+			Offset += MNameLength;
+		}
+		else {
+			Read = false;
+		}
 
 		// Center
-		FileSystemRead(dsm_file, sizeof(Vector3), &g.center, &BytesRead);
+		Read &= ReadMeshFileBytes(dsm_file, &Offset, sizeof(Vector3), &g.center);
 
 		// Extents (min/max)
-		FileSystemRead(dsm_file, sizeof(Vector3), &g.min_extents, &BytesRead);
-		FileSystemRead(dsm_file, sizeof(Vector3), &g.max_extents, &BytesRead);
+		Read &= ReadMeshFileBytes(dsm_file, &Offset, sizeof(Vector3), &g.min_extents);
+		Read &= ReadMeshFileBytes(dsm_file, &Offset, sizeof(Vector3), &g.max_extents);
+		if (!Read) {
+			GeometrySystem::ConfigDispose(&g);
+			break;
+		}
 
 		// Add to the output array.
 		out_geometries.push_back(g);
 	}
 
-	FileSystemClose(dsm_file);
+	if (!Read) {
+		LOG_ERROR("Mesh file is truncated.");
+		return false;
+	}
+
 	return true;
 }
 
@@ -891,29 +956,46 @@ bool MeshLoader::WriteDsmFile(const char* path, const char* name, std::vector<SG
 	return true;
 }
 
-bool MeshLoader::DeduplicateGeometry(std::vector<SGeometryConfig>& outGeometries) {
-	size_t Count = outGeometries.size();
+struct GeometryDeduplicateParams {
+	SGeometryConfig* geometry = nullptr;
+};
+
+static bool DeduplicateGeometryJobStart(void* payload, void* /*context*/) {
+	SGeometryConfig* g = ((GeometryDeduplicateParams*)payload)->geometry;
+	LOG_DEBUG("Geometry de-duplication process starting on geometry object named '%s'.", g->name.c_str());
+
 	uint32_t NewVertCount = 0;
 	Vertex* UniqueVerts = nullptr;
-	for (size_t i = 0; i < Count; ++i) {
-		SGeometryConfig* g = &outGeometries[i];
-		LOG_DEBUG("Geometry de-duplication process starting on geometry object named '%s'.", g->name.c_str());
-		GeometryUtils::DeduplicateVertices(g->vertex_count, (Vertex*)g->vertices, g->index_count, (uint32_t*)g->indices, &NewVertCount, &UniqueVerts);
+	GeometryUtils::DeduplicateVertices(g->vertex_count, (Vertex*)g->vertices, g->index_count, (uint32_t*)g->indices, &NewVertCount, &UniqueVerts);
 
-		// Destroy the old, large array.
-		Memory::Free(g->vertices, g->vertex_count * g->vertex_size, MemoryType::eMemory_Type_Array);
+	// Destroy the old, large array.
+	Memory::Free(g->vertices, g->vertex_count * g->vertex_size, MemoryType::eMemory_Type_Array);
 
-		// And replace with the de-duplicated one.k
-		g->vertex_count = NewVertCount;
-		g->vertices = UniqueVerts;
+	// And replace with the de-duplicated one. The indices were remapped in place and stay as they are.
+	g->vertex_count = NewVertCount;
+	g->vertices = UniqueVerts;
 
-		// Take a copy of the indices as a normal.
-		uint32_t* Indices = (uint32_t*)Memory::Allocate(sizeof(uint32_t) * g->index_count, MemoryType::eMemory_Type_Array);
-		Memory::Copy(Indices, g->indices, sizeof(uint32_t) * g->index_count);
-		// Destroy.
-		Memory::Free(g->indices, sizeof(uint32_t) * g->index_count, MemoryType::eMemory_Type_Array);
-		g->indices = Indices;
+	return true;
+}
+
+bool MeshLoader::DeduplicateGeometry(std::vector<SGeometryConfig>& outGeometries) {
+	// Geometries are independent of each other, so de-duplicate them all in parallel.
+	// In fiber mode the loading job is suspended until the last one is done, and the
+	// resource thread moves on to other loads in the meantime. Otherwise the thread only
+	// waits, helping out could get it stuck in an unrelated long job.
+	JobCounter Counter;
+	JobDesc Desc;
+	Desc.priority = JobPriority::eHigh;
+	Desc.signal_counter = &Counter;
+
+	size_t Count = outGeometries.size();
+	for (size_t i = 0; i < Count; ++i) {
+		GeometryDeduplicateParams Params;
+		Params.geometry = &outGeometries[i];
+		JobSystem::Submit(DeduplicateGeometryJobStart, Params, Desc);
 	}
 
+	JobSystem::WaitForCounter(&Counter, false);
+
 	return true;
 }
\ No newline at end of file
@@ -5,7 +5,7 @@
 #include <vector>
 #include <unordered_map>
 
-struct FileHandle;
+struct FileReadResult;
 struct SGeometryConfig;
 struct SMaterialConfig;
 
@@ -22,15 +22,15 @@ public:
 	virtual void Unload(Resource* resource) override;
 
 private:
-	virtual bool ImportObjFile(FileHandle* obj_file, const char* out_dsm_filename, std::vector<SGeometryConfig>& out_geometries);
-	virtual void ProcessSubobject(std::vector<Vector3>& positions, std::vector<Vector3>& normals, std::vector<Vector2f>& texcoords, std::vector<MeshFaceData>& faces, SGeometryConfig* out_data);
+	virtual bool ImportObjFile(const FileReadResult* obj_file, const char* out_dsm_filename, std::vector<SGeometryConfig>& out_geometries);
+	virtual void ProcessSubobject(TScratchVector<Vector3>& positions, TScratchVector<Vector3>& normals, TScratchVector<Vector2f>& texcoords, TScratchVector<MeshFaceData>& faces, SGeometryConfig* out_data);
 	virtual bool ImportObjMaterialLibraryFile(const char* mtl_file_path);
 
-	virtual bool LoadDsmFile(FileHandle* dsm_file, std::vector<SGeometryConfig>& out_geometries);
+	virtual bool LoadDsmFile(const FileReadResult* dsm_file, std::vector<SGeometryConfig>& out_geometries);
 	virtual bool WriteDsmFile(const char* path, const char* name, std::vector<SGeometryConfig>& geometries);
 	virtual bool WriteDmtFile(const char* mtl_file_path, SMaterialConfig* config);
 
-	virtual bool ImportGltfFile(const std::string& obj_file, const char* out_dsm_filename, std::vector<SGeometryConfig>& out_geometries);
+	virtual bool ImportGltfFile(const FileReadResult* gltf_file, const std::string& obj_file, const char* out_dsm_filename, std::vector<SGeometryConfig>& out_geometries);
 	virtual bool ProcessGltfMesh(size_t meshIndex, const tinygltf::Model& model, const std::vector<SMaterialConfig>& materialConfigs, const std::unordered_map<size_t, int>& nodeParentMap, const std::unordered_map<size_t, Matrix4>& mapMeshMat, std::vector<SGeometryConfig>& out_geometries);
 	virtual bool ProcessGltfMaterial(const tinygltf::Model& model, const char* out_dsm_filename, std::vector<SMaterialConfig>& materialConfigs);
 
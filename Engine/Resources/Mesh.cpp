@@ -7,8 +7,16 @@
 #include "Systems/GeometrySystem.h"
 #include "Systems/JobSystem.hpp"
 
-void Mesh::LoadJobSuccess(void* params) {
-	MeshLoadParams* MeshParams = (MeshLoadParams*)params;
+void Mesh::LoadJobSuccess(void* payload, void* /*context*/) {
+	MeshLoadParams* MeshParams = *(MeshLoadParams**)payload;
+	if (MeshParams->cancel.IsCancelled()) {
+		// Unloaded while the job ran, the mesh may be gone or loading something else by now. Drop the result.
+		LOG_DEBUG("Load of mesh '%s' called off.", MeshParams->resource_name.c_str());
+		ResourceSystem::Unload(&MeshParams->mesh_resource);
+		DeleteObject(MeshParams);
+		return;
+	}
+	MeshParams->out_mesh->PendingLoad = nullptr;
 
 	// This also handle the GPU upload. Can't be jobified until the renderer is multithread.
 	SGeometryConfig* Configs = (SGeometryConfig*)MeshParams->mesh_resource.Data;
@@ -22,45 +30,59 @@ void Mesh::LoadJobSuccess(void* params) {
 
 	LOG_INFO("Successfully loaded mesh: '%s'.", MeshParams->resource_name.c_str());
 	ResourceSystem::Unload(&MeshParams->mesh_resource);
+	DeleteObject(MeshParams);
 }
 
-void Mesh::LoadJobFail(void* params) {
-	MeshLoadParams* MeshParams = (MeshLoadParams*)params;
-	LOG_ERROR("Failed to load mesh: '%s'.", MeshParams->resource_name.c_str());
+void Mesh::LoadJobFail(void* payload, void* /*context*/) {
+	MeshLoadParams* MeshParams = *(MeshLoadParams**)payload;
+	if (MeshParams->cancel.IsCancelled()) {
+		// The mesh was unloaded, and no longer refers to the params.
+		LOG_DEBUG("Load of mesh '%s' called off.", MeshParams->resource_name.c_str());
+	}
+	else {
+		MeshParams->out_mesh->PendingLoad = nullptr;
+		LOG_ERROR("Failed to load mesh: '%s'.", MeshParams->resource_name.c_str());
+	}
 	ResourceSystem::Unload(&MeshParams->mesh_resource);
+	DeleteObject(MeshParams);
 }
 
-bool Mesh::LoadJobStart(void* params, void* result_data) {
-	MeshLoadParams* LoadParams = (MeshLoadParams*)params;
-	bool Result = ResourceSystem::Load(LoadParams->resource_name, ResourceType::eResource_type_Static_Mesh, nullptr, &LoadParams->mesh_resource);
+bool Mesh::LoadJobStart(void* payload, void* /*context*/) {
+	MeshLoadParams* LoadParams = *(MeshLoadParams**)payload;
+	if (LoadParams->cancel.IsCancelled()) {
+		return false;
+	}
 
-	// NOTE: The load params are also used as the result data here, only the mesh)resource field is populated now.
-	Memory::Copy(result_data, LoadParams, sizeof(MeshLoadParams));
-	return Result;
+	return ResourceSystem::Load(LoadParams->resource_name, ResourceType::eResource_type_Static_Mesh, nullptr, &LoadParams->mesh_resource);
 }
 
 bool Mesh::LoadFromResource(const std::string& resource_name) {
 	Generation = INVALID_ID_U8;
 
-	MeshLoadParams Params;
-	Params.resource_name = resource_name;
-	Params.out_mesh = this;
-	Params.mesh_resource = {};
+	// The job only carries a pointer to the params, they hold a string and a resource and do not fit inline.
+	// The params stay with the job rather than the mesh, so the job can tell it was called off even after the mesh is gone.
+	MeshLoadParams* Params = NewObject<MeshLoadParams>();
+	Params->resource_name = resource_name;
+	Params->out_mesh = this;
 	Name = resource_name;
 
-	JobInfo Job = JobSystem::CreateJob(
-		std::bind(&Mesh::LoadJobStart, this, std::placeholders::_1, std::placeholders::_2),
-		std::bind(&Mesh::LoadJobSuccess, this, std::placeholders::_1),
-		std::bind(&Mesh::LoadJobFail, this, std::placeholders::_1),
-		std::make_shared<MeshLoadParams>(Params), 
-		sizeof(MeshLoadParams), 
-		sizeof(MeshLoadParams));
-	JobSystem::Submit(Job);
+	JobDesc Desc;
+	Desc.on_success = LoadJobSuccess;
+	Desc.on_failed = LoadJobFail;
+	Desc.name = "LoadMesh";
+	Desc.gpu_upload = true;
+	PendingLoad = Params;
+	JobSystem::Submit(LoadJobStart, Params, Desc);
 
 	return true;
 }
 
 void Mesh::Unload() {
+	if (PendingLoad != nullptr) {
+		PendingLoad->cancel.Cancel();
+		PendingLoad = nullptr;
+	}
+
 	for (uint32_t i = 0; i < geometry_count; ++i) {
 		GeometrySystem::Release(geometries[i]);
 	}
@@ -3,8 +3,12 @@
 #include "Resource.hpp"
 #include "Geometry.hpp"
 #include "Math/Transform.hpp"
+#include "Memory/ScratchAllocator.h"
+#include "Systems/JobSystem.hpp"
 #include <vector>
 
+struct MeshLoadParams;
+
 enum MeshFileType {
 	eMesh_File_Type_Not_Found,
 	eMesh_File_Type_DSM,
@@ -28,13 +32,14 @@ struct MeshFaceData {
 	MeshVertexIndexData vertices[3];
 };
 
+// Only lives while importing, in scratch memory.
 struct MeshGroupData {
-	std::vector<MeshFaceData> Faces;
+	TScratchVector<MeshFaceData> Faces;
 };
 
 class Mesh {
 public:
-	Mesh() : geometries(nullptr), Parent(nullptr), geometry_count(0), UniqueID(INVALID_ID), Generation(INVALID_ID_U8){}
+	Mesh() : geometries(nullptr), Parent(nullptr), geometry_count(0), UniqueID(INVALID_ID), Generation(INVALID_ID_U8), PendingLoad(nullptr){}
 	virtual ~Mesh() { Unload(); }
 	DAPI bool LoadFromResource(const std::string& resource_name);
 	DAPI void Unload();
@@ -47,9 +52,10 @@ public:
 	DAPI Mesh* GetParent() const { return Parent; }
 
 private:
-	void LoadJobSuccess(void* params);
-	void LoadJobFail(void* params);
-	bool LoadJobStart(void* params, void* result_data);
+	// The payload of the load job is a MeshLoadParams*, released by whichever callback runs.
+	static void LoadJobSuccess(void* payload, void* context);
+	static void LoadJobFail(void* payload, void* context);
+	static bool LoadJobStart(void* payload, void* context);
 
 public:
 	std::string Name;
@@ -59,10 +65,14 @@ public:
 	Geometry** geometries;
 	Transform Transform;
 	Mesh* Parent;
+	// The params of the load in flight, so unloading can call it off. Main thread only.
+	MeshLoadParams* PendingLoad;
 };
 
 struct MeshLoadParams {
 	std::string resource_name;
 	Mesh* out_mesh = nullptr;
 	class Resource mesh_resource;
+	// Set if the mesh was unloaded. A job not started yet skips loading, a finished one drops its result.
+	JobCancelToken cancel;
 };
@@ -8,8 +8,8 @@ IRenderer* CameraSystem::Renderer = nullptr;
 bool CameraSystem::Initialized = false;
 SCameraSystemConfig CameraSystem::Config;
 Camera* CameraSystem::DefaultCamera = nullptr;
-std::vector<Camera*> CameraSystem::Cameras;
-std::unordered_map<std::string, uint32_t> CameraSystem::CameraMap;
+TEngineVector<Camera*, eMemory_Type_Scene>* CameraSystem::Cameras = nullptr;
+TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_Scene>* CameraSystem::CameraMap = nullptr;
 
 bool CameraSystem::Initialize(IRenderer* renderer, SCameraSystemConfig config) {
 	if (config.max_camera_count == 0) {
@@ -28,27 +28,35 @@ bool CameraSystem::Initialize(IRenderer* renderer, SCameraSystemConfig config) {
 
 	Config = config;
 	Renderer = renderer;
-	Cameras.resize(Config.max_camera_count);
+	Cameras = NewObject<TEngineVector<Camera*, eMemory_Type_Scene>>(Config.max_camera_count);
+	CameraMap = NewObject<TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_Scene>>();
 
 	// Setup default camera.
 	DefaultCamera = NewObject<Camera>(0);
-	Cameras[0] = DefaultCamera;
-	CameraMap[DEFAULT_CAMERA_NAME] = 0;
+	(*Cameras)[0] = DefaultCamera;
+	(*CameraMap)[DEFAULT_CAMERA_NAME] = 0;
 
 	Initialized = true;
 	return true;
 }
 
 void CameraSystem::Shutdown() {
-	for (Camera* c : Cameras) {
+	if (Cameras == nullptr) {
+		return;
+	}
+
+	for (Camera* c : *Cameras) {
 		if (c) {
 			DeleteObject(c);
 			c = nullptr;
 		}
 	}
 
-	Cameras.clear();
-	std::vector<Camera*>().swap(Cameras);
+	DeleteObject(Cameras);
+	Cameras = nullptr;
+	DeleteObject(CameraMap);
+	CameraMap = nullptr;
+	Initialized = false;
 }
 
 Camera* CameraSystem::Acquire(const char* name) {
@@ -58,16 +66,16 @@ Camera* CameraSystem::Acquire(const char* name) {
 		}
 
 		unsigned short ID = INVALID_ID_U16;
-		if (CameraMap.find(name) == CameraMap.end()) {
+		if (CameraMap->find(name) == CameraMap->end()) {
 			LOG_ERROR("Camera system Acquire() failed lookup. returned nullptr.");
 			return nullptr;
 		}
 
-		ID = CameraMap[name];
+		ID = (*CameraMap)[name];
 		if (ID == INVALID_ID_U16) {
 			// Find free slot
 			for (unsigned short i = 0; i < Config.max_camera_count; ++i) {
-				if (Cameras[i] == nullptr || Cameras[i]->GetID() == INVALID_ID_U16) {
+				if ((*Cameras)[i] == nullptr || (*Cameras)[i]->GetID() == INVALID_ID_U16) {
 					ID = i;
 					break;
 				}
@@ -87,11 +95,11 @@ Camera* CameraSystem::Acquire(const char* name) {
 			}
 
 			// Update the hashtable.
-			CameraMap[name] = ID;
+			(*CameraMap)[name] = ID;
 		}
 
-		Cameras[ID]->IncreaseReferenceCount();
-		return Cameras[ID];
+		(*Cameras)[ID]->IncreaseReferenceCount();
+		return (*Cameras)[ID];
 	}
 
 	LOG_ERROR("Camera system acquire called before system initialization. return nullptr.");
@@ -106,15 +114,15 @@ void CameraSystem::Release(const char* name) {
 		}
 
 		unsigned short ID = INVALID_ID_U16;
-		if (CameraMap.find(name) == CameraMap.end()) {
+		if (CameraMap->find(name) == CameraMap->end()) {
 			LOG_WARN("Camera system release failed lookup. Nothing was done.");
 			return;
 		}
 
-		ID = CameraMap[name];
+		ID = (*CameraMap)[name];
 		if (ID != INVALID_ID_U16) {
 			// Decrement the reference count, and reset the camera if the counter reaches 0.
-			Camera* Cam = Cameras[ID];
+			Camera* Cam = (*Cameras)[ID];
 			if (Cam == nullptr) {
 				LOG_FATAL("Invalid camera refer. It should not happened.");
 				return;
@@ -124,7 +132,7 @@ void CameraSystem::Release(const char* name) {
 			if (Cam->GetReferenceCount() < 1) {
 				Cam->Reset();
 				Cam->SetID(INVALID_ID_U16);
-				CameraMap[name] = INVALID_ID_U16;
+				(*CameraMap)[name] = INVALID_ID_U16;
 			}
 		}
 	}
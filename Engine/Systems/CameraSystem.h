@@ -1,7 +1,7 @@
 ﻿#pragma once
 
 #include "Renderer/Camera.hpp"
-#include <unordered_map>
+#include "Memory/EngineAllocator.h"
 
 class IRenderer;
 
@@ -48,8 +48,8 @@ private:
 	static bool Initialized;
 
 	static SCameraSystemConfig Config;
-	static std::vector<Camera*> Cameras;
-	static std::unordered_map<std::string, uint32_t> CameraMap;
+	static TEngineVector<Camera*, eMemory_Type_Scene>* Cameras;
+	static TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_Scene>* CameraMap;
 	
 	static Camera* DefaultCamera;
 };
@@ -34,12 +34,12 @@ struct SystemFontLookup {
 };
 
 FontSystemConfig FontSystem::Config;
-std::vector<BitmapFontLookup*> FontSystem::BitmapFonts;
-std::vector<SystemFontLookup*> FontSystem::SystemFonts;
+TEngineVector<BitmapFontLookup*, eMemory_Type_Bitmap_Font>* FontSystem::BitmapFonts = nullptr;
+TEngineVector<SystemFontLookup*, eMemory_Type_System_Font>* FontSystem::SystemFonts = nullptr;
 IRenderer* FontSystem::Renderer = nullptr;
 bool FontSystem::Initilized = false;
-std::unordered_map<std::string, uint32_t> FontSystem::SystemFontMap;
-std::unordered_map<std::string, uint32_t> FontSystem::BitmapFontMap;
+TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_System_Font>* FontSystem::SystemFontMap = nullptr;
+TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_Bitmap_Font>* FontSystem::BitmapFontMap = nullptr;
 
 bool FontSystem::Initialize(IRenderer* renderer, FontSystemConfig* config){
 	if (renderer == nullptr) {
@@ -54,8 +54,10 @@ bool FontSystem::Initialize(IRenderer* renderer, FontSystemConfig* config){
 	Config = *config;
 	Renderer = renderer;
 
-	BitmapFonts.resize(config->maxBitmapFontCount);
-	SystemFonts.resize(config->maxSystemFontCount);
+	BitmapFonts = NewObject<TEngineVector<BitmapFontLookup*, eMemory_Type_Bitmap_Font>>(config->maxBitmapFontCount);
+	SystemFonts = NewObject<TEngineVector<SystemFontLookup*, eMemory_Type_System_Font>>(config->maxSystemFontCount);
+	BitmapFontMap = NewObject<TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_Bitmap_Font>>();
+	SystemFontMap = NewObject<TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_System_Font>>();
 
 	// Load up any default fonts.
 	// Bitmap fonts.
@@ -80,28 +82,38 @@ void FontSystem::Shutdown() {
 	if (Initilized) {
 		// Clean up bitmap fonts.
 		for (unsigned short i = 0; i < Config.maxBitmapFontCount; ++i) {
-			if (BitmapFonts[i] != nullptr) {
-				CleanupFontData(BitmapFonts[i]->font.resourceData->data);
-				BitmapFonts[i]->font.resourceData->data = nullptr;
-				BitmapFonts[i]->id = INVALID_ID_U16;
-				DeleteObject(BitmapFonts[i]);
+			if ((*BitmapFonts)[i] != nullptr) {
+				CleanupFontData((*BitmapFonts)[i]->font.resourceData->data);
+				(*BitmapFonts)[i]->font.resourceData->data = nullptr;
+				(*BitmapFonts)[i]->id = INVALID_ID_U16;
+				DeleteObject((*BitmapFonts)[i]);
 			}
 		}
 
 		// Clean up system fonts.
 		for (unsigned short i = 0; i < Config.maxSystemFontCount; ++i) {
-			if (SystemFonts[i] != nullptr) {
+			if ((*SystemFonts)[i] != nullptr) {
 				// Clean up each variant.
-				uint32_t VariantCount = (uint32_t)SystemFonts[i]->sizeVariants.size();
+				uint32_t VariantCount = (uint32_t)(*SystemFonts)[i]->sizeVariants.size();
 				for (uint32_t j = 0; j < VariantCount; ++j) {
-					CleanupFontData(SystemFonts[i]->sizeVariants[j]);
-					SystemFonts[i]->sizeVariants[j] = nullptr;
+					CleanupFontData((*SystemFonts)[i]->sizeVariants[j]);
+					(*SystemFonts)[i]->sizeVariants[j] = nullptr;
 				}
 
-				SystemFonts[i]->id = INVALID_ID_U16;
-				SystemFonts[i]->sizeVariants.clear();
+				(*SystemFonts)[i]->id = INVALID_ID_U16;
+				(*SystemFonts)[i]->sizeVariants.clear();
 			}
 		}
+
+		DeleteObject(BitmapFonts);
+		BitmapFonts = nullptr;
+		DeleteObject(SystemFonts);
+		SystemFonts = nullptr;
+		DeleteObject(BitmapFontMap);
+		BitmapFontMap = nullptr;
+		DeleteObject(SystemFontMap);
+		SystemFontMap = nullptr;
+		Initilized = false;
 	}
 }
 
@@ -124,7 +136,7 @@ bool FontSystem::LoadSystemFont(SystemFontConfig* config){
 		SystemFontFace* Face = &ResourceData->fonts[i];
 
 		// Make sure a font with this name doesn't already exist.
-		if (SystemFontMap.find(Face->name) != SystemFontMap.end()) {
+		if (SystemFontMap->find(Face->name) != SystemFontMap->end()) {
 			LOG_WARN("A font named '%s' already exists and will not be loaded again.", config->name.c_str());
 			return true;
 		}
@@ -132,7 +144,7 @@ bool FontSystem::LoadSystemFont(SystemFontConfig* config){
 		// Get a new id
 		unsigned short ID = INVALID_ID_U16;
 		for (unsigned short j = 0; j < Config.maxSystemFontCount; ++j) {
-			if (SystemFonts[j] == nullptr) {
+			if ((*SystemFonts)[j] == nullptr) {
 				ID = j;
 				break;
 			}
@@ -177,8 +189,8 @@ bool FontSystem::LoadSystemFont(SystemFontConfig* config){
 
 		// Set the entry id here last before updating the hashtable.
 		Lookup->id = ID;
-		SystemFontMap[Face->name] = ID;
-		SystemFonts[ID] = Lookup;
+		(*SystemFontMap)[Face->name] = ID;
+		(*SystemFonts)[ID] = Lookup;
 	}
 
 	return true;
@@ -186,7 +198,7 @@ bool FontSystem::LoadSystemFont(SystemFontConfig* config){
 
 bool FontSystem::LoadBitmapFont(BitmapFontConfig* config) {
 	// Make sure a font with this name doesn't already exist.
-	if (BitmapFontMap.find(config->name) != BitmapFontMap.end()) {
+	if (BitmapFontMap->find(config->name) != BitmapFontMap->end()) {
 		LOG_WARN("A font named '%s already exists and will not be loaded again.", config->name.c_str());
 		return true;
 	}
@@ -194,7 +206,7 @@ bool FontSystem::LoadBitmapFont(BitmapFontConfig* config) {
 	// Get a new id.
 	unsigned short ID = INVALID_ID_U16;
 	for (unsigned short i = 0; i < Config.maxBitmapFontCount; ++i) {
-		if (BitmapFonts[i] == nullptr) {
+		if ((*BitmapFonts)[i] == nullptr) {
 			ID = i;
 			break;
 		}
@@ -224,22 +236,22 @@ bool FontSystem::LoadBitmapFont(BitmapFontConfig* config) {
 
 	// Set the entry id here last before updating the hastable.
 	Lookup->id = ID;
-	BitmapFontMap[config->name] = ID;
-	BitmapFonts[ID] = Lookup;
+	(*BitmapFontMap)[config->name] = ID;
+	(*BitmapFonts)[ID] = Lookup;
 
 	return Result;
 }
 
 bool FontSystem::Acquire(const std::string& fontName, unsigned short fontSize, class UIText* text) {
 	if (text->Type == UITextType::eUI_Text_Type_Bitmap) {
-		if (BitmapFontMap.find(fontName) == BitmapFontMap.end()) {
+		if (BitmapFontMap->find(fontName) == BitmapFontMap->end()) {
 			LOG_ERROR("A bitmap font named '%s' was not found. Font acquisition failed.", fontName.c_str());
 			return false;
 		}
 
 		// Get the lookup.
-		unsigned short ID = BitmapFontMap[fontName];
-		BitmapFontLookup* Lookup = BitmapFonts[ID];
+		unsigned short ID = (*BitmapFontMap)[fontName];
+		BitmapFontLookup* Lookup = (*BitmapFonts)[ID];
 
 		// Assign the data, increment the reference.
 		text->Data = Lookup->font.resourceData->data;
@@ -248,14 +260,14 @@ bool FontSystem::Acquire(const std::string& fontName, unsigned short fontSize, c
 		return true;
 	}
 	else if (text->Type == UITextType::eUI_Text_Type_system) {
-		if (SystemFontMap.find(fontName) == SystemFontMap.end()) {
+		if (SystemFontMap->find(fontName) == SystemFontMap->end()) {
 			LOG_ERROR("A system font named '%s' was not found. Font acquisition failed.", fontName.c_str());
 			return false;
 		}
 
 		// Get the lookup.
-		unsigned short ID = SystemFontMap[fontName];
-		SystemFontLookup* Lookup = SystemFonts[ID];
+		unsigned short ID = (*SystemFontMap)[fontName];
+		SystemFontLookup* Lookup = (*SystemFonts)[ID];
 
 		// Search the size variants for the correct size.
 		uint32_t Count = (uint32_t)Lookup->sizeVariants.size();
@@ -286,7 +298,7 @@ bool FontSystem::Acquire(const std::string& fontName, unsigned short fontSize, c
 		// Assign the data, increment the reference.
 		text->Data = Lookup->sizeVariants[Length - 1];
 		Lookup->referenceCount++;
-		SystemFonts[ID] = Lookup;
+		(*SystemFonts)[ID] = Lookup;
 		return true;
 	}
 
@@ -307,14 +319,14 @@ bool FontSystem::VerifyAtlas(IFontDataBase* font, const std::string& text) {
 		return true;
 	} 
 	else if (font->type == FontType::eFont_Type_System) {
-		if (SystemFontMap.find(font->face) == SystemFontMap.end()){
+		if (SystemFontMap->find(font->face) == SystemFontMap->end()){
 			LOG_ERROR("A system font named '%s' was not found. Font acquisition failed.", font->face.c_str());
 			return false;
 		}
 
 		// Get the lookup.
-		unsigned short ID = SystemFontMap[font->face];
-		SystemFontLookup* Lookup = SystemFonts[ID];
+		unsigned short ID = (*SystemFontMap)[font->face];
+		SystemFontLookup* Lookup = (*SystemFonts)[ID];
 
 		return VerifySystemFontSizeVariant(Lookup, font, text);
 	}
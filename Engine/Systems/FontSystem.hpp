@@ -3,9 +3,9 @@
 #include "Math/MathTypes.hpp"
 #include "Resources/ResourceTypes.hpp"
 #include "Renderer/RendererTypes.hpp"
+#include "Memory/EngineAllocator.h"
 
 #include <string>
-#include <unordered_map>
 
 class UIText;
 struct BitmapFontLookup;
@@ -83,9 +83,9 @@ private:
 	static IRenderer* Renderer;
 	static FontSystemConfig Config;
 
-	static std::vector<BitmapFontLookup*> BitmapFonts;
-	static std::vector<SystemFontLookup*> SystemFonts;
-	static std::unordered_map<std::string, uint32_t> SystemFontMap;
-	static std::unordered_map<std::string, uint32_t> BitmapFontMap;
+	static TEngineVector<BitmapFontLookup*, eMemory_Type_Bitmap_Font>* BitmapFonts;
+	static TEngineVector<SystemFontLookup*, eMemory_Type_System_Font>* SystemFonts;
+	static TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_System_Font>* SystemFontMap;
+	static TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_Bitmap_Font>* BitmapFontMap;
 
 };
@@ -2,137 +2,965 @@
 
 #include "Core/DMemory.hpp"
 #include "Core/EngineLogger.hpp"
+#include "Core/Console.hpp"
+#include "Core/Metrics.hpp"
+#include "Platform/Platform.hpp"
+#include "Platform/FileSystem.hpp"
 
-bool JobSystem::IsRunning = false;
+#include <thread>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+
+static_assert(MAX_JOB_THREADS <= METRICS_MAX_JOB_THREADS, "Metrics cannot hold every job thread.");
+
+std::atomic<bool> JobSystem::IsRunning = false;
 unsigned char JobSystem::ThreadCount;
-JobThread JobSystem::JobThreads[32];
-std::queue<JobInfo> JobSystem::LowPriorityQueue;
-std::queue<JobInfo> JobSystem::NormalPriorityQueue;
-std::queue<JobInfo> JobSystem::HighPriorityQueue;
-Mutex JobSystem::LowPriQueueMutex;
-Mutex JobSystem::NormalPriQueueMutex;
-Mutex JobSystem::HighPriQueueMutex;
-JobResultEntry JobSystem::PendingResults[MAX_JOB_RESULTS];
-Mutex JobSystem::ResultMutex;
+unsigned char JobSystem::GeneralThreadCount = 0;
+JobThread JobSystem::JobThreads[MAX_JOB_THREADS];
+thread_local JobThread* JobSystem::CurrentThread = nullptr;
+std::atomic<uint32_t> JobSystem::SleepingCount = 0;
+JobRecord* JobSystem::SharedQueueHeads[JOB_PRIORITY_COUNT];
+JobRecord* JobSystem::SharedQueueTails[JOB_PRIORITY_COUNT];
+Mutex JobSystem::SharedQueueMutexes[JOB_PRIORITY_COUNT];
+std::atomic<uint32_t> JobSystem::SharedQueueCounts[JOB_PRIORITY_COUNT];
+MPSCQueue<JobResultEntry> JobSystem::CompletedResults;
+JobRecord* JobSystem::CompletionHead = nullptr;
+JobRecord* JobSystem::CompletionTail = nullptr;
+JobRecord* JobSystem::UploadHead = nullptr;
+JobRecord* JobSystem::UploadTail = nullptr;
+uint32_t JobSystem::BacklogCount = 0;
+bool JobSystem::UploadTurn = false;
+size_t JobSystem::MainThreadID = 0;
+JobRecord* JobSystem::RecordPool = nullptr;
+JobRecord* JobSystem::FreeRecords = nullptr;
+std::atomic_flag JobSystem::FreeRecordLock = ATOMIC_FLAG_INIT;
+bool JobSystem::UseFibers = false;
+JobFiber JobSystem::FiberPool[JOB_FIBER_COUNT];
+JobFiber* JobSystem::FreeFibers = nullptr;
+Mutex JobSystem::FiberMutex;
+std::deque<JobFiber*> JobSystem::ReadyFibers;
+Mutex JobSystem::ReadyFiberMutex;
+std::atomic<uint32_t> JobSystem::ReadyFiberCount = 0;
+std::atomic<bool> JobSystem::TelemetryEnabled = true;
+JobThreadTelemetry JobSystem::ThreadTelemetry[MAX_JOB_THREADS + 1];
+std::atomic<uint32_t> JobSystem::SuspendedCount = 0;
+uint64_t JobSystem::FrameIndex = 0;
+double JobSystem::FrameStartTimes[JOB_TRACE_FRAME_COUNT];
+std::atomic<uint32_t> JobSystem::UpdateIndex = 0;
+
+/**
+ * @brief The shared state of a parallel for. Owned by the caller and its helper jobs, so helpers
+ * which only start after the range is done never touch a dead stack frame.
+ */
+struct ParallelForTask {
+	PFN_ParallelForRange func;
+	size_t begin = 0;
+	size_t end = 0;
+	size_t grain = 1;
+	size_t chunk_count = 0;
+	std::atomic<size_t> next_chunk = 0;
+	std::atomic<size_t> finished_chunks = 0;
+	// The caller and every helper job hold one, the last one to let go deletes the task.
+	std::atomic<uint32_t> references = 0;
+};
+
+static void ReleaseParallelForTask(ParallelForTask* task) {
+	if (task->references.fetch_sub(1) == 1) {
+		DeleteObject(task);
+	}
+}
+
+static void RunParallelForChunks(ParallelForTask* task) {
+	// Claim chunks one at a time, so faster threads simply take more of them.
+	while (true) {
+		size_t Chunk = task->next_chunk.fetch_add(1);
+		if (Chunk >= task->chunk_count) {
+			return;
+		}
+
+		size_t Begin = task->begin + Chunk * task->grain;
+		size_t End = DMIN(Begin + task->grain, task->end);
+		task->func(Begin, End);
+		task->finished_chunks.fetch_add(1, std::memory_order_release);
+	}
+}
+
+static uint64_t SecondsToNanoseconds(double seconds) {
+	return seconds > 0.0 ? (uint64_t)(seconds * 1000000000.0) : 0;
+}
+
+static void AppendJsonString(std::string& json, const char* text) {
+	// Job names come from anywhere, quotes, backslashes and control characters would end the string early.
+	for (const char* c = text; *c != '\0'; ++c) {
+		if (*c == '"' || *c == '\\') {
+			json += '\\';
+			json += *c;
+		}
+		else if ((unsigned char)*c < 0x20) {
+			char Escaped[8];
+			snprintf(Escaped, sizeof(Escaped), "\\u%04x", (unsigned int)*c);
+			json += Escaped;
+		}
+		else {
+			json += *c;
+		}
+	}
+}
+
+static void OnJobTraceCommand(CommandContext context) {
+	// job_trace-<frame count>
+	uint32_t FrameCount = JOB_TRACE_FRAME_COUNT;
+	if (!context.Arguments.empty() && atoi(context.Arguments[0].c_str()) > 0) {
+		FrameCount = (uint32_t)atoi(context.Arguments[0].c_str());
+	}
+
+	const char* Path = "job_trace.json";
+	if (JobSystem::WriteTrace(Path, FrameCount)) {
+		LOG_INFO("Wrote job trace of the last %u frames to %s.", FrameCount, Path);
+	}
+}
 
 uint32_t JobSystem::RunJobThread(void* param) {
-	uint32_t index = *(uint32_t*)param;
+	uint32_t index = *(unsigned char*)param;
 	JobThread* Thr = &JobThreads[index];
+	CurrentThread = Thr;
 	size_t ThreadID = Thr->thread.ThreadID;
-	LOG_INFO("Starting job thread #%i (id=%#x, type=%#x).", Thr->index, ThreadID, Thr->type_mask);
+	LOG_INFO("Starting job thread #%i '%s' (id=%#x, type=%#x, affinity=%#llx).", Thr->index, Thr->name, ThreadID, Thr->type_mask,
+		(unsigned long long)Thr->affinity_mask);
 
-	// A mutex to lock info for this thread.
-	if (!Thr->info_mutex.Create()) {
-		LOG_ERROR("Failed to create job thread mutex! Aborting thread.");
-		return 0;
+	Thread::SetCurrentName(Thr->name);
+	if (Thr->affinity_mask != 0 && !Thread::SetCurrentAffinity(Thr->affinity_mask)) {
+		LOG_WARN("Unable to pin job thread #%i to processors %#llx.", Thr->index, (unsigned long long)Thr->affinity_mask);
 	}
 
+	if (UseFibers && !Thr->thread_fiber.CreateFromThread()) {
+		LOG_ERROR("Job thread #%i failed to become a fiber, its jobs will block while waiting.", Thr->index);
+	}
+	bool FiberMode = Thr->thread_fiber.InternalData != nullptr;
+
 	// Run forever, waiting for jobs,
+	while (IsRunning) {
+		JobRecord* Job = nullptr;
+		JobFiber* Fib = nullptr;
+		if (!AcquireWork(Thr, Job, Fib)) {
+			// Publish that this thread is going to sleep before checking the queues one last time,
+			// so a job submitted in between either gets picked up here or signals the semaphore.
+			Thr->sleeping = true;
+			SleepingCount++;
+			if (!AcquireWork(Thr, Job, Fib)) {
+				Thr->wake_semaphore.Wait();
+				continue;
+			}
+
+			// Work was found after all. If a submitter already consumed the flag, a signal is pending
+			// and the next wait simply returns immediately.
+			if (Thr->sleeping.exchange(false)) {
+				SleepingCount--;
+			}
+		}
+
+		double WorkStart = TelemetryEnabled.load(std::memory_order_relaxed) ? Platform::PlatformGetAbsoluteTime() : 0.0;
+		if (Fib != nullptr) {
+			RunFiber(Thr, Fib);
+		}
+		else {
+			// Without a free fiber the job runs on the thread fiber, and simply blocks if it waits.
+			Fib = FiberMode ? AcquireFiber() : nullptr;
+			if (Fib != nullptr) {
+				Fib->job = Job;
+				Fib->type = Job->type;
+				RunFiber(Thr, Fib);
+			}
+			else {
+				RunJob(Job);
+			}
+		}
+
+		if (WorkStart > 0.0) {
+			uint64_t BusyNs = SecondsToNanoseconds(Platform::PlatformGetAbsoluteTime() - WorkStart);
+			ThreadTelemetry[Thr->index].busy_ns.fetch_add(BusyNs, std::memory_order_relaxed);
+		}
+	}
+
+	if (FiberMode) {
+		Thr->thread_fiber.Destroy();
+	}
+
+	CurrentThread = nullptr;
+	return 1;
+}
+
+bool JobSystem::AcquireWork(JobThread* thr, JobRecord*& out_job, JobFiber*& out_fiber) {
+	// Suspended jobs come first, they are further along than anything still queued.
+	// Only a thread which is a fiber itself can switch to them.
+	out_fiber = thr->thread_fiber.InternalData != nullptr ? PopReadyFiber(thr->type_mask) : nullptr;
+	if (out_fiber != nullptr) {
+		out_job = nullptr;
+		return true;
+	}
+
+	out_job = AcquireJob(thr, thr->type_mask);
+	return out_job != nullptr;
+}
+
+JobThread* JobSystem::GetCurrentThread() {
+	return CurrentThread;
+}
+
+void JobSystem::FiberMain(void* params) {
+	JobFiber* Fib = (JobFiber*)params;
 	while (true) {
-		if (!IsRunning || !Thr) {
-			break;
+		JobRecord* Job = Fib->job;
+		while (Job != nullptr) {
+			RunJob(Job);
+
+			// Keep going on this fiber while there is work and nothing waits to be resumed,
+			// which saves two switches per job.
+			JobThread* Thr = GetCurrentThread();
+			Job = IsRunning && ReadyFiberCount.load() == 0 ? AcquireJob(Thr, Thr->type_mask) : nullptr;
+			if (Job != nullptr) {
+				Fib->type = Job->type;
+			}
 		}
 
-		// Lock and grab a copy of info.
- 		if (!Thr->info_mutex.Lock()) {
-			LOG_ERROR("Failed to obtain lock on job thread mutex!");
+		// Done, hand the fiber back to the thread which returns it to the pool.
+		Fib->job = nullptr;
+		JobThread* Thr = GetCurrentThread();
+		Fiber::Switch(&Fib->fiber, &Thr->thread_fiber);
+	}
+}
+
+JobFiber* JobSystem::AcquireFiber() {
+	FiberMutex.Lock();
+	JobFiber* Fib = FreeFibers;
+	if (Fib != nullptr) {
+		FreeFibers = Fib->next;
+		Fib->next = nullptr;
+	}
+	FiberMutex.UnLock();
+	return Fib;
+}
+
+void JobSystem::ReleaseFiber(JobFiber* fiber) {
+	FiberMutex.Lock();
+	fiber->next = FreeFibers;
+	FreeFibers = fiber;
+	FiberMutex.UnLock();
+}
+
+void JobSystem::RunFiber(JobThread* thr, JobFiber* fiber) {
+	thr->current_fiber = fiber;
+	SScratchStack* ThreadScratch = ScratchAllocator::SetCurrentStack(&fiber->scratch);
+	Fiber::Switch(&thr->thread_fiber, &fiber->fiber);
+	ScratchAllocator::SetCurrentStack(ThreadScratch);
+	thr->current_fiber = nullptr;
+
+	// The fiber either ran out of work or suspended itself on a counter.
+	JobCounter* Counter = fiber->wait_counter;
+	if (Counter == nullptr) {
+		ReleaseFiber(fiber);
+		return;
+	}
+
+	// Park it only now that its context is saved, so no other thread can resume it too early.
+	Counter->Lock();
+	bool Parked = Counter->Value > 0;
+	if (Parked) {
+		fiber->next = Counter->WaitingFibers;
+		Counter->WaitingFibers = fiber;
+	}
+	Counter->Unlock();
+
+	if (!Parked) {
+		ScheduleFiber(fiber);
+	}
+}
+
+void JobSystem::ScheduleFiber(JobFiber* fiber) {
+	JobType Type = fiber->type;
+
+	ReadyFiberMutex.Lock();
+	ReadyFibers.push_back(fiber);
+	ReadyFiberCount++;
+	ReadyFiberMutex.UnLock();
+
+	WakeThread(Type);
+}
+
+JobFiber* JobSystem::PopReadyFiber(uint32_t type_mask) {
+	if (ReadyFiberCount.load() == 0) {
+		return nullptr;
+	}
+
+	JobFiber* Fib = nullptr;
+	ReadyFiberMutex.Lock();
+	for (auto it = ReadyFibers.begin(); it != ReadyFibers.end(); ++it) {
+		if ((type_mask & (uint32_t)(*it)->type) != 0) {
+			Fib = *it;
+			ReadyFibers.erase(it);
+			ReadyFiberCount--;
 			break;
 		}
+	}
+	ReadyFiberMutex.UnLock();
 
-		JobInfo info = Thr->info;
-		if (!Thr->info_mutex.UnLock()) {
-			LOG_ERROR("Failed to release lock on job thread mutex!");
-			break;
+	return Fib;
+}
+
+void JobSystem::RunJob(JobRecord* job) {
+	if (IsCancelled(job)) {
+		CancelJob(job);
+		return;
+	}
+
+	bool Telemetry = TelemetryEnabled.load(std::memory_order_relaxed);
+	double StartTime = Telemetry ? Platform::PlatformGetAbsoluteTime() : 0.0;
+	bool Result = job->entry(job->payload, job->context);
+	if (Telemetry) {
+		RecordJob(job, StartTime, Platform::PlatformGetAbsoluteTime(), Result);
+	}
+
+	// Queue the callback to be executed on the main thread later. The record carries
+	// the results, so the callback holds a reference of its own until it ran.
+	job->succeeded.store(Result, std::memory_order_relaxed);
+	PFN_JobComplete Callback = Result ? job->on_success : job->on_failed;
+	if (Callback != nullptr) {
+		job->references.fetch_add(1, std::memory_order_relaxed);
+		StoreResult(Callback, job);
+	}
+
+	if (job->signal_counter != nullptr) {
+		SignalCounter(job->signal_counter);
+	}
+	SignalCounter(&job->finished);
+	ReleaseRecord(job);
+}
+
+bool JobSystem::IsCancelled(const JobRecord* job) {
+	if (job->cancel_requested.load(std::memory_order_relaxed)) {
+		return true;
+	}
+	if (job->cancel_token != nullptr && job->cancel_token->IsCancelled()) {
+		return true;
+	}
+	return job->deadline > 0.0 && Platform::PlatformGetAbsoluteTime() > job->deadline;
+}
+
+void JobSystem::CancelJob(JobRecord* job) {
+	JobThread* Thr = GetCurrentThread();
+	ThreadTelemetry[Thr != nullptr ? Thr->index : MAX_JOB_THREADS].jobs_cancelled.fetch_add(1, std::memory_order_relaxed);
+
+	job->discarded = true;
+	if (job->signal_counter != nullptr) {
+		SignalCounter(job->signal_counter);
+	}
+	SignalCounter(&job->finished);
+
+	ReleaseRecord(job);
+}
+
+void JobSystem::PromoteAgedJobs() {
+	uint32_t Update = UpdateIndex.load(std::memory_order_relaxed);
+	// Normal before low, so a job climbs at most one level per update.
+	for (int p = (int)JobPriority::eNormal; p >= (int)JobPriority::eLow; --p) {
+		if (SharedQueueCounts[p].load() == 0) {
+			continue;
+		}
+
+		// Queues are in submission order, so the aged jobs are at the front.
+		JobRecord* AgedHead = nullptr;
+		JobRecord* AgedTail = nullptr;
+		uint32_t AgedCount = 0;
+		SharedQueueMutexes[p].Lock();
+		while (SharedQueueHeads[p] != nullptr && Update - SharedQueueHeads[p]->ready_update >= JOB_AGING_UPDATES) {
+			AgedTail = SharedQueueHeads[p];
+			AgedHead = AgedHead != nullptr ? AgedHead : AgedTail;
+			SharedQueueHeads[p] = AgedTail->next;
+			AgedCount++;
 		}
+		if (SharedQueueHeads[p] == nullptr) {
+			SharedQueueTails[p] = nullptr;
+		}
+		SharedQueueCounts[p] -= AgedCount;
+		SharedQueueMutexes[p].UnLock();
 
-		if (info.entry_point) {
-			bool Result = info.entry_point(info.param_data.get(), info.result_data.get());
+		if (AgedHead == nullptr) {
+			continue;
+		}
 
-			// Store the result to be executed on the main thread later.
-			// Note that store_result takes a copy of the result_data so it does
-			// not have to be held onto by this thread any longer.
-			if (Result && info.on_success) {
-				StoreResult(info.on_success, info.result_data, info.result_data_size);
-			}
-			else if (!Result && info.on_failed) {
-				StoreResult(info.on_failed, info.result_data, info.result_data_size);
-			}
+		// They wait behind the jobs already queued at the next level, and age from scratch there.
+		AgedTail->next = nullptr;
+		for (JobRecord* It = AgedHead; It != nullptr; It = It->next) {
+			It->priority = (JobPriority)(p + 1);
+			It->ready_update = Update;
+		}
+
+		SharedQueueMutexes[p + 1].Lock();
+		if (SharedQueueTails[p + 1] != nullptr) {
+			SharedQueueTails[p + 1]->next = AgedHead;
+		}
+		else {
+			SharedQueueHeads[p + 1] = AgedHead;
+		}
+		SharedQueueTails[p + 1] = AgedTail;
+		SharedQueueCounts[p + 1] += AgedCount;
+		SharedQueueMutexes[p + 1].UnLock();
+	}
+}
+
+void JobSystem::RecordJob(const JobRecord* job, double start_time, double end_time, bool succeeded) {
+	// Read after the job ran, a job suspended in fiber mode may have ended on another thread.
+	JobThread* Thr = GetCurrentThread();
+	JobThreadTelemetry& Telemetry = ThreadTelemetry[Thr != nullptr ? Thr->index : MAX_JOB_THREADS];
+
+	uint64_t WaitNs = job->submit_time > 0.0 ? SecondsToNanoseconds(start_time - job->submit_time) : 0;
+	Telemetry.jobs_run.fetch_add(1, std::memory_order_relaxed);
+	Telemetry.wait_ns.fetch_add(WaitNs, std::memory_order_relaxed);
+	Telemetry.run_ns.fetch_add(SecondsToNanoseconds(end_time - start_time), std::memory_order_relaxed);
+	uint64_t MaxWaitNs = Telemetry.max_wait_ns.load(std::memory_order_relaxed);
+	while (WaitNs > MaxWaitNs && !Telemetry.max_wait_ns.compare_exchange_weak(MaxWaitNs, WaitNs, std::memory_order_relaxed)) {}
+
+	JobTraceEvent Event;
+	Event.name = job->name;
+	Event.entry = job->entry;
+	Event.submit_time = job->submit_time;
+	Event.start_time = start_time;
+	Event.end_time = end_time;
+	Event.type = job->type;
+	Event.priority = job->priority;
+	Event.succeeded = succeeded;
+	Telemetry.trace.Push(Event);
+}
+
+void JobSystem::PublishMetrics(double now) {
+	SJobMetrics Jobs;
+	for (int p = 0; p < JOB_PRIORITY_COUNT; ++p) {
+		Jobs.queued_jobs[p] = SharedQueueCounts[p].load();
+		for (unsigned char i = 0; i < ThreadCount; ++i) {
+			Jobs.queued_jobs[p] += (uint32_t)JobThreads[i].local_queues[p].Size();
+		}
+	}
+	Jobs.suspended_jobs = SuspendedCount.load();
+	Jobs.pending_results = (uint32_t)CompletedResults.Size() + BacklogCount;
+	Jobs.thread_count = ThreadCount;
+
+	// Take the counters of the frame that just ended and start over.
+	double FrameTime = now - FrameStartTimes[FrameIndex % JOB_TRACE_FRAME_COUNT];
+	uint64_t JobsRun = 0;
+	uint64_t JobsCancelled = 0;
+	uint64_t WaitNs = 0;
+	uint64_t MaxWaitNs = 0;
+	uint64_t RunNs = 0;
+	for (unsigned char i = 0; i <= ThreadCount; ++i) {
+		// The last entry collects the jobs run on any other thread.
+		JobThreadTelemetry& Telemetry = ThreadTelemetry[i < ThreadCount ? i : MAX_JOB_THREADS];
+		JobsRun += Telemetry.jobs_run.exchange(0, std::memory_order_relaxed);
+		JobsCancelled += Telemetry.jobs_cancelled.exchange(0, std::memory_order_relaxed);
+		WaitNs += Telemetry.wait_ns.exchange(0, std::memory_order_relaxed);
+		uint64_t ThreadMaxWaitNs = Telemetry.max_wait_ns.exchange(0, std::memory_order_relaxed);
+		MaxWaitNs = DMAX(MaxWaitNs, ThreadMaxWaitNs);
+		RunNs += Telemetry.run_ns.exchange(0, std::memory_order_relaxed);
+
+		uint64_t BusyNs = Telemetry.busy_ns.exchange(0, std::memory_order_relaxed);
+		if (i < ThreadCount && FrameTime > 0.0) {
+			// Work is counted when it ends, so a job spanning frames is only seen by the last one.
+			Jobs.thread_utilization[i] = (float)DMIN(BusyNs / (FrameTime * 1000000000.0), 1.0);
+		}
+	}
+
+	Jobs.finished_jobs = (uint32_t)JobsRun;
+	Jobs.cancelled_jobs = (uint32_t)JobsCancelled;
+	if (JobsRun > 0) {
+		Jobs.avg_wait_ms = WaitNs / 1000000.0 / JobsRun;
+		Jobs.avg_run_ms = RunNs / 1000000.0 / JobsRun;
+	}
+	Jobs.max_wait_ms = MaxWaitNs / 1000000.0;
+
+	Metrics::UpdateJobs(Jobs);
+}
 
-			// Clear the param data and result data.
-			if (info.param_data) {
-				info.param_data.reset();
+void JobSystem::EnableTelemetry(bool enabled) {
+	TelemetryEnabled = enabled;
+}
+
+bool JobSystem::WriteTrace(const char* path, uint32_t frame_count) {
+	if (!IsRunning) {
+		LOG_ERROR("Job system is not running, no trace to write.");
+		return false;
+	}
+
+	// The last finished frames plus the current one. The oldest frame still known bounds the trace.
+	uint64_t FrameCount = DMIN((uint64_t)DMAX(frame_count, 1u), (uint64_t)JOB_TRACE_FRAME_COUNT - 1);
+	FrameCount = DMIN(FrameCount, FrameIndex);
+	uint64_t FirstFrame = FrameIndex - FrameCount;
+	double TraceStart = FrameStartTimes[FirstFrame % JOB_TRACE_FRAME_COUNT];
+
+	char Line[512];
+	std::string Json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	for (unsigned char i = 0; i <= ThreadCount; ++i) {
+		int ThreadIndex = i < ThreadCount ? i : MAX_JOB_THREADS;
+		if (i < ThreadCount) {
+			snprintf(Line, sizeof(Line), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"%s\"}},\n", ThreadIndex, JobThreads[i].name);
+		}
+		else {
+			snprintf(Line, sizeof(Line), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"Other threads\"}},\n", ThreadIndex);
+		}
+		Json += Line;
+	}
+
+	// Frame boundaries as global instant events.
+	for (uint64_t f = FirstFrame; f <= FrameIndex; ++f) {
+		double FrameStart = FrameStartTimes[f % JOB_TRACE_FRAME_COUNT];
+		snprintf(Line, sizeof(Line), "{\"name\":\"Frame %llu\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%.3f},\n",
+			(unsigned long long)f, (FrameStart - TraceStart) * 1000000.0);
+		Json += Line;
+	}
+
+	uint32_t EventCount = 0;
+	for (unsigned char i = 0; i <= ThreadCount; ++i) {
+		int ThreadIndex = i < ThreadCount ? i : MAX_JOB_THREADS;
+		const JobTraceBuffer& Trace = ThreadTelemetry[ThreadIndex].trace;
+		if (Trace.slots == nullptr) {
+			continue;
+		}
+
+		// Jobs keep finishing while this runs, events overwritten meanwhile are skipped.
+		uint64_t End = Trace.write_index.load(std::memory_order_acquire);
+		uint64_t Begin = End > JOB_TRACE_CAPACITY ? End - JOB_TRACE_CAPACITY : 0;
+		for (uint64_t e = Begin; e < End; ++e) {
+			JobTraceEvent Event;
+			if (!Trace.Read(e, Event) || Event.end_time < TraceStart) {
+				continue;
 			}
-			if (info.result_data) {
-				info.result_data.reset();
+
+			char Name[64];
+			if (Event.name == nullptr) {
+				snprintf(Name, sizeof(Name), "Job %p", (void*)Event.entry);
 			}
+			double WaitUs = Event.submit_time > 0.0 ? (Event.start_time - Event.submit_time) * 1000000.0 : 0.0;
+			Json += "{\"name\":\"";
+			AppendJsonString(Json, Event.name != nullptr ? Event.name : Name);
+			snprintf(Line, sizeof(Line), "\",\"cat\":\"job\",\"ph\":\"X\",\"pid\":1,\"tid\":%i,\"ts\":%.3f,\"dur\":%.3f,"
+				"\"args\":{\"wait_us\":%.3f,\"type\":%i,\"priority\":%i,\"succeeded\":%s}},\n",
+				ThreadIndex, (Event.start_time - TraceStart) * 1000000.0,
+				(Event.end_time - Event.start_time) * 1000000.0, WaitUs, (int)Event.type, (int)Event.priority,
+				Event.succeeded ? "true" : "false");
+			Json += Line;
+			EventCount++;
+		}
+	}
 
-			// Lock and reset the thread's info object.
-			if (!Thr->info_mutex.Lock()) {
-				LOG_ERROR("Failed to obtain lock on job thread mutex!");
-				break;
+	// Close the array without a trailing comma.
+	Json.resize(Json.size() - 2);
+	Json += "\n]}\n";
+
+	FileHandle Handle;
+	if (!FileSystemOpen(path, eFile_Mode_Write, false, &Handle)) {
+		LOG_ERROR("Unable to open %s to write the job trace.", path);
+		return false;
+	}
+
+	size_t Written = 0;
+	bool Result = FileSystemWrite(&Handle, Json.size(), (void*)Json.data(), &Written) && Written == Json.size();
+	FileSystemClose(&Handle);
+	if (!Result) {
+		LOG_ERROR("Failed to write the job trace to %s.", path);
+		return false;
+	}
+
+	LOG_DEBUG("Job trace holds %u jobs over %u frames.", EventCount, (uint32_t)FrameCount);
+	return true;
+}
+
+void JobSystem::ReleaseTraceBuffers() {
+	Console::UnregisterCommand("job_trace");
+	for (int i = 0; i <= MAX_JOB_THREADS; ++i) {
+		JobTraceBuffer& Trace = ThreadTelemetry[i].trace;
+		if (Trace.slots != nullptr) {
+			Memory::FreeAligned(Trace.slots, sizeof(JobTraceBuffer::Slot) * JOB_TRACE_CAPACITY, alignof(JobTraceBuffer::Slot), MemoryType::eMemory_Type_Job);
+			Trace.slots = nullptr;
+		}
+	}
+}
+
+JobRecord* JobSystem::AcquireRecord() {
+	while (FreeRecordLock.test_and_set(std::memory_order_acquire)) {}
+	JobRecord* Record = FreeRecords;
+	if (Record != nullptr) {
+		FreeRecords = Record->next;
+	}
+	FreeRecordLock.clear(std::memory_order_release);
+
+	if (Record == nullptr) {
+		// More jobs in flight than the pool holds.
+		Record = new(Memory::AllocateAligned(sizeof(JobRecord), alignof(JobRecord), MemoryType::eMemory_Type_Job)) JobRecord();
+		Record->from_heap = true;
+	}
+
+	Record->next = nullptr;
+	return Record;
+}
+
+void JobSystem::ReleaseRecord(JobRecord* record) {
+	// The release orders this thread's use of the record before whoever reuses it.
+	if (record->references.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+		return;
+	}
+
+	if (record->from_heap) {
+		record->~JobRecord();
+		Memory::FreeAligned(record, sizeof(JobRecord), alignof(JobRecord), MemoryType::eMemory_Type_Job);
+		return;
+	}
+
+	while (FreeRecordLock.test_and_set(std::memory_order_acquire)) {}
+	record->next = FreeRecords;
+	FreeRecords = record;
+	FreeRecordLock.clear(std::memory_order_release);
+}
+
+bool JobSystem::MainThreadContinuationStart(void* /*payload*/, void* /*context*/) {
+	return true;
+}
+
+void JobSystem::SignalCounter(JobCounter* counter) {
+	// NOTE: The counter is only touched under its lock, since a waiter may destroy
+	// it as soon as it observes zero.
+	counter->Lock();
+	JobRecord* Released = nullptr;
+	JobFiber* ReleasedFibers = nullptr;
+	counter->Value--;
+	if (counter->Value == 0) {
+		Released = counter->WaitingJobs;
+		counter->WaitingJobs = nullptr;
+		ReleasedFibers = counter->WaitingFibers;
+		counter->WaitingFibers = nullptr;
+	}
+	counter->Unlock();
+
+	while (ReleasedFibers != nullptr) {
+		JobFiber* Next = ReleasedFibers->next;
+		ReleasedFibers->next = nullptr;
+		ScheduleFiber(ReleasedFibers);
+		ReleasedFibers = Next;
+	}
+
+	// Dependents start right away from this thread, there is no need to wait for the next update.
+	while (Released != nullptr) {
+		JobRecord* Next = Released->next;
+		Released->next = nullptr;
+		Schedule(Released);
+		Released = Next;
+	}
+}
+
+void JobSystem::WaitForCounter(JobCounter* counter, bool help) {
+	if (counter == nullptr) {
+		return;
+	}
+
+	JobThread* Thr = GetCurrentThread();
+	if (Thr != nullptr && Thr->current_fiber != nullptr) {
+		if (counter->IsDone()) {
+			return;
+		}
+
+		// Suspend the job, the thread parks the fiber on the counter and carries on with other work.
+		JobFiber* Fib = Thr->current_fiber;
+		Fib->wait_counter = counter;
+		SuspendedCount++;
+		Fiber::Switch(&Fib->fiber, &Thr->thread_fiber);
+
+		// Resumed by the last job signaling the counter, possibly on another thread.
+		SuspendedCount--;
+		Fib->wait_counter = nullptr;
+		return;
+	}
+
+	// Help out with queued work while waiting. Threads which are not job threads only help with general jobs.
+	uint32_t TypeMask = Thr != nullptr ? Thr->type_mask : (uint32_t)JobType::eGeneral;
+	while (!counter->IsDone()) {
+		JobRecord* Job = nullptr;
+		JobFiber* Fib = nullptr;
+		if (help && Thr != nullptr && AcquireWork(Thr, Job, Fib)) {
+			// On the thread fiber here, so suspended fibers can be resumed as well.
+			if (Fib != nullptr) {
+				RunFiber(Thr, Fib);
 			}
-			Thr->info.Release();
-			Memory::Zero(&Thr->info, sizeof(JobInfo));
-			if (!Thr->info_mutex.UnLock()) {
-				LOG_ERROR("Failed to release lock on job thread mutex!");
-				break;
+			else {
+				RunJob(Job);
 			}
 		}
-
-		if (IsRunning) {
-			// TODO: Should probably find a better way to do this. such as sleeping until
-			// a request comes through for a new job.
-			Thr->thread.Sleep(10);
+		else if (help && Thr == nullptr && (Job = AcquireJob(nullptr, TypeMask)) != nullptr) {
+			RunJob(Job);
+		}
+		else if (Thr == nullptr && Thread::GetThreadID() == MainThreadID && DrainResults() > 0) {
+			// Jobs stuck on a full completion queue can only finish once the main thread drains it.
 		}
 		else {
-			break;
+			std::this_thread::yield();
 		}
 	}
+}
 
-	// Destroy the mutex for this thread.
-	Thr->info_mutex.Destroy();
-	return 1;
+bool JobSystem::ParallelForJobStart(void* payload, void* /*context*/) {
+	ParallelForTask* Task = *(ParallelForTask**)payload;
+	RunParallelForChunks(Task);
+	ReleaseParallelForTask(Task);
+	return true;
 }
 
-bool JobSystem::Initialize(unsigned char job_thread_count, unsigned int type_masks[]) {
+void JobSystem::ParallelFor(size_t begin, size_t end, size_t grain, PFN_ParallelForRange func) {
+	if (end <= begin || !func) {
+		return;
+	}
+
+	grain = DMAX(grain, (size_t)1);
+	size_t ChunkCount = (end - begin + grain - 1) / grain;
+	if (ChunkCount == 1 || !IsRunning || GeneralThreadCount == 0) {
+		func(begin, end);
+		return;
+	}
+
+	ParallelForTask* Task = NewObject<ParallelForTask>();
+	Task->func = std::move(func);
+	Task->begin = begin;
+	Task->end = end;
+	Task->grain = grain;
+	Task->chunk_count = ChunkCount;
+
+	// One helper per general thread at most, each helper keeps claiming chunks until none are left.
+	size_t HelperCount = DMIN(ChunkCount - 1, (size_t)GeneralThreadCount);
+	Task->references = (uint32_t)HelperCount + 1;
+	JobDesc Desc;
+	Desc.priority = JobPriority::eHigh;
+	Desc.name = "ParallelFor";
+	for (size_t i = 0; i < HelperCount; ++i) {
+		Submit(ParallelForJobStart, Task, Desc);
+	}
+
+	RunParallelForChunks(Task);
+
+	// Every chunk not finished yet is already running on another thread, so there is nothing
+	// left to help with. Picking up unrelated jobs here would only delay the return.
+	while (Task->finished_chunks.load(std::memory_order_acquire) != ChunkCount) {
+		std::this_thread::yield();
+	}
+
+	ReleaseParallelForTask(Task);
+}
+
+unsigned char JobSystem::PlanThreads(const JobSystemConfig& config, const SProcessorTopology& topology,
+	unsigned int out_type_masks[MAX_JOB_THREADS], uint64_t out_affinity_masks[MAX_JOB_THREADS]) {
+	// The main thread keeps the first core, a dedicated GPU thread the second.
+	int CoreCount = DMAX(topology.core_count, 1);
+	int ReservedCores = config.dedicated_gpu_thread ? 2 : 1;
+	int GPUCount = config.dedicated_gpu_thread ? 1 : 0;
+	int IOCount = DMAX((int)config.io_thread_count, 1);
+	int ComputeCount = config.compute_thread_count > 0 ? config.compute_thread_count : DMAX(CoreCount - ReservedCores, 1);
+	ComputeCount = DMIN(ComputeCount, MAX_JOB_THREADS - GPUCount - IOCount);
+
+	// Pinning needs to know which logical processors make up each core.
+	bool Pin = config.pin_threads && topology.core_masks[0] != 0;
+	uint64_t AllProcessors = 0;
+	for (int c = 0; c < topology.core_count; ++c) {
+		AllProcessors |= topology.core_masks[c];
+	}
+
+	unsigned char Count = 0;
+	if (GPUCount > 0) {
+		out_type_masks[Count] = (unsigned int)JobType::eGPU_Resource;
+		out_affinity_masks[Count] = Pin && CoreCount > 1 ? topology.core_masks[1] : 0;
+		Count++;
+	}
+
+	// Compute threads take the first hardware thread of every core after the reserved ones.
+	// Only as many as there are cores get pinned, the rest float.
+	uint64_t ComputeProcessors = 0;
+	unsigned char FirstCompute = Count + (unsigned char)IOCount;
+	for (int i = 0; i < ComputeCount; ++i) {
+		int Core = ReservedCores + i;
+		uint64_t Mask = 0;
+		if (Pin && Core < CoreCount) {
+			uint64_t CoreMask = topology.core_masks[Core];
+			// Lowest set bit.
+			Mask = CoreMask & (~CoreMask + 1);
+		}
+		out_type_masks[FirstCompute + i] = (unsigned int)JobType::eGeneral;
+		out_affinity_masks[FirstCompute + i] = Mask;
+		ComputeProcessors |= Mask;
+	}
+
+	// I/O threads may run anywhere but on the hardware threads taken by compute threads.
+	uint64_t IOProcessors = Pin ? AllProcessors & ~ComputeProcessors : 0;
+	for (int i = 0; i < IOCount; ++i) {
+		out_type_masks[Count] = (unsigned int)JobType::eResource_Load;
+		if (i == 0 && GPUCount == 0) {
+			out_type_masks[Count] |= (unsigned int)JobType::eGPU_Resource;
+		}
+		out_affinity_masks[Count] = IOProcessors;
+		Count++;
+	}
+
+	return Count + (unsigned char)ComputeCount;
+}
+
+bool JobSystem::Initialize(const JobSystemConfig& config) {
+	SProcessorTopology Topology;
+	if (!Platform::GetProcessorTopology(&Topology)) {
+		LOG_WARN("Processor topology unknown, job threads are not pinned.");
+	}
+	LOG_INFO("%i logical processors on %i physical cores available.", Topology.logical_count, Topology.core_count);
+
+	unsigned int TypeMasks[MAX_JOB_THREADS];
+	uint64_t AffinityMasks[MAX_JOB_THREADS];
+	unsigned char Count = PlanThreads(config, Topology, TypeMasks, AffinityMasks);
+	return Initialize(Count, TypeMasks, config.use_fibers, AffinityMasks);
+}
+
+unsigned char JobSystem::GetThreadCount() {
+	return ThreadCount;
+}
+
+bool JobSystem::Initialize(unsigned char job_thread_count, unsigned int type_masks[], bool use_fibers, const uint64_t affinity_masks[]) {
+	if (job_thread_count > MAX_JOB_THREADS) {
+		LOG_WARN("Requested %i job threads, capped at %i.", job_thread_count, MAX_JOB_THREADS);
+		job_thread_count = MAX_JOB_THREADS;
+	}
+
 	IsRunning = true;
 	ThreadCount = job_thread_count;
+	GeneralThreadCount = 0;
+	SleepingCount = 0;
+
+	MainThreadID = Thread::GetThreadID();
+
+	UpdateIndex = 0;
+
+	// Telemetry slots of job threads, plus the one shared by every other thread.
+	SuspendedCount = 0;
+	FrameIndex = 0;
+	FrameStartTimes[0] = Platform::PlatformGetAbsoluteTime();
+	for (int i = 0; i <= MAX_JOB_THREADS; ++i) {
+		JobThreadTelemetry& Telemetry = ThreadTelemetry[i];
+		Telemetry.jobs_run = 0;
+		Telemetry.jobs_cancelled = 0;
+		Telemetry.wait_ns = 0;
+		Telemetry.max_wait_ns = 0;
+		Telemetry.run_ns = 0;
+		Telemetry.busy_ns = 0;
+		Telemetry.trace.write_index = 0;
+		if (i < job_thread_count || i == MAX_JOB_THREADS) {
+			size_t TraceSize = sizeof(JobTraceBuffer::Slot) * JOB_TRACE_CAPACITY;
+			Telemetry.trace.slots = (JobTraceBuffer::Slot*)Memory::AllocateAligned(TraceSize, alignof(JobTraceBuffer::Slot), MemoryType::eMemory_Type_Job);
+			for (int s = 0; s < JOB_TRACE_CAPACITY; ++s) {
+				new(&Telemetry.trace.slots[s]) JobTraceBuffer::Slot();
+				Telemetry.trace.slots[s].sequence.store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+	Console::RegisterCommand("job_trace", 1, OnJobTraceCommand);
+
+	// Every record starts out in the free list.
+	// The payload is 16 byte aligned, so is the pool. Memory::Allocate() does not align.
+	RecordPool = (JobRecord*)Memory::AllocateAligned(sizeof(JobRecord) * JOB_POOL_SIZE, alignof(JobRecord), MemoryType::eMemory_Type_Job);
+	FreeRecords = nullptr;
+	for (int i = JOB_POOL_SIZE - 1; i >= 0; --i) {
+		new(&RecordPool[i]) JobRecord();
+		RecordPool[i].next = FreeRecords;
+		FreeRecords = &RecordPool[i];
+	}
+
+	if (!CompletedResults.Create(MAX_JOB_RESULTS)) {
+		LOG_ERROR("Failed to create job completion queue!");
+		ReleaseTraceBuffers();
+		return false;
+	}
 
-	// Invalidate all result slots.
-	for (unsigned short i = 0; i < MAX_JOB_RESULTS; ++i) {
-		PendingResults[i].id = INVALID_ID_U16;
+	// Create needed mutexes. The job threads start pulling from the queues immediately.
+	for (int p = 0; p < JOB_PRIORITY_COUNT; ++p) {
+		SharedQueueHeads[p] = nullptr;
+		SharedQueueTails[p] = nullptr;
+		SharedQueueCounts[p] = 0;
+		if (!SharedQueueMutexes[p].Create()) {
+			LOG_ERROR("Failed to create job queue mutex!");
+			ReleaseTraceBuffers();
+			return false;
+		}
+	}
+
+	UseFibers = use_fibers;
+	FreeFibers = nullptr;
+	ReadyFiberCount = 0;
+	if (UseFibers) {
+		if (!FiberMutex.Create() || !ReadyFiberMutex.Create()) {
+			LOG_ERROR("Failed to create fiber mutexes!");
+			ReleaseTraceBuffers();
+			return false;
+		}
+
+		for (int i = JOB_FIBER_COUNT - 1; i >= 0; --i) {
+			if (!FiberPool[i].fiber.Create(FiberMain, &FiberPool[i], JOB_FIBER_STACK_SIZE)) {
+				LOG_ERROR("Failed to create job fiber!");
+				ReleaseTraceBuffers();
+				return false;
+			}
+			FiberPool[i].next = FreeFibers;
+			FreeFibers = &FiberPool[i];
+		}
 	}
 
 	LOG_INFO("Main thread id is: %#x.", Thread::GetThreadID());
 	LOG_DEBUG("Spawning %i job threads.", ThreadCount);
 
+	// Set up every thread before starting any, since they steal from each other.
 	for (unsigned char i = 0; i < ThreadCount; ++i) {
 		JobThreads[i].index = i;
 		JobThreads[i].type_mask = type_masks[i];
-		if (!JobThreads[i].thread.Create(RunJobThread, &JobThreads[i].index, false)) {
-			LOG_FATAL("OS Error in creating job thread. Application cannot continue.");
+		JobThreads[i].affinity_mask = affinity_masks != nullptr ? affinity_masks[i] : 0;
+		const char* Role = "Job";
+		if (type_masks[i] == (uint32_t)JobType::eGeneral) {
+			Role = "Compute";
+		}
+		else if ((type_masks[i] & (uint32_t)JobType::eResource_Load) != 0) {
+			Role = "IO";
+		}
+		else if (type_masks[i] == (uint32_t)JobType::eGPU_Resource) {
+			Role = "GPU";
+		}
+		snprintf(JobThreads[i].name, sizeof(JobThreads[i].name), "%s #%i", Role, i);
+		if ((type_masks[i] & (uint32_t)JobType::eGeneral) != 0) {
+			GeneralThreadCount++;
+		}
+		JobThreads[i].sleeping = false;
+		if (!JobThreads[i].wake_semaphore.Create(INVALID_ID >> 1, 0)) {
+			LOG_FATAL("Failed to create job thread semaphore. Application cannot continue.");
+			ReleaseTraceBuffers();
 			return false;
 		}
 
-		Memory::Zero(&JobThreads[i].info, sizeof(JobInfo));
+		for (int p = 0; p < JOB_PRIORITY_COUNT; ++p) {
+			if (!JobThreads[i].local_queues[p].Create(JOB_LOCAL_QUEUE_CAPACITY)) {
+				LOG_FATAL("Failed to create job thread queue. Application cannot continue.");
+				ReleaseTraceBuffers();
+				return false;
+			}
+		}
 	}
 
-	// Create needed mutexes.
-	if (!ResultMutex.Create()) {
-		LOG_ERROR("Failed to create result mutex!");
-		return false;
-	}
-	if (!LowPriQueueMutex.Create()) {
-		LOG_ERROR("Failed to create low priority queue mutex!");
-		return false;
-	}
-	if (!NormalPriQueueMutex.Create()) {
-		LOG_ERROR("Failed to create normal priority queue mutex!");
-		return false;
-	}
-	if (!HighPriQueueMutex.Create()) {
-		LOG_ERROR("Failed to create high priority queue mutex!");
-		return false;
+	for (unsigned char i = 0; i < ThreadCount; ++i) {
+		if (!JobThreads[i].thread.Create(RunJobThread, &JobThreads[i].index, false)) {
+			LOG_FATAL("OS Error in creating job thread. Application cannot continue.");
+			// The threads already started use the trace buffers, stop them first.
+			IsRunning = false;
+			for (unsigned char t = 0; t < i; ++t) {
+				JobThreads[t].wake_semaphore.Signal();
+				JobThreads[t].thread.Join();
+			}
+			ReleaseTraceBuffers();
+			return false;
+		}
 	}
 
 	return true;
@@ -145,174 +973,486 @@ void JobSystem::Shutdown() {
 
 	IsRunning = false;
 
-	// Check for a free thread first.
+	// Wake every thread so it can observe the shutdown and leave its loop.
 	for (unsigned char i = 0; i < ThreadCount; ++i) {
-		JobThreads[i].thread.Destroy();
-	}
-
-	for (uint32_t i = 0; i < LowPriorityQueue.size(); ++i) {
-		JobInfo* Temp = nullptr;
-		LowPriorityQueue.pop();
-        if (Temp != nullptr){
-            Temp->Release();
-            Temp = nullptr;
-        }
-
-		NormalPriorityQueue.pop();
-        if (Temp != nullptr){
-            Temp->Release();
-            Temp = nullptr;
-        }
-        
-		HighPriorityQueue.pop();
-        if (Temp != nullptr){
-            Temp->Release();
-            Temp = nullptr;
-        }
-	}
-
-	// Destroy mutexes
-	ResultMutex.Destroy();
-	LowPriQueueMutex.Destroy();
-	NormalPriQueueMutex.Destroy();
-	HighPriQueueMutex.Destroy();
-}
-
-void JobSystem::ProcessQueue(std::queue<JobInfo>& queue, Mutex* queue_mutex) {
-	// Check for a free thread first.
-	while (queue.size() > 0) {
-		JobInfo info = queue.front();
-		bool ThreadFound = false;
-		for (unsigned char i = 0; i < ThreadCount; ++i) {
-			JobThread* thread = &JobThreads[i];
-			if ((thread->type_mask & (uint32_t)info.type) == 0) {
-				continue;
-			}
+		JobThreads[i].wake_semaphore.Signal();
+	}
+
+	// Everything below is shared with the threads, so none of it may go before the last of them has returned.
+	for (unsigned char i = 0; i < ThreadCount; ++i) {
+		JobThreads[i].thread.Join();
+	}
 
-			// Check that the job thread can handle the job type.
-			if (!thread->info_mutex.Lock()) {
-				LOG_ERROR("Failed to obtain lock on job thread mutex!");
+	// Release jobs which never got to run.
+	for (unsigned char i = 0; i < ThreadCount; ++i) {
+		for (int p = 0; p < JOB_PRIORITY_COUNT; ++p) {
+			JobRecord* Job = nullptr;
+			while (JobThreads[i].local_queues[p].Steal(Job)) {
+				ReleaseRecord(Job);
 			}
+			JobThreads[i].local_queues[p].Destroy();
+		}
+		JobThreads[i].wake_semaphore.Destroy();
+	}
+
+	for (int p = 0; p < JOB_PRIORITY_COUNT; ++p) {
+		while (SharedQueueHeads[p] != nullptr) {
+			JobRecord* Next = SharedQueueHeads[p]->next;
+			ReleaseRecord(SharedQueueHeads[p]);
+			SharedQueueHeads[p] = Next;
+		}
+		SharedQueueTails[p] = nullptr;
+		SharedQueueCounts[p] = 0;
+		SharedQueueMutexes[p].Destroy();
+	}
+
+	if (UseFibers) {
+		// Jobs still suspended at this point never finish.
+		if (ReadyFiberCount.load() > 0) {
+			LOG_WARN("Job system shut down with %i suspended jobs.", ReadyFiberCount.load());
+		}
+		ReadyFibers.clear();
+		ReadyFiberCount = 0;
+
+		for (int i = 0; i < JOB_FIBER_COUNT; ++i) {
+			FiberPool[i].fiber.Destroy();
+			ScratchAllocator::ReleaseStack(&FiberPool[i].scratch);
+			FiberPool[i].job = nullptr;
+			FiberPool[i].wait_counter = nullptr;
+			FiberPool[i].next = nullptr;
+		}
+		FreeFibers = nullptr;
+
+		FiberMutex.Destroy();
+		ReadyFiberMutex.Destroy();
+		UseFibers = false;
+	}
+
+	// Callbacks of jobs finished since the last update never run.
+	JobResultEntry Entry;
+	while (CompletedResults.Pop(Entry)) {
+		ReleaseRecord(Entry.record);
+	}
+	CompletedResults.Destroy();
 
-			if (!thread->info.entry_point) {
-				// Make sure to remove the entry from the queue.
-				if (!queue_mutex->Lock()) {
-					LOG_ERROR("Failed to obtain lock on queue mutex!");
-				}
-				queue.pop();
-				if (!queue_mutex->UnLock()) {
-					LOG_ERROR("Failed to release lock on queue mutex!");
-				}
-
-				thread->info = info;
-				ThreadFound = true;
+	JobRecord* Backlogs[2] = { CompletionHead, UploadHead };
+	for (JobRecord* Record : Backlogs) {
+		while (Record != nullptr) {
+			JobRecord* Next = Record->next;
+			ReleaseRecord(Record);
+			Record = Next;
+		}
+	}
+	CompletionHead = CompletionTail = nullptr;
+	UploadHead = UploadTail = nullptr;
+	BacklogCount = 0;
+	UploadTurn = false;
+
+	ReleaseTraceBuffers();
+
+	// NOTE: Records of jobs which are still suspended or waiting on a counter go away with the pool.
+	Memory::FreeAligned(RecordPool, sizeof(JobRecord) * JOB_POOL_SIZE, alignof(JobRecord), MemoryType::eMemory_Type_Job);
+	RecordPool = nullptr;
+	FreeRecords = nullptr;
+}
+
+JobRecord* JobSystem::AcquireJob(JobThread* thr, uint32_t type_mask) {
+	// Only general jobs are ever stolen, dedicated threads stick to the shared queues.
+	bool CanSteal = (type_mask & (uint32_t)JobType::eGeneral) != 0;
+
+	for (int p = (int)JobPriority::eHigh; p >= (int)JobPriority::eLow; --p) {
+		JobRecord* Job = nullptr;
+		if (thr != nullptr && thr->local_queues[p].Pop(Job)) {
+			return Job;
+		}
+
+		Job = PopSharedQueue(p, type_mask);
+		if (Job != nullptr) {
+			return Job;
+		}
+
+		if (CanSteal) {
+			Job = StealJob(thr, p);
+			if (Job != nullptr) {
+				return Job;
 			}
+		}
+	}
 
-			if (!thread->info_mutex.UnLock()) {
-				LOG_ERROR("Failed to release lock on thread mutex!");
+	return nullptr;
+}
+
+JobRecord* JobSystem::PopSharedQueue(int priority, uint32_t type_mask) {
+	if (SharedQueueCounts[priority].load() == 0) {
+		return nullptr;
+	}
+
+	Mutex& QueueMutex = SharedQueueMutexes[priority];
+	if (!QueueMutex.Lock()) {
+		LOG_ERROR("Failed to obtain lock on queue mutex!");
+		return nullptr;
+	}
+
+	// Take the oldest job this thread is able to handle. Jobs of other types are left
+	// in place for their dedicated threads.
+	JobRecord* Job = nullptr;
+	JobRecord* Previous = nullptr;
+	for (JobRecord* It = SharedQueueHeads[priority]; It != nullptr; Previous = It, It = It->next) {
+		if ((type_mask & (uint32_t)It->type) != 0) {
+			Job = It;
+			if (Previous != nullptr) {
+				Previous->next = It->next;
 			}
+			else {
+				SharedQueueHeads[priority] = It->next;
+			}
+			if (SharedQueueTails[priority] == It) {
+				SharedQueueTails[priority] = Previous;
+			}
+			Job->next = nullptr;
+			SharedQueueCounts[priority]--;
+			break;
+		}
+	}
+
+	if (!QueueMutex.UnLock()) {
+		LOG_ERROR("Failed to release lock on queue mutex!");
+	}
+
+	return Job;
+}
+
+JobRecord* JobSystem::StealJob(JobThread* thr, int priority) {
+	// Start at the next thread so thieves spread out over the victims.
+	unsigned char Start = thr != nullptr ? thr->index + 1 : 0;
+	for (unsigned char i = 0; i < ThreadCount; ++i) {
+		JobThread* Victim = &JobThreads[(Start + i) % ThreadCount];
+		if (Victim == thr) {
+			continue;
+		}
 
-			// Break after unlocking if an available thread was found.
-			if (ThreadFound) {
-				break;
+		JobRecord* Job = nullptr;
+		WorkStealDeque<JobRecord*>& Queue = Victim->local_queues[priority];
+		while (!Queue.IsEmpty()) {
+			if (Queue.Steal(Job)) {
+				return Job;
 			}
 		}
+	}
 
-		// This means all of the threads are currently handling a job.
-		// So wait until the next update and try again.
-		if (!ThreadFound) {
-			break;
+	return nullptr;
+}
+
+void JobSystem::WakeThread(JobType type) {
+	// Order the preceding push before reading the sleeping state, pairs with the
+	// re-check a thread does after announcing it goes to sleep.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (SleepingCount.load() == 0) {
+		return;
+	}
+
+	for (unsigned char i = 0; i < ThreadCount; ++i) {
+		JobThread* Thr = &JobThreads[i];
+		if ((Thr->type_mask & (uint32_t)type) == 0) {
+			continue;
+		}
+
+		// Only one thread needs to be woken up per job. If every capable thread is busy,
+		// they pick the job up when they finish their current one.
+		if (Thr->sleeping.exchange(false)) {
+			SleepingCount--;
+			Thr->wake_semaphore.Signal();
+			return;
 		}
 	}
 }
 
-void JobSystem::Update() {
+void JobSystem::Update(double time_budget_ms, uint32_t max_gpu_uploads) {
 	if (!IsRunning) {
 		return;
 	}
 
-	ProcessQueue(HighPriorityQueue, &HighPriQueueMutex);
-	ProcessQueue(NormalPriorityQueue, &NormalPriQueueMutex);
-	ProcessQueue(LowPriorityQueue, &LowPriQueueMutex);
+	DrainResults();
+	RunCompletions(time_budget_ms / 1000.0, max_gpu_uploads);
+
+	PromoteAgedJobs();
+	UpdateIndex.fetch_add(1, std::memory_order_relaxed);
+
+	if (TelemetryEnabled.load(std::memory_order_relaxed)) {
+		double Now = Platform::PlatformGetAbsoluteTime();
+		PublishMetrics(Now);
+		FrameIndex++;
+		FrameStartTimes[FrameIndex % JOB_TRACE_FRAME_COUNT] = Now;
+	}
+}
+
+uint32_t JobSystem::DrainResults() {
+	// Only drain what fits in the queue at once, so jobs finishing continuously cannot stall the frame.
+	JobResultEntry Entry;
+	uint32_t Count = 0;
+	while (Count < MAX_JOB_RESULTS && CompletedResults.Pop(Entry)) {
+		Entry.record->completion = Entry.callback;
+		DeferCompletion(Entry.record);
+		Count++;
+	}
+
+	return Count;
+}
+
+void JobSystem::DeferCompletion(JobRecord* record) {
+	JobRecord*& Head = record->gpu_upload ? UploadHead : CompletionHead;
+	JobRecord*& Tail = record->gpu_upload ? UploadTail : CompletionTail;
+	record->next = nullptr;
+	if (Tail != nullptr) {
+		Tail->next = record;
+	}
+	else {
+		Head = record;
+	}
+	Tail = record;
+	BacklogCount++;
+}
+
+void JobSystem::RunCompletions(double time_budget, uint32_t max_gpu_uploads) {
+	// A callback may submit jobs or wait on counters, which drains more results into the backlogs,
+	// so every record is unlinked before its callback runs.
+	double Deadline = time_budget > 0.0 ? Platform::PlatformGetAbsoluteTime() + time_budget : 0.0;
+	bool First = true;
+	// Uploads are held back by their own limit as well, so a burst of finished loads spreads
+	// its GPU work over several frames instead of spiking one.
+	uint32_t Uploads = 0;
+	while (true) {
+		bool CanUpload = UploadHead != nullptr && (max_gpu_uploads == 0 || Uploads < max_gpu_uploads);
+		if (CompletionHead == nullptr && !CanUpload) {
+			return;
+		}
+		if (!First && Deadline > 0.0 && Platform::PlatformGetAbsoluteTime() >= Deadline) {
+			return;
+		}
 
-	// Process pending results.
-	for (unsigned short i = 0; i < MAX_JOB_RESULTS; ++i) {
-		// Lock and take a copy, unlock.
-		if (!ResultMutex.Lock()) {
-			LOG_ERROR("Failed to obtain lock on result mutex!");
+		// The turn carries over to the next update, so even callbacks which each take the whole
+		// budget leave the other backlog every second update.
+		bool Upload = CanUpload && (UploadTurn || CompletionHead == nullptr);
+		JobRecord*& Head = Upload ? UploadHead : CompletionHead;
+		JobRecord*& Tail = Upload ? UploadTail : CompletionTail;
+		JobRecord* Record = Head;
+		Head = Record->next;
+		if (Head == nullptr) {
+			Tail = nullptr;
 		}
+		BacklogCount--;
+		UploadTurn = !Upload;
 
-		JobResultEntry Entry = PendingResults[i];
-		if (!ResultMutex.UnLock()) {
-			LOG_ERROR("Failed to release lock on result mutex!");
+		Record->completion(Record->payload, Record->context);
+		ReleaseRecord(Record);
+		if (Upload) {
+			Uploads++;
 		}
+		First = false;
+	}
+}
 
-		if (Entry.id != INVALID_ID_U16) {
-			// Execute the callback.
-			Entry.callback(Entry.params.get());
+void JobSystem::StoreResult(PFN_JobComplete callback, JobRecord* record) {
+	JobResultEntry Entry;
+	Entry.callback = callback;
+	Entry.record = record;
 
-			if (Entry.params) {
-				Entry.params.reset();
-			}
+	while (!CompletedResults.Push(Entry)) {
+		// The main thread drains the queue, it must not wait on itself. Its own results
+		// go straight to the backlog instead.
+		if (Thread::GetThreadID() == MainThreadID) {
+			record->completion = callback;
+			DeferCompletion(record);
+			return;
+		}
 
-			// Lock actual entry, invalidate and clear it
-			if (!ResultMutex.Lock()) {
-				LOG_ERROR("Failed to obtain lock on result mutex!");
-			}
-			Memory::Zero(&PendingResults[i], sizeof(JobResultEntry));
-			PendingResults[i].id = INVALID_ID_U16;
-			if (!ResultMutex.UnLock()) {
-				LOG_ERROR("Failed to release lock on result mutex!");
-			}
+		// Back-pressure, wait for the next update to make room instead of dropping the result.
+		std::this_thread::yield();
+	}
+}
+
+JobRecord* JobSystem::CreateRecord(PFN_JobEntry entry, const void* payload, size_t payload_size, const JobDesc& desc) {
+	// Count the job before it can possibly run, so waiters never see the counter hit zero early.
+	if (desc.signal_counter != nullptr) {
+		desc.signal_counter->Lock();
+		desc.signal_counter->Value++;
+		desc.signal_counter->Unlock();
+	}
+
+	JobRecord* Job = AcquireRecord();
+	Job->entry = entry;
+	Job->on_success = desc.on_success;
+	Job->on_failed = desc.on_failed;
+	Job->context = desc.context;
+	Job->type = desc.type;
+	Job->priority = desc.priority;
+	Job->signal_counter = desc.signal_counter;
+	Job->wait_counter = desc.wait_counter;
+	Job->cancel_token = desc.cancel_token;
+	Job->deadline = desc.deadline;
+	Job->name = desc.name;
+	Job->gpu_upload = desc.gpu_upload;
+	// Held by the job until it finished, and by the handle returned.
+	Job->finished.Value = 1;
+	Job->references.store(2, std::memory_order_relaxed);
+	Job->succeeded.store(false, std::memory_order_relaxed);
+	Job->cancel_requested.store(false, std::memory_order_relaxed);
+	Job->discarded = false;
+	Job->submit_time = TelemetryEnabled.load(std::memory_order_relaxed) ? Platform::PlatformGetAbsoluteTime() : 0.0;
+	Memory::Copy(Job->payload, payload, payload_size);
+
+	return Job;
+}
+
+JobHandle JobSystem::SubmitPayload(PFN_JobEntry entry, const void* payload, size_t payload_size, const JobDesc& desc) {
+	JobRecord* Job = CreateRecord(entry, payload, payload_size, desc);
+	JobHandle Handle(Job);
+
+	// Park the job on its wait counter. The last job signaling the counter schedules it.
+	JobCounter* WaitCounter = Job->wait_counter;
+	if (WaitCounter != nullptr) {
+		WaitCounter->Lock();
+		bool Parked = WaitCounter->Value > 0;
+		if (Parked) {
+			Job->next = WaitCounter->WaitingJobs;
+			WaitCounter->WaitingJobs = Job;
+		}
+		WaitCounter->Unlock();
+
+		if (Parked) {
+			return Handle;
 		}
 	}
+
+	Schedule(Job);
+	return Handle;
+}
+
+struct FileReadJobPayload {
+	FileReadResult* result = nullptr;
+};
+
+bool JobSystem::FileReadJobStart(void* payload, void* /*context*/) {
+	return ((FileReadJobPayload*)payload)->result->success;
 }
 
-void JobSystem::Submit(JobInfo info) {
-	std::queue<JobInfo>* Queue = &NormalPriorityQueue;
-	Mutex* QueueMutex = &NormalPriQueueMutex;
+void JobSystem::OnFileReadComplete(FileReadResult* /*result*/, void* context) {
+	Schedule((JobRecord*)context);
+}
 
-	// If the job is high priority, try to kick it off immediately.
-	if (info.priority == JobPriority::eHigh) {
-		Queue = &HighPriorityQueue;
-		QueueMutex = &HighPriQueueMutex;
+JobHandle JobSystem::ReadFile(const char* path, FileReadResult* out_result) {
+	FileReadJobPayload Payload;
+	Payload.result = out_result;
+	JobDesc Desc;
+	Desc.name = "ReadFile";
 
-		// Check for a free thread that supports the job type first.
-		for (unsigned char i = 0; i < ThreadCount; ++i) {
-			JobThread* thread = &JobThreads[i];
-			if (thread->type_mask & (uint32_t)info.type) {
-				bool Found = false;
-				if (!thread->info_mutex.Lock()) {
-					LOG_ERROR("Failed to obtain lock on job thread mutex!");
-				}
-				if (!thread->info.entry_point) {
-					LOG_INFO("Job immediately submitted on thread %i.", thread->index);
-					thread->info = info;
-					Found = true;
-				}
-				if (!thread->info_mutex.UnLock()) {
-					LOG_ERROR("Failed to release lock on job thread mutex!");
-				}
-				if (Found) {
-					return;
-				}
-			}
+	// The job only reports the outcome, it is scheduled by the read completing rather than now.
+	JobRecord* Job = CreateRecord(FileReadJobStart, &Payload, sizeof(Payload), Desc);
+	JobHandle Handle(Job);
+	if (!FileSystemReadAsync(path, out_result, OnFileReadComplete, Job)) {
+		*out_result = FileReadResult();
+		Schedule(Job);
+	}
+
+	return Handle;
+}
+
+JobHandle::JobHandle(const JobHandle& other) : Record(other.Record) {
+	if (Record != nullptr) {
+		Record->references.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+JobHandle::JobHandle(JobHandle&& other) noexcept : Record(other.Record) {
+	other.Record = nullptr;
+}
+
+JobHandle& JobHandle::operator=(const JobHandle& other) {
+	if (other.Record != nullptr) {
+		other.Record->references.fetch_add(1, std::memory_order_relaxed);
+	}
+	if (Record != nullptr) {
+		JobSystem::ReleaseRecord(Record);
+	}
+	Record = other.Record;
+	return *this;
+}
+
+JobHandle& JobHandle::operator=(JobHandle&& other) noexcept {
+	if (this != &other) {
+		if (Record != nullptr) {
+			JobSystem::ReleaseRecord(Record);
 		}
+		Record = other.Record;
+		other.Record = nullptr;
+	}
+	return *this;
+}
+
+JobHandle::~JobHandle() {
+	if (Record != nullptr) {
+		JobSystem::ReleaseRecord(Record);
+	}
+}
+
+bool JobHandle::IsReady() const {
+	return Record == nullptr || Record->finished.IsDone();
+}
+
+bool JobHandle::Succeeded() const {
+	// The counter lock taken by IsReady() orders the result before it.
+	return IsReady() && Record != nullptr && Record->succeeded.load(std::memory_order_relaxed);
+}
+
+bool JobHandle::IsCancelled() const {
+	// Written before the finished counter is signaled, so ordered by the counter lock as well.
+	return IsReady() && Record != nullptr && Record->discarded;
+}
+
+void JobHandle::Cancel() const {
+	if (Record != nullptr) {
+		Record->cancel_requested.store(true, std::memory_order_relaxed);
 	}
+}
 
-	// If this point is reached, all threads are busy.
-	// Add to the queue and try again next cycle.
-	if (info.priority == JobPriority::eLow) {
-		Queue = &LowPriorityQueue;
-		QueueMutex = &LowPriQueueMutex;
+void JobHandle::Wait() const {
+	if (Record != nullptr) {
+		JobSystem::WaitForCounter(&Record->finished);
+	}
+}
+
+void JobSystem::Schedule(JobRecord* job) {
+	int Priority = (int)job->priority;
+	JobType Type = job->type;
+
+	// Jobs spawned from a job stay on the spawning thread, where idle threads can steal them.
+	JobThread* Thr = GetCurrentThread();
+	if (Thr != nullptr && Type == JobType::eGeneral && (Thr->type_mask & (uint32_t)Type) != 0) {
+		if (Thr->local_queues[Priority].Push(job)) {
+			WakeThread(Type);
+			return;
+		}
 	}
 
 	// NOTO: Locking here in case the job is submitted from another thread.
-	if (!QueueMutex->Lock()) {
+	job->ready_update = UpdateIndex.load(std::memory_order_relaxed);
+	Mutex& QueueMutex = SharedQueueMutexes[Priority];
+	if (!QueueMutex.Lock()) {
 		LOG_ERROR("Failed to obtain lock on queue mutex!");
 	}
-	Queue->push(info);
-	if (!QueueMutex->UnLock()) {
+	job->next = nullptr;
+	if (SharedQueueTails[Priority] != nullptr) {
+		SharedQueueTails[Priority]->next = job;
+	}
+	else {
+		SharedQueueHeads[Priority] = job;
+	}
+	SharedQueueTails[Priority] = job;
+	SharedQueueCounts[Priority]++;
+	if (!QueueMutex.UnLock()) {
 		LOG_ERROR("Failed to release lock on queue mutex!");
 	}
+
+	// Kick off the job immediately if a capable thread is idle.
+	WakeThread(Type);
 }
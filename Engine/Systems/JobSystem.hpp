@@ -4,23 +4,57 @@
 
 #include "Core/DThread.hpp"
 #include "Core/DMutex.hpp"
+#include "Core/DSemaphore.hpp"
+#include "Core/DFiber.hpp"
 #include "Core/DMemory.hpp"
-
-#include <queue>
+#include "Memory/ScratchAllocator.h"
+#include "Platform/Platform.hpp"
+#include "Platform/FileSystem.hpp"
+#include "Containers/TWorkStealDeque.hpp"
+#include "Containers/TMPSCQueue.hpp"
+
+#include <deque>
+#include <atomic>
 #include <functional>
+#include <type_traits>
 
+// The capacity of the completion queue. Job threads wait for the main thread to drain it when full.
 #define MAX_JOB_RESULTS 512
+// Affinity masks address 64 logical processors, threads beyond that could not be pinned anyway.
+#define MAX_JOB_THREADS 64
+#define JOB_PRIORITY_COUNT 3
+// The capacity of each per-thread, per-priority deque. Overflow goes to the shared queues.
+#define JOB_LOCAL_QUEUE_CAPACITY 4096
+// The size of the payload stored inline in every job record.
+#define JOB_PAYLOAD_SIZE 64
+// The number of pooled job records. Only jobs beyond that many in flight are allocated from the heap.
+#define JOB_POOL_SIZE 4096
+// The number of fibers jobs run on in fiber mode. Bounds how many jobs can be suspended at once.
+#define JOB_FIBER_COUNT 128
+// Fiber stacks are only committed as they are touched.
+#define JOB_FIBER_STACK_SIZE KIBIBYTES(256)
+// The number of finished jobs each thread keeps for the trace, older ones are overwritten.
+#define JOB_TRACE_CAPACITY 8192
+// The number of updates whose start time is kept, bounds how many frames a trace can span.
+#define JOB_TRACE_FRAME_COUNT 120
+// The number of updates a job waits in a shared queue before it is promoted to the next priority.
+#define JOB_AGING_UPDATES 8
 
-//template<typename T>
-//using PFN_OnJobStart = std::function<bool(std::shared_ptr<T>, std::shared_ptr<T>)>
-//template<typename T>
-//using PFN_OnJobComplete = std::function<void(std::shared_ptr<void>)>
+/**
+ * @brief The body of a parallel for, called with a [begin, end) subrange of the full range.
+ */
+typedef std::function<void(size_t, size_t)> PFN_ParallelForRange;
 
-typedef std::function<bool(void*, void*)> PFN_OnJobStart;
-typedef std::function<void(void*)> PFN_OnJobComplete;
+/**
+ * @brief The entry point of a job submitted with an inline payload.
+ * Gets the job's own copy of the payload, which also carries any results, and the context of the job.
+ */
+typedef bool(*PFN_JobEntry)(void* payload, void* context);
 
-//typedef bool(*PFN_OnJobStart)(void*, void*);
-//typedef void(*PFN_OnJobComplete)(void*);
+/**
+ * @brief Called on the main thread with the payload and context of a finished job.
+ */
+typedef void(*PFN_JobComplete)(void* payload, void* context);
 
 /**
  * @brief Describes a type of job.
@@ -50,7 +84,8 @@ enum class JobType : char{
 /**
  * @brief Determines which job queue a job uses. The high-priority queue is always exhausted
  * first before processing the normal-priority queue, which must also be exhausted before
- * processing the low-priority queue.
+ * processing the low-priority queue. Job threads pull from the queues themselves as soon
+ * as they are woken up by a submission, and steal from each other when they run dry.
  */
 enum class JobPriority : char{
 	eLow,
@@ -58,175 +93,659 @@ enum class JobPriority : char{
 	eHigh
 };
 
-struct JobInfo {
+/**
+ * @brief Counts unfinished jobs, used to express dependencies between jobs.
+ * Every job submitted with a signal counter increments it on submission and decrements it
+ * when it finishes. A job submitted with a wait counter is held back until that counter
+ * reaches zero, then starts right away on any capable job thread, without a round trip
+ * through the main thread. Submit the jobs signaling a counter before the jobs waiting on it,
+ * and keep the counter alive until every job referencing it has finished.
+ */
+class DAPI JobCounter {
 public:
-	JobInfo() : entry_point(nullptr), on_success(nullptr), on_failed(nullptr), param_data(nullptr), result_data(nullptr) {}
-	JobInfo(const JobInfo& info) {
-		entry_point = nullptr;
-		on_success = nullptr;
-		on_failed = nullptr;
-
-		if (info.entry_point) {
-			entry_point = info.entry_point;
-		}
-		if (info.on_success) {
-			on_success = info.on_success;
-		}
-		if (info.on_failed) {
-			on_failed = info.on_failed;
-		}
+	JobCounter() : Value(0), WaitingJobs(nullptr), WaitingFibers(nullptr) {}
+
+	/**
+	 * @brief Checks if every job signaling this counter has finished.
+	 */
+	bool IsDone() const {
+		Lock();
+		bool Done = Value == 0;
+		Unlock();
+		return Done;
+	}
 
-		type = info.type;
-		priority = info.priority;
-		param_data_size = info.param_data_size;
-		result_data_size = info.result_data_size;
+private:
+	friend class JobSystem;
 
-		if (info.param_data) {
-			param_data = info.param_data;
-		}
-		if (info.result_data) {
-			result_data = info.result_data;
-		}
+	// NOTE: Critical sections are a handful of instructions, so spinning is cheaper than a Mutex.
+	void Lock() const {
+		while (WaitLock.test_and_set(std::memory_order_acquire)) {}
 	}
 
-	void Release() {
-		entry_point = nullptr;
-		on_success = nullptr;
-		on_failed = nullptr;
+	void Unlock() const {
+		WaitLock.clear(std::memory_order_release);
 	}
 
+private:
+	int Value;
+	mutable std::atomic_flag WaitLock = ATOMIC_FLAG_INIT;
+	// Jobs held back until this counter reaches zero, linked through JobRecord::next.
+	struct JobRecord* WaitingJobs;
+	// Jobs suspended in fiber mode until this counter reaches zero, linked through JobFiber::next.
+	struct JobFiber* WaitingFibers;
+};
+
+/**
+ * @brief Calls off the jobs submitted with it. A job is only checked right before it starts, jobs
+ * already running finish normally. Called off jobs neither run nor call back, but still signal their
+ * counters, so dependents go ahead. Keep the token alive until every job referencing it has finished.
+ */
+class DAPI JobCancelToken {
+public:
+	JobCancelToken() : Cancelled(false) {}
+
+	void Cancel() { Cancelled.store(true, std::memory_order_relaxed); }
+	bool IsCancelled() const { return Cancelled.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<bool> Cancelled;
+};
+
+/**
+ * @brief Describes how a job submitted with an inline payload runs.
+ */
+struct JobDesc {
 	JobType type = JobType::eGeneral;
 	JobPriority priority = JobPriority::eNormal;
-	PFN_OnJobStart entry_point = nullptr;
-	PFN_OnJobComplete on_success = nullptr;
-	PFN_OnJobComplete on_failed = nullptr;
+	// Optional. Run on the main thread by the update after the job succeeded or failed.
+	PFN_JobComplete on_success = nullptr;
+	PFN_JobComplete on_failed = nullptr;
+	// Optional. Passed to the entry point and the callbacks as is.
+	void* context = nullptr;
+	// Optional. Incremented when the job is submitted, decremented when it finishes.
+	JobCounter* signal_counter = nullptr;
+	// Optional. The job does not start before this counter reaches zero.
+	JobCounter* wait_counter = nullptr;
+	// Optional. Calls the job off while it is queued, see JobCancelToken. Neither callback runs then,
+	// so jobs whose payload points at memory they own check a token of their own instead.
+	const JobCancelToken* cancel_token = nullptr;
+	// Optional. The job is called off if it has not started by then, see Platform::PlatformGetAbsoluteTime().
+	double deadline = 0.0;
+	// Optional. Shown in the trace, must outlive the job. Typically a string literal.
+	const char* name = nullptr;
+	// Set if the completion callbacks upload to the GPU, see JobSystem::Update().
+	bool gpu_upload = false;
+};
 
-	std::shared_ptr<void> param_data = nullptr;
-	size_t param_data_size = 0;
+/**
+ * @brief Refers to a submitted job, so the submitter can poll it, wait on it or chain work after it.
+ * Copies refer to the same job, and keep its record from being reused. An empty handle counts as ready.
+ * NOTE: Release every handle before the job system shuts down.
+ */
+class DAPI JobHandle {
+public:
+	JobHandle() : Record(nullptr) {}
+	JobHandle(const JobHandle& other);
+	JobHandle(JobHandle&& other) noexcept;
+	JobHandle& operator=(const JobHandle& other);
+	JobHandle& operator=(JobHandle&& other) noexcept;
+	~JobHandle();
 
-	std::shared_ptr<void> result_data = nullptr;
-	size_t result_data_size = 0;
+	bool IsValid() const { return Record != nullptr; }
+
+	/**
+	 * @brief Checks if the job finished. Its completion callbacks may still be waiting for an update.
+	 */
+	bool IsReady() const;
+
+	/**
+	 * @brief Checks if the job finished and its entry point returned true.
+	 */
+	bool Succeeded() const;
+
+	/**
+	 * @brief Checks if the job finished without running, because it was called off or missed its deadline.
+	 */
+	bool IsCancelled() const;
+
+	/**
+	 * @brief Blocks until the job finished, see JobSystem::WaitForCounter().
+	 */
+	void Wait() const;
+
+	/**
+	 * @brief Calls the job off if it has not started yet, see JobCancelToken.
+	 */
+	void Cancel() const;
+
+	/**
+	 * @brief Submits a job which starts on a job thread once this one finished, whether it succeeded or not.
+	 * @param entry The function the job runs.
+	 * @param payload The job's parameters and room for its results.
+	 * @param desc How the job runs. Its wait counter is replaced by this job.
+	 * @returns The handle of the new job, so continuations can be chained.
+	 */
+	template<typename PayloadType>
+	JobHandle Then(PFN_JobEntry entry, const PayloadType& payload, JobDesc desc = JobDesc()) const;
+
+	/**
+	 * @brief Runs a callback on the main thread, in the first update after this job finished.
+	 * @param callback Called with its own copy of the payload and the context.
+	 * @param payload Passed to the callback.
+	 * @param context Passed to the callback as is.
+	 * @returns The handle of the continuation, ready once the callback is due rather than once it ran.
+	 */
+	template<typename PayloadType>
+	JobHandle ThenOnMainThread(PFN_JobComplete callback, const PayloadType& payload, void* context = nullptr) const;
+
+private:
+	friend class JobSystem;
+
+	// Takes over a reference already held on the record.
+	explicit JobHandle(struct JobRecord* record) : Record(record) {}
+
+private:
+	struct JobRecord* Record;
+};
+
+/**
+ * @brief A queued job. Records come from a pool and carry the payload inline, so submitting
+ * and retiring a job needs no heap allocation. Owned by the job system, returned to the pool
+ * once the job is done with and no handle refers to it anymore.
+ */
+struct JobRecord {
+	PFN_JobEntry entry = nullptr;
+	PFN_JobComplete on_success = nullptr;
+	PFN_JobComplete on_failed = nullptr;
+	void* context = nullptr;
+	JobType type = JobType::eGeneral;
+	JobPriority priority = JobPriority::eNormal;
+	// Allocated from the heap because the pool ran dry.
+	bool from_heap = false;
+	bool gpu_upload = false;
+	JobCounter* signal_counter = nullptr;
+	JobCounter* wait_counter = nullptr;
+	const JobCancelToken* cancel_token = nullptr;
+	double deadline = 0.0;
+	// The update during which the job was last queued in a shared queue, drives its aging.
+	uint32_t ready_update = 0;
+	// Next record in a shared queue, a wait list or the free list.
+	JobRecord* next = nullptr;
+	const char* name = nullptr;
+	// When the job was submitted, zero if telemetry was off.
+	double submit_time = 0.0;
+	// The callback picked by the outcome, while the finished job waits for the main thread.
+	PFN_JobComplete completion = nullptr;
+	// One until the job finished. Handle waiters and continuations hang off it.
+	JobCounter finished;
+	// Held by the running job, its pending callback and every handle.
+	std::atomic<uint32_t> references;
+	std::atomic<bool> succeeded;
+	// Set through a handle to call the job off.
+	std::atomic<bool> cancel_requested;
+	// Set if the job was called off instead of run, before the finished counter is signaled.
+	bool discarded = false;
+	alignas(16) unsigned char payload[JOB_PAYLOAD_SIZE];
+};
+
+/**
+ * @brief A finished job as recorded for the trace. Times are in seconds, see Platform::PlatformGetAbsoluteTime().
+ */
+struct JobTraceEvent {
+	const char* name = nullptr;
+	PFN_JobEntry entry = nullptr;
+	double submit_time = 0.0;
+	double start_time = 0.0;
+	// A job suspended in fiber mode ends on the thread that resumed it, and its span includes the suspension.
+	double end_time = 0.0;
+	JobType type = JobType::eGeneral;
+	JobPriority priority = JobPriority::eNormal;
+	bool succeeded = false;
+};
+
+/**
+ * @brief A ring of the most recently finished jobs. Writers never wait and overwrite the oldest events.
+ * Each slot carries a sequence number, so a reader can tell whether a slot it copied was rewritten meanwhile.
+ */
+struct JobTraceBuffer {
+	struct Slot {
+		std::atomic<uint64_t> sequence;
+		JobTraceEvent event;
+	};
+
+	Slot* slots = nullptr;
+	std::atomic<uint64_t> write_index;
+
+	void Push(const JobTraceEvent& event) {
+		if (slots == nullptr) {
+			return;
+		}
+
+		uint64_t Index = write_index.fetch_add(1, std::memory_order_relaxed);
+		Slot& Target = slots[Index % JOB_TRACE_CAPACITY];
+		// Odd while being written.
+		Target.sequence.store(Index * 2 + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		Target.event = event;
+		Target.sequence.store(Index * 2 + 2, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Copies the event written at the given index.
+	 * @returns False if it has not been written yet, or was overwritten.
+	 */
+	bool Read(uint64_t index, JobTraceEvent& out_event) const {
+		const Slot& Source = slots[index % JOB_TRACE_CAPACITY];
+		uint64_t Sequence = Source.sequence.load(std::memory_order_acquire);
+		if (Sequence != index * 2 + 2) {
+			return false;
+		}
+
+		out_event = Source.event;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return Source.sequence.load(std::memory_order_relaxed) == Sequence;
+	}
+};
+
+/**
+ * @brief What a thread did since the last update, plus its recent jobs for the trace.
+ * Job threads write their own, other threads running jobs share one.
+ */
+struct JobThreadTelemetry {
+	JobTraceBuffer trace;
+	std::atomic<uint64_t> jobs_run;
+	std::atomic<uint64_t> jobs_cancelled;
+	std::atomic<uint64_t> wait_ns;
+	std::atomic<uint64_t> max_wait_ns;
+	std::atomic<uint64_t> run_ns;
+	// Time spent running jobs and fibers rather than looking for work or sleeping.
+	std::atomic<uint64_t> busy_ns;
+};
+
+/**
+ * @brief A fiber jobs run on in fiber mode, so a job waiting on a counter can be suspended
+ * and its thread can carry on with other jobs.
+ */
+struct JobFiber {
+	Fiber fiber;
+	// The job to run when switched to.
+	JobRecord* job = nullptr;
+	// The type of the running job, a suspended fiber only resumes on a thread able to handle it.
+	JobType type = JobType::eGeneral;
+	// Set while the job waits on a counter.
+	JobCounter* wait_counter = nullptr;
+	// Next fiber in the free list, or waiting on the same counter.
+	JobFiber* next = nullptr;
+	// Scratch memory of the jobs run on the fiber, it moves between threads with them.
+	SScratchStack scratch;
 };
 
 struct JobThread {
 	unsigned char index;
 	Thread thread;
-	JobInfo info;
-	// A mutex to guard access to this thread's info.
-	Mutex info_mutex;
+	// Shown in debuggers, profilers and the trace.
+	char name[16];
+	// The logical processors the thread is pinned to, zero if it is not pinned.
+	uint64_t affinity_mask;
+	// General jobs submitted from jobs running on this thread, one deque per priority.
+	// The owner pops from the bottom, idle threads steal from the top.
+	WorkStealDeque<JobRecord*> local_queues[JOB_PRIORITY_COUNT];
+	// Signaled when a job this thread can handle has been submitted.
+	Semaphore wake_semaphore;
+	// Set while the thread is about to block on the wake semaphore.
+	std::atomic<bool> sleeping;
 	// The types of jobs this thread can handle.
 	uint32_t type_mask;
+	// The thread's own context in fiber mode, job fibers switch back to it when done or suspended.
+	Fiber thread_fiber;
+	// The job fiber currently running on this thread, nullptr while on the thread fiber.
+	JobFiber* current_fiber = nullptr;
+};
+
+/**
+ * @brief Describes the job threads to start. Thread counts left at zero are derived from the processor topology.
+ */
+struct JobSystemConfig {
+	// Threads running general jobs, each pinned to a physical core of its own. Zero takes every core
+	// not reserved for the main thread and the GPU thread.
+	unsigned char compute_thread_count = 0;
+	// Threads loading resources. They mostly wait on the disk, so they stay off the cores of the compute
+	// threads and run on the hardware threads those leave free. At least one.
+	unsigned char io_thread_count = 1;
+	// Gives GPU resource jobs a thread of their own, for multithreaded renderers.
+	// Otherwise the first I/O thread runs them.
+	bool dedicated_gpu_thread = true;
+	// Pins threads to cores where the platform allows it.
+	bool pin_threads = true;
+	// Runs jobs on fibers, see JobSystem::Initialize().
+	bool use_fibers = false;
 };
 
 struct JobResultEntry {
-	unsigned short id;
-	PFN_OnJobComplete callback = nullptr;
-	uint32_t param_size = 0;
-	std::shared_ptr<void> params = nullptr;
+	PFN_JobComplete callback = nullptr;
+	// The finished job, retired once the callback ran.
+	JobRecord* record = nullptr;
 };
 
 class JobSystem {
 public:
-	static bool Initialize(unsigned char job_thread_count, unsigned int type_masks[]);
-	static void Shutdown();
+	/**
+	 * @brief Initializes the job system and starts the job threads.
+	 * @param job_thread_count The number of job threads.
+	 * @param type_masks The types of jobs each thread can handle.
+	 * @param use_fibers Runs jobs on fibers, so a job waiting on a counter is suspended instead of blocking its thread.
+	 * @param affinity_masks Optional. The logical processors each thread is pinned to, zero leaves a thread unpinned.
+	 */
+	static DAPI bool Initialize(unsigned char job_thread_count, unsigned int type_masks[], bool use_fibers = false, const uint64_t affinity_masks[] = nullptr);
+
+	/**
+	 * @brief Initializes the job system with threads sized and pinned after the processor topology.
+	 * @param config Which threads to start.
+	 */
+	static DAPI bool Initialize(const JobSystemConfig& config);
+
+	/**
+	 * @brief Gets the number of job threads running.
+	 */
+	static DAPI unsigned char GetThreadCount();
+	static DAPI void Shutdown();
 
 	/**
 	 * @brief Updates the job system. Should happen once an update cycle.
+	 * Only runs the completion callbacks of finished jobs and ages queued jobs, the job threads pick up
+	 * queued work by themselves. Jobs which waited JOB_AGING_UPDATES in a shared queue are promoted to the
+	 * next priority, so low priority work cannot starve behind a steady stream of higher priority work.
+	 * Callbacks which do not fit in the budget are deferred to later updates, oldest first. At least one
+	 * callback runs per update, so a slow one cannot stall the others forever. Uploads and the other
+	 * callbacks take turns, so neither kind can starve the other of the budget.
+	 * @param time_budget_ms The time callbacks may take, zero for no limit.
+	 * @param max_gpu_uploads The number of callbacks of jobs flagged gpu_upload that may run, zero for no limit.
+	 * They also count against the time budget.
 	 */
-	static void Update();
+	static DAPI void Update(double time_budget_ms = 0.0, uint32_t max_gpu_uploads = 0);
 
 	/**
-	 * @brief Submits the provided job to the queued for execution.
-	 * @param info The description of the job to be executed.
+	 * @brief Submits a job whose payload is copied into a pooled job record, and wakes up a
+	 * sleeping job thread which is able to handle it. Never allocates while the pool has records left.
+	 * @param entry The function the job runs. Gets the record's copy of the payload.
+	 * @param payload The job's parameters and room for its results.
+	 * @param desc How the job runs.
+	 * @returns A handle to wait on the job or chain work after it. May be dropped.
 	 */
-	static DAPI void Submit(JobInfo info);
+	template<typename PayloadType>
+	static JobHandle Submit(PFN_JobEntry entry, const PayloadType& payload, const JobDesc& desc = JobDesc()) {
+		static_assert(std::is_trivially_copyable<PayloadType>::value, "Job payloads are copied as raw bytes.");
+		static_assert(sizeof(PayloadType) <= JOB_PAYLOAD_SIZE, "Job payload does not fit inline, pass a pointer to it instead.");
+		static_assert(alignof(PayloadType) <= 16, "Job payload alignment is too large.");
+		return SubmitPayload(entry, &payload, sizeof(PayloadType), desc);
+	}
 
 	/**
-	 * @brief Creates a new job with default type
+	 * @brief Submits a job with an inline payload of the given size. See Submit().
 	 */
-	template<typename T>
-	static DAPI JobInfo CreateJob(PFN_OnJobStart entry, PFN_OnJobComplete on_success, PFN_OnJobComplete on_failed,
-		std::shared_ptr<T> param_data, size_t param_data_size, size_t result_data_size,
-		JobType type = JobType::eGeneral, JobPriority priority = JobPriority::eNormal) {
-		JobInfo Job;
-		Job.entry_point = std::move(entry);
-		Job.on_success = std::move(on_success);
-		Job.on_failed = std::move(on_failed);
-		Job.type = type;
-		Job.priority = priority;
+	static DAPI JobHandle SubmitPayload(PFN_JobEntry entry, const void* payload, size_t payload_size, const JobDesc& desc);
 
-		Job.param_data_size = param_data_size;
-		if (param_data_size > 0) {
-			Job.param_data = std::move(param_data);
-		}
-		else {
-			Job.param_data = nullptr;
-		}
+	/**
+	 * @brief Reads a whole file without occupying a job thread while the read is in flight. See FileSystemReadAsync().
+	 * @param path The path of the file to be read.
+	 * @param out_result Filled in once the read finished, must stay alive until then. Free the data with FileSystemFreeReadResult().
+	 * @returns A handle which is ready once the read finished, and succeeded if it did. Process the data with Then().
+	 */
+	static DAPI JobHandle ReadFile(const char* path, FileReadResult* out_result);
 
-		Job.result_data_size = result_data_size;
-		if (result_data_size > 0) {
-			//Job.result_data = Memory::Allocate(result_data_size, MemoryType::eMemory_Type_Job);
-			Job.result_data = std::make_shared<T>();
-		}
-		else {
-			Job.result_data = nullptr;
-		}
+	/**
+	 * @brief Blocks until the counter reaches zero. Runs other queued jobs on the calling
+	 * thread while waiting instead of idling. In fiber mode a job calling this is suspended
+	 * instead, and resumes once the counter reaches zero, possibly on another job thread.
+	 * On the main thread, finished jobs are moved off the completion queue while waiting, their callbacks
+	 * still run in the next update.
+	 * @param counter The counter to wait on.
+	 * @param help False to only yield while waiting. A thread helping out may pick up an unrelated long job
+	 * and return only once that is done, long after the counter reached zero.
+	 */
+	static DAPI void WaitForCounter(JobCounter* counter, bool help = true);
 
-		return Job;
-	}
+	/**
+	 * @brief Splits [begin, end) into chunks of grain elements and runs them on the general job threads.
+	 * The calling thread executes chunks as well, and returns once every chunk has finished.
+	 * Ranges which fit in a single chunk run serially on the calling thread.
+	 * @param begin The first index of the range.
+	 * @param end One past the last index of the range.
+	 * @param grain The number of elements per chunk. Large enough for a chunk to take a few microseconds.
+	 * @param func Called once per chunk, possibly on several threads at the same time.
+	 */
+	static DAPI void ParallelFor(size_t begin, size_t end, size_t grain, PFN_ParallelForRange func);
+
+	/**
+	 * @brief Turns the recording of job timings on or off. On by default. Costs a few clock reads per job.
+	 * Counters are published to Metrics by every update.
+	 */
+	static DAPI void EnableTelemetry(bool enabled);
+
+	/**
+	 * @brief Writes the jobs finished during the last frames as a Chrome trace_event JSON file,
+	 * which chrome://tracing or Perfetto can open. Main thread only.
+	 * @param path The file to write.
+	 * @param frame_count The number of finished frames to cover besides the current one, capped at JOB_TRACE_FRAME_COUNT - 1.
+	 * @returns True if written.
+	 */
+	static DAPI bool WriteTrace(const char* path, uint32_t frame_count);
 
 private:
-	template<typename T>
-	static void StoreResult(PFN_OnJobComplete callback, std::shared_ptr<T> params, size_t param_size) {
-		// Create the new entry.
-		JobResultEntry Entry;
-		Entry.id = INVALID_ID_U16;
-		Entry.param_size = (uint32_t)param_size;
-		Entry.callback = std::move(callback);
-
-		if (Entry.param_size > 0) {
-			// Take a copy, as the job is destroyed after this.
-			Entry.params = std::move(params);
-		}
-		else {
-			Entry.params = nullptr;
-		}
+	friend class JobHandle;
 
-		// Lock, find a free space, store, unlock.
-		if (!ResultMutex.Lock()) {
-			LOG_ERROR("Failed to obtain mutex lock for storing a result! Result storage may be corrupted.");
-		}
+	/**
+	 * @brief Queues a completion callback to be run on the main thread by the next update.
+	 * Waits for the main thread to make room if the completion queue is full.
+	 */
+	static void StoreResult(PFN_JobComplete callback, JobRecord* record);
 
-		for (unsigned short i = 0; i < MAX_JOB_RESULTS; ++i) {
-			if (PendingResults[i].id == INVALID_ID_U16) {
-				PendingResults[i] = Entry;
-				PendingResults[i].id = i;
-				break;
-			}
-		}
+	/**
+	 * @brief Moves finished jobs from the completion queue to the main thread backlogs, making room for
+	 * job threads waiting on a full queue. Main thread only.
+	 * @returns The number of jobs moved.
+	 */
+	static uint32_t DrainResults();
 
-		if (!ResultMutex.UnLock()) {
-			LOG_ERROR("Failed to release mutex lock for result storage, storage may be corrupted.");
-		}
-	}
+	/**
+	 * @brief Appends a finished job to the backlog its callback belongs to. Main thread only.
+	 */
+	static void DeferCompletion(JobRecord* record);
+
+	/**
+	 * @brief Runs backlogged completion callbacks within the budget. Main thread only.
+	 */
+	static void RunCompletions(double time_budget, uint32_t max_gpu_uploads);
 
 	static uint32_t RunJobThread(void* params);
-	static void ProcessQueue(std::queue<JobInfo>& queue, Mutex* queue_mutex);
+
+	/**
+	 * @brief Lays out the job threads for the given topology.
+	 * @returns The number of threads, their type and affinity masks are written to the arrays.
+	 */
+	static unsigned char PlanThreads(const JobSystemConfig& config, const SProcessorTopology& topology,
+		unsigned int out_type_masks[MAX_JOB_THREADS], uint64_t out_affinity_masks[MAX_JOB_THREADS]);
+	static void RunJob(JobRecord* job);
+
+	/**
+	 * @brief Checks if a job about to start was called off or missed its deadline.
+	 */
+	static bool IsCancelled(const JobRecord* job);
+
+	/**
+	 * @brief Retires a job called off before it started. Its counters are signaled, its callbacks never run.
+	 */
+	static void CancelJob(JobRecord* job);
+
+	/**
+	 * @brief Moves jobs which waited too long in a shared queue to the next priority. Main thread only.
+	 */
+	static void PromoteAgedJobs();
+
+	/**
+	 * @brief Adds a finished job to the calling thread's telemetry.
+	 */
+	static void RecordJob(const JobRecord* job, double start_time, double end_time, bool succeeded);
+
+	/**
+	 * @brief Collects the counters since the last update and hands them to Metrics. Main thread only.
+	 */
+	static void PublishMetrics(double now);
+
+	/**
+	 * @brief Frees the trace buffers and takes the command writing them away. No thread may be recording.
+	 */
+	static void ReleaseTraceBuffers();
+	static bool ParallelForJobStart(void* payload, void* context);
+
+	// Runs nothing, the continuation callback runs on the main thread once this job finished.
+	static bool MainThreadContinuationStart(void* payload, void* context);
+
+	/**
+	 * @brief Fills in a pooled record for the job and counts it on its signal counter. Scheduling is up to the caller.
+	 * @returns The record, holding one reference for the job and one for its handle.
+	 */
+	static JobRecord* CreateRecord(PFN_JobEntry entry, const void* payload, size_t payload_size, const JobDesc& desc);
+
+	// Runs once a file read finished, reporting its outcome.
+	static bool FileReadJobStart(void* payload, void* context);
+	static void OnFileReadComplete(FileReadResult* result, void* context);
+
+	/**
+	 * @brief Takes a record from the pool, or the heap if the pool is empty.
+	 */
+	static JobRecord* AcquireRecord();
+
+	/**
+	 * @brief Drops a reference on the record, returning it to the pool once the last one is gone.
+	 */
+	static void ReleaseRecord(JobRecord* record);
+
+	/**
+	 * @brief Takes the next suspended fiber ready to resume or, if there is none, the next job.
+	 * @returns True if any work was found.
+	 */
+	static bool AcquireWork(JobThread* thr, JobRecord*& out_job, JobFiber*& out_fiber);
+
+	/**
+	 * @brief Reads the calling job thread. Kept out of line, since a fiber may resume on another thread
+	 * and the compiler would otherwise reuse a thread local address computed before the switch.
+	 */
+	static DNOINLINE JobThread* GetCurrentThread();
+
+	static void FiberMain(void* params);
+	static JobFiber* AcquireFiber();
+	static void ReleaseFiber(JobFiber* fiber);
+
+	/**
+	 * @brief Switches from the thread fiber to a job fiber, then parks or releases it once it switches back.
+	 */
+	static void RunFiber(JobThread* thr, JobFiber* fiber);
+
+	/**
+	 * @brief Queues a suspended fiber whose counter reached zero to be resumed.
+	 */
+	static void ScheduleFiber(JobFiber* fiber);
+	static JobFiber* PopReadyFiber(uint32_t type_mask);
+
+	/**
+	 * @brief Queues a job whose dependencies are met.
+	 */
+	static void Schedule(JobRecord* job);
+
+	/**
+	 * @brief Decrements the counter, scheduling the jobs waiting on it once it reaches zero.
+	 */
+	static void SignalCounter(JobCounter* counter);
+
+	/**
+	 * @brief Takes the next job the given thread can handle, highest priority first. Looks at the
+	 * thread's own deque, then the shared queue, then steals from other threads.
+	 * @param thr The calling job thread, or nullptr if not called from a job thread.
+	 */
+	static JobRecord* AcquireJob(JobThread* thr, uint32_t type_mask);
+	static JobRecord* PopSharedQueue(int priority, uint32_t type_mask);
+	static JobRecord* StealJob(JobThread* thr, int priority);
+
+	/**
+	 * @brief Wakes up one sleeping job thread that is able to handle the given job type.
+	 */
+	static void WakeThread(JobType type);
 
 private:
-	static bool IsRunning;
+	static std::atomic<bool> IsRunning;
 	static unsigned char ThreadCount;
-	static JobThread JobThreads[32];
-	
-	static std::queue<JobInfo> LowPriorityQueue;
-	static std::queue<JobInfo> NormalPriorityQueue;
-	static std::queue<JobInfo> HighPriorityQueue;
-	
+	// The number of threads able to run general jobs, bounds the helpers of a parallel for.
+	static unsigned char GeneralThreadCount;
+	static JobThread JobThreads[MAX_JOB_THREADS];
+	// The job thread the calling thread is, nullptr on any other thread.
+	static thread_local JobThread* CurrentThread;
+	static std::atomic<uint32_t> SleepingCount;
+
+	// Shared queues for jobs submitted from outside the job threads, and for typed jobs
+	// that must reach a dedicated thread. Indexed by JobPriority.
+	// Intrusive lists linked through JobRecord::next, so queuing never allocates.
+	static JobRecord* SharedQueueHeads[JOB_PRIORITY_COUNT];
+	static JobRecord* SharedQueueTails[JOB_PRIORITY_COUNT];
 	// Mutexes for each queue, since a job could be kicked off from another job (thread).
-	static Mutex LowPriQueueMutex;
-	static Mutex NormalPriQueueMutex;
-	static Mutex HighPriQueueMutex;
+	static Mutex SharedQueueMutexes[JOB_PRIORITY_COUNT];
+	// Lets threads skip locking empty queues.
+	static std::atomic<uint32_t> SharedQueueCounts[JOB_PRIORITY_COUNT];
 	
-	static JobResultEntry PendingResults[MAX_JOB_RESULTS];
-	static Mutex ResultMutex;
+	static JobRecord* RecordPool;
+	static JobRecord* FreeRecords;
+	// NOTE: Taking or returning a record is a couple of instructions, so spinning is cheaper than a Mutex.
+	static std::atomic_flag FreeRecordLock;
+
+	static bool UseFibers;
+	static JobFiber FiberPool[JOB_FIBER_COUNT];
+	static JobFiber* FreeFibers;
+	static Mutex FiberMutex;
+	// Suspended fibers whose counter reached zero, resumed before any new job is started.
+	static std::deque<JobFiber*> ReadyFibers;
+	static Mutex ReadyFiberMutex;
+	static std::atomic<uint32_t> ReadyFiberCount;
+
+	// Finished jobs waiting for their callbacks to run on the main thread.
+	static MPSCQueue<JobResultEntry> CompletedResults;
+	// Finished jobs taken off the queue whose callbacks did not fit in an update yet, linked through
+	// JobRecord::next. Callbacks uploading to the GPU wait in a backlog of their own. Main thread only.
+	static JobRecord* CompletionHead;
+	static JobRecord* CompletionTail;
+	static JobRecord* UploadHead;
+	static JobRecord* UploadTail;
+	static uint32_t BacklogCount;
+	// Set if the next callback run comes from the upload backlog, the backlogs take turns.
+	static bool UploadTurn;
+	// The thread which initialized the system and runs the updates.
+	static size_t MainThreadID;
+
+	static std::atomic<bool> TelemetryEnabled;
+	// One per job thread, the last one is shared by every other thread running jobs.
+	static JobThreadTelemetry ThreadTelemetry[MAX_JOB_THREADS + 1];
+	// Jobs suspended in fiber mode, waiting on a counter or ready to resume.
+	static std::atomic<uint32_t> SuspendedCount;
+	// The number of updates so far, and when the most recent ones started.
+	static uint64_t FrameIndex;
+	static double FrameStartTimes[JOB_TRACE_FRAME_COUNT];
+	// Counts updates for aging. Cheaper to read than the clock, and jobs only age as updates happen anyway.
+	static std::atomic<uint32_t> UpdateIndex;
 };
+
+template<typename PayloadType>
+JobHandle JobHandle::Then(PFN_JobEntry entry, const PayloadType& payload, JobDesc desc) const {
+	// The continuation parks on the counter of this job, the handle keeps it alive until then.
+	desc.wait_counter = Record != nullptr ? &Record->finished : nullptr;
+	return JobSystem::Submit(entry, payload, desc);
+}
+
+template<typename PayloadType>
+JobHandle JobHandle::ThenOnMainThread(PFN_JobComplete callback, const PayloadType& payload, void* context) const {
+	JobDesc Desc;
+	Desc.on_success = callback;
+	Desc.on_failed = callback;
+	Desc.context = context;
+	Desc.name = "MainThreadContinuation";
+	return Then(JobSystem::MainThreadContinuationStart, payload, Desc);
+}
@@ -17,8 +17,8 @@ MaterialShaderUniformLocations MaterialSystem::MaterialLocations;
 uint32_t MaterialSystem::MaterialShaderID = INVALID_ID;
 UIShaderUniformLocations MaterialSystem::UILocations;
 uint32_t MaterialSystem::UIShaderID = INVALID_ID;
-std::vector<Material*> MaterialSystem::RegisteredMaterials;
-std::unordered_map<std::string, uint32_t> MaterialSystem::MaterialMap;
+TEngineVector<Material*, eMemory_Type_Material_Instance>* MaterialSystem::RegisteredMaterials = nullptr;
+TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_Material_Instance>* MaterialSystem::MaterialMap = nullptr;
 
 bool MaterialSystem::Initialize(IRenderer* renderer, SMaterialSystemConfig config) {
 	if (config.max_material_count == 0) {
@@ -40,7 +40,8 @@ bool MaterialSystem::Initialize(IRenderer* renderer, SMaterialSystemConfig confi
 
 	// Invalidate all textures in the array.
 	uint32_t Count = MaterialSystemConfig.max_material_count;
-	RegisteredMaterials.resize(Count);
+	RegisteredMaterials = NewObject<TEngineVector<Material*, eMemory_Type_Material_Instance>>(Count);
+	MaterialMap = NewObject<TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_Material_Instance>>();
 
 	// Create default textures for use in the system.
 	if (!CreateDefaultMaterial()) {
@@ -53,22 +54,28 @@ bool MaterialSystem::Initialize(IRenderer* renderer, SMaterialSystemConfig confi
 }
 
 void MaterialSystem::Shutdown() {
-	// Destroy all loaded textures.
-	for (Material* m : RegisteredMaterials) {
-		if (m) {
-			DestroyMaterial(m);
-			DeleteObject(m);
-			m = nullptr;
-		}
-	};
-	RegisteredMaterials.clear();
-	std::vector<Material*>().swap(RegisteredMaterials);
+	if (RegisteredMaterials != nullptr) {
+		// Destroy all loaded textures.
+		for (Material* m : *RegisteredMaterials) {
+			if (m) {
+				DestroyMaterial(m);
+				DeleteObject(m);
+				m = nullptr;
+			}
+		};
+		DeleteObject(RegisteredMaterials);
+		RegisteredMaterials = nullptr;
+		DeleteObject(MaterialMap);
+		MaterialMap = nullptr;
+	}
 
 	if (DefaultMaterial) {
 		DestroyMaterial(DefaultMaterial);
 		DeleteObject(DefaultMaterial);
 		DefaultMaterial = nullptr;
 	}
+
+	Initilized = false;
 }
 
 Material* MaterialSystem::Acquire(const char* name) {
@@ -107,16 +114,16 @@ Material* MaterialSystem::AcquireFromConfig(SMaterialConfig config) {
 	}
 
 	// 如果找不到材质，则创建一个新的材质。
-	if (MaterialMap.find(config.name) == MaterialMap.end()) {
+	if (MaterialMap->find(config.name) == MaterialMap->end()) {
 		uint32_t Count = MaterialSystemConfig.max_material_count;
 		Material* m = nullptr;
 		for (uint32_t i = 0; i < Count; ++i) {
-			if (RegisteredMaterials[i] == nullptr) {
+			if ((*RegisteredMaterials)[i] == nullptr) {
 				// A free slot has been found. Use it index as the handle.
-				RegisteredMaterials[i] = NewObject<Material>();
-				RegisteredMaterials[i]->SetID(i);
-				MaterialMap[config.name] = i;
-				m = RegisteredMaterials[i];
+				(*RegisteredMaterials)[i] = NewObject<Material>();
+				(*RegisteredMaterials)[i]->SetID(i);
+				(*MaterialMap)[config.name] = i;
+				m = (*RegisteredMaterials)[i];
 				break;
 			}
 		}
@@ -173,10 +180,10 @@ Material* MaterialSystem::AcquireFromConfig(SMaterialConfig config) {
 		}
 	}
 
-	uint32_t MaterialID = MaterialMap[config.name];
+	uint32_t MaterialID = (*MaterialMap)[config.name];
 	Material* Mat = GetDefaultMaterial();
 	if (MaterialID != INVALID_ID) {
-		Mat = RegisteredMaterials[MaterialID];
+		Mat = (*RegisteredMaterials)[MaterialID];
 	}
 	ASSERT(Mat != nullptr);
 
@@ -201,9 +208,9 @@ void MaterialSystem::Release(const char* name) {
 	// Take a copy of name, it will be zero-out in DestroyMaterial();
 	char* CopyMatName = StringCopy(name);
 
-	if (MaterialMap.find(CopyMatName) != MaterialMap.end()) {
-		uint32_t MaterialID = MaterialMap[CopyMatName];
-		Material* Mat = RegisteredMaterials[MaterialID];
+	if (MaterialMap->find(CopyMatName) != MaterialMap->end()) {
+		uint32_t MaterialID = (*MaterialMap)[CopyMatName];
+		Material* Mat = (*RegisteredMaterials)[MaterialID];
 		if (Mat->GetReferenceCount() == 0) {
 			LOG_WARN("Tried to release non-existent material: %s", CopyMatName);
 			return;
@@ -214,12 +221,12 @@ void MaterialSystem::Release(const char* name) {
 			// Release material.
 			DestroyMaterial(Mat);
 			DeleteObject(Mat);
-			RegisteredMaterials[MaterialID] = nullptr;
+			(*RegisteredMaterials)[MaterialID] = nullptr;
 			LOG_INFO("Released material '%s'. Material unloaded.", CopyMatName);
 		}
 
 		// Update the entry.
-		MaterialMap.erase(CopyMatName);
+		MaterialMap->erase(CopyMatName);
 	}
 
 	Memory::Free(CopyMatName, sizeof(char) * strlen(CopyMatName) + 1, MemoryType::eMemory_Type_String);
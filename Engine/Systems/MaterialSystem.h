@@ -2,7 +2,7 @@
 
 #include "Defines.hpp"
 #include "Resources/ResourceTypes.hpp"
-#include <unordered_map>
+#include "Memory/EngineAllocator.h"
 
 class IRenderer;
 
@@ -68,9 +68,9 @@ public:
 	static Material* DefaultMaterial;
 
 	// Array of registered materials.
-	static std::vector<Material*> RegisteredMaterials;
+	static TEngineVector<Material*, eMemory_Type_Material_Instance>* RegisteredMaterials;
 	// Hashtable for material lookups.
-	static std::unordered_map<std::string, uint32_t> MaterialMap;
+	static TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_Material_Instance>* MaterialMap;
 
 	// Know locations for the material shader.
 	static MaterialShaderUniformLocations MaterialLocations;
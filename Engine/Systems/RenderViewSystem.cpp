@@ -16,8 +16,8 @@
 bool RenderViewSystem::Initialized = false;
 uint32_t RenderViewSystem::MaxViewCount = 0;
 IRenderer* RenderViewSystem::Renderer = nullptr;
-std::vector<IRenderView*> RenderViewSystem::RegisteredViews;
-std::unordered_map<std::string, uint32_t> RenderViewSystem::RegisteredViewMap;
+TEngineVector<IRenderView*, eMemory_Type_Renderer>* RenderViewSystem::RegisteredViews = nullptr;
+TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_Renderer>* RenderViewSystem::RegisteredViewMap = nullptr;
 
 bool RenderViewSystem::Initialize(IRenderer* renderer, SRenderViewSystemConfig config) {
 	if (renderer == nullptr) {
@@ -34,19 +34,21 @@ bool RenderViewSystem::Initialize(IRenderer* renderer, SRenderViewSystemConfig c
 	Renderer = renderer;
 
 	// Fill the array with invalid entries.
-	RegisteredViews.resize(MaxViewCount);
-	for (uint32_t i = 0; i < MaxViewCount; ++i) {
-		RegisteredViews[i] = nullptr;
-	}
+	RegisteredViews = NewObject<TEngineVector<IRenderView*, eMemory_Type_Renderer>>(MaxViewCount, nullptr);
+	RegisteredViewMap = NewObject<TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_Renderer>>();
 
 	Initialized = true;
 	return true;
 }
 
 void RenderViewSystem::Shutdown() {
+	if (RegisteredViews == nullptr) {
+		return;
+	}
+
 	// Renderview
-	for (uint32_t i = 0; i < RegisteredViews.size(); ++i) {
-		IRenderView* View = RegisteredViews[i];
+	for (uint32_t i = 0; i < RegisteredViews->size(); ++i) {
+		IRenderView* View = (*RegisteredViews)[i];
 		if (View == nullptr) {
 			continue;
 		}
@@ -59,11 +61,14 @@ void RenderViewSystem::Shutdown() {
 			View->Passes[j].Targets.clear();
 			View->Passes[j].Destroy();
 		}
-		RegisteredViews[i]->Passes.clear();
-		RegisteredViews[i]->OnDestroy();
-	}
-	RegisteredViews.clear();
-	std::vector<IRenderView*>().swap(RegisteredViews);
+		(*RegisteredViews)[i]->Passes.clear();
+		(*RegisteredViews)[i]->OnDestroy();
+	}
+	DeleteObject(RegisteredViews);
+	RegisteredViews = nullptr;
+	DeleteObject(RegisteredViewMap);
+	RegisteredViewMap = nullptr;
+	Initialized = false;
 }
 
 bool RenderViewSystem::Create(const RenderViewConfig& config) {
@@ -78,14 +83,14 @@ bool RenderViewSystem::Create(const RenderViewConfig& config) {
 	}
 
 	unsigned short ID = INVALID_ID_U16;
-	if (RegisteredViewMap.find(config.name) != RegisteredViewMap.end()){
+	if (RegisteredViewMap->find(config.name) != RegisteredViewMap->end()){
 		LOG_ERROR("RenderViewSystem::Create() A view named '%s' already exists. A new one will not be created.", config.name);
 		return false;
 	}
 
 	// Find a new ID.
 	for (uint32_t i = 0; i < MaxViewCount; ++i) {
-		if (RegisteredViews[i] == nullptr) {
+		if ((*RegisteredViews)[i] == nullptr) {
 			ID = i;
 			break;
 		}
@@ -99,22 +104,22 @@ bool RenderViewSystem::Create(const RenderViewConfig& config) {
 
 	// TODO: Assign these function pointers to known functions based on the view type.
 	// TODO: Refactor pattern.
-	if (RegisteredViews[ID] == nullptr) {
+	if ((*RegisteredViews)[ID] == nullptr) {
 		if (config.type == RenderViewKnownType::eRender_View_Known_Type_World) {
-			RegisteredViews[ID] = new RenderViewWorld(config);
+			(*RegisteredViews)[ID] = new RenderViewWorld(config);
 		}
 		else if (config.type == RenderViewKnownType::eRender_View_Known_Type_UI) {
-			RegisteredViews[ID] = new RenderViewUI(config);
+			(*RegisteredViews)[ID] = new RenderViewUI(config);
 		}
 		else if (config.type == RenderViewKnownType::eRender_View_Known_Type_Skybox) {
-			RegisteredViews[ID] = new RenderViewSkybox(config);
+			(*RegisteredViews)[ID] = new RenderViewSkybox(config);
 		}
 		else if (config.type == RenderViewKnownType::eRender_View_Known_Type_Pick) {
-			RegisteredViews[ID] = new RenderViewPick(config, Renderer);
+			(*RegisteredViews)[ID] = new RenderViewPick(config, Renderer);
 		}
 	}
 
-	IRenderView* View = RegisteredViews[ID];
+	IRenderView* View = (*RegisteredViews)[ID];
 	View->ID = ID;
 
 	for (uint32_t i = 0; i < View->RenderpassCount; ++i) {
@@ -128,7 +133,7 @@ bool RenderViewSystem::Create(const RenderViewConfig& config) {
 	RegenerateRendertargets(View);
 
 	// Update the hashtable entry.
-	RegisteredViewMap[config.name] = ID;
+	(*RegisteredViewMap)[config.name] = ID;
 
 	return true;
 }
@@ -176,23 +181,23 @@ void RenderViewSystem::RegenerateRendertargets(IRenderView* view) {
 
 void RenderViewSystem::OnWindowResize(uint32_t width, uint32_t height) {
 	// Send to all view.
-	for (uint32_t i = 0; i < RegisteredViews.size(); ++i) {
-		if (RegisteredViews[i]) {
-			RegisteredViews[i]->OnResize(width, height);
+	for (uint32_t i = 0; i < RegisteredViews->size(); ++i) {
+		if ((*RegisteredViews)[i]) {
+			(*RegisteredViews)[i]->OnResize(width, height);
 		}
 	}
 }
 
 IRenderView* RenderViewSystem::Get(const std::string& name) {
 	if (Initialized) {
-		if (RegisteredViewMap.find(name) == RegisteredViewMap.end()){
+		if (RegisteredViewMap->find(name) == RegisteredViewMap->end()){
 			LOG_WARN("Can not find render view '%s', return nullptr.", name.c_str());
 			return nullptr;
 		}
 
-		uint16_t ID = RegisteredViewMap[name];
+		uint16_t ID = (*RegisteredViewMap)[name];
 		if (ID != INVALID_ID_U16) {
-			IRenderView* Result = RegisteredViews[ID];
+			IRenderView* Result = (*RegisteredViews)[ID];
 			return Result;
 		}
 	}
@@ -4,6 +4,7 @@
 #include "Math/MathTypes.hpp"
 #include "Containers/TArray.hpp"
 #include "Containers/THashTable.hpp"
+#include "Memory/EngineAllocator.h"
 #include "Renderer/Interface/IRenderView.hpp"
 
 class IRenderer;
@@ -32,6 +33,6 @@ private:
 	static IRenderer* Renderer;
 	static uint32_t MaxViewCount;
 
-	static std::vector<IRenderView*> RegisteredViews;
-	static std::unordered_map<std::string, uint32_t> RegisteredViewMap;
+	static TEngineVector<IRenderView*, eMemory_Type_Renderer>* RegisteredViews;
+	static TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_Renderer>* RegisteredViewMap;
 };
\ No newline at end of file
@@ -12,7 +12,7 @@
 #include "Resources/Loaders/SystemFontLoader.hpp"
 
 SResourceSystemConfig ResourceSystem::Config;
-std::vector<IResourceLoader*> ResourceSystem::RegisteredLoaders;
+TEngineVector<IResourceLoader*, eMemory_Type_Resource>* ResourceSystem::RegisteredLoaders = nullptr;
 bool ResourceSystem::Initilized = false;
 
 bool ResourceSystem::Initialize(SResourceSystemConfig config) {
@@ -22,6 +22,7 @@ bool ResourceSystem::Initialize(SResourceSystemConfig config) {
 	}
 
 	Config = config;
+	RegisteredLoaders = NewObject<TEngineVector<IResourceLoader*, eMemory_Type_Resource>>();
 
 	// NOTE: Auto-register known loader types here.
 	IResourceLoader* BinLoader = NewObject<BinaryLoader>();
@@ -47,17 +48,18 @@ bool ResourceSystem::Initialize(SResourceSystemConfig config) {
 
 void ResourceSystem::Shutdown() {
 	if (Initilized) {
-		for (uint32_t i = 0; i < RegisteredLoaders.size(); i++) {
-			DeleteObject(RegisteredLoaders[i]);
+		for (uint32_t i = 0; i < RegisteredLoaders->size(); i++) {
+			DeleteObject((*RegisteredLoaders)[i]);
 		}
 
-		RegisteredLoaders.clear();
-		std::vector<IResourceLoader*>().swap(RegisteredLoaders);
+		DeleteObject(RegisteredLoaders);
+		RegisteredLoaders = nullptr;
+		Initilized = false;
 	}
 }
 
 bool ResourceSystem::RegisterLoader(IResourceLoader* loader) {
-	uint32_t Count = (uint32_t)RegisteredLoaders.size();
+	uint32_t Count = (uint32_t)RegisteredLoaders->size();
 	if (Count > Config.max_loader_count) {
 		LOG_ERROR("Can not register more loader, max loader count is %d.", Config.max_loader_count);
 		return false;
@@ -65,13 +67,13 @@ bool ResourceSystem::RegisterLoader(IResourceLoader* loader) {
 
 	// Ensure no loaders for the given type already exist.
 	for (uint32_t i = 0; i < Count; ++i) {
-		if (RegisteredLoaders[i] == nullptr) continue;
-		if (RegisteredLoaders[i]->Id != INVALID_ID) {
-			if (RegisteredLoaders[i]->Type == loader->Type) {
+		if ((*RegisteredLoaders)[i] == nullptr) continue;
+		if ((*RegisteredLoaders)[i]->Id != INVALID_ID) {
+			if ((*RegisteredLoaders)[i]->Type == loader->Type) {
 				LOG_ERROR("Resource system register loader error. Loader of type %d already exists and will ot be registered.", loader->Type);
 				return false;
 			}
-			else if (RegisteredLoaders[i]->CustomType.length() > 0 && RegisteredLoaders[i]->CustomType.compare(loader->CustomType) == 0) {
+			else if ((*RegisteredLoaders)[i]->CustomType.length() > 0 && (*RegisteredLoaders)[i]->CustomType.compare(loader->CustomType) == 0) {
 				LOG_ERROR("Resource system register loader error. Loader of custom type %d already exists and will ot be registered.", loader->CustomType.c_str());
 				return false;
 			}
@@ -79,7 +81,7 @@ bool ResourceSystem::RegisterLoader(IResourceLoader* loader) {
 	}
 
 	loader->Id = Count;
-	RegisteredLoaders.push_back(loader);
+	RegisteredLoaders->push_back(loader);
 
 	return true;
 }
@@ -89,9 +91,9 @@ bool ResourceSystem::Load(const std::string& name, ResourceType type, void* para
 		// Select loader.
 		uint32_t Count = Config.max_loader_count;
 		for (uint32_t i = 0; i < Count; ++i) {
-			if (RegisteredLoaders[i]->Id != INVALID_ID && RegisteredLoaders[i]->Type == type) {
-				resource->LoaderID = RegisteredLoaders[i]->Id;
-				return RegisteredLoaders[i]->Load(name, params, resource);
+			if ((*RegisteredLoaders)[i]->Id != INVALID_ID && (*RegisteredLoaders)[i]->Type == type) {
+				resource->LoaderID = (*RegisteredLoaders)[i]->Id;
+				return (*RegisteredLoaders)[i]->Load(name, params, resource);
 			}
 		}
 	}
@@ -109,9 +111,9 @@ bool ResourceSystem::LoadCustom(const std::string& name, const char* custom_type
 
 	uint32_t Count = Config.max_loader_count;
 	for (uint32_t i = 0; i < Count; ++i) {
-		if (RegisteredLoaders[i]->Id != INVALID_ID && RegisteredLoaders[i]->Type == eResource_type_Custom && RegisteredLoaders[i]->CustomType.compare(custom_type)== 0) {
-			resource->LoaderID = RegisteredLoaders[i]->Id;
-			return RegisteredLoaders[i]->Load(name, params, resource);
+		if ((*RegisteredLoaders)[i]->Id != INVALID_ID && (*RegisteredLoaders)[i]->Type == eResource_type_Custom && (*RegisteredLoaders)[i]->CustomType.compare(custom_type)== 0) {
+			resource->LoaderID = (*RegisteredLoaders)[i]->Id;
+			return (*RegisteredLoaders)[i]->Load(name, params, resource);
 		}
 	}
 
@@ -126,7 +128,7 @@ void ResourceSystem::Unload(Resource* resource) {
 	}
 
 	if (resource->LoaderID != INVALID_ID) {
-		IResourceLoader* Loader = RegisteredLoaders[resource->LoaderID];
+		IResourceLoader* Loader = (*RegisteredLoaders)[resource->LoaderID];
 		if (Loader->Id != INVALID_ID) {
 			Loader->Unload(resource);
 		}
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "Resources/Resource.hpp"
-#include <vector>
+#include "Memory/EngineAllocator.h"
 
 class IResourceLoader;
 
@@ -27,7 +27,7 @@ public:
 
 public:
 	static SResourceSystemConfig Config;
-	static std::vector<IResourceLoader*> RegisteredLoaders;
+	static TEngineVector<IResourceLoader*, eMemory_Type_Resource>* RegisteredLoaders;
 
 	static bool Initilized;
 };
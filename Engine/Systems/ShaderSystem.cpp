@@ -11,10 +11,10 @@
 
 IRenderer* ShaderSystem::Renderer = nullptr;
 ShaderSystem::Config ShaderSystem::ShaderSystemConfig;
-std::unordered_map<std::string, uint32_t> ShaderSystem::ShaderMap;
+TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_Renderer>* ShaderSystem::ShaderMap = nullptr;
 
 uint32_t ShaderSystem::CurrentShaderID;
-std::vector<Shader*> ShaderSystem::Shaders;
+TEngineVector<Shader*, eMemory_Type_Renderer>* ShaderSystem::Shaders = nullptr;
 bool ShaderSystem::Initilized = false;
 ShaderLanguage ShaderSystem::GLOBAL_SHADER_TYPE = ShaderLanguage::eHLSL;
 
@@ -47,7 +47,8 @@ bool ShaderSystem::Initialize(IRenderer* renderer, ShaderSystem::Config config)
 	
 	// Figure out how large of a hashtable is needed.
 	// Block of memory will contain state structure then the block for the hashtable.
-	Shaders.resize(config.max_shader_count);
+	Shaders = NewObject<TEngineVector<Shader*, eMemory_Type_Renderer>>(config.max_shader_count);
+	ShaderMap = NewObject<TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_Renderer>>();
 	ShaderSystemConfig = config;
 	CurrentShaderID = INVALID_ID;
 
@@ -63,7 +64,7 @@ bool ShaderSystem::Initialize(IRenderer* renderer, ShaderSystem::Config config)
 void ShaderSystem::Shutdown() {
 	if (Initilized) {
 		for (uint32_t i = 0; i < ShaderSystemConfig.max_shader_count; ++i) {
-			Shader* s = Shaders[i];
+			Shader* s = (*Shaders)[i];
 			if (s != nullptr) {
 				if (s->ID != INVALID_ID) {
 					s->Destroy();
@@ -76,8 +77,11 @@ void ShaderSystem::Shutdown() {
 
 		EngineEvent::Unregister(eEventCode::Reload_Shader_Module, nullptr, OnReloadShader);
 
-		ShaderMap.clear();
-		std::vector<Shader*>().swap(Shaders);
+		DeleteObject(ShaderMap);
+		ShaderMap = nullptr;
+		DeleteObject(Shaders);
+		Shaders = nullptr;
+		Initilized = false;
 	}
 }
 
@@ -111,7 +115,7 @@ bool ShaderSystem::Create(IRenderpass* pass, ShaderConfig* config) {
 	uint32_t ID = GetShaderID(config->name);
 	if (ID == INVALID_ID) {
 		ID = NewShaderID();
-		ShaderMap[config->name] = ID;
+		(*ShaderMap)[config->name] = ID;
 	}
 	else {
 		LOG_WARN("Shader named '%s' already create. It will be covered.", config->name);
@@ -121,7 +125,7 @@ bool ShaderSystem::Create(IRenderpass* pass, ShaderConfig* config) {
 	switch (BackendAPI)
 	{
 	case eRenderer_Backend_Type_Vulkan:
-		Shaders[ID] = NewObject<VulkanShader>(Renderer);
+		(*Shaders)[ID] = NewObject<VulkanShader>(Renderer);
 		break;
 		// TODO
 	case eRenderer_Backend_Type_OpenGL:
@@ -129,11 +133,11 @@ bool ShaderSystem::Create(IRenderpass* pass, ShaderConfig* config) {
 	case eRenderer_Backend_Type_DirecX:
 		break;
 	default:
-		Shaders[ID] = NewObject<VulkanShader>(Renderer);
+		(*Shaders)[ID] = NewObject<VulkanShader>(Renderer);
 		break;
 	}
 	
-	Shader* OutShader = Shaders[ID];
+	Shader* OutShader = (*Shaders)[ID];
 	OutShader->ID = ID;
 	if (OutShader->ID == INVALID_ID) {
 		LOG_ERROR("Unable to find free slot to create new shader. Aborting.");
@@ -202,11 +206,11 @@ unsigned ShaderSystem::GetID(const char* shader_name) {
 }
 
 Shader* ShaderSystem::GetByID(uint32_t shader_id) {
-	if (shader_id >= ShaderSystemConfig.max_shader_count || Shaders[shader_id]->ID == INVALID_ID) {
+	if (shader_id >= ShaderSystemConfig.max_shader_count || (*Shaders)[shader_id]->ID == INVALID_ID) {
 		return nullptr;
 	}
 
-	return Shaders[shader_id];
+	return (*Shaders)[shader_id];
 }
 
 Shader* ShaderSystem::Get(const std::string& shader_name) {
@@ -228,7 +232,7 @@ void ShaderSystem::Destroy(const char* shader_name) {
 		return;
 	}
 
-	Shader* s = Shaders[ShaderID];
+	Shader* s = (*Shaders)[ShaderID];
 	s->Destroy();
 }
 
@@ -289,7 +293,7 @@ bool ShaderSystem::SetUniform(const char* uniform_name, const void* value) {
 		LOG_ERROR("ShaderSystem::SetUniform called without a shader in use.");
 		return false;
 	}
-	Shader* s = Shaders[CurrentShaderID];
+	Shader* s = (*Shaders)[CurrentShaderID];
 	unsigned short Index = GetUniformIndex(s, uniform_name);
 	return SetUniformByIndex(Index, value);
 }
@@ -304,7 +308,7 @@ bool ShaderSystem::SetUniformByIndex(unsigned short index, const void* value) {
 		return false;
 	}
 
-	Shader* Shader = Shaders[CurrentShaderID];
+	Shader* Shader = (*Shaders)[CurrentShaderID];
 	ShaderUniform* uniform = &Shader->Uniforms[index];
 	if (Shader->BoundScope != uniform->scope) {
 		if (uniform->scope == eShader_Scope_Global) {
@@ -326,21 +330,21 @@ bool ShaderSystem::SetSamplerByIndex(unsigned short index, const Texture* tex) {
 }
 
 bool ShaderSystem::ApplyGlobal() {
-	return Renderer->ApplyGlobalRenderShader(Shaders[CurrentShaderID]);
+	return Renderer->ApplyGlobalRenderShader((*Shaders)[CurrentShaderID]);
 }
 
 bool ShaderSystem::ApplyInstance(bool need_update) {
-	return Renderer->ApplyInstanceRenderShader(Shaders[CurrentShaderID], need_update);
+	return Renderer->ApplyInstanceRenderShader((*Shaders)[CurrentShaderID], need_update);
 }
 
 bool ShaderSystem::BindGlobal(uint32_t instance_id) {
-	Shader* s = Shaders[CurrentShaderID];
+	Shader* s = (*Shaders)[CurrentShaderID];
 	s->BoundInstanceId = instance_id;
 	return Renderer->BindGlobalsRenderShader(s);
 }
 
 bool ShaderSystem::BindInstance(uint32_t instance_id) {
-	Shader* s = Shaders[CurrentShaderID];
+	Shader* s = (*Shaders)[CurrentShaderID];
 	s->BoundInstanceId = instance_id;
 	return Renderer->BindInstanceRenderShader(s, instance_id);
 }
@@ -463,8 +467,8 @@ bool ShaderSystem::AddUniform(Shader* shader, ShaderUniformConfig& config) {
 
 uint32_t ShaderSystem::GetShaderID(const std::string& shader_name) {
 	uint32_t ShaderID = INVALID_ID;
-	auto it = ShaderMap.find(shader_name);
-	if (it == ShaderMap.end()){
+	auto it = ShaderMap->find(shader_name);
+	if (it == ShaderMap->end()){
 		return INVALID_ID;
 	}
 
@@ -473,7 +477,7 @@ uint32_t ShaderSystem::GetShaderID(const std::string& shader_name) {
 
 uint32_t ShaderSystem::NewShaderID() {
 	for (uint32_t i = 0; i < ShaderSystemConfig.max_shader_count; ++i) {
-		if (Shaders[i] == nullptr || Shaders[i]->ID == INVALID_ID) {
+		if ((*Shaders)[i] == nullptr || (*Shaders)[i]->ID == INVALID_ID) {
 			return i;
 		}
 	}
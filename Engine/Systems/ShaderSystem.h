@@ -3,6 +3,7 @@
 #include "Defines.hpp"
 #include "Containers/THashTable.hpp"
 #include "Resources/ResourceTypes.hpp"
+#include "Memory/EngineAllocator.h"
 #include <functional>
 #include <map>
 
@@ -187,10 +188,10 @@ private:
 public:
 	static IRenderer* Renderer;
 	static ShaderSystem::Config ShaderSystemConfig;
-	static std::unordered_map<std::string, uint32_t> ShaderMap;
+	static TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_Renderer>* ShaderMap;
 	
 	static uint32_t CurrentShaderID;
-	static std::vector<Shader*> Shaders;
+	static TEngineVector<Shader*, eMemory_Type_Renderer>* Shaders;
 	
 	static bool Initilized;
 	static ShaderLanguage GLOBAL_SHADER_TYPE;
@@ -8,12 +8,15 @@
 #include "Systems/JobSystem.hpp"
 #include "Renderer/RendererFrontend.hpp"
 
+// Pixels per parallel chunk of the transparency scan.
+#define TEXTURE_ALPHA_SCAN_GRAIN 65536
+
 STextureSystemConfig TextureSystem::TextureSystemConfig;
 Texture* TextureSystem::DefaultDiffuseTexture = nullptr;
 Texture* TextureSystem::DefaultSpecularTexture = nullptr;
 Texture* TextureSystem::DefaultNormalTexture = nullptr;
 Texture* TextureSystem::DefaultRoughnessMetallicTexture = nullptr;
-std::unordered_map<std::string, Texture*> TextureSystem::TextureMap;
+TEngineUnorderedMap<std::string, Texture*, eMemory_Type_Texture>* TextureSystem::TextureMap = nullptr;
 bool TextureSystem::Initilized = false;
 IRenderer* TextureSystem::Renderer = nullptr;
 
@@ -34,6 +37,7 @@ bool TextureSystem::Initialize(IRenderer* renderer, STextureSystemConfig config)
 
 	TextureSystemConfig = config;
 	Renderer = renderer;
+	TextureMap = NewObject<TEngineUnorderedMap<std::string, Texture*, eMemory_Type_Texture>>();
 
 	// Create default textures for use in the system.
 	if (!CreateDefaultTexture()) {
@@ -46,17 +50,22 @@ bool TextureSystem::Initialize(IRenderer* renderer, STextureSystemConfig config)
 }
 
 void TextureSystem::Shutdown() {
-	// Destroy all loaded textures.
-	for (auto& PairsTex : TextureMap) {
-		Texture* tex = PairsTex.second;
-		if (tex != nullptr && tex->Generation != INVALID_ID) {
-			LOG_DEBUG("Destroying texture: '%s'.", tex->GetName().c_str());
-			Renderer->DestroyTexture(tex);
-			DeleteObject(tex);
+	if (TextureMap != nullptr) {
+		// Destroy all loaded textures.
+		for (auto& PairsTex : *TextureMap) {
+			Texture* tex = PairsTex.second;
+			if (tex != nullptr && tex->Generation != INVALID_ID) {
+				LOG_DEBUG("Destroying texture: '%s'.", tex->GetName().c_str());
+				Renderer->DestroyTexture(tex);
+				DeleteObject(tex);
+			}
 		}
+		DeleteObject(TextureMap);
+		TextureMap = nullptr;
 	}
 
 	DestroyDefaultTexture();
+	Initilized = false;
 }
 
 Texture* TextureSystem::Acquire(const char* name, bool auto_release) {
@@ -73,7 +82,7 @@ Texture* TextureSystem::Acquire(const char* name, bool auto_release) {
 		return nullptr;
 	}
 
-	OutTexture = TextureMap[name];
+	OutTexture = (*TextureMap)[name];
 	if (OutTexture == nullptr) {
 		LOG_ERROR("TextureSystem::Acquire() failed to get texture.");
 		return nullptr;
@@ -98,7 +107,7 @@ Texture* TextureSystem::AcquireCube(const char* name, bool auto_release) {
 		return nullptr;
 	}
 
-	OutTexture = TextureMap[name];
+	OutTexture = (*TextureMap)[name];
 	if (OutTexture == nullptr) {
 		LOG_ERROR("TextureSystem::Acquire() failed to get texture.");
 		return nullptr;
@@ -116,7 +125,7 @@ Texture* TextureSystem::AcquireWriteable(const char* name, uint32_t width, uint3
 		return nullptr;
 	}
 	
-	Texture* t = TextureMap[name];
+	Texture* t = (*TextureMap)[name];
 	t->SetID(ID);
 	t->Type = TextureType::eTexture_Type_2D;
 	t->SetName(name);
@@ -166,7 +175,7 @@ void TextureSystem::WrapInternal(const char* name, uint32_t width, uint32_t heig
 			return;
 		}
 
-		t = TextureMap[name];
+		t = (*TextureMap)[name];
 	}
 	else {
 		if (tex) {
@@ -482,8 +491,8 @@ bool TextureSystem::LoadCubeTexture(const std::string& name, const char texture_
 	return true;
 }
 
-void TextureSystem::LoadJobSuccess(void* params) {
-	TextureLoadParams* TextureParams = (TextureLoadParams*)params;
+void TextureSystem::LoadJobSuccess(void* payload, void* /*context*/) {
+	TextureLoadParams* TextureParams = *(TextureLoadParams**)payload;
 
 	// This also handles the GPU upload. Can't be jobfied until the renderer is multithread.
 	ImageResourceData* ResourceData = (ImageResourceData*)TextureParams->ImageResource.Data;
@@ -512,16 +521,18 @@ void TextureSystem::LoadJobSuccess(void* params) {
 
 	// Clean up data.
 	ResourceSystem::Unload(&TextureParams->ImageResource);
+	DeleteObject(TextureParams);
 }
 
-void TextureSystem::LoadJobFail(void* params) {
-	TextureLoadParams* TextureParams = (TextureLoadParams*)params;
+void TextureSystem::LoadJobFail(void* payload, void* /*context*/) {
+	TextureLoadParams* TextureParams = *(TextureLoadParams**)payload;
 	LOG_ERROR("Failed to load texture '%s'.", TextureParams->resource_name.c_str());
 	ResourceSystem::Unload(&TextureParams->ImageResource);
+	DeleteObject(TextureParams);
 }
 
-bool TextureSystem::LoadJobStart(void* params, void* result_data) {
-	TextureLoadParams* LoadParams = (TextureLoadParams*)params;
+bool TextureSystem::LoadJobStart(void* payload, void* /*context*/) {
+	TextureLoadParams* LoadParams = *(TextureLoadParams**)payload;
 
 	ImageResourceParams ResourceParams;
 	ResourceParams.flip_y = true;
@@ -542,25 +553,29 @@ bool TextureSystem::LoadJobStart(void* params, void* result_data) {
 	LoadParams->out_texture->Generation = INVALID_ID;
 
 	size_t TotalSize = LoadParams->temp_texture.Width * LoadParams->temp_texture.Height * LoadParams->temp_texture.ChannelCount;
-	// Check for transparency.
-	bool HasTransparency = false;
-	for (size_t i = 0; i < TotalSize; i += LoadParams->temp_texture.ChannelCount) {
-		unsigned char a = ResourceData->pixels[i + 3];
-		if (a < 255) {
-			HasTransparency = true;
-			break;
+	// Check for transparency. Chunks bail out as soon as any of them found a transparent pixel.
+	size_t ChannelCount = LoadParams->temp_texture.ChannelCount;
+	const unsigned char* Pixels = ResourceData->pixels;
+	std::atomic<bool> HasTransparency = false;
+	JobSystem::ParallelFor(0, TotalSize / ChannelCount, TEXTURE_ALPHA_SCAN_GRAIN, [&](size_t begin, size_t end) {
+		if (HasTransparency.load(std::memory_order_relaxed)) {
+			return;
 		}
-	}
+
+		for (size_t i = begin; i < end; ++i) {
+			unsigned char a = Pixels[i * ChannelCount + 3];
+			if (a < 255) {
+				HasTransparency = true;
+				return;
+			}
+		}
+	});
 
 	// Take a copy of the name
 	LoadParams->temp_texture.SetName(LoadParams->resource_name);
 	LoadParams->temp_texture.Generation = INVALID_ID;
 	LoadParams->temp_texture.Flags |= HasTransparency ? TextureFlagBits::eTexture_Flag_Has_Transparency : 0;
 
-	// NOTE: The load params are also used as the result data here, only the image_resource field is populated now.
-	Memory::Copy(result_data, LoadParams, sizeof(TextureLoadParams));
-	((TextureLoadParams*)result_data)->resource_name = LoadParams->resource_name;
-
 	return Result;
 }
 
@@ -591,19 +606,18 @@ Texture* TextureSystem::CheckTextureName(const std::string& name) {
 bool TextureSystem::LoadTexture(const std::string& name, Texture* texture) {
 	// Kick off a texture loading job. Only handles loading from disk to CPU.
 	// GPU upload is handled after completion of this job.
-	TextureLoadParams Params;
-	Params.resource_name = name;
-	Params.out_texture = texture;
-	Params.current_generation = texture->Generation;
-
-	JobInfo Job = JobSystem::CreateJob(
-		std::bind(&TextureSystem::LoadJobStart, std::placeholders::_1, std::placeholders::_2),
-		std::bind(&TextureSystem::LoadJobSuccess, std::placeholders::_1),
-		std::bind(&TextureSystem::LoadJobFail, std::placeholders::_1),
-		std::make_shared<TextureLoadParams>(Params),
-		sizeof(TextureLoadParams),
-		sizeof(TextureLoadParams));
-	JobSystem::Submit(Job);
+	// The job only carries a pointer to the params, they hold strings and a resource and do not fit inline.
+	TextureLoadParams* Params = NewObject<TextureLoadParams>();
+	Params->resource_name = name;
+	Params->out_texture = texture;
+	Params->current_generation = texture->Generation;
+
+	JobDesc Desc;
+	Desc.on_success = LoadJobSuccess;
+	Desc.on_failed = LoadJobFail;
+	Desc.name = "LoadTexture";
+	Desc.gpu_upload = true;
+	JobSystem::Submit(LoadJobStart, Params, Desc);
 	return true;
 }
 
@@ -613,7 +627,7 @@ bool TextureSystem::ProcessTextureReference(const std::string& name, TextureType
 		return false;
 	}
 
-	Texture* Tex = TextureMap[name];
+	Texture* Tex = (*TextureMap)[name];
 	// 创建新贴图资源
 	if (Tex == nullptr) {
 		// This means no texture exists here. Find a free index first.
@@ -624,7 +638,7 @@ bool TextureSystem::ProcessTextureReference(const std::string& name, TextureType
 				Tex = NewObject<Texture>();
 				Tex->SetID(i);
 				// Either way, update the entry.
-				TextureMap[name] = Tex;
+				(*TextureMap)[name] = Tex;
 				break;
 			}
 		}
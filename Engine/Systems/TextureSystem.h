@@ -4,6 +4,7 @@
 #include "Resources/Texture.hpp"
 #include "Resources/Resource.hpp"
 #include "Containers/THashTable.hpp"
+#include "Memory/EngineAllocator.h"
 
 #define DEFAULT_DIFFUSE_TEXTURE_NAME "DefaultBaseColorTexture"
 #define DEFAULT_SPECULAR_TEXTURE_NAME "DefaultSpecularTexture"
@@ -56,9 +57,10 @@ private:
 	static bool ProcessTextureReference(const std::string& name, TextureType type,
 		short reference_diff, bool auto_release, bool skip_load);
 
-	static void LoadJobSuccess(void* params);
-	static void LoadJobFail(void* params);
-	static bool LoadJobStart(void* params, void* result_data);
+	// The payload of the load job is a TextureLoadParams*, released by whichever callback runs.
+	static void LoadJobSuccess(void* payload, void* context);
+	static void LoadJobFail(void* payload, void* context);
+	static bool LoadJobStart(void* payload, void* context);
 
 private:
 	static STextureSystemConfig TextureSystemConfig;
@@ -68,7 +70,7 @@ private:
 	static Texture* DefaultRoughnessMetallicTexture;
 
 	// Hashtable for texture lookups.
-	static std::unordered_map<std::string, Texture*> TextureMap;
+	static TEngineUnorderedMap<std::string, Texture*, eMemory_Type_Texture>* TextureMap;
 
 	static bool Initilized;
 
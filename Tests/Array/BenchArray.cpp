@@ -0,0 +1,128 @@
+#include <iostream>
+#include "Containers/TArray.hpp"
+#include "Platform/Platform.hpp"
+#include "../Benchmark.h"
+
+#include <string>
+#include <vector>
+
+struct BenchArrayVertex {
+	float position[3];
+	float normal[3];
+	float texcoord[2];
+};
+
+// Sums what the benchmarks read back, so the compiler cannot drop the work.
+static size_t BenchArraySink = 0;
+
+/**
+ * @brief Adapts std::vector to the TArray calls the benchmarks use.
+ */
+template<typename ElementType>
+class BenchStdArray {
+public:
+	void Reserve(size_t capacity) { Elements.reserve(capacity); }
+	void Push(const ElementType& value) { Elements.push_back(value); }
+	template<typename... Args>
+	ElementType& EmplaceBack(Args&&... args) { return Elements.emplace_back(std::forward<Args>(args)...); }
+	size_t Size() const { return Elements.size(); }
+	ElementType& operator[](size_t i) { return Elements[i]; }
+
+private:
+	std::vector<ElementType> Elements;
+};
+
+/**
+ * @brief Fills round_count arrays with element_count elements each, made by the given function, growing them as they go
+ * or reserving up front. Reports the time per element added.
+ */
+template<typename Array, typename Make>
+static void BenchArrayPush(const std::string& name, int element_count, int round_count, bool reserve, Make make) {
+	double Start = Platform::PlatformGetAbsoluteTime();
+	for (int Round = 0; Round < round_count; ++Round) {
+		Array Elements;
+		if (reserve) {
+			Elements.Reserve(element_count);
+		}
+		for (int i = 0; i < element_count; ++i) {
+			Elements.Push(make(i));
+		}
+		BenchArraySink += Elements.Size();
+	}
+	double Seconds = Platform::PlatformGetAbsoluteTime() - Start;
+
+	int Count = element_count * round_count;
+	ReportBenchmark(name, 1, "", Count, Seconds * 1000000000.0 / Count, "ns/op");
+}
+
+/**
+ * @brief Builds strings in place at the end of the array, instead of building them apart and copying them in.
+ */
+template<typename Array>
+static void BenchArrayEmplace(const std::string& name, int element_count, int round_count) {
+	double Start = Platform::PlatformGetAbsoluteTime();
+	for (int Round = 0; Round < round_count; ++Round) {
+		Array Elements;
+		for (int i = 0; i < element_count; ++i) {
+			Elements.EmplaceBack(48, 'a' + (char)(i % 26));
+		}
+		BenchArraySink += Elements[element_count - 1].size();
+	}
+	double Seconds = Platform::PlatformGetAbsoluteTime() - Start;
+
+	int Count = element_count * round_count;
+	ReportBenchmark(name, 1, "", Count, Seconds * 1000000000.0 / Count, "ns/op");
+}
+
+/**
+ * @brief Collects arrays of vertices into an outer array, the way meshes are gathered, so growing the outer array
+ * moves the inner ones. Reports the time per inner array.
+ */
+template<typename Outer, typename Inner>
+static void BenchArrayNested(const std::string& name, int inner_count, int round_count) {
+	double Start = Platform::PlatformGetAbsoluteTime();
+	for (int Round = 0; Round < round_count; ++Round) {
+		Outer Meshes;
+		for (int i = 0; i < inner_count; ++i) {
+			Inner Vertices;
+			Vertices.Reserve(64);
+			Vertices.Push(BenchArrayVertex{ { (float)i } });
+			Meshes.EmplaceBack(std::move(Vertices));
+		}
+		BenchArraySink += Meshes.Size();
+	}
+	double Seconds = Platform::PlatformGetAbsoluteTime() - Start;
+
+	int Count = inner_count * round_count;
+	ReportBenchmark(name, 1, "", Count, Seconds * 1000000000.0 / Count, "ns/op");
+}
+
+int BenchArray() {
+	printf("Benchmark array...\n");
+
+	const int ElementCount = 10000;
+	const int RoundCount = 200;
+	auto MakeInt = [](int i) { return i; };
+	auto MakeVertex = [](int i) { return BenchArrayVertex{ { (float)i, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.5f, 0.5f } }; };
+	auto MakeString = [](int i) { return std::to_string(i * 7919) + "_benchmark_string_outside_sso"; };
+
+	BenchArrayPush<TArray<int>>("array_push_int", ElementCount, RoundCount, false, MakeInt);
+	BenchArrayPush<BenchStdArray<int>>("vector_push_int", ElementCount, RoundCount, false, MakeInt);
+	BenchArrayPush<TArray<int>>("array_reserve_push_int", ElementCount, RoundCount, true, MakeInt);
+	BenchArrayPush<BenchStdArray<int>>("vector_reserve_push_int", ElementCount, RoundCount, true, MakeInt);
+
+	BenchArrayPush<TArray<BenchArrayVertex>>("array_push_vertex", ElementCount, RoundCount, false, MakeVertex);
+	BenchArrayPush<BenchStdArray<BenchArrayVertex>>("vector_push_vertex", ElementCount, RoundCount, false, MakeVertex);
+
+	BenchArrayPush<TArray<std::string>>("array_push_string", ElementCount, RoundCount / 4, false, MakeString);
+	BenchArrayPush<BenchStdArray<std::string>>("vector_push_string", ElementCount, RoundCount / 4, false, MakeString);
+
+	BenchArrayEmplace<TArray<std::string>>("array_emplace_string", ElementCount, RoundCount / 4);
+	BenchArrayEmplace<BenchStdArray<std::string>>("vector_emplace_string", ElementCount, RoundCount / 4);
+
+	BenchArrayNested<TArray<TArray<BenchArrayVertex>>, TArray<BenchArrayVertex>>("array_nested_move", ElementCount / 10, RoundCount);
+	BenchArrayNested<BenchStdArray<BenchStdArray<BenchArrayVertex>>, BenchStdArray<BenchArrayVertex>>("vector_nested_move", ElementCount / 10, RoundCount);
+
+	printf("\n");
+	return BenchArraySink > 0 ? 0 : -1;
+}
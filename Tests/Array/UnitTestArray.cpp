@@ -107,4 +107,65 @@ void TestArray(){
 	TCopy T;
 	TCopy* Test1 = new TCopy(T);
 	TCopy* Test2 = NewObject<TCopy>(T);
+
+	// Moving hands the elements over and leaves the source empty.
+	TArray<CA> Source = ::T();
+	const CA* SourceData = Source.Data();
+	TArray<CA> Moved(std::move(Source));
+	TArray<CA> Assigned;
+	Assigned.Push(CA("ZZZZZZ"));
+	Assigned = std::move(Moved);
+	bool MoveOK = Assigned.Data() == SourceData && Assigned.Size() == 2 && Assigned[1].Str == "BBBBBB" &&
+		Source.IsEmpty() && Source.Data() == nullptr && Moved.IsEmpty() && Moved.Data() == nullptr;
+	printf("Array move construct and assign: %s\n", MoveOK ? "OK" : "FAILED");
+
+	// Reserved memory does not move while filling it, and elements are built in place.
+	TArray<CA> Emplaced;
+	Emplaced.Reserve(100);
+	const CA* ReservedData = Emplaced.Data();
+	bool EmplaceOK = Emplaced.GetCapacity() == 100;
+	for (int i = 0; i < 100; ++i) {
+		CA& Added = Emplaced.EmplaceBack(std::to_string(i));
+		EmplaceOK = EmplaceOK && Added.Str == std::to_string(i);
+	}
+	EmplaceOK = EmplaceOK && Emplaced.Data() == ReservedData && Emplaced.Size() == 100;
+
+	// Pushing an element of the array itself while it grows.
+	Emplaced.Push(Emplaced[0]);
+	EmplaceOK = EmplaceOK && Emplaced.Size() == 101 && Emplaced[100].Str == "0" && Emplaced[99].Str == "99";
+	printf("Array reserve and emplace: %s\n", EmplaceOK ? "OK" : "FAILED");
+
+	// Inserting and removing keep the order, for elements copied as a whole and for elements moved one by one.
+	TArray<int> Ints;
+	TArray<CA> Strings;
+	for (int i = 0; i < 10; ++i) {
+		if (i != 5) {
+			Ints.Push(i);
+			Strings.Push(CA(std::to_string(i)));
+		}
+	}
+	Ints.InsertAt(5, 5);
+	Strings.InsertAt(5, CA("5"));
+	int RemovedInt = Ints.PopAt(0);
+	CA RemovedString = Strings.PopAt(0);
+	bool OrderOK = RemovedInt == 0 && RemovedString.Str == "0" && Ints.Size() == 9 && Strings.Size() == 9;
+	for (int i = 0; i < 9 && OrderOK; ++i) {
+		OrderOK = Ints[i] == i + 1 && Strings[i].Str == std::to_string(i + 1);
+	}
+	printf("Array insert and remove: %s\n", OrderOK ? "OK" : "FAILED");
+
+	// Resizing zeroes what it adds, copies are deep.
+	TArray<int> Sized;
+	Sized.Push(7);
+	Sized.Resize(64);
+	bool ResizeOK = Sized.Size() == 64 && Sized[0] == 7;
+	for (int i = 1; i < 64 && ResizeOK; ++i) {
+		ResizeOK = Sized[i] == 0;
+	}
+	TArray<CA> Copied;
+	Copied.Push(CA("YYYYYY"));
+	Copied = Strings;
+	Copied[0].Str = "XXXXXX";
+	ResizeOK = ResizeOK && Copied.Size() == Strings.Size() && Strings[0].Str == "1" && Copied[8].Str == "9";
+	printf("Array resize and copy: %s\n", ResizeOK ? "OK" : "FAILED");
 }
\ No newline at end of file
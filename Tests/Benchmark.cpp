@@ -0,0 +1,29 @@
+#include "JobSystem/BenchJobSystem.cpp"
+#include "Freelist/BenchFreelist.cpp"
+#include "Memory/BenchMemory.cpp"
+#include "Array/BenchArray.cpp"
+
+int main(int argc, char** argv) {
+	// Results go to <prefix>.csv and <prefix>.json. Allocation traces recorded by memory_profile-trace may follow, replacing
+	// the one shipped in Memory/Traces.
+	std::string Prefix = argc > 1 ? argv[1] : "benchmark";
+	std::vector<std::string> TracePaths;
+	for (int i = 2; i < argc; ++i) {
+		TracePaths.push_back(argv[i]);
+	}
+
+	Memory::Initialize(GIBIBYTES(1));
+
+	BenchJobSystem();
+	BenchFreelist();
+	BenchMemory(TracePaths);
+	BenchArray();
+
+	if (!WriteBenchmarkCSV(Prefix + ".csv") || !WriteBenchmarkJSON(Prefix + ".json")) {
+		printf("Failed to write the benchmark results to %s.csv and %s.json.\n", Prefix.c_str(), Prefix.c_str());
+		return -1;
+	}
+
+	printf("Wrote %i results to %s.csv and %s.json.\n", (int)BenchmarkResults.size(), Prefix.c_str(), Prefix.c_str());
+	return 0;
+}
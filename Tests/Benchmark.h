@@ -0,0 +1,69 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One measurement. Benchmarks append their results, main() writes them all out at the end,
+ * so runs can be compared across changes.
+ */
+struct SBenchmarkResult {
+	std::string benchmark;
+	int threads = 0;
+	// The job priority measured, "Mixed" when spread over all of them, empty when it does not apply.
+	std::string priority;
+	// The number of operations the value was measured over.
+	int count = 0;
+	double value = 0.0;
+	std::string unit;
+};
+
+static std::vector<SBenchmarkResult> BenchmarkResults;
+
+static void ReportBenchmark(const std::string& benchmark, int threads, const std::string& priority, int count, double value, const std::string& unit) {
+	SBenchmarkResult Result;
+	Result.benchmark = benchmark;
+	Result.threads = threads;
+	Result.priority = priority;
+	Result.count = count;
+	Result.value = value;
+	Result.unit = unit;
+	BenchmarkResults.push_back(Result);
+
+	printf("%-28s threads %2i %-7s %9i: %14.2f %s\n", benchmark.c_str(), threads, priority.c_str(), count, value, unit.c_str());
+}
+
+static bool WriteBenchmarkCSV(const std::string& path) {
+	std::ofstream File(path);
+	if (!File.is_open()) {
+		return false;
+	}
+
+	File << "benchmark,threads,priority,count,value,unit\n";
+	for (const SBenchmarkResult& Result : BenchmarkResults) {
+		File << Result.benchmark << "," << Result.threads << "," << Result.priority << "," << Result.count << ","
+			<< Result.value << "," << Result.unit << "\n";
+	}
+	return true;
+}
+
+static bool WriteBenchmarkJSON(const std::string& path) {
+	std::ofstream File(path);
+	if (!File.is_open()) {
+		return false;
+	}
+
+	// Names and units are plain identifiers, nothing needs escaping.
+	File << "[\n";
+	for (size_t i = 0; i < BenchmarkResults.size(); ++i) {
+		const SBenchmarkResult& Result = BenchmarkResults[i];
+		File << "\t{\"benchmark\":\"" << Result.benchmark << "\",\"threads\":" << Result.threads
+			<< ",\"priority\":\"" << Result.priority << "\",\"count\":" << Result.count
+			<< ",\"value\":" << Result.value << ",\"unit\":\"" << Result.unit << "\"}"
+			<< (i + 1 < BenchmarkResults.size() ? ",\n" : "\n");
+	}
+	File << "]\n";
+	return true;
+}
@@ -0,0 +1,97 @@
+#include <iostream>
+#include "Systems/JobSystem.hpp"
+#include "Platform/FileSystem.hpp"
+#include "Platform/Platform.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+struct FileCheckPayload {
+	FileReadResult* result = nullptr;
+	int index = 0;
+	std::atomic<int>* matched = nullptr;
+};
+
+static std::string AsyncTestFileContents(int index) {
+	// Sizes differ, one file is large enough to need several pages.
+	std::string Contents = "File " + std::to_string(index) + "\n";
+	int Repeat = index == 0 ? 100000 : index * 7;
+	for (int i = 0; i < Repeat; ++i) {
+		Contents += (char)('a' + (i + index) % 26);
+	}
+	return Contents;
+}
+
+static bool FileCheckStart(void* payload, void* /*context*/) {
+	// Runs on a job thread once the read finished.
+	FileCheckPayload* Check = (FileCheckPayload*)payload;
+	std::string Expected = AsyncTestFileContents(Check->index);
+	if (Check->result->success && Check->result->size == Expected.size() &&
+		memcmp(Check->result->data, Expected.data(), Expected.size()) == 0 && Check->result->data[Check->result->size] == '\0') {
+		Check->matched->fetch_add(1);
+	}
+	return true;
+}
+
+int TestFileSystemAsync() {
+	printf("Test asynchronous file reads...\n");
+
+	const int FileCount = 64;
+	std::vector<std::string> Paths;
+	for (int i = 0; i < FileCount; ++i) {
+		Paths.push_back("AsyncReadTest" + std::to_string(i) + ".txt");
+		std::ofstream File(Paths[i], std::ios::binary);
+		File << AsyncTestFileContents(i);
+	}
+
+	unsigned int TypeMasks[2] = {
+		(unsigned int)JobType::eGeneral | (unsigned int)JobType::eGPU_Resource,
+		(unsigned int)JobType::eGeneral | (unsigned int)JobType::eResource_Load
+	};
+	if (!JobSystem::Initialize(2, TypeMasks)) {
+		printf("Failed to initialize job system.\n");
+		return -1;
+	}
+
+	// Fewer slots than files, so some reads wait for others to finish.
+	bool Async = FileSystemAsyncInitialize(16);
+
+	std::vector<FileReadResult> Results(FileCount);
+	std::vector<JobHandle> Checks;
+	std::atomic<int> Matched = 0;
+	double Start = Platform::PlatformGetAbsoluteTime();
+	for (int i = 0; i < FileCount; ++i) {
+		FileCheckPayload Check;
+		Check.result = &Results[i];
+		Check.index = i;
+		Check.matched = &Matched;
+		Checks.push_back(JobSystem::ReadFile(Paths[i].c_str(), &Results[i]).Then(FileCheckStart, Check));
+	}
+	for (JobHandle& Check : Checks) {
+		Check.Wait();
+	}
+	double ReadTime = (Platform::PlatformGetAbsoluteTime() - Start) * 1000000.0;
+	printf("Read %i of %i files %s in %.2fus: %s\n", Matched.load(), FileCount, Async ? "through io_uring" : "blocking",
+		ReadTime, Matched.load() == FileCount ? "OK" : "FAILED");
+
+	FileReadResult Missing;
+	JobHandle MissingRead = JobSystem::ReadFile("AsyncReadTestMissing.txt", &Missing);
+	MissingRead.Wait();
+	printf("Missing file reported as failed: %s\n", MissingRead.IsReady() && !MissingRead.Succeeded() && Missing.data == nullptr ? "OK" : "FAILED");
+
+	FileSystemAsyncShutdown();
+	JobSystem::Update();
+	JobSystem::Shutdown();
+
+	for (int i = 0; i < FileCount; ++i) {
+		FileSystemFreeReadResult(&Results[i]);
+		remove(Paths[i].c_str());
+	}
+
+	printf("\n");
+	return 0;
+}
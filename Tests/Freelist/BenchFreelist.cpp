@@ -0,0 +1,186 @@
+#include <iostream>
+#include "Containers/Freelist.hpp"
+#include "Platform/Platform.hpp"
+#include "../Benchmark.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief The first fit list Freelist used to be, kept as the baseline to compare against.
+ * A sorted singly linked list of free ranges, nodes taken from a fixed pool by scanning it.
+ */
+class BenchFirstFitList {
+public:
+	struct Node {
+		size_t offset = INVALID_ID;
+		size_t size = INVALID_ID;
+		Node* next = nullptr;
+	};
+
+	void Create(size_t total_size, size_t max_entries) {
+		Nodes.assign(max_entries, Node());
+		Head = &Nodes[0];
+		Head->offset = 0;
+		Head->size = total_size;
+	}
+
+	bool AllocateBlock(size_t size, size_t* offset) {
+		Node* Current = Head;
+		Node* Prev = nullptr;
+		while (Current != nullptr) {
+			if (Current->size == size) {
+				*offset = Current->offset;
+				(Prev != nullptr ? Prev->next : Head) = Current->next;
+				*Current = Node();
+				return true;
+			}
+			else if (Current->size > size) {
+				*offset = Current->offset;
+				Current->size -= size;
+				Current->offset += size;
+				return true;
+			}
+			Prev = Current;
+			Current = Current->next;
+		}
+		return false;
+	}
+
+	bool FreeBlock(size_t size, size_t offset) {
+		Node* Current = Head;
+		Node* Prev = nullptr;
+		while (Current != nullptr && Current->offset < offset) {
+			Prev = Current;
+			Current = Current->next;
+		}
+
+		Node* NewNode = AcquireNode();
+		if (NewNode == nullptr) {
+			return false;
+		}
+		NewNode->offset = offset;
+		NewNode->size = size;
+		NewNode->next = Current;
+		(Prev != nullptr ? Prev->next : Head) = NewNode;
+
+		if (Current != nullptr && NewNode->offset + NewNode->size == Current->offset) {
+			NewNode->size += Current->size;
+			NewNode->next = Current->next;
+			*Current = Node();
+		}
+		if (Prev != nullptr && Prev->offset + Prev->size == NewNode->offset) {
+			Prev->size += NewNode->size;
+			Prev->next = NewNode->next;
+			*NewNode = Node();
+		}
+		return true;
+	}
+
+	size_t GetFreeSpace() const {
+		size_t Total = 0;
+		for (Node* Current = Head; Current != nullptr; Current = Current->next) {
+			Total += Current->size;
+		}
+		return Total;
+	}
+
+	size_t GetLargestFreeBlock() const {
+		size_t Largest = 0;
+		for (Node* Current = Head; Current != nullptr; Current = Current->next) {
+			Largest = DMAX(Largest, Current->size);
+		}
+		return Largest;
+	}
+
+private:
+	Node* AcquireNode() {
+		for (size_t i = 1; i < Nodes.size(); ++i) {
+			if (Nodes[i].offset == INVALID_ID) {
+				return &Nodes[i];
+			}
+		}
+		return nullptr;
+	}
+
+	std::vector<Node> Nodes;
+	Node* Head = nullptr;
+};
+
+struct BenchFreelistBlock {
+	size_t offset = 0;
+	size_t size = 0;
+};
+
+/**
+ * @brief Keeps live_count blocks of random sizes alive, then frees a random one and allocates another, op_count times.
+ * Reports the time per operation, and the share of free space outside the largest free block afterwards.
+ */
+template<typename List>
+static void BenchFreelistChurn(const std::string& name, List& list, int live_count, int op_count) {
+	std::vector<BenchFreelistBlock> Blocks;
+	unsigned int Seed = 4242;
+	auto NextSize = [&Seed]() {
+		Seed = Seed * 1103515245u + 12345u;
+		// Mostly small blocks, now and then a large one.
+		return (Seed >> 16) % 16 == 0 ? 4096 + (size_t)(Seed >> 8) % 60000 : 16 + (size_t)(Seed >> 8) % 1000;
+	};
+
+	for (int i = 0; i < live_count; ++i) {
+		BenchFreelistBlock Block;
+		Block.size = NextSize();
+		if (list.AllocateBlock(Block.size, &Block.offset)) {
+			Blocks.push_back(Block);
+		}
+	}
+
+	int Failed = 0;
+	double Start = Platform::PlatformGetAbsoluteTime();
+	for (int i = 0; i < op_count && !Blocks.empty(); ++i) {
+		Seed = Seed * 1103515245u + 12345u;
+		size_t Index = (Seed >> 4) % Blocks.size();
+		list.FreeBlock(Blocks[Index].size, Blocks[Index].offset);
+
+		Blocks[Index].size = NextSize();
+		if (!list.AllocateBlock(Blocks[Index].size, &Blocks[Index].offset)) {
+			Blocks[Index] = Blocks.back();
+			Blocks.pop_back();
+			Failed++;
+		}
+	}
+	double Seconds = Platform::PlatformGetAbsoluteTime() - Start;
+
+	size_t FreeSpace = list.GetFreeSpace();
+	double Fragmentation = FreeSpace > 0 ? 100.0 * (1.0 - (double)list.GetLargestFreeBlock() / (double)FreeSpace) : 0.0;
+	ReportBenchmark(name + "_churn", 1, "", op_count, Seconds * 1000000000.0 / (op_count * 2), "ns/op");
+	ReportBenchmark(name + "_fragmentation", 1, "", op_count, Fragmentation, "%");
+	ReportBenchmark(name + "_failed", 1, "", op_count, Failed, "allocations");
+
+	for (BenchFreelistBlock& Block : Blocks) {
+		list.FreeBlock(Block.size, Block.offset);
+	}
+}
+
+int BenchFreelist() {
+	printf("Benchmark free list...\n");
+
+	const size_t TotalSize = MEBIBYTES(64);
+	const int LiveCounts[] = { 1000, 10000 };
+	const int OpCount = 50000;
+	for (int LiveCount : LiveCounts) {
+		std::string Suffix = "_" + std::to_string(LiveCount);
+
+		Freelist TLSF;
+		TLSF.Create(TotalSize);
+		BenchFreelistChurn("freelist_tlsf" + Suffix, TLSF, LiveCount, OpCount);
+		TLSF.Destroy();
+
+		// The old list sized its node pool by the memory size. Used nodes stay packed at the front, so a smaller pool scans the same.
+		BenchFirstFitList FirstFit;
+		FirstFit.Create(TotalSize, TotalSize / sizeof(void*) / 64);
+		BenchFreelistChurn("freelist_first_fit" + Suffix, FirstFit, LiveCount, OpCount);
+	}
+
+	printf("\n");
+	return 0;
+}
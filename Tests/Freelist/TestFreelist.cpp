@@ -1,6 +1,13 @@
 #include <iostream>
 #include "Containers/Freelist.hpp"
 
+#include <vector>
+
+struct FreelistTestBlock {
+	size_t offset = 0;
+	size_t size = 0;
+};
+
 int TestFreelist() {
 	printf("Test free list...\n");
 	
@@ -26,6 +33,61 @@ int TestFreelist() {
 		printf("Free block successful...\n");
 	}
 
+	// The whole range can be taken at once, and only once.
+	size_t Whole = INVALID_ID;
+	bool WholeTaken = List.AllocateBlock(512, &Whole) && Whole == 0 && List.GetFreeSpace() == 0 && !List.AllocateBlock(1, &Offset);
+	WholeTaken &= List.FreeBlock(512, Whole) && !List.FreeBlock(512, Whole);
+	printf("Allocate whole range and refuse double free: %s\n", WholeTaken ? "OK" : "FAILED");
+	List.Destroy();
+
+	// Random sizes allocated and freed in random order never overlap, and everything merges back into one block.
+	const size_t TotalSize = 1 << 20;
+	List.Create(TotalSize);
+	std::vector<FreelistTestBlock> Blocks;
+	std::vector<unsigned char> Owned(TotalSize, 0);
+	unsigned int Seed = 12345;
+	bool Valid = true;
+	for (int i = 0; i < 20000; ++i) {
+		Seed = Seed * 1103515245u + 12345u;
+		if (Blocks.empty() || (Seed >> 16) % 3 != 0) {
+			FreelistTestBlock Block;
+			Block.size = 1 + (Seed >> 8) % 700;
+			if (List.AllocateBlock(Block.size, &Block.offset)) {
+				for (size_t j = Block.offset; j < Block.offset + Block.size; ++j) {
+					Valid &= Owned[j] == 0;
+					Owned[j] = 1;
+				}
+				Blocks.push_back(Block);
+			}
+		}
+		else {
+			size_t Index = (Seed >> 4) % Blocks.size();
+			FreelistTestBlock Block = Blocks[Index];
+			Blocks[Index] = Blocks.back();
+			Blocks.pop_back();
+			for (size_t j = Block.offset; j < Block.offset + Block.size; ++j) {
+				Owned[j] = 0;
+			}
+			Valid &= List.FreeBlock(Block.size, Block.offset);
+		}
+	}
+
+	size_t Used = 0;
+	for (const FreelistTestBlock& Block : Blocks) {
+		Used += Block.size;
+	}
+	Valid &= List.GetFreeSpace() == TotalSize - Used;
+	for (const FreelistTestBlock& Block : Blocks) {
+		Valid &= List.FreeBlock(Block.size, Block.offset);
+	}
+	Valid &= List.GetFreeSpace() == TotalSize && List.GetLargestFreeBlock() == TotalSize;
+	printf("Random allocations never overlap and merge back: %s\n", Valid ? "OK" : "FAILED");
+
+	// Growing adds to the free block at the end.
+	size_t Front = INVALID_ID;
+	bool Grown = List.AllocateBlock(TotalSize / 2, &Front) && List.Resize(TotalSize * 2) &&
+		List.GetLargestFreeBlock() == TotalSize * 3 / 2 && List.FreeBlock(TotalSize / 2, Front) && List.GetLargestFreeBlock() == TotalSize * 2;
+	printf("Resize joins the last free block: %s\n", Grown ? "OK" : "FAILED");
 	List.Destroy();
 
 	printf("\n");
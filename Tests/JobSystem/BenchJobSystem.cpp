@@ -0,0 +1,184 @@
+#include <iostream>
+#include "Systems/JobSystem.hpp"
+#include "Platform/Platform.hpp"
+#include "../Benchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static const char* BenchPriorityNames[JOB_PRIORITY_COUNT] = { "Low", "Normal", "High" };
+
+static bool BenchEmptyJob(void* /*payload*/, void* /*context*/) {
+	return true;
+}
+
+struct BenchLatencyPayload {
+	double* out_start_time = nullptr;
+};
+
+static bool BenchLatencyJob(void* payload, void* /*context*/) {
+	*((BenchLatencyPayload*)payload)->out_start_time = Platform::PlatformGetAbsoluteTime();
+	return true;
+}
+
+struct BenchFanOutPayload {
+	int child_count = 0;
+};
+
+static bool BenchFanOutJob(void* payload, void* /*context*/) {
+	// Fans out to the children, then joins them before finishing.
+	JobCounter Children;
+	JobDesc Desc;
+	Desc.signal_counter = &Children;
+	for (int i = 0; i < ((BenchFanOutPayload*)payload)->child_count; ++i) {
+		JobSystem::Submit(BenchEmptyJob, 0, Desc);
+	}
+	JobSystem::WaitForCounter(&Children);
+	return true;
+}
+
+struct BenchProducerPayload {
+	int job_count = 0;
+	JobCounter* counter = nullptr;
+};
+
+static bool BenchProducerJob(void* payload, void* /*context*/) {
+	BenchProducerPayload* Producer = (BenchProducerPayload*)payload;
+	JobDesc Desc;
+	Desc.signal_counter = Producer->counter;
+	for (int i = 0; i < Producer->job_count; ++i) {
+		Desc.priority = (JobPriority)(i % JOB_PRIORITY_COUNT);
+		JobSystem::Submit(BenchEmptyJob, 0, Desc);
+	}
+	return true;
+}
+
+static bool BenchStartJobSystem(unsigned char thread_count, bool use_fibers) {
+	unsigned int TypeMasks[MAX_JOB_THREADS];
+	for (unsigned char i = 0; i < thread_count; ++i) {
+		TypeMasks[i] = (unsigned int)JobType::eGeneral;
+	}
+	TypeMasks[0] |= (unsigned int)JobType::eResource_Load | (unsigned int)JobType::eGPU_Resource;
+	return JobSystem::Initialize(thread_count, TypeMasks, use_fibers);
+}
+
+static void BenchThroughput(int threads, int job_count) {
+	for (int p = JOB_PRIORITY_COUNT - 1; p >= 0; --p) {
+		JobCounter Jobs;
+		JobDesc Desc;
+		Desc.priority = (JobPriority)p;
+		Desc.signal_counter = &Jobs;
+
+		double Start = Platform::PlatformGetAbsoluteTime();
+		for (int i = 0; i < job_count; ++i) {
+			JobSystem::Submit(BenchEmptyJob, 0, Desc);
+		}
+		JobSystem::WaitForCounter(&Jobs);
+		double Seconds = Platform::PlatformGetAbsoluteTime() - Start;
+		JobSystem::Update();
+
+		ReportBenchmark("empty_job_throughput", threads, BenchPriorityNames[p], job_count, job_count / Seconds, "jobs/s");
+	}
+}
+
+static void BenchLatency(int threads, int sample_count) {
+	// One job at a time on an idle system, so every sample includes waking a sleeping thread.
+	std::vector<double> Samples(sample_count);
+	for (int i = 0; i < sample_count; ++i) {
+		double StartTime = 0.0;
+		BenchLatencyPayload Payload;
+		Payload.out_start_time = &StartTime;
+
+		double SubmitTime = Platform::PlatformGetAbsoluteTime();
+		JobHandle Job = JobSystem::Submit(BenchLatencyJob, Payload);
+		// Poll rather than help, the main thread running the job itself would hide the wake up.
+		while (!Job.IsReady()) {
+			std::this_thread::yield();
+		}
+		Samples[i] = (StartTime - SubmitTime) * 1000000.0;
+	}
+	JobSystem::Update();
+
+	double Total = 0.0;
+	for (double Sample : Samples) {
+		Total += Sample;
+	}
+	std::sort(Samples.begin(), Samples.end());
+	ReportBenchmark("submit_to_start_avg", threads, "Normal", sample_count, Total / sample_count, "us");
+	ReportBenchmark("submit_to_start_p50", threads, "Normal", sample_count, Samples[sample_count / 2], "us");
+	ReportBenchmark("submit_to_start_p99", threads, "Normal", sample_count, Samples[sample_count * 99 / 100], "us");
+}
+
+static void BenchFanOut(int threads, int round_count, int child_count, const char* benchmark) {
+	BenchFanOutPayload Payload;
+	Payload.child_count = child_count;
+
+	double Start = Platform::PlatformGetAbsoluteTime();
+	for (int i = 0; i < round_count; ++i) {
+		JobSystem::Submit(BenchFanOutJob, Payload).Wait();
+	}
+	double Seconds = Platform::PlatformGetAbsoluteTime() - Start;
+	JobSystem::Update();
+
+	ReportBenchmark(benchmark, threads, "Normal", round_count * child_count, Seconds * 1000000.0 / round_count, "us/round");
+}
+
+static void BenchProducers(int threads, int producer_count, int job_count) {
+	// Every producer runs on a job thread, so they all push into their own deques and the shared queues at once.
+	JobCounter Jobs;
+	BenchProducerPayload Payload;
+	Payload.job_count = job_count / producer_count;
+	Payload.counter = &Jobs;
+	JobDesc Desc;
+	Desc.signal_counter = &Jobs;
+
+	double Start = Platform::PlatformGetAbsoluteTime();
+	for (int i = 0; i < producer_count; ++i) {
+		JobSystem::Submit(BenchProducerJob, Payload, Desc);
+	}
+	JobSystem::WaitForCounter(&Jobs);
+	double Seconds = Platform::PlatformGetAbsoluteTime() - Start;
+	JobSystem::Update();
+
+	int Submitted = Payload.job_count * producer_count;
+	ReportBenchmark("multi_producer_throughput", threads, "Mixed", Submitted, Submitted / Seconds, "jobs/s");
+}
+
+int BenchJobSystem() {
+	printf("Benchmark job system...\n");
+
+	// Powers of two up to every logical processor, plus the full count.
+	SProcessorTopology Topology;
+	Platform::GetProcessorTopology(&Topology);
+	int MaxThreads = DMIN(DMAX(Topology.logical_count, 1), MAX_JOB_THREADS);
+	std::vector<int> ThreadCounts;
+	for (int Count = 1; Count < MaxThreads; Count *= 2) {
+		ThreadCounts.push_back(Count);
+	}
+	ThreadCounts.push_back(MaxThreads);
+
+	for (int Threads : ThreadCounts) {
+		if (!BenchStartJobSystem((unsigned char)Threads, false)) {
+			printf("Failed to initialize job system with %i threads.\n", Threads);
+			return -1;
+		}
+		BenchThroughput(Threads, 100000);
+		BenchLatency(Threads, 1000);
+		BenchFanOut(Threads, 200, 256, "fan_out_fan_in");
+		BenchProducers(Threads, DMAX(Threads * 2, 4), 100000);
+		JobSystem::Shutdown();
+
+		// Joining suspends the fan out job instead of blocking its thread.
+		if (!BenchStartJobSystem((unsigned char)Threads, true)) {
+			printf("Failed to initialize job system with %i threads and fibers.\n", Threads);
+			return -1;
+		}
+		BenchFanOut(Threads, 200, 256, "fan_out_fan_in_fibers");
+		JobSystem::Shutdown();
+	}
+
+	printf("\n");
+	return 0;
+}
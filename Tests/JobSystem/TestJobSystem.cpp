@@ -0,0 +1,667 @@
+#include <iostream>
+#include "Systems/JobSystem.hpp"
+#include "Platform/Platform.hpp"
+#include "Core/Metrics.hpp"
+#include "Memory/ScratchAllocator.h"
+
+#include <cmath>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+struct JobLatencyParams {
+	double submit_time = 0.0;
+	double* out_start_time = nullptr;
+	std::atomic<int>* finished = nullptr;
+};
+
+static bool JobLatencyStart(void* payload, void* /*context*/) {
+	JobLatencyParams* Params = (JobLatencyParams*)payload;
+	*Params->out_start_time = Platform::PlatformGetAbsoluteTime();
+	Params->finished->fetch_add(1);
+	return true;
+}
+
+struct JobSpawnParams {
+	int child_count = 0;
+	std::atomic<int>* finished = nullptr;
+};
+
+static bool JobChildStart(void* payload, void* /*context*/) {
+	JobSpawnParams* Params = (JobSpawnParams*)payload;
+	Params->finished->fetch_add(1);
+	return true;
+}
+
+static bool JobSpawnStart(void* payload, void* /*context*/) {
+	JobSpawnParams* Params = (JobSpawnParams*)payload;
+
+	// Children are pushed to this thread's own deque and stolen by idle threads.
+	JobSpawnParams ChildParams;
+	ChildParams.finished = Params->finished;
+	for (int i = 0; i < Params->child_count; ++i) {
+		JobDesc Desc;
+		Desc.priority = JobPriority(i % 3);
+		JobSystem::Submit(JobChildStart, ChildParams, Desc);
+	}
+
+	Params->finished->fetch_add(1);
+	return true;
+}
+
+struct JobDependencyParams {
+	std::atomic<int>* finished = nullptr;
+	int* out_finished_before = nullptr;
+};
+
+struct JobPayload {
+	std::atomic<int>* finished = nullptr;
+};
+
+static bool JobPayloadStart(void* payload, void* /*context*/) {
+	((JobPayload*)payload)->finished->fetch_add(1);
+	return true;
+}
+
+static void JobCountCompleted(void* /*payload*/, void* context) {
+	// Runs on the main thread only, no synchronization needed.
+	(*(int*)context)++;
+}
+
+static void JobSlowCompleted(void* /*payload*/, void* context) {
+	// Stands in for a callback doing real work on the main thread, like a GPU upload.
+	double End = Platform::PlatformGetAbsoluteTime() + 0.001;
+	while (Platform::PlatformGetAbsoluteTime() < End) {}
+	(*(int*)context)++;
+}
+
+struct JobChainPayload {
+	std::atomic<int>* sequence = nullptr;
+	int* out_order = nullptr;
+	bool succeed = true;
+};
+
+static bool JobChainStart(void* payload, void* /*context*/) {
+	JobChainPayload* Payload = (JobChainPayload*)payload;
+	*Payload->out_order = Payload->sequence->fetch_add(1);
+	return Payload->succeed;
+}
+
+static void JobChainCompleted(void* payload, void* /*context*/) {
+	JobChainPayload* Payload = (JobChainPayload*)payload;
+	*Payload->out_order = Payload->sequence->fetch_add(1);
+}
+
+struct JobGatePayload {
+	std::atomic<bool>* open = nullptr;
+	std::atomic<bool>* started = nullptr;
+};
+
+static bool JobGateStart(void* payload, void* /*context*/) {
+	// Holds its thread until the test opens the gate.
+	if (((JobGatePayload*)payload)->started != nullptr) {
+		((JobGatePayload*)payload)->started->store(true);
+	}
+	while (!((JobGatePayload*)payload)->open->load()) {
+		std::this_thread::yield();
+	}
+	return true;
+}
+
+static void ParallelForBody(const std::vector<float>& input, std::vector<float>& output, size_t begin, size_t end) {
+	for (size_t i = begin; i < end; ++i) {
+		float Value = input[i];
+		for (int k = 0; k < 16; ++k) {
+			Value = std::sqrt(Value * Value + 1.0f);
+		}
+		output[i] = Value;
+	}
+}
+
+static bool JobDependencyStart(void* payload, void* /*context*/) {
+	JobDependencyParams* Params = (JobDependencyParams*)payload;
+	if (Params->out_finished_before != nullptr) {
+		*Params->out_finished_before = Params->finished->load();
+	}
+	Params->finished->fetch_add(1);
+	return true;
+}
+
+struct FiberPingPong {
+	Fiber main_fiber;
+	Fiber fiber;
+	int remaining = 0;
+};
+
+static void FiberPingPongStart(void* params) {
+	FiberPingPong* PingPong = (FiberPingPong*)params;
+	while (true) {
+		PingPong->remaining--;
+		Fiber::Switch(&PingPong->fiber, &PingPong->main_fiber);
+	}
+}
+
+struct JobWaitingParams {
+	int child_count = 0;
+	std::atomic<int>* waiting = nullptr;
+	std::atomic<int>* max_waiting = nullptr;
+	std::atomic<int>* finished = nullptr;
+	std::atomic<int>* scratch_broken = nullptr;
+};
+
+static bool JobWaitingStart(void* payload, void* /*context*/) {
+	JobWaitingParams* Params = (JobWaitingParams*)payload;
+
+	// Scratch memory taken before the wait must be intact after it, even if other jobs ran on this thread
+	// and the job resumes on another one.
+	ScratchScope Scope;
+	int* Scratch = Scope.Allocate<int>(256);
+	for (int i = 0; i < 256; ++i) {
+		Scratch[i] = i;
+	}
+	size_t ScratchTop = ScratchAllocator::GetMarker();
+
+	JobCounter Children;
+	JobSpawnParams ChildParams;
+	ChildParams.finished = Params->finished;
+	JobDesc Desc;
+	Desc.priority = JobPriority::eLow;
+	Desc.signal_counter = &Children;
+	for (int i = 0; i < Params->child_count; ++i) {
+		JobSystem::Submit(JobChildStart, ChildParams, Desc);
+	}
+
+	// Count the jobs waiting at the same time. More of them than there are threads means
+	// they were suspended rather than blocking their thread.
+	int Waiting = Params->waiting->fetch_add(1) + 1;
+	int MaxWaiting = Params->max_waiting->load();
+	while (Waiting > MaxWaiting && !Params->max_waiting->compare_exchange_weak(MaxWaiting, Waiting)) {}
+	// Let the other waiting jobs start before the children run.
+	Platform::PlatformSleep(1);
+
+	JobSystem::WaitForCounter(&Children);
+	bool Intact = ScratchAllocator::GetMarker() == ScratchTop;
+	for (int i = 0; i < 256; ++i) {
+		Intact &= Scratch[i] == i;
+	}
+	if (!Intact) {
+		Params->scratch_broken->fetch_add(1);
+	}
+	Params->waiting->fetch_sub(1);
+	Params->finished->fetch_add(1);
+	return true;
+}
+
+int TestJobFibers() {
+	printf("Test job fibers...\n");
+
+	// Measure a round trip between two fibers on one thread.
+	FiberPingPong PingPong;
+	if (!PingPong.main_fiber.CreateFromThread() || !PingPong.fiber.Create(FiberPingPongStart, &PingPong, KIBIBYTES(64))) {
+		printf("Failed to create fibers.\n");
+		return -1;
+	}
+
+	const int SwitchCount = 100000;
+	PingPong.remaining = SwitchCount;
+	double SwitchStart = Platform::PlatformGetAbsoluteTime();
+	while (PingPong.remaining > 0) {
+		Fiber::Switch(&PingPong.main_fiber, &PingPong.fiber);
+	}
+	double SwitchTime = (Platform::PlatformGetAbsoluteTime() - SwitchStart) * 1000000000.0;
+	printf("Fiber switch cost over %i round trips: %.2fns per switch\n", SwitchCount, SwitchTime / (SwitchCount * 2.0));
+
+	PingPong.fiber.Destroy();
+	PingPong.main_fiber.Destroy();
+
+	unsigned int TypeMasks[2] = {
+		(unsigned int)JobType::eGeneral | (unsigned int)JobType::eGPU_Resource,
+		(unsigned int)JobType::eGeneral | (unsigned int)JobType::eResource_Load
+	};
+	if (!JobSystem::Initialize(2, TypeMasks, true)) {
+		printf("Failed to initialize job system with fibers.\n");
+		return -1;
+	}
+
+	// Eight jobs waiting on their children at once on two threads.
+	const int ParentCount = 8;
+	const int ChildCount = 100;
+	std::atomic<int> Waiting = 0;
+	std::atomic<int> MaxWaiting = 0;
+	std::atomic<int> Finished = 0;
+	std::atomic<int> ScratchBroken = 0;
+	JobCounter Parents;
+	double WaitStart = Platform::PlatformGetAbsoluteTime();
+	JobWaitingParams Params;
+	Params.child_count = ChildCount;
+	Params.waiting = &Waiting;
+	Params.max_waiting = &MaxWaiting;
+	Params.finished = &Finished;
+	Params.scratch_broken = &ScratchBroken;
+	JobDesc Desc;
+	Desc.priority = JobPriority::eHigh;
+	Desc.signal_counter = &Parents;
+	for (int i = 0; i < ParentCount; ++i) {
+		JobSystem::Submit(JobWaitingStart, Params, Desc);
+	}
+
+	JobSystem::WaitForCounter(&Parents);
+	double WaitTime = (Platform::PlatformGetAbsoluteTime() - WaitStart) * 1000000.0;
+	const int ExpectedCount = ParentCount * (ChildCount + 1);
+	printf("Ran %i jobs with up to %i suspended at once on 2 threads in %.2fus: %s\n", Finished.load(), MaxWaiting.load(),
+		WaitTime, Finished.load() == ExpectedCount && MaxWaiting.load() > 2 ? "OK" : "FAILED");
+	printf("Scratch memory of suspended jobs kept across the wait: %s\n", ScratchBroken.load() == 0 ? "OK" : "FAILED");
+
+	JobSystem::Shutdown();
+
+	printf("\n");
+	return 0;
+}
+
+int TestJobThreadLayout() {
+	printf("Test job thread layout...\n");
+
+	SProcessorTopology Topology;
+	bool Known = Platform::GetProcessorTopology(&Topology);
+	printf("Processor topology %s: %i logical processors on %i cores\n", Known ? "known" : "unknown", Topology.logical_count, Topology.core_count);
+
+	JobSystemConfig Config;
+	if (!JobSystem::Initialize(Config)) {
+		printf("Failed to initialize job system from the topology.\n");
+		return -1;
+	}
+
+	// Every job type must find a thread able to run it.
+	std::atomic<int> Finished = 0;
+	JobCounter Jobs;
+	JobPayload Payload;
+	Payload.finished = &Finished;
+	JobType Types[3] = { JobType::eGeneral, JobType::eResource_Load, JobType::eGPU_Resource };
+	for (int i = 0; i < 3; ++i) {
+		JobDesc Desc;
+		Desc.type = Types[i];
+		Desc.signal_counter = &Jobs;
+		JobSystem::Submit(JobPayloadStart, Payload, Desc);
+	}
+	JobSystem::WaitForCounter(&Jobs);
+
+	printf("Started %i job threads, ran a job of every type: %s\n", JobSystem::GetThreadCount(),
+		Finished.load() == 3 && JobSystem::GetThreadCount() >= 3 ? "OK" : "FAILED");
+
+	JobSystem::Shutdown();
+
+	printf("\n");
+	return 0;
+}
+
+int TestJobSystem() {
+	printf("Test job system...\n");
+
+	unsigned int TypeMasks[2] = {
+		(unsigned int)JobType::eGeneral | (unsigned int)JobType::eGPU_Resource,
+		(unsigned int)JobType::eGeneral | (unsigned int)JobType::eResource_Load
+	};
+	if (!JobSystem::Initialize(2, TypeMasks)) {
+		printf("Failed to initialize job system.\n");
+		return -1;
+	}
+
+	// Submit one job at a time to an idle system, so every sample measures how long a
+	// sleeping job thread takes to wake up and start the job.
+	const int SampleCount = 200;
+	double TotalLatency = 0.0;
+	double MinLatency = 1e9;
+	double MaxLatency = 0.0;
+	std::atomic<int> Finished = 0;
+	for (int i = 0; i < SampleCount; ++i) {
+		double StartTime = 0.0;
+		JobLatencyParams Params;
+		Params.out_start_time = &StartTime;
+		Params.finished = &Finished;
+		Params.submit_time = Platform::PlatformGetAbsoluteTime();
+
+		JobDesc Desc;
+		Desc.type = i % 2 == 0 ? JobType::eGeneral : JobType::eResource_Load;
+		JobSystem::Submit(JobLatencyStart, Params, Desc);
+
+		while (Finished.load() != i + 1) {}
+
+		double Latency = (StartTime - Params.submit_time) * 1000000.0;
+		TotalLatency += Latency;
+		MinLatency = DMIN(MinLatency, Latency);
+		MaxLatency = DMAX(MaxLatency, Latency);
+
+		// Give the job thread time to go back to sleep.
+		Platform::PlatformSleep(1);
+	}
+
+	printf("Submit-to-start latency over %i jobs: avg %.2fus, min %.2fus, max %.2fus\n",
+		SampleCount, TotalLatency / SampleCount, MinLatency, MaxLatency);
+
+	// Fan out fine-grained jobs from jobs to exercise the work stealing.
+	const int RootCount = 16;
+	const int ChildCount = 1000;
+	Finished = 0;
+	double SpawnStart = Platform::PlatformGetAbsoluteTime();
+	JobSpawnParams SpawnParams;
+	SpawnParams.child_count = ChildCount;
+	SpawnParams.finished = &Finished;
+	for (int i = 0; i < RootCount; ++i) {
+		JobSystem::Submit(JobSpawnStart, SpawnParams);
+	}
+
+	const int ExpectedCount = RootCount * (ChildCount + 1);
+	while (Finished.load() != ExpectedCount) {}
+	double SpawnTime = (Platform::PlatformGetAbsoluteTime() - SpawnStart) * 1000000.0;
+	printf("Ran %i spawned jobs in %.2fus (%.3fus per job)\n", ExpectedCount, SpawnTime, SpawnTime / ExpectedCount);
+
+	// A job waiting on four prerequisites starts as soon as the last of them finishes.
+	JobCounter Prerequisites;
+	JobCounter Dependent;
+	int FinishedBefore = -1;
+	Finished = 0;
+	JobDependencyParams DependentParams;
+	DependentParams.finished = &Finished;
+	DependentParams.out_finished_before = &FinishedBefore;
+	JobDesc DependentDesc;
+	DependentDesc.wait_counter = &Prerequisites;
+	DependentDesc.signal_counter = &Dependent;
+
+	JobDependencyParams PrerequisiteParams;
+	PrerequisiteParams.finished = &Finished;
+	JobDesc PrerequisiteDesc;
+	PrerequisiteDesc.signal_counter = &Prerequisites;
+	for (int i = 0; i < 4; ++i) {
+		JobSystem::Submit(JobDependencyStart, PrerequisiteParams, PrerequisiteDesc);
+	}
+
+	// Submitted while prerequisites are still in flight.
+	JobSystem::Submit(JobDependencyStart, DependentParams, DependentDesc);
+
+	JobSystem::WaitForCounter(&Dependent);
+	printf("Dependent job started after %i of 4 prerequisites: %s\n", FinishedBefore, FinishedBefore == 4 ? "OK" : "FAILED");
+
+	// Far more results than the completion queue holds. None may get lost, job threads wait for
+	// the queue to drain, and the main thread drains it while it waits on the jobs.
+	const int CompletionCount = MAX_JOB_RESULTS * 4;
+	int CallbackCount = 0;
+	JobCounter Completions;
+	JobDependencyParams CompletionParams;
+	CompletionParams.finished = &Finished;
+	JobDesc CompletionDesc;
+	CompletionDesc.on_success = JobCountCompleted;
+	CompletionDesc.context = &CallbackCount;
+	CompletionDesc.signal_counter = &Completions;
+	for (int i = 0; i < CompletionCount; ++i) {
+		JobSystem::Submit(JobDependencyStart, CompletionParams, CompletionDesc);
+	}
+
+	JobSystem::WaitForCounter(&Completions);
+	JobSystem::Update();
+	printf("Completion callbacks run for %i jobs: %i: %s\n", CompletionCount, CallbackCount, CallbackCount == CompletionCount ? "OK" : "FAILED");
+
+	const int UpdateCount = 10000;
+	double UpdateStart = Platform::PlatformGetAbsoluteTime();
+	for (int i = 0; i < UpdateCount; ++i) {
+		JobSystem::Update();
+	}
+	double UpdateTime = (Platform::PlatformGetAbsoluteTime() - UpdateStart) * 1000000000.0;
+	printf("Update with no finished jobs: %.2fns\n", UpdateTime / UpdateCount);
+
+	// Jobs with an inline payload live in pooled records, submitting them does not allocate.
+	const int SubmitCount = 100000;
+	Finished = 0;
+	JobCounter PayloadJobs;
+	JobDesc Desc;
+	Desc.signal_counter = &PayloadJobs;
+	JobPayload Payload;
+	Payload.finished = &Finished;
+	double PayloadStart = Platform::PlatformGetAbsoluteTime();
+	for (int i = 0; i < SubmitCount; ++i) {
+		JobSystem::Submit(JobPayloadStart, Payload, Desc);
+	}
+	JobSystem::WaitForCounter(&PayloadJobs);
+	double PayloadTime = (Platform::PlatformGetAbsoluteTime() - PayloadStart) * 1000000000.0;
+	printf("Submit and run %i jobs: %.2fns per job: %s\n", SubmitCount,
+		PayloadTime / SubmitCount, Finished.load() == SubmitCount ? "OK" : "FAILED");
+
+	// The same loop run serially and split across the job threads must produce the same output.
+	const size_t ElementCount = 1 << 20;
+	std::vector<float> Input(ElementCount);
+	std::vector<float> SerialOutput(ElementCount);
+	std::vector<float> ParallelOutput(ElementCount);
+	for (size_t i = 0; i < ElementCount; ++i) {
+		Input[i] = (float)(i % 1000);
+	}
+
+	double SerialStart = Platform::PlatformGetAbsoluteTime();
+	ParallelForBody(Input, SerialOutput, 0, ElementCount);
+	double SerialTime = (Platform::PlatformGetAbsoluteTime() - SerialStart) * 1000.0;
+
+	double ParallelStart = Platform::PlatformGetAbsoluteTime();
+	JobSystem::ParallelFor(0, ElementCount, 4096, [&](size_t begin, size_t end) {
+		ParallelForBody(Input, ParallelOutput, begin, end);
+	});
+	double ParallelTime = (Platform::PlatformGetAbsoluteTime() - ParallelStart) * 1000.0;
+
+	bool Match = SerialOutput == ParallelOutput;
+	printf("ParallelFor over %i elements: serial %.2fms, parallel %.2fms (%.2fx): %s\n",
+		(int)ElementCount, SerialTime, ParallelTime, SerialTime / ParallelTime, Match ? "OK" : "FAILED");
+
+	// Every update publishes the counters of the frame that just ended. The trace covers the last frames.
+	const int FrameCount = 4;
+	const int FrameJobCount = 100;
+	JobSystem::Update();
+	bool CountersMatch = true;
+	for (int f = 0; f < FrameCount; ++f) {
+		JobCounter FrameJobs;
+		JobDesc FrameDesc;
+		FrameDesc.signal_counter = &FrameJobs;
+		FrameDesc.name = "TelemetryJob";
+		for (int i = 0; i < FrameJobCount; ++i) {
+			JobSystem::Submit(JobPayloadStart, Payload, FrameDesc);
+		}
+		JobSystem::WaitForCounter(&FrameJobs);
+		JobSystem::Update();
+		CountersMatch &= Metrics::Jobs().finished_jobs == FrameJobCount;
+	}
+
+	const SJobMetrics& Jobs = Metrics::Jobs();
+	printf("Telemetry of the last frame: %u jobs, wait avg %.3fms max %.3fms, run avg %.4fms, utilization %.2f %.2f\n",
+		Jobs.finished_jobs, Jobs.avg_wait_ms, Jobs.max_wait_ms, Jobs.avg_run_ms, Jobs.thread_utilization[0], Jobs.thread_utilization[1]);
+
+	// A name the trace has to escape, in the current frame which the trace covers too.
+	JobCounter EscapedJob;
+	JobDesc EscapedDesc;
+	EscapedDesc.signal_counter = &EscapedJob;
+	EscapedDesc.name = "Say \"hi\" C:\\";
+	JobSystem::Submit(JobPayloadStart, Payload, EscapedDesc);
+	JobSystem::WaitForCounter(&EscapedJob);
+
+	const char* TracePath = "job_trace_test.json";
+	int TracedJobs = -1;
+	bool NameEscaped = false;
+	if (JobSystem::WriteTrace(TracePath, FrameCount)) {
+		std::ifstream TraceFile(TracePath);
+		std::stringstream Trace;
+		Trace << TraceFile.rdbuf();
+		std::string Text = Trace.str();
+		TracedJobs = 0;
+		for (size_t Pos = Text.find("\"name\":\"TelemetryJob\""); Pos != std::string::npos; Pos = Text.find("\"name\":\"TelemetryJob\"", Pos + 1)) {
+			TracedJobs++;
+		}
+		NameEscaped = Text.find("\"name\":\"Say \\\"hi\\\" C:\\\\\"") != std::string::npos;
+		TraceFile.close();
+		remove(TracePath);
+	}
+	printf("Job counters per frame and trace of %i frames with %i jobs, names escaped: %s\n", FrameCount, TracedJobs,
+		CountersMatch && TracedJobs == FrameCount * FrameJobCount && NameEscaped ? "OK" : "FAILED");
+
+	// Continuations start once the job they hang off finished, main thread ones in the next update.
+	std::atomic<int> Sequence = 0;
+	int Order[4] = { -1, -1, -1, -1 };
+	JobChainPayload Chain[4];
+	for (int i = 0; i < 4; ++i) {
+		Chain[i].sequence = &Sequence;
+		Chain[i].out_order = &Order[i];
+	}
+	Chain[0].succeed = false;
+	JobHandle First = JobSystem::Submit(JobChainStart, Chain[0]);
+	JobHandle Second = First.Then(JobChainStart, Chain[1]);
+	JobHandle Third = Second.Then(JobChainStart, Chain[2]);
+	JobHandle MainThread = Third.ThenOnMainThread(JobChainCompleted, Chain[3]);
+	Third.Wait();
+	bool ChainKept = First.IsReady() && !First.Succeeded() && Second.Succeeded() && Third.Succeeded();
+	ChainKept &= Order[0] == 0 && Order[1] == 1 && Order[2] == 2;
+	MainThread.Wait();
+	ChainKept &= Order[3] == -1;
+	JobSystem::Update();
+	ChainKept &= Order[3] == 3 && JobHandle().IsReady();
+	printf("Continuations ran in order %i %i %i, on the main thread %i: %s\n", Order[0], Order[1], Order[2], Order[3],
+		ChainKept ? "OK" : "FAILED");
+
+	// Jobs called off while they wait behind a gate never run nor call back, their counter still reaches zero.
+	std::atomic<bool> GateOpen = false;
+	JobGatePayload Gate;
+	Gate.open = &GateOpen;
+	JobCounter GateJobs;
+	JobDesc GateDesc;
+	GateDesc.signal_counter = &GateJobs;
+	JobSystem::Submit(JobGateStart, Gate, GateDesc);
+
+	Finished = 0;
+	int CancelledCallbacks = 0;
+	JobCancelToken Token;
+	JobCounter GatedJobs;
+	JobDesc TokenDesc;
+	TokenDesc.wait_counter = &GateJobs;
+	TokenDesc.signal_counter = &GatedJobs;
+	TokenDesc.cancel_token = &Token;
+	TokenDesc.on_success = JobCountCompleted;
+	TokenDesc.context = &CancelledCallbacks;
+	for (int i = 0; i < 8; ++i) {
+		JobSystem::Submit(JobPayloadStart, Payload, TokenDesc);
+	}
+	JobDesc LateDesc;
+	LateDesc.wait_counter = &GateJobs;
+	LateDesc.signal_counter = &GatedJobs;
+	LateDesc.deadline = Platform::PlatformGetAbsoluteTime() - 1.0;
+	JobHandle Late = JobSystem::Submit(JobPayloadStart, Payload, LateDesc);
+	JobDesc KeptDesc;
+	KeptDesc.wait_counter = &GateJobs;
+	KeptDesc.signal_counter = &GatedJobs;
+	JobHandle Called = JobSystem::Submit(JobPayloadStart, Payload, KeptDesc);
+	JobHandle Kept = JobSystem::Submit(JobPayloadStart, Payload, KeptDesc);
+	Token.Cancel();
+	Called.Cancel();
+	GateOpen = true;
+	JobSystem::WaitForCounter(&GatedJobs);
+	JobSystem::Update();
+	bool CancelKept = Finished.load() == 1 && CancelledCallbacks == 0 && Metrics::Jobs().cancelled_jobs == 10;
+	CancelKept &= Late.IsCancelled() && Called.IsCancelled() && !Kept.IsCancelled() && Kept.Succeeded();
+	printf("Cancelled 10 of 11 gated jobs, %i ran: %s\n", Finished.load(), CancelKept ? "OK" : "FAILED");
+
+	// A low priority job waiting long enough climbs to the front of the high priority queue. Only the
+	// second thread loads resources, so the gate holds every resource job in the shared queues.
+	GateOpen = false;
+	std::atomic<bool> GateStarted = false;
+	Gate.started = &GateStarted;
+	GateDesc.type = JobType::eResource_Load;
+	JobSystem::Submit(JobGateStart, Gate, GateDesc);
+	// The gate has to hold the thread before the updates, or it would age along with the job.
+	while (!GateStarted.load()) {
+		std::this_thread::yield();
+	}
+	Sequence = 0;
+	int AgedOrder[5] = { -1, -1, -1, -1, -1 };
+	JobChainPayload Aged[5];
+	JobCounter AgedJobs;
+	JobDesc AgedDesc;
+	AgedDesc.type = JobType::eResource_Load;
+	AgedDesc.signal_counter = &AgedJobs;
+	for (int i = 0; i < 5; ++i) {
+		Aged[i].sequence = &Sequence;
+		Aged[i].out_order = &AgedOrder[i];
+	}
+	AgedDesc.priority = JobPriority::eLow;
+	JobSystem::Submit(JobChainStart, Aged[0], AgedDesc);
+	for (int i = 0; i <= JOB_AGING_UPDATES * 2; ++i) {
+		JobSystem::Update();
+	}
+	bool Promoted = Metrics::Jobs().queued_jobs[(int)JobPriority::eHigh] == 1;
+	AgedDesc.priority = JobPriority::eHigh;
+	for (int i = 1; i < 5; ++i) {
+		JobSystem::Submit(JobChainStart, Aged[i], AgedDesc);
+	}
+	GateOpen = true;
+	JobSystem::WaitForCounter(&AgedJobs);
+	printf("Low priority job aged into the high queue, ran %i of 5: %s\n", AgedOrder[0] + 1,
+		Promoted && AgedOrder[0] == 0 ? "OK" : "FAILED");
+
+	// Completions which do not fit in an update's budget or upload limit wait for the next updates.
+	const int UploadCount = 8;
+	const int SlowCount = 8;
+	int UploadsDone = 0;
+	int SlowDone = 0;
+	JobCounter BudgetJobs;
+	JobDesc UploadDesc;
+	UploadDesc.signal_counter = &BudgetJobs;
+	UploadDesc.on_success = JobCountCompleted;
+	UploadDesc.context = &UploadsDone;
+	UploadDesc.gpu_upload = true;
+	JobDesc SlowDesc;
+	SlowDesc.signal_counter = &BudgetJobs;
+	SlowDesc.on_success = JobSlowCompleted;
+	SlowDesc.context = &SlowDone;
+	for (int i = 0; i < UploadCount; ++i) {
+		JobSystem::Submit(JobPayloadStart, Payload, UploadDesc);
+	}
+	for (int i = 0; i < SlowCount; ++i) {
+		JobSystem::Submit(JobPayloadStart, Payload, SlowDesc);
+	}
+	JobSystem::WaitForCounter(&BudgetJobs);
+
+	bool BudgetKept = true;
+	int Updates = 0;
+	while ((UploadsDone < UploadCount || SlowDone < SlowCount) && Updates < 100) {
+		int UploadsBefore = UploadsDone;
+		int SlowBefore = SlowDone;
+		JobSystem::Update(2.5, 2);
+		Updates++;
+		// Slow callbacks take a millisecond each, so at most three fit. Uploads take turns with them
+		// rather than waiting for them to be through.
+		BudgetKept &= SlowDone - SlowBefore <= 3 && UploadsDone - UploadsBefore <= 2;
+		BudgetKept &= UploadsDone > UploadsBefore || UploadsDone == UploadCount;
+	}
+	printf("Budgeted completions over %i updates, %i slow and %i uploads: %s\n", Updates, SlowDone, UploadsDone,
+		BudgetKept && SlowDone == SlowCount && UploadsDone == UploadCount && Updates >= UploadCount / 2 ? "OK" : "FAILED");
+
+	// Under a budget smaller than one slow callback at most one of them runs per update.
+	// The backlogs still alternate, uploads do not wait for every slow callback.
+	UploadsDone = 0;
+	SlowDone = 0;
+	for (int i = 0; i < SlowCount; ++i) {
+		JobSystem::Submit(JobPayloadStart, Payload, SlowDesc);
+	}
+	for (int i = 0; i < UploadCount; ++i) {
+		JobSystem::Submit(JobPayloadStart, Payload, UploadDesc);
+	}
+	JobSystem::WaitForCounter(&BudgetJobs);
+
+	bool Alternated = true;
+	Updates = 0;
+	while ((UploadsDone < UploadCount || SlowDone < SlowCount) && Updates < 100) {
+		int SlowBefore = SlowDone;
+		JobSystem::Update(0.1, 2);
+		Updates++;
+		Alternated &= SlowDone - SlowBefore <= 1 && (UploadsDone >= SlowDone - 1 || UploadsDone == UploadCount);
+	}
+	printf("Tight budget completions over %i updates, %i slow and %i uploads: %s\n", Updates, SlowDone, UploadsDone,
+		Alternated && SlowDone == SlowCount && UploadsDone == UploadCount ? "OK" : "FAILED");
+
+	JobSystem::Shutdown();
+
+	printf("\n");
+	return 0;
+}
@@ -0,0 +1,402 @@
+#include <iostream>
+#include "Core/DMemory.hpp"
+#include "Memory/DynamicAllocator.h"
+#include "Platform/Platform.hpp"
+#include "../Benchmark.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Replayed when no traces are passed in. Recorded with memory_profile-trace around the array, hash table, freelist,
+// string, job system and async file read unit tests, run from the bin directory like the benchmark.
+#define BENCH_MEMORY_DEFAULT_TRACE "../Tests/Memory/Traces/unit_tests.txt"
+
+struct SBenchAllocOp {
+	// The block allocated or freed, an index into the replay's block table.
+	uint32_t block;
+	// Zero frees the block.
+	uint32_t size;
+	unsigned short alignment;
+};
+
+struct SBenchAllocPhase {
+	std::string name;
+	std::vector<SBenchAllocOp> ops;
+};
+
+struct SBenchAllocTrace {
+	std::string name;
+	uint32_t block_count = 0;
+	std::vector<SBenchAllocPhase> phases;
+};
+
+/**
+ * @brief Writes synthetic traces, keeping track of the blocks alive at each point.
+ */
+class BenchTraceBuilder {
+public:
+	explicit BenchTraceBuilder(SBenchAllocTrace* trace) : Trace(trace) {}
+
+	void BeginPhase(const std::string& name) {
+		Trace->phases.push_back({ name, {} });
+	}
+
+	uint32_t Random() {
+		Seed = Seed * 1103515245u + 12345u;
+		return Seed >> 8;
+	}
+
+	size_t RandomSize(size_t min, size_t max) {
+		return min + (size_t)Random() % (max - min + 1);
+	}
+
+	// Returns the index of the new block in the live list.
+	size_t Allocate(size_t size, unsigned short alignment = 16) {
+		uint32_t Block = Trace->block_count++;
+		Trace->phases.back().ops.push_back({ Block, (uint32_t)size, alignment });
+		Live.push_back(Block);
+		return Live.size() - 1;
+	}
+
+	void Free(size_t live_index) {
+		Trace->phases.back().ops.push_back({ Live[live_index], 0, 0 });
+		Live[live_index] = Live.back();
+		Live.pop_back();
+	}
+
+	void FreeRandom() {
+		Free(Random() % Live.size());
+	}
+
+	size_t GetLiveCount() const { return Live.size(); }
+
+private:
+	SBenchAllocTrace* Trace;
+	std::vector<uint32_t> Live;
+	uint32_t Seed = 4242;
+};
+
+/**
+ * @brief A run of the engine: loading a scene, a stretch of frames and shutting down. Modeled on the allocations the
+ * loaders, systems and render views make, none of the sizes are taken from an actual run.
+ */
+static SBenchAllocTrace BenchBuildEngineRunTrace() {
+	SBenchAllocTrace Trace;
+	Trace.name = "engine_run";
+	BenchTraceBuilder Builder(&Trace);
+
+	// Entities, nodes and names stay, materials and configs stay, texture and mesh data stays next to the staging
+	// copies the loaders free right after.
+	Builder.BeginPhase("load");
+	for (int i = 0; i < 20000; ++i) {
+		uint32_t Kind = Builder.Random() % 100;
+		if (Kind < 70) {
+			size_t Index = Builder.Allocate(Builder.RandomSize(16, 256));
+			if (Kind < 20) {
+				Builder.Free(Index);
+			}
+		}
+		else if (Kind < 99) {
+			Builder.Allocate(Builder.RandomSize(256, KIBIBYTES(16)));
+		}
+		else {
+			size_t Size = Builder.RandomSize(KIBIBYTES(64), MEBIBYTES(2));
+			size_t Staging = Builder.Allocate(Size);
+			Builder.Allocate(Size);
+			Builder.Free(Staging);
+		}
+	}
+
+	// Per frame temporaries freed at its end, now and then a material swapped or a texture streamed in.
+	Builder.BeginPhase("frames");
+	for (int Frame = 0; Frame < 300; ++Frame) {
+		size_t FrameStart = Builder.GetLiveCount();
+		for (int i = 0; i < 400; ++i) {
+			Builder.Allocate(Builder.RandomSize(16, 512));
+		}
+		while (Builder.GetLiveCount() > FrameStart) {
+			Builder.Free(FrameStart);
+		}
+
+		for (int i = 0; i < 10; ++i) {
+			Builder.FreeRandom();
+			Builder.Allocate(Builder.RandomSize(256, KIBIBYTES(16)));
+		}
+		if (Frame % 30 == 0) {
+			Builder.FreeRandom();
+			Builder.Allocate(Builder.RandomSize(KIBIBYTES(64), MEBIBYTES(2)));
+		}
+	}
+
+	Builder.BeginPhase("shutdown");
+	while (Builder.GetLiveCount() > 0) {
+		Builder.FreeRandom();
+	}
+
+	return Trace;
+}
+
+/**
+ * @brief Keeps live_count blocks of sizes between min_size and max_size alive, then frees a random one and allocates
+ * another, op_count times. Every large_share-th block is between 4KiB and 64KiB instead, if large_share is not 0.
+ */
+static SBenchAllocTrace BenchBuildChurnTrace(const std::string& name, int live_count, int op_count, size_t min_size, size_t max_size, uint32_t large_share) {
+	SBenchAllocTrace Trace;
+	Trace.name = name;
+	BenchTraceBuilder Builder(&Trace);
+	auto NextSize = [&]() {
+		return large_share != 0 && Builder.Random() % large_share == 0 ? Builder.RandomSize(KIBIBYTES(4), KIBIBYTES(64)) : Builder.RandomSize(min_size, max_size);
+	};
+
+	Builder.BeginPhase("fill");
+	for (int i = 0; i < live_count; ++i) {
+		Builder.Allocate(NextSize());
+	}
+
+	Builder.BeginPhase("churn");
+	for (int i = 0; i < op_count; ++i) {
+		Builder.FreeRandom();
+		Builder.Allocate(NextSize());
+	}
+
+	Builder.BeginPhase("drain");
+	while (Builder.GetLiveCount() > 0) {
+		Builder.FreeRandom();
+	}
+
+	return Trace;
+}
+
+/**
+ * @brief Loads a trace recorded by MemoryProfiler::StartTrace(). Blocks are told apart by their address, which a later
+ * allocation may reuse once freed. Frees of blocks allocated before recording started are dropped.
+ */
+static bool BenchLoadTrace(const std::string& path, SBenchAllocTrace* out_trace) {
+	std::ifstream File(path);
+	if (!File.is_open()) {
+		return false;
+	}
+
+	size_t NameStart = path.find_last_of("/\\") + 1;
+	out_trace->name = "trace_" + path.substr(NameStart, path.find_last_of('.') > NameStart ? path.find_last_of('.') - NameStart : std::string::npos);
+	out_trace->phases.push_back({ "replay", {} });
+	std::vector<SBenchAllocOp>& Ops = out_trace->phases.back().ops;
+
+	std::unordered_map<std::string, uint32_t> LiveBlocks;
+	std::string Line;
+	while (std::getline(File, Line)) {
+		std::istringstream Fields(Line);
+		std::string Kind, Address;
+		Fields >> Kind >> Address;
+		if (Kind == "a") {
+			unsigned long long Size = 0;
+			unsigned int Alignment = 1;
+			Fields >> Size >> Alignment;
+			uint32_t Block = out_trace->block_count++;
+			LiveBlocks[Address] = Block;
+			Ops.push_back({ Block, (uint32_t)DMAX(Size, 1ull), (unsigned short)DMAX(Alignment, 1u) });
+		}
+		else if (Kind == "f") {
+			auto Found = LiveBlocks.find(Address);
+			if (Found != LiveBlocks.end()) {
+				Ops.push_back({ Found->second, 0, 0 });
+				LiveBlocks.erase(Found);
+			}
+		}
+	}
+
+	return !Ops.empty();
+}
+
+/**
+ * @brief A DynamicAllocator of its own, without the lock and caches of the memory system in front.
+ */
+class BenchDynamicAllocatorBackend {
+public:
+	void Begin() { Allocator.Create(MEBIBYTES(64), GIBIBYTES(16ull)); }
+	void End() { Allocator.Destroy(); }
+	void* Allocate(size_t size, unsigned short alignment) { return Allocator.AllocateAligned(size, alignment); }
+	void Free(void* block, size_t /*size*/, unsigned short /*alignment*/) { Allocator.FreeAligned(block); }
+
+	// The share of free space outside the largest free block.
+	double GetFragmentation() {
+		size_t FreeSpace = Allocator.GetFreeSpace();
+		return FreeSpace > 0 ? 100.0 * (1.0 - (double)Allocator.GetLargestFreeBlock() / (double)FreeSpace) : 0.0;
+	}
+	bool HasFragmentation() const { return true; }
+
+private:
+	DynamicAllocator Allocator;
+};
+
+/**
+ * @brief The memory system as the engine uses it, with the thread caches in front of the heap.
+ */
+class BenchMemoryBackend {
+public:
+	void Begin() {}
+	void End() {}
+	void* Allocate(size_t size, unsigned short alignment) { return Memory::AllocateUninitialized(size, alignment, eMemory_Type_Array); }
+	void Free(void* block, size_t size, unsigned short alignment) { Memory::FreeAligned(block, size, alignment, eMemory_Type_Array); }
+	double GetFragmentation() { return 0.0; }
+	bool HasFragmentation() const { return false; }
+};
+
+/**
+ * @brief The memory system's object slabs for blocks fitting them, the heap for larger ones. Not zeroed, like the other backends.
+ */
+class BenchSlabBackend {
+public:
+	void Begin() {}
+	void End() {}
+	void* Allocate(size_t size, unsigned short alignment) { return Memory::AllocateObjectUninitialized(size, alignment, eMemory_Type_Array); }
+	void Free(void* block, size_t size, unsigned short alignment) { Memory::FreeAligned(block, size, alignment, eMemory_Type_Array); }
+	double GetFragmentation() { return 0.0; }
+	bool HasFragmentation() const { return false; }
+};
+
+/**
+ * @brief The C runtime's malloc, the baseline. Larger alignments than malloc guarantees keep the raw block in front.
+ */
+class BenchMallocBackend {
+public:
+	void Begin() {}
+	void End() {}
+
+	void* Allocate(size_t size, unsigned short alignment) {
+		if (alignment <= 16) {
+			return malloc(size);
+		}
+
+		void* Raw = malloc(size + alignment);
+		if (Raw == nullptr) {
+			return nullptr;
+		}
+		void** Block = (void**)PaddingAligned((size_t)Raw + sizeof(void*), alignment);
+		Block[-1] = Raw;
+		return Block;
+	}
+
+	void Free(void* block, size_t /*size*/, unsigned short alignment) {
+		free(alignment <= 16 ? block : ((void**)block)[-1]);
+	}
+
+	double GetFragmentation() { return 0.0; }
+	bool HasFragmentation() const { return false; }
+};
+
+/**
+ * @brief Replays a trace against an allocator. Every page of a new block is written to, as the code asking for it would.
+ * Reports the time per operation of each phase, how far the resident set grew and, where the allocator tells, the
+ * worst fragmentation seen at the end of a phase.
+ */
+template<typename Backend>
+static void BenchReplayTrace(const SBenchAllocTrace& trace, const std::string& backend_name, Backend& backend) {
+	std::vector<void*> Blocks(trace.block_count, nullptr);
+	std::vector<uint32_t> Sizes(trace.block_count, 0);
+	std::vector<unsigned short> Alignments(trace.block_count, 0);
+	const size_t PageSize = Platform::PlatformGetPageSize();
+
+	backend.Begin();
+	size_t BaseResident = Platform::PlatformGetResidentMemory();
+	size_t PeakResident = BaseResident;
+	double Fragmentation = 0.0;
+	int Failed = 0;
+	for (const SBenchAllocPhase& Phase : trace.phases) {
+		double Start = Platform::PlatformGetAbsoluteTime();
+		for (const SBenchAllocOp& Op : Phase.ops) {
+			if (Op.size > 0) {
+				char* Block = (char*)backend.Allocate(Op.size, Op.alignment);
+				if (Block == nullptr) {
+					Failed++;
+					continue;
+				}
+
+				for (size_t Offset = 0; Offset < Op.size; Offset += PageSize) {
+					Block[Offset] = 1;
+				}
+				Blocks[Op.block] = Block;
+				Sizes[Op.block] = Op.size;
+				Alignments[Op.block] = Op.alignment;
+			}
+			else if (Blocks[Op.block] != nullptr) {
+				backend.Free(Blocks[Op.block], Sizes[Op.block], Alignments[Op.block]);
+				Blocks[Op.block] = nullptr;
+			}
+		}
+		double Seconds = Platform::PlatformGetAbsoluteTime() - Start;
+
+		PeakResident = DMAX(PeakResident, Platform::PlatformGetResidentMemory());
+		if (backend.HasFragmentation()) {
+			Fragmentation = DMAX(Fragmentation, backend.GetFragmentation());
+		}
+
+		int OpCount = (int)Phase.ops.size();
+		ReportBenchmark("alloc_" + trace.name + "_" + Phase.name + "_" + backend_name, 1, "", OpCount,
+			OpCount > 0 ? Seconds * 1000000000.0 / OpCount : 0.0, "ns/op");
+	}
+
+	std::string Name = "alloc_" + trace.name + "_" + backend_name;
+	ReportBenchmark(Name + "_resident", 1, "", (int)trace.block_count, (double)(PeakResident - BaseResident) / MEBIBYTES(1), "MiB");
+	if (backend.HasFragmentation()) {
+		ReportBenchmark(Name + "_fragmentation", 1, "", (int)trace.block_count, Fragmentation, "%");
+	}
+	if (Failed > 0) {
+		ReportBenchmark(Name + "_failed", 1, "", (int)trace.block_count, Failed, "allocations");
+	}
+
+	// Recorded traces may end with blocks still alive.
+	for (uint32_t i = 0; i < trace.block_count; ++i) {
+		if (Blocks[i] != nullptr) {
+			backend.Free(Blocks[i], Sizes[i], Alignments[i]);
+		}
+	}
+	backend.End();
+}
+
+/**
+ * @brief Replays the synthetic traces, and the traces recorded by memory_profile-trace passed in, against the engine's
+ * allocators and malloc. Without any passed in, the recorded trace shipped with the tests is replayed.
+ */
+int BenchMemory(const std::vector<std::string>& trace_paths) {
+	printf("Benchmark memory...\n");
+
+	std::vector<SBenchAllocTrace> Traces;
+	Traces.push_back(BenchBuildEngineRunTrace());
+	Traces.push_back(BenchBuildChurnTrace("small_churn", 10000, 200000, 16, 256, 0));
+	Traces.push_back(BenchBuildChurnTrace("mixed_churn", 5000, 100000, 16, 1024, 16));
+	std::vector<std::string> TracePaths = trace_paths;
+	if (TracePaths.empty()) {
+		TracePaths.push_back(BENCH_MEMORY_DEFAULT_TRACE);
+	}
+	for (const std::string& Path : TracePaths) {
+		SBenchAllocTrace Trace;
+		if (!BenchLoadTrace(Path, &Trace)) {
+			printf("Unable to load the allocation trace %s.\n", Path.c_str());
+			continue;
+		}
+		Traces.push_back(Trace);
+	}
+
+	// Resident growth only counts memory an allocator had not touched in an earlier replay.
+	for (const SBenchAllocTrace& Trace : Traces) {
+		BenchMallocBackend Malloc;
+		BenchReplayTrace(Trace, "malloc", Malloc);
+
+		BenchDynamicAllocatorBackend Dynamic;
+		BenchReplayTrace(Trace, "dynamic_allocator", Dynamic);
+
+		BenchMemoryBackend Engine;
+		BenchReplayTrace(Trace, "memory", Engine);
+
+		BenchSlabBackend Slabs;
+		BenchReplayTrace(Trace, "memory_slabs", Slabs);
+	}
+
+	printf("\n");
+	return 0;
+}
@@ -0,0 +1,355 @@
+#include <iostream>
+#include "Core/DMemory.hpp"
+#include "Memory/EngineAllocator.h"
+#include "Memory/FrameAllocator.h"
+#include "Memory/MemoryProfiler.h"
+#include "Memory/ScratchAllocator.h"
+#include "Platform/Platform.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct MemoryTestBlock {
+	unsigned char* data = nullptr;
+	size_t size = 0;
+};
+
+// Allocates blocks of mixed sizes, frees half of them right away and hands the rest to the caller.
+static bool MemoryAllocateBlocks(int thread_index, int count, std::vector<MemoryTestBlock>* out_blocks) {
+	bool Valid = true;
+	for (int i = 0; i < count; ++i) {
+		MemoryTestBlock Block;
+		Block.size = 1 + (size_t)((i * 37 + thread_index * 11) % (i % 16 == 0 ? 8192 : 600));
+		Block.data = (unsigned char*)Memory::Allocate(Block.size, MemoryType::eMemory_Type_Job);
+		for (size_t j = 0; j < Block.size; ++j) {
+			Valid &= Block.data[j] == 0;
+		}
+		Memory::Set(Block.data, thread_index + 1, Block.size);
+
+		if (i % 2 == 0) {
+			Memory::Free(Block.data, Block.size, MemoryType::eMemory_Type_Job);
+		}
+		else {
+			out_blocks->push_back(Block);
+		}
+	}
+	return Valid;
+}
+
+struct MemoryTestObject {
+	MemoryTestObject(int value) : value(value) {}
+	~MemoryTestObject() { value = -1; }
+
+	int value = 0;
+	double payload[5];
+};
+
+struct MemoryFrameItem {
+	float distance;
+	int index;
+};
+
+int TestMemory() {
+	printf("Test memory...\n");
+
+	// A cached block still reports the size and alignment it was requested with.
+	void* Small = Memory::AllocateAligned(24, 8, MemoryType::eMemory_Type_Array);
+	size_t Size = 0;
+	unsigned short Alignment = 0;
+	bool Reported = Memory::GetAlignmentSize(Small, &Size, &Alignment) && Size == 24 && Alignment == 8;
+	Memory::FreeAligned(Small, 24, 8, MemoryType::eMemory_Type_Array);
+	printf("Cached block size and alignment: %s\n", Reported ? "OK" : "FAILED");
+
+	// Every thread allocates, then frees the blocks of its neighbour, so blocks change threads.
+	const int ThreadCount = 4;
+	const int BlockCount = 20000;
+	size_t CountBefore = Memory::GetAllocateCount();
+	std::vector<MemoryTestBlock> Blocks[ThreadCount];
+	std::atomic<int> Valid = 0;
+	double Start = Platform::PlatformGetAbsoluteTime();
+	std::vector<std::thread> Threads;
+	for (int i = 0; i < ThreadCount; ++i) {
+		Threads.emplace_back([i, &Blocks, &Valid]() {
+			if (MemoryAllocateBlocks(i, BlockCount, &Blocks[i])) {
+				Valid.fetch_add(1);
+			}
+		});
+	}
+	for (std::thread& Thread : Threads) {
+		Thread.join();
+	}
+	Threads.clear();
+
+	std::atomic<int> Intact = 0;
+	for (int i = 0; i < ThreadCount; ++i) {
+		Threads.emplace_back([i, &Blocks, &Intact]() {
+			int Owner = (i + 1) % ThreadCount;
+			bool Matches = true;
+			for (MemoryTestBlock& Block : Blocks[Owner]) {
+				for (size_t j = 0; j < Block.size; ++j) {
+					Matches &= Block.data[j] == (unsigned char)(Owner + 1);
+				}
+				Memory::Free(Block.data, Block.size, MemoryType::eMemory_Type_Job);
+			}
+			if (Matches) {
+				Intact.fetch_add(1);
+			}
+		});
+	}
+	for (std::thread& Thread : Threads) {
+		Thread.join();
+	}
+	double Time = (Platform::PlatformGetAbsoluteTime() - Start) * 1000.0;
+
+	// The threads exited, their statistics are still counted.
+	bool Balanced = Memory::GetAllocateCount() == CountBefore;
+	printf("Allocated and freed %i blocks on %i threads in %.2fms: %s\n", ThreadCount * BlockCount, ThreadCount, Time,
+		Valid.load() == ThreadCount && Intact.load() == ThreadCount && Balanced ? "OK" : "FAILED");
+
+	// Objects of one size share slabs, so they mostly sit one block after the other. Earlier frees leave a few gaps.
+	const int ObjectCount = 1000;
+	std::vector<MemoryTestObject*> Objects;
+	Start = Platform::PlatformGetAbsoluteTime();
+	for (int i = 0; i < ObjectCount; ++i) {
+		Objects.push_back(NewObject<MemoryTestObject>(i));
+	}
+	Time = Platform::PlatformGetAbsoluteTime() - Start;
+
+	int Adjacent = 0;
+	bool Constructed = true;
+	for (int i = 0; i < ObjectCount; ++i) {
+		Constructed &= Objects[i]->value == i;
+		// Freed blocks are reused last in first out, so neighbours may run downwards.
+		Adjacent += i > 0 && std::abs((long long)((char*)Objects[i] - (char*)Objects[i - 1])) == 64 ? 1 : 0;
+	}
+	char* Usage = Memory::GetMemoryUsageStr();
+	bool UsageReported = strstr(Usage, "Object slabs") != nullptr;
+	Memory::Free(Usage, strlen(Usage) + 1, MemoryType::eMemory_Type_String);
+
+	Start = Platform::PlatformGetAbsoluteTime();
+	for (MemoryTestObject* Object : Objects) {
+		DeleteObject(Object);
+	}
+	Time = (Time + Platform::PlatformGetAbsoluteTime() - Start) * 1000000.0;
+
+	// Blocks freed like any other memory find their way back to the slab.
+	MemoryTestObject* Reused = NewObject<MemoryTestObject>(7);
+	bool Recycled = Reused == Objects.back();
+	Memory::Free(Reused, sizeof(MemoryTestObject), MemoryType::eMemory_Type_Entity);
+	printf("Created and deleted %i objects in %.2fus, packed and reported: %s\n", ObjectCount, Time,
+		Adjacent >= ObjectCount * 9 / 10 && Constructed && UsageReported && Recycled ? "OK" : "FAILED");
+
+	// Frame memory is handed out in order, stays put through the next frame and is reused the frame after.
+	const int FrameItemCount = 10000;
+	CountBefore = Memory::GetAllocateCount();
+	Memory::BeginFrame();
+	Start = Platform::PlatformGetAbsoluteTime();
+	TFrameVector<MemoryFrameItem> Items;
+	Items.reserve(FrameItemCount);
+	for (int i = 0; i < FrameItemCount; ++i) {
+		Items.push_back(MemoryFrameItem{ (float)i, i });
+	}
+	Time = (Platform::PlatformGetAbsoluteTime() - Start) * 1000000.0;
+	void* FirstFrameBlock = Items.data();
+	void* FrameBlock = Memory::AllocateFrame(64, 64);
+	bool InOrder = (size_t)FrameBlock % 64 == 0 && (char*)FrameBlock >= (char*)(Items.data() + FrameItemCount);
+
+	Memory::BeginFrame();
+	void* NextFrameBlock = Memory::AllocateFrame(64, 64);
+	bool Kept = true;
+	for (int i = 0; i < FrameItemCount; ++i) {
+		Kept &= Items[i].index == i;
+	}
+	TFrameVector<MemoryFrameItem>().swap(Items);
+
+	Memory::BeginFrame();
+	bool FrameReused = Memory::AllocateFrame(64, 64) == FirstFrameBlock && NextFrameBlock != FrameBlock;
+	bool Untracked = Memory::GetAllocateCount() == CountBefore;
+	printf("Filled %i frame items in %.2fus, kept and reused: %s\n", FrameItemCount, Time,
+		InOrder && Kept && FrameReused && Untracked ? "OK" : "FAILED");
+
+	// Blocks allocated uninitialized keep what was there before, large blocks come from the heap and are zeroed again.
+	unsigned char* Scratch = (unsigned char*)Memory::Allocate(256, MemoryType::eMemory_Type_Array);
+	Memory::Set(Scratch, 0xAB, 256);
+	Memory::Free(Scratch, 256, MemoryType::eMemory_Type_Array);
+	unsigned char* Dirty = (unsigned char*)Memory::AllocateUninitialized(256, 1, MemoryType::eMemory_Type_Array);
+	bool Uncleared = Dirty == Scratch && Dirty[255] == 0xAB;
+	Memory::Free(Dirty, 256, MemoryType::eMemory_Type_Array);
+
+	// Slab blocks are handed out last freed first, so the object comes back as it was left.
+	unsigned char* Object = (unsigned char*)Memory::AllocateObject(64, 8, MemoryType::eMemory_Type_Entity);
+	Memory::Set(Object, 0xCD, 64);
+	Memory::Free(Object, 64, MemoryType::eMemory_Type_Entity);
+	unsigned char* DirtyObject = (unsigned char*)Memory::AllocateObjectUninitialized(64, 8, MemoryType::eMemory_Type_Entity);
+	Uncleared &= DirtyObject == Object && DirtyObject[63] == 0xCD;
+	Memory::Free(DirtyObject, 64, MemoryType::eMemory_Type_Entity);
+
+	const size_t LargeSize = MEBIBYTES(16);
+	unsigned char* Large = (unsigned char*)Memory::AllocateUninitialized(LargeSize, 1, MemoryType::eMemory_Type_Texture);
+	bool LargeZeroed = Memory::Owns(Large);
+	Memory::Set(Large, 0xEF, LargeSize);
+	Memory::Free(Large, LargeSize, MemoryType::eMemory_Type_Texture);
+	Start = Platform::PlatformGetAbsoluteTime();
+	Large = (unsigned char*)Memory::Allocate(LargeSize, MemoryType::eMemory_Type_Texture);
+	Time = (Platform::PlatformGetAbsoluteTime() - Start) * 1000000.0;
+	for (size_t i = 0; i < LargeSize; i += 4093) {
+		LargeZeroed &= Large[i] == 0;
+	}
+	size_t LargeReported = 0;
+	Alignment = 0;
+	LargeZeroed &= Memory::GetAlignmentSize(Large, &LargeReported, &Alignment) && LargeReported == LargeSize && Alignment == 1;
+	Memory::Free(Large, LargeSize, MemoryType::eMemory_Type_Texture);
+	printf("Uninitialized block kept, %lluMiB block zeroed in %.2fus: %s\n", (unsigned long long)(LargeSize / MEBIBYTES(1)), Time,
+		Uncleared && LargeZeroed && Memory::GetAllocateCount() == CountBefore ? "OK" : "FAILED");
+
+	// The heap commits more of its reserved range as it runs out, and fails once the range is used up.
+	DynamicAllocator Growing;
+	bool Grown = Growing.Create(DYNAMIC_ALLOCATOR_CHUNK_SIZE, MEBIBYTES(128));
+	std::vector<unsigned char*> GrowingBlocks;
+	Start = Platform::PlatformGetAbsoluteTime();
+	for (int i = 0; i < 200 && Grown; ++i) {
+		unsigned char* Block = (unsigned char*)Growing.AllocateAligned(KIBIBYTES(512), 16);
+		Grown &= Block != nullptr && Growing.Contains(Block) && (size_t)Block % 16 == 0;
+		if (Block != nullptr) {
+			Memory::Set(Block, i, KIBIBYTES(512));
+			GrowingBlocks.push_back(Block);
+		}
+	}
+	Time = (Platform::PlatformGetAbsoluteTime() - Start) * 1000.0;
+	Grown &= Growing.GetTotalSpace() >= MEBIBYTES(100) && Growing.GetTotalSpace() <= Growing.GetReservedSpace();
+	for (size_t i = 0; i < GrowingBlocks.size(); ++i) {
+		Grown &= GrowingBlocks[i][KIBIBYTES(512) - 1] == (unsigned char)i;
+		Growing.FreeAligned(GrowingBlocks[i]);
+	}
+	bool Exhausted = Growing.AllocateAligned(MEBIBYTES(200), 16) == nullptr && Growing.GetFreeSpace() == Growing.GetTotalSpace();
+	Growing.Destroy();
+	printf("Grew the heap to hold %llu blocks in %.2fms, failed past the reserve: %s\n", (unsigned long long)GrowingBlocks.size(), Time,
+		Grown && Exhausted ? "OK" : "FAILED");
+
+	// Scratch memory is stacked per thread, and a scope hands back everything allocated within it at once.
+	size_t ScratchMarker = ScratchAllocator::GetMarker();
+	void* ScratchFirst = nullptr;
+	bool Stacked = true;
+	Start = Platform::PlatformGetAbsoluteTime();
+	{
+		ScratchScope Scope;
+		ScratchFirst = ScratchAllocator::Allocate(100, 1);
+		double* Aligned = Scope.Allocate<double>(1000);
+		Stacked &= (size_t)Aligned % alignof(double) == 0 && (char*)Aligned >= (char*)ScratchFirst + 100;
+		{
+			ScratchScope Inner;
+			TScratchVector<int> Values;
+			for (int i = 0; i < 100000; ++i) {
+				Values.push_back(i);
+			}
+
+			// The buffers left behind by growing are reused, and freeing the vector pops everything off again.
+			int* Reused = Inner.Allocate<int>(50000);
+			Stacked &= Values[99999] == 99999 && Reused < Values.data();
+			ScratchAllocator::Free(Reused, 50000 * sizeof(int));
+			TScratchVector<int>().swap(Values);
+			Stacked &= ScratchAllocator::Allocate(8, 8) == (void*)(Aligned + 1000);
+		}
+		Stacked &= ScratchAllocator::Allocate(8, 8) == (void*)(Aligned + 1000);
+
+		// Scratch vectors throw rather than hand out nullptr once the reserved range is used up.
+		bool Threw = false;
+		try {
+			TScratchVector<char> Huge;
+			Huge.reserve(SCRATCH_RESERVE_SIZE);
+		}
+		catch (const std::bad_alloc&) {
+			Threw = true;
+		}
+		Stacked &= Threw;
+	}
+	Time = (Platform::PlatformGetAbsoluteTime() - Start) * 1000000.0;
+	Stacked &= ScratchAllocator::GetMarker() == ScratchMarker && ScratchAllocator::Allocate(100, 1) == ScratchFirst;
+	ScratchAllocator::Rewind(ScratchMarker);
+
+	// Threads stack on memory of their own.
+	void* OtherFirst = nullptr;
+	std::thread([&OtherFirst]() {
+		ScratchScope Scope;
+		OtherFirst = Scope.Allocate<char>(100);
+	}).join();
+	Stacked &= OtherFirst != nullptr && OtherFirst != ScratchFirst && ScratchAllocator::GetCommittedSize() >= MEBIBYTES(1);
+	printf("Scratch scopes nested and rewound in %.2fus: %s\n", Time, Stacked ? "OK" : "FAILED");
+
+	// The profiler attributes blocks to the code allocating them, catches frees of the wrong size and lists what is left.
+	MemoryProfiler::SetEnabled(true);
+	void* Profiled[4];
+	for (int i = 0; i < 4; ++i) {
+		Profiled[i] = Memory::Allocate(100, MemoryType::eMemory_Type_Job);
+	}
+	void* Leaked = Memory::AllocateAligned(3000, 16, MemoryType::eMemory_Type_Job);
+	Memory::BeginFrame();
+
+	SMemoryProfileSummary Profile;
+	MemoryProfiler::GetSummary(&Profile);
+	const SMemoryTagProfile& JobTag = Profile.tags[eMemory_Type_Job];
+	bool Attributed = Profile.outstanding_count == 5 && Profile.outstanding_bytes == 3400 && Profile.callsite_count >= 2 &&
+		JobTag.last_frame_allocations == 5 && JobTag.last_frame_bytes == 3400 && JobTag.peak >= JobTag.current && JobTag.current >= 3400;
+
+	Memory::Free(Profiled[0], 64, MemoryType::eMemory_Type_Job);
+	for (int i = 1; i < 4; ++i) {
+		Memory::Free(Profiled[i], 100, MemoryType::eMemory_Type_Job);
+	}
+	MemoryProfiler::GetSummary(&Profile);
+	bool Checked = Profile.outstanding_count == 1 && Profile.outstanding_bytes == 3000 && Profile.size_mismatches == 1;
+
+	const char* ReportPath = "memory_report_test.txt";
+	bool Written = MemoryProfiler::WriteReport(ReportPath);
+	std::remove(ReportPath);
+	Memory::FreeAligned(Leaked, 3000, 16, MemoryType::eMemory_Type_Job);
+	MemoryProfiler::SetEnabled(false);
+	printf("Profiled allocations attributed, mismatched free caught and reported: %s\n", Attributed && Checked && Written ? "OK" : "FAILED");
+
+	// Standard containers on engine allocators are counted under their tag, and give all of it back once emptied.
+	MemoryProfiler::SetEnabled(true);
+	MemoryProfiler::GetSummary(&Profile);
+	size_t DictBefore = Profile.tags[eMemory_Type_Dict].current;
+	bool Tagged = true;
+	{
+		TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_Dict> Registry;
+		TEngineVector<uint64_t, eMemory_Type_Dict> Values;
+		for (uint32_t i = 0; i < 1000; ++i) {
+			Registry["Registered_" + std::to_string(i)] = i;
+			Values.push_back(i);
+		}
+		Tagged &= Registry["Registered_999"] == 999 && Values[999] == 999;
+
+		MemoryProfiler::GetSummary(&Profile);
+		const SMemoryTagProfile& DictTag = Profile.tags[eMemory_Type_Dict];
+		Tagged &= DictTag.current >= DictBefore + 1000 * sizeof(uint64_t) && DictTag.allocation_count >= 1000;
+
+		TEngineUnorderedMap<std::string, uint32_t, eMemory_Type_Dict>().swap(Registry);
+		TEngineVector<uint64_t, eMemory_Type_Dict>().swap(Values);
+	}
+	MemoryProfiler::GetSummary(&Profile);
+	Tagged &= Profile.tags[eMemory_Type_Dict].current == DictBefore && Profile.size_mismatches == 0;
+	MemoryProfiler::SetEnabled(false);
+	printf("Engine allocator containers tracked under their tag: %s\n", Tagged ? "OK" : "FAILED");
+
+	// Engine allocator containers only live while the memory system runs, outside of it they throw rather than fall back.
+	size_t HeapSize = Memory::TotalAllocateSize;
+	Memory::Shutdown();
+	bool Refused = false;
+	try {
+		TEngineVector<uint64_t, eMemory_Type_Dict> Early;
+		Early.push_back(7);
+	}
+	catch (const std::bad_alloc&) {
+		Refused = true;
+	}
+	bool Restarted = Memory::Initialize(HeapSize);
+	printf("Engine allocator refused to allocate while the memory system was down: %s\n", Refused && Restarted ? "OK" : "FAILED");
+
+	printf("\n");
+	return 0;
+}
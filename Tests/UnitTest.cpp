@@ -5,6 +5,9 @@
 #include "Array/UnitTestArray.cpp"
 #include "Matrix/TestMatrix.cpp"
 #include "SIMD/TestSIMD.cpp"
+#include "JobSystem/TestJobSystem.cpp"
+#include "FileSystem/TestFileSystemAsync.cpp"
+#include "Memory/TestMemory.cpp"
 
 int main() {
 
@@ -17,6 +20,11 @@ int main() {
 	UnitTestAudio();
 	TestMatrix();
 	TestSIMD();
+	TestJobSystem();
+	TestJobFibers();
+	TestJobThreadLayout();
+	TestFileSystemAsync();
+	TestMemory();
 
 	return 0;
 }